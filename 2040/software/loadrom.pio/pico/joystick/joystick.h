@@ -73,6 +73,15 @@
 #define JOY_BIT_TRIGA   4       // Bit 4: Trigger A (DE-9 pin 6)
 #define JOY_BIT_TRIGB   5       // Bit 5: Trigger B (DE-9 pin 7)
 
+// PSG register 15 pin-8 outputs (mouse strobe), one bit per joystick port
+#define PSG_R15_PIN8_PORT1  4   // Bit 4: pin 8 of joystick port 1
+#define PSG_R15_PIN8_PORT2  5   // Bit 5: pin 8 of joystick port 2
+
+// MSX mouse: idle time on pin 8 after which the next toggle starts a new
+// X-high/X-low/Y-high/Y-low read and latches fresh deltas. BIOS GTPAD
+// toggles every few tens of microseconds; reads are separated by a frame.
+#define MOUSE_STROBE_TIMEOUT_US  1500u
+
 // Analog stick deadzone (percentage of full range, 0–100)
 #define DEADZONE_PERCENT  25
 
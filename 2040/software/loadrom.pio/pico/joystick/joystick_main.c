@@ -7,7 +7,8 @@
 // Turns the PicoVerse 2040 cartridge into a dedicated USB joystick adapter.
 // Intercepts MSX I/O ports:
 //   0xA0 (OUT) — PSG register address latch
-//   0xA1 (OUT) — PSG register data write (R15 bit 6 = port select)
+//   0xA1 (OUT) — PSG register data write (R15 bit 6 = port select,
+//                bits 4/5 = pin 8 mouse strobe)
 //   0xA2 (IN)  — PSG register data read  (R14 = joystick state)
 //
 // Architecture:
@@ -17,8 +18,12 @@
 //           (only pulls bits LOW for pressed buttons).
 //           For all other register reads, tri-states the bus to let
 //           the real PSG chip respond.
+//           A USB mouse (or trackball) on a port is presented as an
+//           MSX mouse: each pin-8 toggle in R15 advances the nibble
+//           sequence, so the R14 answer is ready before the read arrives.
 //   Core 1: TinyUSB host task processes USB HID gamepad reports and
-//           updates the MSX joystick state for up to 2 ports.
+//           updates the MSX joystick state for up to 2 ports. Mouse
+//           reports are accumulated as running totals for Core 0.
 //
 // This work is licensed under a "Creative Commons Attribution-NonCommercial-
 // ShareAlike 4.0 International License".
@@ -61,6 +66,33 @@ volatile uint8_t joystick_state[2] = { 0xFF, 0xFF };
 static volatile uint8_t psg_register_latch;   // Last value written to port 0xA0
 static volatile uint8_t joystick_port_sel;    // 0 = port 1, 1 = port 2
 
+// -----------------------------------------------------------------------
+// Mouse state — per MSX port
+//
+// Core 1 adds every USB report to running totals (wrapping uint32, already
+// in MSX sign: +X = left, +Y = up). Core 0 keeps how much of each total it
+// has handed to the MSX, so motion larger than one ±127 read is carried
+// over to the next read instead of being clipped. Each variable has a
+// single writer, so no lock is needed.
+// -----------------------------------------------------------------------
+static volatile bool     mouse_present[2];    // Written by Core 1
+static volatile uint8_t  mouse_buttons[2] = { 0x30, 0x30 }; // R14 bits 4/5, active-low
+static volatile uint32_t mouse_total_x[2];    // Written by Core 1
+static volatile uint32_t mouse_total_y[2];
+
+typedef struct {
+    uint32_t taken_x;       // Part of mouse_total_x already sent
+    uint32_t taken_y;
+    uint32_t last_strobe_us;
+    int8_t   dx;            // Deltas latched for the current sequence
+    int8_t   dy;
+    uint8_t  phase;         // 0 = X high, 1 = X low, 2 = Y high, 3 = Y low
+    uint8_t  strobe;        // Last pin-8 level written to R15
+    uint8_t  nibble;        // Value presented on R14 bits 0-3
+} mouse_port_t;
+
+static mouse_port_t mouse_port[2];            // Core 0 (IRQ) only
+
 // -----------------------------------------------------------------------
 // Per-device gamepad context (up to CFG_TUH_HID = 4 HID interfaces)
 // -----------------------------------------------------------------------
@@ -68,6 +100,7 @@ static volatile uint8_t joystick_port_sel;    // 0 = port 1, 1 = port 2
 
 typedef struct {
     bool             active;       // Device is mounted and recognised
+    bool             is_mouse;     // Boot-protocol mouse/trackball
     uint8_t          dev_addr;     // TinyUSB device address
     uint8_t          instance;     // TinyUSB HID instance
     uint8_t          msx_port;     // Assigned MSX port (0 or 1), 0xFF = none
@@ -114,11 +147,82 @@ static inline uint16_t __not_in_flash_func(build_opendrain_token)(uint8_t joy_st
 }
 
 // -----------------------------------------------------------------------
-// PIO1 IRQ handler — services I/O reads and writes
+// Take up to ±127 counts of pending motion from a running total.
 // -----------------------------------------------------------------------
-static void __not_in_flash_func(joystick_pio1_irq_handler)(void)
+static inline int8_t __not_in_flash_func(mouse_take)(uint32_t total, uint32_t *taken)
+{
+    int32_t pending = (int32_t)(total - *taken);
+    if (pending > 127) pending = 127;
+    if (pending < -127) pending = -127;
+    *taken += (uint32_t)pending;
+    return (int8_t)pending;
+}
+
+// -----------------------------------------------------------------------
+// Pin 8 of a mouse port toggled: present the next nibble. The first toggle
+// after MOUSE_STROBE_TIMEOUT_US of silence restarts the sequence and
+// latches new X/Y deltas.
+// -----------------------------------------------------------------------
+static void __not_in_flash_func(mouse_strobe)(uint8_t port)
+{
+    mouse_port_t *ms = &mouse_port[port];
+    uint32_t now = time_us_32();
+
+    if (now - ms->last_strobe_us > MOUSE_STROBE_TIMEOUT_US)
+        ms->phase = 0;
+    ms->last_strobe_us = now;
+
+    switch (ms->phase)
+    {
+        case 0:
+            ms->dx = mouse_take(mouse_total_x[port], &ms->taken_x);
+            ms->dy = mouse_take(mouse_total_y[port], &ms->taken_y);
+            ms->nibble = ((uint8_t)ms->dx >> 4) & 0x0Fu;
+            break;
+        case 1:
+            ms->nibble = (uint8_t)ms->dx & 0x0Fu;
+            break;
+        case 2:
+            ms->nibble = ((uint8_t)ms->dy >> 4) & 0x0Fu;
+            break;
+        default:
+            ms->nibble = (uint8_t)ms->dy & 0x0Fu;
+            break;
+    }
+    ms->phase = (ms->phase + 1u) & 0x03u;
+}
+
+// -----------------------------------------------------------------------
+// R15 write: follow the pin-8 level of each port that has a mouse. Ports
+// without a mouse drop any motion left over from an unplugged one.
+// -----------------------------------------------------------------------
+static inline void __not_in_flash_func(mouse_track_r15)(uint8_t data)
+{
+    for (uint8_t port = 0; port < 2; port++)
+    {
+        mouse_port_t *ms = &mouse_port[port];
+        uint8_t strobe = (data >> (PSG_R15_PIN8_PORT1 + port)) & 0x01u;
+
+        if (!mouse_present[port])
+        {
+            ms->taken_x = mouse_total_x[port];
+            ms->taken_y = mouse_total_y[port];
+            ms->strobe = strobe;
+            continue;
+        }
+        if (strobe != ms->strobe)
+        {
+            ms->strobe = strobe;
+            mouse_strobe(port);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+// Apply captured I/O writes (ports 0xA0, 0xA1)
+// -----------------------------------------------------------------------
+static inline void __not_in_flash_func(joystick_drain_writes)(void)
 {
-    // --- Handle I/O writes first (ports 0xA0, 0xA1) ---
     while (!pio_sm_is_rx_fifo_empty(IO_PIO, IO_SM_WRITE))
     {
         uint32_t sample = pio_sm_get(IO_PIO, IO_SM_WRITE);
@@ -132,29 +236,46 @@ static void __not_in_flash_func(joystick_pio1_irq_handler)(void)
         }
         else if (port == PSG_WRITE_PORT)
         {
-            // PSG data write — we only care about R15 (port select)
+            // PSG data write — we only care about R15 (port select,
+            // mouse strobe)
             if (psg_register_latch == PSG_REG_PORTB)
             {
                 // Bit 6 selects joystick port: 0 = port 1, 1 = port 2
                 joystick_port_sel = (data >> 6) & 0x01u;
+                mouse_track_r15(data);
             }
         }
     }
+}
+
+// -----------------------------------------------------------------------
+// PIO1 IRQ handler — services I/O reads and writes
+// -----------------------------------------------------------------------
+static void __not_in_flash_func(joystick_pio1_irq_handler)(void)
+{
+    // --- Handle I/O writes first (ports 0xA0, 0xA1) ---
+    joystick_drain_writes();
 
     // --- Handle I/O reads (port 0xA2) ---
-    // The PIO asserts /WAIT and is stalled on pull — we MUST respond
-    // to every read or the Z80 hangs.
+    // The PIO only passes port 0xA2 here; it asserts /WAIT and is stalled
+    // on pull — we MUST respond to every read or the Z80 hangs.
     while (!pio_sm_is_rx_fifo_empty(IO_PIO, IO_SM_READ))
     {
         uint16_t addr = (uint16_t)pio_sm_get(IO_PIO, IO_SM_READ);
         uint8_t port = (uint8_t)(addr & 0xFFu);
 
+        // A read picked up on a later pass of this loop may follow R15/latch
+        // writes (mouse strobe) that are still queued: apply them first.
+        joystick_drain_writes();
+
         if (port == PSG_READ_PORT && psg_register_latch == PSG_REG_PORTA)
         {
             // R14 read — return joystick state using open-drain protocol
             uint8_t sel = joystick_port_sel;  // 0 or 1
-            pio_sm_put(IO_PIO, IO_SM_READ,
-                       build_opendrain_token(joystick_state[sel]));
+            uint8_t state = joystick_state[sel];
+            if (mouse_present[sel])
+                state = 0xC0u | mouse_buttons[sel] | mouse_port[sel].nibble;
+            pio_sm_put(IO_PIO, IO_SM_READ, build_opendrain_token(state));
         }
         else
         {
@@ -220,6 +341,11 @@ static void io_bus_init(void)
     sm_config_set_clkdiv(&cfg_r, 1.0f);
     pio_sm_init(IO_PIO, IO_SM_READ, offset_read, &cfg_r);
 
+    // X = owned port for the PIO-side filter: only reads of port 0xA2 reach the CPU.
+    pio_sm_put(IO_PIO, IO_SM_READ, PSG_READ_PORT);
+    pio_sm_exec(IO_PIO, IO_SM_READ, pio_encode_pull(false, false));
+    pio_sm_exec(IO_PIO, IO_SM_READ, pio_encode_mov(pio_x, pio_osr));
+
     // Preload /WAIT low; the PIO releases it by switching direction to input.
     pio_sm_set_pins_with_mask(IO_PIO, IO_SM_READ, 0u, (1u << PIN_WAIT));
 
@@ -308,22 +434,43 @@ void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance,
     gamepad_dev_t *gp = &gamepads[slot];
     memset(gp, 0, sizeof(*gp));
 
-    // Try to parse as a gamepad
-    if (!gp_parse_descriptor(desc_report, desc_len, &gp->layout))
+    // Boot-protocol mice (and trackballs, which enumerate as mice) become
+    // MSX mice; anything else must parse as a gamepad.
+    bool is_mouse = (tuh_hid_interface_protocol(dev_addr, instance) == HID_ITF_PROTOCOL_MOUSE);
+    if (!is_mouse && !gp_parse_descriptor(desc_report, desc_len, &gp->layout))
         return;  // Not a gamepad or unrecognised descriptor
 
     uint8_t port = allocate_msx_port();
     if (port == 0xFF) return;  // Both ports taken
 
     gp->active   = true;
+    gp->is_mouse = is_mouse;
     gp->dev_addr = dev_addr;
     gp->instance = instance;
     gp->msx_port = port;
 
+    if (is_mouse)
+    {
+        // Reports arrive in boot format (buttons, dX, dY) once the
+        // protocol switch completes; reception starts in the callback.
+        mouse_buttons[port] = 0x30;
+        __dmb();
+        mouse_present[port] = true;
+        if (tuh_hid_set_protocol(dev_addr, instance, HID_PROTOCOL_BOOT))
+            return;
+    }
+
     // Start receiving reports
     tuh_hid_receive_report(dev_addr, instance);
 }
 
+void tuh_hid_set_protocol_complete_cb(uint8_t dev_addr, uint8_t instance, uint8_t protocol)
+{
+    (void)protocol;
+    if (find_gamepad(dev_addr, instance) >= 0)
+        tuh_hid_receive_report(dev_addr, instance);
+}
+
 void tuh_hid_umount_cb(uint8_t dev_addr, uint8_t instance)
 {
     int slot = find_gamepad(dev_addr, instance);
@@ -332,7 +479,14 @@ void tuh_hid_umount_cb(uint8_t dev_addr, uint8_t instance)
     // Release MSX port — set state to idle
     uint8_t port = gamepads[slot].msx_port;
     if (port < 2)
+    {
         joystick_state[port] = 0xFF;
+        if (gamepads[slot].is_mouse)
+        {
+            mouse_present[port] = false;
+            mouse_buttons[port] = 0x30;
+        }
+    }
 
     gamepads[slot].active = false;
 }
@@ -346,6 +500,20 @@ void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t instance,
         const uint8_t *data = report;
         uint16_t data_len = len;
 
+        if (gp->is_mouse) {
+            // Boot mouse report: buttons, dX, dY (USB: +X right, +Y down)
+            if (len >= 3 && gp->msx_port < 2) {
+                uint8_t port = gp->msx_port;
+                mouse_total_x[port] -= (uint32_t)(int32_t)(int8_t)report[1];
+                mouse_total_y[port] -= (uint32_t)(int32_t)(int8_t)report[2];
+                mouse_buttons[port] = (uint8_t)(((report[0] & 0x01u) ? 0 : (1u << JOY_BIT_TRIGA)) |
+                                                ((report[0] & 0x02u) ? 0 : (1u << JOY_BIT_TRIGB)));
+                __dmb();
+            }
+            tuh_hid_receive_report(dev_addr, instance);
+            return;
+        }
+
         // Skip report ID byte if present
         if (gp->layout.report_id != 0 && len > 0) {
             data++;
@@ -390,6 +558,7 @@ int main(void)
     psg_register_latch = 0;
     joystick_port_sel = 0;
     memset(gamepads, 0, sizeof(gamepads));
+    memset(mouse_port, 0, sizeof(mouse_port));
 
     setup_gpio();
     io_bus_init();
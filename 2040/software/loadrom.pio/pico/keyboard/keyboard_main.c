@@ -103,8 +103,8 @@ static void __not_in_flash_func(keyboard_pio1_irq_handler)(void)
     }
 
     // --- Handle I/O reads (port 0xA9) ---
-    // The PIO asserts /WAIT and is stalled on pull — we MUST respond
-    // to every read or the Z80 hangs.
+    // The PIO only passes port 0xA9 here; it asserts /WAIT and is stalled
+    // on pull — we MUST respond to every read or the Z80 hangs.
     while (!pio_sm_is_rx_fifo_empty(IO_PIO, IO_SM_READ))
     {
         uint16_t addr = (uint16_t)pio_sm_get(IO_PIO, IO_SM_READ);
@@ -179,6 +179,11 @@ static void io_bus_init(void)
     sm_config_set_clkdiv(&cfg_r, 1.0f);
     pio_sm_init(IO_PIO, IO_SM_READ, offset_read, &cfg_r);
 
+    // X = owned port for the PIO-side filter: only reads of port 0xA9 reach the CPU.
+    pio_sm_put(IO_PIO, IO_SM_READ, 0xA9u);
+    pio_sm_exec(IO_PIO, IO_SM_READ, pio_encode_pull(false, false));
+    pio_sm_exec(IO_PIO, IO_SM_READ, pio_encode_mov(pio_x, pio_osr));
+
     // Set /WAIT pin HIGH in the PIO output register BEFORE switching mux.
     // This prevents a brief /WAIT=LOW glitch that would freeze the Z80.
     pio_sm_set_pins_with_mask(IO_PIO, IO_SM_READ, (1u << PIN_WAIT), (1u << PIN_WAIT));
@@ -249,6 +249,11 @@ static void msx_pio_io_bus_init(void)
     sm_config_set_clkdiv(&cfg_io_read, 1.0f);
     pio_sm_init(msx_io_bus.pio_read, msx_io_bus.sm_io_read, msx_io_bus.offset_io_read, &cfg_io_read);
 
+    // X = owned port block for the PIO-side filter: only FC-FF reads reach the CPU.
+    pio_sm_put(msx_io_bus.pio_read, msx_io_bus.sm_io_read, 0xFCu >> 2);
+    pio_sm_exec(msx_io_bus.pio_read, msx_io_bus.sm_io_read, pio_encode_pull(false, false));
+    pio_sm_exec(msx_io_bus.pio_read, msx_io_bus.sm_io_read, pio_encode_mov(pio_x, pio_osr));
+
     pio_sm_config cfg_io_write = msx_io_write_captor_program_get_default_config(msx_io_bus.offset_io_write);
     sm_config_set_in_pins(&cfg_io_write, PIN_A0);
     sm_config_set_in_shift(&cfg_io_write, false, false, 32);
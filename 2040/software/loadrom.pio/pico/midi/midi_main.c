@@ -152,7 +152,7 @@ static void __not_in_flash_func(midi_pio1_irq_handler)(void) {
         }
     }
 
-    // --- Handle I/O reads ---
+    // --- Handle I/O reads (ports 0xE8-0xEF, filtered by the PIO) ---
     while (!pio_sm_is_rx_fifo_empty(IO_PIO, IO_SM_READ)) {
         uint16_t addr = (uint16_t)pio_sm_get(IO_PIO, IO_SM_READ);
         uint8_t port = (uint8_t)(addr & 0xFFu);
@@ -262,6 +262,11 @@ static void io_bus_init(void) {
     sm_config_set_clkdiv(&cfg_r, 1.0f);
     pio_sm_init(IO_PIO, IO_SM_READ, offset_read, &cfg_r);
 
+    // X = owned port for the PIO-side filter: only reads of ports 0xE8-0xEF reach the CPU.
+    pio_sm_put(IO_PIO, IO_SM_READ, (0xE8u >> 3));
+    pio_sm_exec(IO_PIO, IO_SM_READ, pio_encode_pull(false, false));
+    pio_sm_exec(IO_PIO, IO_SM_READ, pio_encode_mov(pio_x, pio_osr));
+
     // Preload /WAIT low; the PIO releases it by switching direction to input.
     pio_sm_set_pins_with_mask(IO_PIO, IO_SM_READ, 0u, (1u << PIN_WAIT));
 
@@ -30,8 +30,8 @@
 #include "midi_fw.h"
 #include "midipac_fw.h"
 #include "joystick_fw.h"
-#include "sha1.h"
-#include "romdb.h"
+#define MAPPER_DETECT_MAX_ROM_SIZE (16u * 1024u * 1024u) // matches MAX_ROM_SIZE below
+#include "../../../../../common/mapper_detect.h"
 
 #ifndef APP_VERSION
 #define APP_VERSION "v1.0"
@@ -147,23 +147,11 @@ const char* mapper_description(int number) {
     return MAPPER_DESCRIPTIONS[number - 1];
 }
 
-// Attempt to guess the mapper type from the ROM contents.
-// Returns the mapper byte expected by the firmware (0 signals unsupported/unknown).
-// Code adapted from openMSX mapper detection routines.
+// Attempt to guess the mapper type from the ROM contents using the shared
+// SHA1 + heuristic detector (common/mapper_detect.h, the same header as the
+// 2350 tools and the Explorer firmware). Returns the mapper byte expected by
+// the firmware (0 signals unsupported/unknown).
 uint8_t detect_rom_type(const char *filename, uint32_t size) {
-    
-    // Define the NEO8 signature
-    const char neo8_signature[] = "ROM_NEO8";
-    const char neo16_signature[] = "ROM_NE16";
-    const char ascii16x_signature[] = "ASCII16X";
-
-    // Scores for each mapper type (unit weights, matching openMSX guessRomType)
-    unsigned int konami_score = 0;
-    unsigned int konami_scc_score = 0;
-    unsigned int ascii8_score = 0;
-    unsigned int ascii16_score = 0;
-
-    //size_t size = file_size(filename);
     if (size > MAX_ROM_SIZE || size < MIN_ROM_SIZE) {
         printf("Invalid ROM size\n");
         return 0; // unknown mapper
@@ -175,216 +163,33 @@ uint8_t detect_rom_type(const char *filename, uint32_t size) {
         return 0; // unknown mapper
     }
 
-    // openMSX-style: inspect the full ROM for mapper-write patterns.
-    size_t read_size = size;
-    // Dynamically allocate memory for the ROM
-    uint8_t *rom = (uint8_t *)malloc(read_size);
+    uint8_t *rom = (uint8_t *)malloc(size);
     if (!rom) {
         printf("Failed to allocate memory for ROM\n");
         fclose(file);
         return 0; // unknown mapper
     }
 
-    size_t read_bytes = fread(rom, 1, read_size, file);
+    size_t read_bytes = fread(rom, 1, size, file);
     fclose(file);
-    if (read_bytes != read_size) {
+    if (read_bytes != size) {
         printf("Failed to read ROM data from %s\n", filename);
         free(rom);
         return 0; // unknown mapper
     }
 
-    // SHA1 database lookup (openMSX softwaredb) — checked before heuristics.
-    {
-        uint8_t sha1[20];
-        sha1_from_buffer(rom, (uint32_t)read_size, sha1);
-        uint8_t db_type = romdb_lookup(sha1);
-        if (db_type) {
-            free(rom);
-            return db_type;
-        }
-    }
-    
-    // Check if the ROM has the signature "AB" at 0x0000 and 0x0001
-    // Those are the cases for 16KB and 32KB ROMs
-    if (rom[0] == 'A' && rom[1] == 'B' && size == 16384) {
-        free(rom);
-        return 1;     // Plain 16KB 
-    }
-
-    if (rom[0] == 'A' && rom[1] == 'B' && size <= 32768) {
-
-        // Check if it is a normal 32KB ROM or Planar32/48-style layout.
-        if (rom[0x4000] == 'A' && rom[0x4001] == 'B') {
-            free(rom);
-            return 4; // Planar32/48 style (AB at 0x4000)
-        }
-        
-        free(rom);
-        return 2;     // Plain 32KB 
-    }
-
-    // Check for the "AB" header at the start
-    if (rom[0] == 'A' && rom[1] == 'B') {
-        if (memcmp(&rom[16], ascii16x_signature, sizeof(ascii16x_signature) - 1) == 0) {
-            free(rom);
-            return ROM_TYPE_ASCII16X; // ASCII16-X mapper detected
-        }
-        // Check for the NEO8 signature at offset 16
-        if (memcmp(&rom[16], neo8_signature, sizeof(neo8_signature) - 1) == 0) {
-            free(rom);
-            return 8; // NEO8 mapper detected
-        } else if (memcmp(&rom[16], neo16_signature, sizeof(neo16_signature) - 1) == 0) {
-            free(rom);
-            return 9; // NEO16 mapper detected
-        }
-    }
-
-    // Manbow 2 detection: 512KB ROM with "Manbow 2" string at offset 0x28000.
-    // All known Manbow 2 dumps share this signature (game-over music track label).
-    // Must be checked before the heuristic scoring which would classify it as Konami SCC.
-    if (size == 524288u && rom[0] == 'A' && rom[1] == 'B' &&
-        memcmp(&rom[0x28000], "Manbow 2", 8) == 0)
-    {
-        free(rom);
-        return ROM_TYPE_MANBOW2;
-    }
-
-    // Check if the ROM has the signature "AB" at 0x4000 and 0x4001
-    // That is the case for 48KB Planar mapping.
-    if (rom[0x4000] == 'A' && rom[0x4001] == 'B' && size <= 49152) {
-        free(rom);
-        return 4; // Planar48
-    }
-
-    // 64KB planar ROMs may only expose AB at 0x4000.
-    // Treat that as sufficient for Planar64 classification.
-    if (size == 65536u) {
-        bool ab4000 = (rom[0x4000] == 'A' && rom[0x4001] == 'B');
-
-        if (ab4000) {
-            free(rom);
-            return ROM_TYPE_PLANAR64;
-        }
-    }
-
-    // Heuristic analysis for larger ROMs
-    if (size > 32768) {
-        // Scan through the ROM data to detect ld (nnnn),a patterns.
-        // Scoring matches openMSX guessRomType(): unit weights, no SCC
-        // credit for 0x6000, and >= tie-breaking favoring later types.
-        for (size_t i = 0; i < read_size - 3; i++) {
-            if (rom[i] == 0x32) { // ld (nnnn),a
-                uint16_t addr = rom[i + 1] | (rom[i + 2] << 8);
-                switch (addr) {
-                    case 0x4000:
-                    case 0x8000:
-                    case 0xA000:
-                        konami_score++;
-                        break;
-                    case 0x5000:
-                    case 0x9000:
-                    case 0xB000:
-                        konami_scc_score++;
-                        break;
-                    case 0x6800:
-                    case 0x7800:
-                        ascii8_score++;
-                        break;
-                    case 0x77FF:
-                        ascii16_score++;
-                        break;
-                    case 0x6000:
-                        konami_score++;
-                        ascii8_score++;
-                        ascii16_score++;
-                        break;
-                    case 0x7000:
-                        konami_scc_score++;
-                        ascii8_score++;
-                        ascii16_score++;
-                        break;
-                }
-            }
-        }
-
-        // openMSX quirk: subtract 1 from ASCII8 if non-zero.
-        if (ascii8_score) ascii8_score--;
+    mapper_detect_result_t result;
+    uint8_t mapper = mapper_detect_buffer_ranked(rom, size, 0u, &result);
+    free(rom);
 
 #if defined(DEBUG) || defined(_DEBUG)
-        printf("DEBUG: ascii8_score = %u\n", ascii8_score);
-        printf("DEBUG: ascii16_score = %u\n", ascii16_score);
-        printf("DEBUG: konami_score = %u\n", konami_score);
-        printf("DEBUG: konami_scc_score = %u\n\n", konami_scc_score);
+    for (uint8_t i = 0; i < result.count; ++i) {
+        printf("DEBUG: candidate %u mapper %u confidence %u (source %u)\n",
+               i, result.cand[i].mapper, result.cand[i].confidence, result.source);
+    }
 #endif
 
-        // Pick the winner using >= so that later types win ties.
-        // Iteration order: KonamiSCC, Konami, ASCII8, ASCII16.
-        // This means ASCII16 beats ASCII8 on equal scores, etc.
-        {
-            uint8_t best_type = 0; // GENERIC_8KB / unknown
-            unsigned int best_score = 0;
-            struct { unsigned int score; uint8_t type; } candidates[] = {
-                { konami_scc_score, 3 },  // Konami SCC
-                { konami_score,     7 },  // Konami
-                { ascii8_score,     5 },  // ASCII8
-                { ascii16_score,    6 },  // ASCII16
-            };
-            for (int c = 0; c < 4; c++) {
-                if (candidates[c].score && candidates[c].score >= best_score) {
-                    best_score = candidates[c].score;
-                    best_type = candidates[c].type;
-                }
-            }
-            if (best_type) {
-                free(rom);
-                return best_type;
-            }
-        }
-
-        // Avoid false positives when no mapper writes were identified.
-        // For 64KB ROMs with AB header(s), fallback to Planar64.
-        if (konami_score == 0 && konami_scc_score == 0 && ascii8_score == 0 && ascii16_score == 0)
-        {
-            bool ab0 = (rom[0x0000] == 'A' && rom[0x0001] == 'B');
-            bool ab4000 = (rom[0x4000] == 'A' && rom[0x4001] == 'B');
-
-            if (size == 65536u && (ab0 || ab4000))
-            {
-                free(rom);
-                return ROM_TYPE_PLANAR64;
-            }
-
-            // Some valid dumps contain no detectable ld(nn),a mapper writes.
-            // For AB-header ROMs larger than 64KB, use raw constant density
-            // as a secondary hint: 0x77FF favors ASCII16; otherwise ASCII8.
-            if (size > 65536u && ab0 && ((size % 16384u) == 0u))
-            {
-                unsigned int raw_77ff = 0u;
-                unsigned int raw_6800 = 0u;
-                unsigned int raw_7800 = 0u;
-
-                for (size_t i = 0; i + 1 < read_size; ++i)
-                {
-                    uint16_t raw = (uint16_t)(rom[i] | (rom[i + 1] << 8));
-                    if (raw == 0x77FFu) ++raw_77ff;
-                    else if (raw == 0x6800u) ++raw_6800;
-                    else if (raw == 0x7800u) ++raw_7800;
-                }
-
-                free(rom);
-                return (raw_77ff > (raw_6800 + raw_7800)) ? 6 : 5; // ASCII16 : ASCII8
-            }
-
-            free(rom);
-            return 0; // unknown mapper
-        }
-
-        free(rom);
-        return 0; // unknown mapper
-    }
-    
-    free(rom);
-    return 0;
+    return mapper;
 }
 
 // Print usage information
@@ -1,121 +0,0 @@
-// Minimal SHA-1 implementation for PicoVerse PC tools.
-// Based on the public-domain implementation by Steve Reid.
-//
-// Usage:
-//   uint8_t digest[20];
-//   sha1_from_buffer(data, length, digest);
-
-#ifndef SHA1_H
-#define SHA1_H
-
-#include <stdint.h>
-#include <string.h>
-
-typedef struct {
-    uint32_t state[5];
-    uint32_t count[2];
-    uint8_t  buffer[64];
-} sha1_ctx;
-
-static inline uint32_t sha1_rol(uint32_t value, unsigned int bits)
-{
-    return (value << bits) | (value >> (32 - bits));
-}
-
-#define SHA1_BLK0(i) (block[i] = (sha1_rol(block[i],24)&0xFF00FF00u) \
-                                | (sha1_rol(block[i],8)&0x00FF00FFu))
-#define SHA1_BLK(i)  (block[i&15] = sha1_rol(block[(i+13)&15]^block[(i+8)&15] \
-                                              ^block[(i+2)&15]^block[i&15],1))
-
-#define SHA1_R0(v,w,x,y,z,i) z+=((w&(x^y))^y)+SHA1_BLK0(i)+0x5A827999u+sha1_rol(v,5);w=sha1_rol(w,30);
-#define SHA1_R1(v,w,x,y,z,i) z+=((w&(x^y))^y)+SHA1_BLK(i)+0x5A827999u+sha1_rol(v,5);w=sha1_rol(w,30);
-#define SHA1_R2(v,w,x,y,z,i) z+=(w^x^y)+SHA1_BLK(i)+0x6ED9EBA1u+sha1_rol(v,5);w=sha1_rol(w,30);
-#define SHA1_R3(v,w,x,y,z,i) z+=(((w|x)&y)|(w&x))+SHA1_BLK(i)+0x8F1BBCDCu+sha1_rol(v,5);w=sha1_rol(w,30);
-#define SHA1_R4(v,w,x,y,z,i) z+=(w^x^y)+SHA1_BLK(i)+0xCA62C1D6u+sha1_rol(v,5);w=sha1_rol(w,30);
-
-static void sha1_transform(uint32_t state[5], const uint8_t buf[64])
-{
-    uint32_t a, b, c, d, e;
-    uint32_t block[16];
-    memcpy(block, buf, 64);
-
-    a = state[0]; b = state[1]; c = state[2]; d = state[3]; e = state[4];
-
-    SHA1_R0(a,b,c,d,e, 0); SHA1_R0(e,a,b,c,d, 1); SHA1_R0(d,e,a,b,c, 2); SHA1_R0(c,d,e,a,b, 3);
-    SHA1_R0(b,c,d,e,a, 4); SHA1_R0(a,b,c,d,e, 5); SHA1_R0(e,a,b,c,d, 6); SHA1_R0(d,e,a,b,c, 7);
-    SHA1_R0(c,d,e,a,b, 8); SHA1_R0(b,c,d,e,a, 9); SHA1_R0(a,b,c,d,e,10); SHA1_R0(e,a,b,c,d,11);
-    SHA1_R0(d,e,a,b,c,12); SHA1_R0(c,d,e,a,b,13); SHA1_R0(b,c,d,e,a,14); SHA1_R0(a,b,c,d,e,15);
-    SHA1_R1(e,a,b,c,d,16); SHA1_R1(d,e,a,b,c,17); SHA1_R1(c,d,e,a,b,18); SHA1_R1(b,c,d,e,a,19);
-    SHA1_R2(a,b,c,d,e,20); SHA1_R2(e,a,b,c,d,21); SHA1_R2(d,e,a,b,c,22); SHA1_R2(c,d,e,a,b,23);
-    SHA1_R2(b,c,d,e,a,24); SHA1_R2(a,b,c,d,e,25); SHA1_R2(e,a,b,c,d,26); SHA1_R2(d,e,a,b,c,27);
-    SHA1_R2(c,d,e,a,b,28); SHA1_R2(b,c,d,e,a,29); SHA1_R2(a,b,c,d,e,30); SHA1_R2(e,a,b,c,d,31);
-    SHA1_R2(d,e,a,b,c,32); SHA1_R2(c,d,e,a,b,33); SHA1_R2(b,c,d,e,a,34); SHA1_R2(a,b,c,d,e,35);
-    SHA1_R2(e,a,b,c,d,36); SHA1_R2(d,e,a,b,c,37); SHA1_R2(c,d,e,a,b,38); SHA1_R2(b,c,d,e,a,39);
-    SHA1_R3(a,b,c,d,e,40); SHA1_R3(e,a,b,c,d,41); SHA1_R3(d,e,a,b,c,42); SHA1_R3(c,d,e,a,b,43);
-    SHA1_R3(b,c,d,e,a,44); SHA1_R3(a,b,c,d,e,45); SHA1_R3(e,a,b,c,d,46); SHA1_R3(d,e,a,b,c,47);
-    SHA1_R3(c,d,e,a,b,48); SHA1_R3(b,c,d,e,a,49); SHA1_R3(a,b,c,d,e,50); SHA1_R3(e,a,b,c,d,51);
-    SHA1_R3(d,e,a,b,c,52); SHA1_R3(c,d,e,a,b,53); SHA1_R3(b,c,d,e,a,54); SHA1_R3(a,b,c,d,e,55);
-    SHA1_R3(e,a,b,c,d,56); SHA1_R3(d,e,a,b,c,57); SHA1_R3(c,d,e,a,b,58); SHA1_R3(b,c,d,e,a,59);
-    SHA1_R4(a,b,c,d,e,60); SHA1_R4(e,a,b,c,d,61); SHA1_R4(d,e,a,b,c,62); SHA1_R4(c,d,e,a,b,63);
-    SHA1_R4(b,c,d,e,a,64); SHA1_R4(a,b,c,d,e,65); SHA1_R4(e,a,b,c,d,66); SHA1_R4(d,e,a,b,c,67);
-    SHA1_R4(c,d,e,a,b,68); SHA1_R4(b,c,d,e,a,69); SHA1_R4(a,b,c,d,e,70); SHA1_R4(e,a,b,c,d,71);
-    SHA1_R4(d,e,a,b,c,72); SHA1_R4(c,d,e,a,b,73); SHA1_R4(b,c,d,e,a,74); SHA1_R4(a,b,c,d,e,75);
-    SHA1_R4(e,a,b,c,d,76); SHA1_R4(d,e,a,b,c,77); SHA1_R4(c,d,e,a,b,78); SHA1_R4(b,c,d,e,a,79);
-
-    state[0] += a; state[1] += b; state[2] += c; state[3] += d; state[4] += e;
-}
-
-static inline void sha1_init(sha1_ctx *ctx)
-{
-    ctx->state[0] = 0x67452301u;
-    ctx->state[1] = 0xEFCDAB89u;
-    ctx->state[2] = 0x98BADCFEu;
-    ctx->state[3] = 0x10325476u;
-    ctx->state[4] = 0xC3D2E1F0u;
-    ctx->count[0] = ctx->count[1] = 0;
-}
-
-static inline void sha1_update(sha1_ctx *ctx, const uint8_t *data, uint32_t len)
-{
-    uint32_t i, j;
-    j = (ctx->count[0] >> 3) & 63;
-    if ((ctx->count[0] += len << 3) < (len << 3))
-        ctx->count[1]++;
-    ctx->count[1] += (len >> 29);
-    if ((j + len) > 63) {
-        i = 64 - j;
-        memcpy(&ctx->buffer[j], data, i);
-        sha1_transform(ctx->state, ctx->buffer);
-        for (; i + 63 < len; i += 64)
-            sha1_transform(ctx->state, &data[i]);
-        j = 0;
-    } else {
-        i = 0;
-    }
-    memcpy(&ctx->buffer[j], &data[i], len - i);
-}
-
-static inline void sha1_final(sha1_ctx *ctx, uint8_t digest[20])
-{
-    uint8_t finalcount[8];
-    for (unsigned int i = 0; i < 8; i++)
-        finalcount[i] = (uint8_t)((ctx->count[(i >= 4) ? 0 : 1]
-                         >> ((3 - (i & 3)) * 8)) & 255);
-    sha1_update(ctx, (const uint8_t *)"\200", 1);
-    while ((ctx->count[0] & 504) != 448)
-        sha1_update(ctx, (const uint8_t *)"\0", 1);
-    sha1_update(ctx, finalcount, 8);
-    for (unsigned int i = 0; i < 20; i++)
-        digest[i] = (uint8_t)((ctx->state[i >> 2] >> ((3 - (i & 3)) * 8)) & 255);
-}
-
-// Convenience: compute SHA1 of a buffer in one call.
-static inline void sha1_from_buffer(const uint8_t *data, uint32_t len, uint8_t digest[20])
-{
-    sha1_ctx ctx;
-    sha1_init(&ctx);
-    sha1_update(&ctx, data, len);
-    sha1_final(&ctx, digest);
-}
-
-#endif // SHA1_H
@@ -0,0 +1,71 @@
+// MSX PICOVERSE PROJECT
+// (c) 2026 Cristiano Goncalves
+// The Retro Hacker
+//
+// mailbox.c - Framed request/reply mailbox to the PicoVerse 2350 Explorer firmware
+//
+// This work is licensed  under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+// License". https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+#include <string.h>
+#include "menu.h"
+#include "mailbox.h"
+
+#define MBOX_DEFAULT_TIMEOUT 600 // Jiffies (10 s at 60 Hz) for menu commands
+
+static unsigned char mbox_seq = 0;
+
+unsigned char mbox_call(unsigned char cmd, const void *request, unsigned int request_len, unsigned int timeout_jiffies) {
+    volatile unsigned int *jiffyPtr = (volatile unsigned int *)JIFFY;
+    unsigned int start;
+    unsigned char status;
+
+    if (request_len > MBOX_PAYLOAD_SIZE) {
+        return MBOX_STATUS_ERROR;
+    }
+    Poke(MBOX_CMD, cmd);
+    Poke(MBOX_LEN_L, (unsigned char)(request_len & 0xFF));
+    Poke(MBOX_LEN_H, (unsigned char)(request_len >> 8));
+    if (request_len) {
+        memcpy((void *)MBOX_PAYLOAD, request, request_len);
+    }
+
+    if (++mbox_seq == 0) {
+        mbox_seq = 1;
+    }
+    Poke(MBOX_SEQ, mbox_seq);
+
+    start = *jiffyPtr;
+    for (;;) {
+        status = Peek(MBOX_STATUS);
+        if (status != MBOX_STATUS_BUSY && Peek(MBOX_SEQ) == mbox_seq) {
+            return status;
+        }
+        if ((unsigned int)(*jiffyPtr - start) > timeout_jiffies) {
+            return MBOX_STATUS_TIMEOUT;
+        }
+    }
+}
+
+unsigned int mbox_take_reply(void *reply, unsigned int max_len) {
+    unsigned int len = (unsigned int)Peek(MBOX_LEN_L) | ((unsigned int)Peek(MBOX_LEN_H) << 8);
+    if (reply && max_len) {
+        memcpy(reply, (const void *)MBOX_PAYLOAD, len < max_len ? len : max_len);
+    }
+    mbox_release();
+    return len;
+}
+
+void mbox_release(void) {
+    Poke(MBOX_STATUS, MBOX_STATUS_IDLE);
+}
+
+unsigned char mbox_command(unsigned char cmd, const void *request, unsigned int request_len, unsigned char *reply) {
+    unsigned char status = mbox_call(cmd, request, request_len, MBOX_DEFAULT_TIMEOUT);
+    if (status == MBOX_STATUS_DONE) {
+        mbox_take_reply(reply, MBOX_REPLY_SIZE);
+    } else {
+        mbox_release();
+    }
+    return status;
+}
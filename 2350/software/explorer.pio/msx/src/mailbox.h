@@ -0,0 +1,36 @@
+// MSX PICOVERSE PROJECT
+// (c) 2026 Cristiano Goncalves
+// The Retro Hacker
+//
+// mailbox.h - Framed request/reply mailbox to the PicoVerse 2350 Explorer firmware
+//
+// A request is one block write of the command, length and payload followed by
+// a sequence-number write. Completion is a single status byte, and the reply
+// is length-prefixed so it can be copied out with one LDIR. Menu commands
+// (CMD_*) take their CTRL_QUERY_BASE parameters as payload and reply with a
+// MBOX_REPLY_SIZE snapshot of the control registers. Page and list data is not
+// sent through the mailbox: the menu reads the data buffer window directly.
+//
+// This work is licensed  under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+// License". https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+// Posts a request and waits up to timeout_jiffies for the reply. Returns
+// MBOX_STATUS_DONE, MBOX_STATUS_ERROR or MBOX_STATUS_TIMEOUT. The reply stays
+// mapped until mbox_take_reply() or mbox_release().
+unsigned char mbox_call(unsigned char cmd, const void *request, unsigned int request_len, unsigned int timeout_jiffies);
+
+// Copies up to max_len reply bytes, releases the frame and returns the full
+// reply length.
+unsigned int mbox_take_reply(void *reply, unsigned int max_len);
+
+// Maps the data buffer back without reading the reply.
+void mbox_release(void);
+
+// Runs a menu command and copies its control-register reply (MBOX_REPLY_SIZE
+// bytes). Returns the mbox_call() status.
+unsigned char mbox_command(unsigned char cmd, const void *request, unsigned int request_len, unsigned char *reply);
+
+#endif
@@ -28,9 +28,10 @@ ROMRecord records[FILES_PER_PAGE];
 static unsigned char menu_message_row;
 
 // --- Forward declarations (UI + Pico protocol) ---
+static void print_search_prompt(const char *prompt, unsigned char content_width, int input_limit, const char *buffer);
 static int read_search_query(char *buffer, int max_len);
 static void send_query_to_pico(const char *query);
-static unsigned int read_match_index(void);
+static void apply_filter_on_pico(void);
 static unsigned int bios_calatr(void);
 int record_is_folder(const ROMRecord *record);
 int record_is_mp3(const ROMRecord *record);
@@ -39,12 +40,14 @@ static void build_menu_row_text(const ROMRecord *record, const char *name_overri
 static void enter_directory(int index);
 static void refresh_menu_state(const char *loading_text);
 static void wait_key_with_blinking_status(const char *text);
+static void show_verify_status(void);
 static void wait_command_with_blinking_status(const char *text, unsigned int wait_limit);
 static void draw_menu_row(unsigned char row, ROMRecord *record, int selected);
 static void redefine_function_keys(void);
 static void switch_browse_source(unsigned char source_mode, const char *loading_text);
 static void switch_menu_source(unsigned char source_mode);
 static void print_chip_id_line(void);
+static void bootTimesMenu(void);
 void msx_wait(uint16_t times_jiffy);
 void delay_ms(uint16_t milliseconds);
 
@@ -161,10 +164,16 @@ static void send_query_to_pico(const char *query) {
     }
 }
 
-// read_match_index - Read the Pico-calculated match index.
-static unsigned int read_match_index(void) {
-    return (unsigned int)(*((unsigned char *)CTRL_MATCH_L)) |
-           ((unsigned int)(*((unsigned char *)CTRL_MATCH_H)) << 8);
+// apply_filter_on_pico - Filter the list on the Pico with the query it holds
+// and reload the first page of the result. Uses the last line for its status.
+static void apply_filter_on_pico(void) {
+    Poke(CTRL_CMD, CMD_APPLY_FILTER);
+    wait_command_with_blinking_status(menu_ui_status_text("Filtering...", "Filtering the ROM list..."), 1000);
+    readROMData(records, &totalFiles, &totalSize);
+    totalPages = (int)((totalFiles + FILES_PER_PAGE - 1) / FILES_PER_PAGE);
+    if (totalPages == 0) {
+        totalPages = 1;
+    }
 }
 
 // record_is_folder - Check if a ROM record represents a folder.
@@ -362,6 +371,19 @@ static void wait_key_with_blinking_status(const char *text) {
     (void)bios_chget();
 }
 
+// show_verify_status - Report the SHA-1 check of the image launched last.
+// A mismatch waits for a key; a pass stays on the last line until it is redrawn.
+static void show_verify_status(void) {
+    unsigned char status = Peek(CTRL_VERIFY_STATUS);
+
+    if (status == VERIFY_MISMATCH) {
+        wait_key_with_blinking_status(menu_ui_status_text("SHA-1 mismatch", "Last ROM failed its SHA-1 check."));
+        menu_ui_clear_last_line();
+    } else if (status == VERIFY_OK_SIDECAR || status == VERIFY_OK_ROMDB) {
+        menu_ui_print_last_line_text(menu_ui_status_text("SHA-1 OK", "Last ROM passed its SHA-1 check."));
+    }
+}
+
 static void wait_command_with_blinking_status(const char *text, unsigned int wait_limit) {
     unsigned char blink_state = 1;
     unsigned char blink_tick = 0;
@@ -473,6 +495,7 @@ void load_page_records(unsigned int page_index) {
     unsigned char *memory = (unsigned char *)MEMORY_START;
     unsigned int i;
 
+    Poke(CTRL_PAGE_H, (unsigned char)(page_index >> 8));
     Poke(CTRL_PAGE, (unsigned char)page_index);
     for (unsigned int wait = 0; wait < 1000; wait++) {
         if (*((unsigned char *)CTRL_PAGE) == (unsigned char)page_index) {
@@ -708,6 +731,14 @@ static int wait_for_key_with_scroll(void)
             return (int)bios_chget();
         }
 
+        // A ROM pushed over USB (EXPLORER_USB_PUSH firmware) launches like a
+        // menu selection: the Pico already knows what to run after the reset.
+        if (Peek(CTRL_USB_PUSH) == CTRL_MAGIC) {
+            Poke(MP3_CTRL_CMD, MP3_CMD_STOP);
+            execute_rst00();
+            execute_rst00();
+        }
+
         // handle scrolling
         if ((unsigned int)(*jiffyPtr - lastTick) >= scrollDelay) {
             if (!use_80_columns && menu_shortcut_selection == MENU_SHORTCUT_MICROSD) {
@@ -752,6 +783,9 @@ char* mapper_description(int number) {
     if (number >= 15 && number <= 21) {
         return "SYSTEM";
     }
+    if (number == 22) {
+        return "AUTO";
+    }
     if (number <= 0 || number > 14) {
         return "Unknown";
     }
@@ -830,7 +864,7 @@ void helpMenu()
     Locate(0, 12);
     printf("H - Show this help / D - Delete file");
     Locate(0, 13);
-    printf("C - Toggle 40/80 columns");
+    printf("C - 40/80 columns / B - Boot times");
     Locate(0, 14);
     menu_ui_print_str_inverted_width("ROM Detail", 10);
     Locate(0, 15);
@@ -855,6 +889,46 @@ void helpMenu()
     frame_rendered = 0;
 }
 
+// bootTimesMenu - Display the boot timeline recorded by the Pico
+// Each stage is selected through CTRL_BOOT_STAGE and its time since power-on
+// read back from CTRL_BOOT_TIME_L/H; stages that were never reached show --.
+// Only reachable from the Explorer list: File Hunter maps its status text
+// over these registers.
+static void bootTimesMenu(void)
+{
+    static const char *const stage_names[] = {
+        "Firmware start", "Clocks", "PSRAM", "Menu ROM", "Records", "SD mount", "Dir scan", "First MSX read"
+    };
+    unsigned char count = Peek(CTRL_BOOT_STAGE);
+    unsigned char i;
+
+    if (count > sizeof(stage_names) / sizeof(stage_names[0])) {
+        count = sizeof(stage_names) / sizeof(stage_names[0]);
+    }
+    Cls();
+    Locate(0, 0);
+    menu_ui_print_title_line();
+    Locate(0, 1);
+    menu_ui_print_delimiter_line();
+    Locate(0, 2);
+    menu_ui_print_str_inverted_width("Boot Times (ms)", 15);
+    for (i = 0; i < count; i++) {
+        unsigned int ms;
+        Poke(CTRL_BOOT_STAGE, i);
+        ms = (unsigned int)Peek(CTRL_BOOT_TIME_L) | ((unsigned int)Peek(CTRL_BOOT_TIME_H) << 8);
+        Locate(0, 3 + i);
+        if (ms == 0xFFFFu) {
+            printf("%-16s    --", stage_names[i]);
+        } else {
+            printf("%-16s %5u", stage_names[i], ms);
+        }
+    }
+    Locate(0, 23);
+    printf("Press any key to return.");
+    (void)bios_chget();
+    frame_rendered = 0;
+}
+
 
 // loadGame - Load the game from the flash memory
 // This function will load the game from the flash memory based on the index. 
@@ -868,6 +942,7 @@ void loadGame(int index)
     Poke(MP3_CTRL_CMD, MP3_CMD_STOP);
     if ((record->Mapper & ~SOURCE_SD_FLAG) != 0)
     {
+        Poke(ROM_SELECT_REGISTER_H, (unsigned char)(index >> 8)); // Folders can hold more than 256 entries
         Poke(ROM_SELECT_REGISTER, index); // Set the game index (absolute)
         execute_rst00(); // Execute RST 00h to reset the MSX computer and load the game
         execute_rst00();
@@ -912,6 +987,10 @@ void navigateMenu()
                 helpMenu();
                 displayMenu();
             }
+            if (key == 'b' || key == 'B') {
+                bootTimesMenu();
+                displayMenu();
+            }
             if (key == 27) {
                 enter_directory(-1);
                 refresh_menu_state(0);
@@ -997,6 +1076,11 @@ void navigateMenu()
                 helpMenu(); // Display the help menu
                 displayMenu();
                 break;
+            case 66: // B - Boot times
+            case 98: // b
+                bootTimesMenu();
+                displayMenu();
+                break;
             case 99: // C 
             case 67: // c 
                 if (menu_ui_try_toggle_columns()) {
@@ -1029,26 +1113,27 @@ void navigateMenu()
                 break;
             case 47: // / - Search
             {
+                int saved_index = currentIndex;
                 int search_result = read_search_query(search_query, SEARCH_MAX_LEN);
+                // Enter keeps the filtered list; ESC, F4 or an empty query go
+                // back to the full list where the cursor was.
+                if (search_result > 0 && search_query[0] && totalFiles == 0) {
+                    wait_key_with_blinking_status(menu_ui_status_text("Not found", "No matching ROM found."));
+                    search_result = 0;
+                }
+                if (search_result <= 0 || !search_query[0]) {
+                    send_query_to_pico("");
+                    apply_filter_on_pico();
+                    currentIndex = saved_index;
+                } else {
+                    currentIndex = 0;
+                }
                 if (search_result < 0) {
                     launch_wifi_config();
                     break;
                 }
-                if (search_result) {
-                    const char *message = menu_ui_status_text("Searching...", "Searching the ROM list...");
-                    send_query_to_pico(search_query);
-                    Poke(CTRL_CMD, CMD_FIND_FIRST);
-                    wait_command_with_blinking_status(message, 1000);
-                    unsigned int match = read_match_index();
-                    if (match == 0xFFFFu || match >= totalFiles) {
-                        wait_key_with_blinking_status(menu_ui_status_text("Not found", "No matching ROM found."));
-                        menu_ui_clear_last_line();
-                    } else {
-                        currentIndex = (int)match;
-                        currentPage = (currentIndex / FILES_PER_PAGE) + 1;
-                        menu_ui_clear_last_line();
-                    }
-                }
+                currentPage = (currentIndex / FILES_PER_PAGE) + 1;
+                menu_ui_clear_last_line();
                 displayMenu();
                 break;
             }
@@ -1091,7 +1176,12 @@ void main() {
     frame_rendered = 0;
     menu_message_row = 0;
     menu_shortcut_selection = MENU_SHORTCUT_FLASH;
-    
+
+    // The Pico serves this ROM before its first directory listing is ready;
+    // CTRL_CMD stays busy until the listing has been built.
+    for (int i = 0; i < BOOT_WAIT_LIMIT && Peek(CTRL_CMD) != 0; i++) {
+        delay_ms(20);
+    }
     readROMData(records, &totalFiles, &totalSize);
     totalPages = (int)((totalFiles + FILES_PER_PAGE - 1) / FILES_PER_PAGE);
 
@@ -1106,13 +1196,39 @@ void main() {
     switch_menu_source(SOURCE_MODE_FLASH);
     *((unsigned int *)BIOS_GETPNT) = *((unsigned int *)BIOS_PUTPNT);
     redefine_function_keys();
+    show_verify_status();
     // Activate navigation
     navigateMenu();
 }
 
 
+// print_search_prompt - Draw the search prompt and the query typed so far on
+// the last line, leaving the cursor after the query.
+static void print_search_prompt(const char *prompt, unsigned char content_width, int input_limit, const char *buffer) {
+    unsigned char prompt_col = (unsigned char)strlen(prompt);
+    if (use_80_columns) {
+        menu_ui_print_last_line_text(prompt);
+    } else {
+        Locate(0, 23);
+        printf("%s", prompt);
+        for (unsigned char col = prompt_col; col < content_width; col++) {
+            PrintChar(' ');
+        }
+    }
+    int len = (int)strlen(buffer);
+    Locate(prompt_col, 23);
+    for (int i = 0; i < input_limit; i++) {
+        PrintChar(i < len ? (unsigned char)buffer[i] : ' ');
+    }
+    Locate(prompt_col + (unsigned char)len, 23);
+}
+
+// read_search_query - Read the search query on the last line. Every edit is
+// streamed to the Pico, which filters the list as the user types; the list
+// is redrawn once the keys typed ahead have been handled.
 static int read_search_query(char *buffer, int max_len) {
     int len = 0;
+    int dirty_from = -1;
     const char *prompt = "Search: ";
     unsigned char prompt_col = (unsigned char)strlen(prompt);
     unsigned char content_width = (unsigned char)(menu_ui_row_width() - 2);
@@ -1129,22 +1245,23 @@ static int read_search_query(char *buffer, int max_len) {
     }
 
     buffer[0] = '\0';
-    if (use_80_columns) {
-        menu_ui_print_last_line_text(prompt);
-    } else {
-        Locate(0, 23);
-        printf("Search: ");
-        for (unsigned char col = prompt_col; col < content_width; col++) {
-            PrintChar(' ');
-        }
-    }
-    Locate(prompt_col, 23);
-    for (int i = 0; i < input_limit; i++) {
-        PrintChar(' ');
-    }
-    Locate(prompt_col, 23);
+    print_search_prompt(prompt, content_width, input_limit, buffer);
+    send_query_to_pico("");
 
     while (1) {
+        if (dirty_from >= 0 && !bios_chsns()) {
+            int i = dirty_from;
+            do {
+                Poke(CTRL_QUERY_BASE + i, (unsigned char)buffer[i]);
+            } while (buffer[i++] != '\0');
+            dirty_from = -1;
+            apply_filter_on_pico();
+            currentPage = 1;
+            currentIndex = 0;
+            displayMenu();
+            // The filter status took the last line; put the prompt back.
+            print_search_prompt(prompt, content_width, input_limit, buffer);
+        }
         char ch = (char)bios_chget();
         if (ch == MENU_KEY_F4_CONFIG) {
             buffer[0] = '\0';
@@ -1152,6 +1269,11 @@ static int read_search_query(char *buffer, int max_len) {
         }
         if (ch == 13) {
             buffer[len] = '\0';
+            if (dirty_from >= 0) {
+                // Keys typed ahead of the last redraw: filter on the final query.
+                send_query_to_pico(buffer);
+                apply_filter_on_pico();
+            }
             return 1;
         }
         if (ch == 27) {
@@ -1162,6 +1284,9 @@ static int read_search_query(char *buffer, int max_len) {
             if (len > 0) {
                 len--;
                 buffer[len] = '\0';
+                if (dirty_from < 0 || dirty_from > len) {
+                    dirty_from = len;
+                }
                 Locate(prompt_col + len, 23);
                 printf(" ");
                 Locate(prompt_col + len, 23);
@@ -1170,6 +1295,9 @@ static int read_search_query(char *buffer, int max_len) {
         }
         if (ch >= 32 && ch <= 126) {
             if (len < input_limit) {
+                if (dirty_from < 0) {
+                    dirty_from = len;
+                }
                 buffer[len++] = ch;
                 buffer[len] = '\0';
                 Locate(prompt_col + len - 1, 23);
@@ -1194,8 +1322,11 @@ void msx_wait(uint16_t times_jiffy)
     __endasm;
 }
 
+// Rounds down to whole 20 ms jiffies, but waits at least one: msx_wait(0)
+// would count down from 0xFFFF.
 void delay_ms(uint16_t milliseconds)
 {
-    msx_wait(milliseconds / 20);
+    uint16_t jiffies = milliseconds / 20;
+    msx_wait(jiffies ? jiffies : 1);
 }
 
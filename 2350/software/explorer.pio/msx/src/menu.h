@@ -24,6 +24,7 @@
 #define SD_ROM_MAX_SIZE_KB 4096 // 4 MB PSRAM region capacity for microSD-loaded ROMs
 #define MEMORY_START 0xB900 // Start of the memory area to read the ROM records
 #define ROM_SELECT_REGISTER 0xBF7F // Memory-mapped register that selects the ROM to load
+#define ROM_SELECT_REGISTER_H 0xBF7E // High byte of the ROM index, written before ROM_SELECT_REGISTER
 #define JIFFY 0xFC9E
 #define SOURCE_SD_FLAG 0x80
 #define FOLDER_FLAG 0x40
@@ -67,6 +68,7 @@
 #define AUDIO_PROFILE_YM2151_SFG01 8
 #define AUDIO_PROFILE_MEGARAM_SCC 9
 #define AUDIO_PROFILE_MEGARAM_SCC_PLUS 10
+#define AUDIO_PROFILE_MOONSOUND 11
 #define AUDIO_VOLUME_DEFAULT 100
 #define AUDIO_VOLUME_MAX 200
 #define AUDIO_VOLUME_STEP 10
@@ -77,6 +79,20 @@
 // between the SD partition info buffer (0xBF80..0xBF9F) and the chip-id buffer
 // (0xBFAF..0xBFBF). The save channel reuses query buffer byte 7.
 #define CTRL_VDP_FREQ 0xBFA0
+#define CTRL_PAGE_H 0xBFA3 // High byte of the page index, written before CTRL_PAGE
+// SHA-1 check of the last image staged in PSRAM. The Pico keeps the verdict
+// across the launch reset and reports it once, at the next menu boot.
+#define CTRL_VERIFY_STATUS 0xBFA1
+#define VERIFY_OK_SIDECAR 2
+#define VERIFY_OK_ROMDB 3
+#define VERIFY_MISMATCH 5
+// Boot timeline: write a stage number to CTRL_BOOT_STAGE, then read its time
+// in ms since power-on (0xFFFF = not reached). CTRL_BOOT_STAGE reads back the
+// number of stages.
+#define CTRL_BOOT_STAGE  0xBFAC
+#define CTRL_BOOT_TIME_L 0xBFAD
+#define CTRL_BOOT_TIME_H 0xBFAE
+#define BOOT_WAIT_LIMIT  250 // 20 ms steps before reading the records anyway
 #define MP3_CTRL_BASE      0xBFE0
 #define MP3_CTRL_CMD       (MP3_CTRL_BASE + 0)
 #define MP3_CTRL_STATUS    (MP3_CTRL_BASE + 1)
@@ -87,6 +103,7 @@
 #define MP3_CTRL_TOTAL_L   (MP3_CTRL_BASE + 6)
 #define MP3_CTRL_TOTAL_H   (MP3_CTRL_BASE + 7)
 #define MP3_CTRL_MODE      (MP3_CTRL_BASE + 8)
+#define CTRL_USB_PUSH      (MP3_CTRL_BASE + 15) // Reads CTRL_MAGIC once a ROM pushed over USB waits to run
 #define MP3_STATUS_PLAYING 0x01
 #define MP3_STATUS_ERROR   0x04
 #define MP3_STATUS_EOF     0x08
@@ -131,6 +148,27 @@
 #define CTRL_FH_FLAG_OFFSET MAX_FILE_NAME_LENGTH
 #define CTRL_FH_SIZE_OFFSET (CTRL_FH_FLAG_OFFSET + 1)
 #define CTRL_FH_RECORD_SIZE (MAX_FILE_NAME_LENGTH + 3)
+// Mailbox frame (see mailbox.h). While a request is outstanding it overlays
+// the data buffer at MEMORY_START.
+#define MBOX_BASE MEMORY_START
+#define MBOX_STATUS (MBOX_BASE + 0)
+#define MBOX_SEQ    (MBOX_BASE + 1)
+#define MBOX_CMD    (MBOX_BASE + 2)
+#define MBOX_LEN_L  (MBOX_BASE + 4)
+#define MBOX_LEN_H  (MBOX_BASE + 5)
+#define MBOX_HEADER_SIZE 8
+#define MBOX_PAYLOAD (MBOX_BASE + MBOX_HEADER_SIZE)
+#define MBOX_PAYLOAD_SIZE (DATA_BUFFER_SIZE - MBOX_HEADER_SIZE)
+#define MBOX_STATUS_IDLE    0x00
+#define MBOX_STATUS_BUSY    0x01
+#define MBOX_STATUS_DONE    0x02
+#define MBOX_STATUS_ERROR   0x03
+#define MBOX_STATUS_TIMEOUT 0xFF // Library only: no reply within the timeout
+#define MBOX_REPLY_CTRL_SIZE 16  // Reply: CTRL_BASE_ADDR..+15
+#define MBOX_REPLY_VDP_FREQ  MBOX_REPLY_CTRL_SIZE
+#define MBOX_REPLY_PARTITION (MBOX_REPLY_VDP_FREQ + 1)
+#define MBOX_REPLY_SIZE      (MBOX_REPLY_PARTITION + CTRL_SD_PARTITION_INFO_SIZE)
+#define MBOX_REPLY_CTRL(reg) ((reg) - CTRL_BASE_ADDR)
 
 #define SOURCE_MODE_ALL   0x00
 #define SOURCE_MODE_FLASH 0x01
@@ -4,6 +4,7 @@
 #include "menu_ui.h"
 #include "menu_input.h"
 #include "screen_rom.h"
+#include "mailbox.h"
 
 static void send_detect_mapper(unsigned int index);
 static unsigned char send_set_mapper(unsigned int index, unsigned char mapper);
@@ -11,7 +12,6 @@ static unsigned char send_load_options(unsigned int index, unsigned char *audio_
 static void send_save_options(unsigned int index, unsigned char audio_profile, unsigned char psg_enabled, unsigned char mapper, unsigned char sd_partition, unsigned char audio_volume, unsigned char vdp_freq);
 static void wait_for_ctrl_cmd_clear(void);
 static unsigned char read_mapper_value(void);
-static unsigned char read_ack_value(void);
 static void render_rom_screen(const ROMRecord *record);
 static void render_rom_prefixed_line(unsigned char row, const char *prefix, const char *text, int selected);
 static void render_rom_mapper_line(const char *mapper_text, int selected);
@@ -99,6 +99,12 @@ static unsigned char record_supports_msx_music(const ROMRecord *record) {
     return record_supports_external_scc_audio(record);
 }
 
+static unsigned char record_supports_moonsound(const ROMRecord *record) {
+    /* The OPL4 sits on the I/O bus next to a game mapper; system ROMs keep
+       the I/O blocks for their own devices. */
+    return !record_is_folder(record) && !record_is_system_rom(record);
+}
+
 static void send_detect_mapper(unsigned int index) {
     write_index_query(index);
     for (unsigned int i = 2; i < CTRL_QUERY_SIZE; i++) {
@@ -116,65 +122,65 @@ static void wait_for_ctrl_cmd_clear(void) {
     }
 }
 
+// Option commands go through the mailbox: one block write, one status poll
+// and a single copy of every control register they report back.
 static unsigned char send_set_mapper(unsigned int index, unsigned char mapper) {
-    write_index_query(index);
-    Poke(CTRL_QUERY_BASE + 2, mapper);
-    for (unsigned int i = 3; i < CTRL_QUERY_SIZE; i++) {
-        Poke(CTRL_QUERY_BASE + i, 0);
+    unsigned char request[3];
+    unsigned char reply[MBOX_REPLY_SIZE];
+    request[0] = (unsigned char)(index & 0xFFu);
+    request[1] = (unsigned char)((index >> 8) & 0xFFu);
+    request[2] = mapper;
+    if (mbox_command(CMD_SET_MAPPER, request, sizeof(request), reply) != MBOX_STATUS_DONE) {
+        return 0;
     }
-    Poke(CTRL_CMD, CMD_SET_MAPPER);
-    wait_for_ctrl_cmd_clear();
-    return read_ack_value();
+    return reply[MBOX_REPLY_CTRL(CTRL_ACK)];
 }
 
 static unsigned char send_load_options(unsigned int index, unsigned char *audio_profile, unsigned char *psg_enabled, unsigned char *mapper, unsigned char *sd_partition, unsigned char *audio_volume, unsigned char *vdp_freq) {
-    write_index_query(index);
-    for (unsigned int i = 2; i < CTRL_QUERY_SIZE; i++) {
-        Poke(CTRL_QUERY_BASE + i, 0);
+    unsigned char request[2];
+    unsigned char reply[MBOX_REPLY_SIZE];
+    request[0] = (unsigned char)(index & 0xFFu);
+    request[1] = (unsigned char)((index >> 8) & 0xFFu);
+    if (mbox_command(CMD_LOAD_OPTIONS, request, sizeof(request), reply) != MBOX_STATUS_DONE) {
+        current_wavegame_rom = 0;
+        return 0;
     }
-    Poke(CTRL_CMD, CMD_LOAD_OPTIONS);
-    wait_for_ctrl_cmd_clear();
-    current_wavegame_rom = Peek(CTRL_WAVEGAME_ROM) ? 1 : 0;
-    if (!read_ack_value()) {
+    current_wavegame_rom = reply[MBOX_REPLY_CTRL(CTRL_WAVEGAME_ROM)] ? 1 : 0;
+    if (!reply[MBOX_REPLY_CTRL(CTRL_ACK)]) {
         return 0;
     }
-    *audio_profile = Peek(CTRL_AUDIO);
-    *psg_enabled = Peek(CTRL_PSG_EMULATION) ? 1 : 0;
-    *mapper = Peek(CTRL_MAPPER);
-    *sd_partition = Peek(CTRL_SD_PARTITION);
-    *audio_volume = Peek(CTRL_AUDIO_VOLUME);
-    *vdp_freq = Peek(CTRL_VDP_FREQ);
+    *audio_profile = reply[MBOX_REPLY_CTRL(CTRL_AUDIO)];
+    *psg_enabled = reply[MBOX_REPLY_CTRL(CTRL_PSG_EMULATION)] ? 1 : 0;
+    *mapper = reply[MBOX_REPLY_CTRL(CTRL_MAPPER)];
+    *sd_partition = reply[MBOX_REPLY_CTRL(CTRL_SD_PARTITION)];
+    *audio_volume = reply[MBOX_REPLY_CTRL(CTRL_AUDIO_VOLUME)];
+    *vdp_freq = reply[MBOX_REPLY_VDP_FREQ];
     if (*vdp_freq > VDP_FREQ_50HZ) {
         *vdp_freq = VDP_FREQ_DEFAULT;
     }
-    sd_partition_count = Peek(CTRL_SD_PARTITION_INFO_BASE);
-    sd_partition_mask = Peek(CTRL_SD_PARTITION_INFO_BASE + 1);
+    sd_partition_count = reply[MBOX_REPLY_PARTITION];
+    sd_partition_mask = reply[MBOX_REPLY_PARTITION + 1];
     return 1;
 }
 
 static void send_save_options(unsigned int index, unsigned char audio_profile, unsigned char psg_enabled, unsigned char mapper, unsigned char sd_partition, unsigned char audio_volume, unsigned char vdp_freq) {
-    write_index_query(index);
-    Poke(CTRL_QUERY_BASE + 2, audio_profile);
-    Poke(CTRL_QUERY_BASE + 3, psg_enabled ? 1 : 0);
-    Poke(CTRL_QUERY_BASE + 4, mapper);
-    Poke(CTRL_QUERY_BASE + 5, sd_partition);
-    Poke(CTRL_QUERY_BASE + 6, audio_volume);
-    Poke(CTRL_QUERY_BASE + 7, vdp_freq);
-    for (unsigned int i = 8; i < CTRL_QUERY_SIZE; i++) {
-        Poke(CTRL_QUERY_BASE + i, 0);
-    }
-    Poke(CTRL_CMD, CMD_SAVE_OPTIONS);
-    wait_for_ctrl_cmd_clear();
+    unsigned char request[8];
+    unsigned char reply[MBOX_REPLY_SIZE];
+    request[0] = (unsigned char)(index & 0xFFu);
+    request[1] = (unsigned char)((index >> 8) & 0xFFu);
+    request[2] = audio_profile;
+    request[3] = psg_enabled ? 1 : 0;
+    request[4] = mapper;
+    request[5] = sd_partition;
+    request[6] = audio_volume;
+    request[7] = vdp_freq;
+    mbox_command(CMD_SAVE_OPTIONS, request, sizeof(request), reply);
 }
 
 static unsigned char read_mapper_value(void) {
     return *((unsigned char *)CTRL_MAPPER);
 }
 
-static unsigned char read_ack_value(void) {
-    return *((unsigned char *)CTRL_ACK);
-}
-
 static void apply_detected_mapper(ROMRecord *record) {
     unsigned char mapper = read_mapper_value();
     if (mapper != 0) {
@@ -186,11 +192,11 @@ static void apply_detected_mapper(ROMRecord *record) {
 
 void quick_run_rom(unsigned int index) {
     ROMRecord *record = &records[index % FILES_PER_PAGE];
-    write_index_query(index);
-    Poke(CTRL_CMD, CMD_PREPARE_QUICK_RUN);
-    while (Peek(CTRL_CMD) != 0) {
-        delay_ms(10);
-    }
+    unsigned char request[2];
+    unsigned char reply[MBOX_REPLY_SIZE];
+    request[0] = (unsigned char)(index & 0xFFu);
+    request[1] = (unsigned char)((index >> 8) & 0xFFu);
+    mbox_command(CMD_PREPARE_QUICK_RUN, request, sizeof(request), reply);
     apply_detected_mapper(record);
     loadGame((int)index);
 }
@@ -330,7 +336,7 @@ void show_rom_screen(unsigned int index) {
                 }
             }
             if ((key == 28 || key == 29) && selection == 0 && !waiting_mapper && allow_mapper_override) {
-                static const unsigned char mapper_cycle[] = {1,2,3,4,5,6,7,8,9,12,13,14};
+                static const unsigned char mapper_cycle[] = {1,2,3,4,5,6,7,8,9,12,13,14,22};
                 const unsigned int mapper_count = (unsigned int)(sizeof(mapper_cycle) / sizeof(mapper_cycle[0]));
                 unsigned char mapper_code = record_mapper_code(record->Mapper);
                 int dir = (key == 28) ? 1 : -1;
@@ -875,6 +881,9 @@ static unsigned char audio_profile_is_supported(const ROMRecord *record, unsigne
     if (audio_profile == AUDIO_PROFILE_MSX_MUSIC) {
         return record_supports_msx_music(record) && !record_is_sunrise_mapper_system_rom(record);
     }
+    if (audio_profile == AUDIO_PROFILE_MOONSOUND) {
+        return record_supports_moonsound(record);
+    }
     return 0;
 }
 
@@ -904,7 +913,8 @@ static unsigned char next_audio_profile(const ROMRecord *record, unsigned char a
         AUDIO_PROFILE_YM2151_SFG05,
         AUDIO_PROFILE_YM2151_SFG01,
         AUDIO_PROFILE_DUAL_PSG,
-        AUDIO_PROFILE_MSX_MUSIC
+        AUDIO_PROFILE_MSX_MUSIC,
+        AUDIO_PROFILE_MOONSOUND
     };
     const unsigned int audio_count = (unsigned int)(sizeof(audio_profiles) / sizeof(audio_profiles[0]));
     int current = -1;
@@ -960,6 +970,8 @@ static void build_audio_text(const ROMRecord *record, unsigned char audio_profil
         audio_label = "Dual PSG";
     } else if (audio_profile == AUDIO_PROFILE_MSX_MUSIC) {
         audio_label = "FMPAC/MSX-MUSIC";
+    } else if (audio_profile == AUDIO_PROFILE_MOONSOUND) {
+        audio_label = "MoonSound (OPL4)";
     }
     strncpy(out, audio_label, out_size - 1);
     out[out_size - 1] = '\0';
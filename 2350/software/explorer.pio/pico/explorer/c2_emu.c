@@ -2,17 +2,19 @@
 // (c) 2026 Cristiano Goncalves
 // The Retro Hacker
 //
-// c2_emu.c - Carnivore2 RAM-mode emulation for SROM /D15 support.
+// c2_emu.c - Carnivore2 RAM-mode and flash-mode emulation for SROM.
 //
-// Emulates the minimum Carnivore2 surface that SROM /D15 touches:
+// Emulates the Carnivore2 surface that SROM /D15 and /F touch:
 //   - Port 0xF0 detection protocol (OUT 'C'/'S'/'R'/'H'/'0'..'3'/'A'/'M')
 //   - CardMDR register and its base/enable/reg-read-disable bits
 //   - Four bank configuration blocks (Mask, Addr, Reg, Mult, MaskR, AdrD)
 //   - AddrFR page multiplier
 //   - Bank-window RAM read/write path backed by an external PSRAM buffer
+//   - AMD command set of the M29W640GB flash over a sparse PSRAM image
 //
-// Flash writes are not persisted, but the AMD autoselect command sequence is
-// emulated so SROM's chip-ID probe can identify the RAM-mode surface.
+// Flash program and erase complete immediately, so SROM's DQ7 data polling
+// sees the final value on its first read. Persisting the image is left to
+// the launcher, which saves the chunks marked in flash_dirty[].
 //
 // This work is licensed under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
 // License". https://creativecommons.org/licenses/by-nc-sa/4.0/
@@ -375,7 +377,109 @@ bool __not_in_flash_func(c2_bank_switch_write)(c2_state_t *c2, uint16_t addr, ui
 }
 
 // -----------------------------------------------------------------------
-// AMD / Spansion / Numonyx flash autoselect emulation.
+// Sparse flash image. A 64KB sector gets a PSRAM slot the first time it is
+// programmed after an erase; erasing it returns the slot to the pool.
+// -----------------------------------------------------------------------
+void c2_flash_attach(c2_state_t *c2, uint8_t *pool, uint8_t slots, const uint8_t *map)
+{
+    if (slots > C2_FLASH_MAX_SLOTS) slots = C2_FLASH_MAX_SLOTS;
+    c2->flash_pool = pool;
+    c2->flash_slots = slots;
+    memset(c2->flash_map, C2_FLASH_UNMAPPED, sizeof(c2->flash_map));
+    memset(c2->flash_owner, C2_FLASH_UNMAPPED, sizeof(c2->flash_owner));
+    memset((void *)c2->flash_dirty, 0, sizeof(c2->flash_dirty));
+    c2->flash_map_dirty = 0u;
+
+    if (map == NULL) return;
+    for (uint32_t sector = 0; sector < C2_FLASH_SECTORS; ++sector)
+    {
+        uint8_t slot = map[sector];
+        if (slot < slots && c2->flash_owner[slot] == C2_FLASH_UNMAPPED)
+        {
+            c2->flash_map[sector] = slot;
+            c2->flash_owner[slot] = (uint8_t)sector;
+        }
+    }
+}
+
+static inline void c2_flash_touch(c2_state_t *c2, uint8_t slot, uint32_t off)
+{
+    c2->flash_dirty[slot * C2_FLASH_CHUNKS + (off / C2_FLASH_CHUNK_SIZE)] = 1u;
+    c2->flash_gen++;
+}
+
+// Back `sector` with a free slot filled with 0xFF. Returns the slot or
+// C2_FLASH_UNMAPPED when the pool is exhausted.
+static uint8_t __not_in_flash_func(c2_flash_map_sector)(c2_state_t *c2, uint32_t sector)
+{
+    for (uint8_t slot = 0; slot < c2->flash_slots; ++slot)
+    {
+        if (c2->flash_owner[slot] != C2_FLASH_UNMAPPED) continue;
+        memset(c2->flash_pool + (uint32_t)slot * C2_FLASH_SECTOR_SIZE, 0xFFu, C2_FLASH_SECTOR_SIZE);
+        c2->flash_owner[slot] = (uint8_t)sector;
+        c2->flash_map[sector] = slot;
+        for (uint32_t off = 0; off < C2_FLASH_SECTOR_SIZE; off += C2_FLASH_CHUNK_SIZE)
+            c2_flash_touch(c2, slot, off);
+        c2->flash_map_dirty = 1u;
+        return slot;
+    }
+    return C2_FLASH_UNMAPPED;
+}
+
+// Returns false when the sector needs a slot and the pool has none left.
+static bool __not_in_flash_func(c2_flash_program)(c2_state_t *c2, uint32_t linear, uint8_t data)
+{
+    if (c2->flash_pool == NULL || linear >= C2_FLASH_SIZE) return true;
+    uint32_t sector = linear / C2_FLASH_SECTOR_SIZE;
+    uint8_t slot = c2->flash_map[sector];
+    if (slot == C2_FLASH_UNMAPPED)
+    {
+        if (data == 0xFFu) return true;  // programming 1s into erased flash is a no-op
+        slot = c2_flash_map_sector(c2, sector);
+        if (slot == C2_FLASH_UNMAPPED) return false;
+    }
+    // Programming can only clear bits, as on the real chip.
+    uint32_t off = linear % C2_FLASH_SECTOR_SIZE;
+    uint8_t *cell = c2->flash_pool + (uint32_t)slot * C2_FLASH_SECTOR_SIZE + off;
+    *cell &= data;
+    c2_flash_touch(c2, slot, off);
+    return true;
+}
+
+static void __not_in_flash_func(c2_flash_erase_sector)(c2_state_t *c2, uint32_t linear)
+{
+    if (c2->flash_pool == NULL || linear >= C2_FLASH_SIZE) return;
+    uint32_t sector = linear / C2_FLASH_SECTOR_SIZE;
+    uint8_t slot = c2->flash_map[sector];
+    if (slot == C2_FLASH_UNMAPPED) return;
+
+    if (sector == 0u)
+    {
+        // Bottom boot block: erase just the 8KB parameter sector.
+        uint32_t off = linear & ~(C2_FLASH_BOOT_SECTOR - 1u) & (C2_FLASH_SECTOR_SIZE - 1u);
+        memset(c2->flash_pool + (uint32_t)slot * C2_FLASH_SECTOR_SIZE + off, 0xFFu, C2_FLASH_BOOT_SECTOR);
+        for (uint32_t o = off; o < off + C2_FLASH_BOOT_SECTOR; o += C2_FLASH_CHUNK_SIZE)
+            c2_flash_touch(c2, slot, o);
+        return;
+    }
+
+    c2->flash_map[sector] = C2_FLASH_UNMAPPED;
+    c2->flash_owner[slot] = C2_FLASH_UNMAPPED;
+    c2->flash_map_dirty = 1u;
+    c2->flash_gen++;
+}
+
+static void __not_in_flash_func(c2_flash_erase_chip)(c2_state_t *c2)
+{
+    if (c2->flash_pool == NULL) return;
+    memset(c2->flash_map, C2_FLASH_UNMAPPED, sizeof(c2->flash_map));
+    memset(c2->flash_owner, C2_FLASH_UNMAPPED, sizeof(c2->flash_owner));
+    c2->flash_map_dirty = 1u;
+    c2->flash_gen++;
+}
+
+// -----------------------------------------------------------------------
+// AMD / Spansion / Numonyx flash command emulation.
 //
 // c2ramldr probes the "flash" chip type by arming R1 as flash (Mult=0x95,
 // RAM bit clear), writing the unlock sequence (AA/55/90) and reading
@@ -389,12 +493,22 @@ bool __not_in_flash_func(c2_bank_switch_write)(c2_state_t *c2, uint16_t addr, ui
 //   Device C2    (0x1C) = 0x10   (M29W640G)
 //   Device C3    (0x1E) = 0x00   (bottom boot sector -> "M29W640GB")
 //
-// Autoselect is armed when a flash-mode bank (Mult.RAM=0, Mult.WRITE_EN=1)
-// sees the AA/55/90 unlock on low-12-bit offsets 0xAAA/0x555/0xAAA.
-// A byte-program command (0xA0) is accepted but silently dropped: this
-// firmware treats the flash window as read-only. Any other bank-window
-// write (including 0xF0 reset) returns autoselect to idle.
+// Commands are recognised when a flash-mode bank (Mult.RAM=0,
+// Mult.WRITE_EN=1) sees the AA/55 unlock on low-12-bit offsets 0xAAA/0x555
+// followed by the command byte at 0xAAA:
+//   90       autoselect (IDs above until the next write)
+//   A0       byte program at the next write's address
+//   80 AA 55 erase setup, then 30 at a sector address (sector erase) or
+//            10 at 0xAAA (chip erase)
+// Any other write (including 0xF0 reset) returns the machine to idle.
+//
+// A byte program that finds the PSRAM pool full is reported as a program
+// timeout: reads return DQ7 = complement of the data, a toggling DQ6 and
+// DQ5 = 1, so flashers stop with an error instead of verifying 0xFF later.
 // -----------------------------------------------------------------------
+#define C2_FLASH_DQ7 0x80u
+#define C2_FLASH_DQ6 0x40u
+#define C2_FLASH_DQ5 0x20u
 #define C2_AUTOSEL_OFF_CHECK(a_low, want)   (((a_low) & 0xFFFu) == (want))
 
 static uint8_t c2_autosel_id_read(uint16_t addr)
@@ -414,7 +528,7 @@ static uint8_t c2_autosel_id_read(uint16_t addr)
 // Update AMD flash state machine on a write captured by a flash-mode
 // bank window. Returns true if the write was absorbed by the state
 // machine (caller should not route it to RAM).
-bool __not_in_flash_func(c2_flash_cmd_write)(c2_state_t *c2, uint16_t addr, uint8_t data)
+bool __not_in_flash_func(c2_flash_cmd_write)(c2_state_t *c2, uint16_t addr, uint32_t linear, uint8_t data)
 {
     uint16_t low = addr & 0x0FFFu;
     switch (c2->flash_state)
@@ -429,7 +543,8 @@ bool __not_in_flash_func(c2_flash_cmd_write)(c2_state_t *c2, uint16_t addr, uint
             return true;
         case 2u:
             if (low == 0xAAAu && data == 0x90u) { c2->flash_state = 3u; return true; } // autoselect ON
-            if (low == 0xAAAu && data == 0xA0u) { c2->flash_state = 4u; return true; } // program-byte (ignored)
+            if (low == 0xAAAu && data == 0xA0u) { c2->flash_state = 4u; return true; } // program-byte
+            if (low == 0xAAAu && data == 0x80u) { c2->flash_state = 5u; return true; } // erase setup
             c2->flash_state = 0u;
             return true;
         case 3u:
@@ -437,7 +552,30 @@ bool __not_in_flash_func(c2_flash_cmd_write)(c2_state_t *c2, uint16_t addr, uint
             c2->flash_state = 0u;
             return true;
         case 4u:
-            // Program-byte target write: swallow, stay idle.
+            // Program-byte target write.
+            if (c2_flash_program(c2, linear, data))
+            {
+                c2->flash_state = 0u;
+            }
+            else
+            {
+                c2->flash_status = (uint8_t)(~data & C2_FLASH_DQ7);
+                c2->flash_state = 8u;
+            }
+            return true;
+        case 5u:
+            c2->flash_state = (low == 0xAAAu && data == 0xAAu) ? 6u : 0u;
+            return true;
+        case 6u:
+            c2->flash_state = (low == 0x555u && data == 0x55u) ? 7u : 0u;
+            return true;
+        case 7u:
+            if (data == 0x30u) c2_flash_erase_sector(c2, linear);
+            else if (low == 0xAAAu && data == 0x10u) c2_flash_erase_chip(c2);
+            c2->flash_state = 0u;
+            return true;
+        case 8u:
+            // Failed program: the next write (normally F0) resets.
             c2->flash_state = 0u;
             return true;
         default:
@@ -447,14 +585,26 @@ bool __not_in_flash_func(c2_flash_cmd_write)(c2_state_t *c2, uint16_t addr, uint
 }
 
 // Return value to drive onto the bus while a flash-mode bank window is
-// active. `linear` is the decoded PSRAM offset (used only when the bus
-// is in normal-read mode, i.e. flash_state != 3).
-uint8_t __not_in_flash_func(c2_flash_read)(const c2_state_t *c2, uint16_t addr, uint32_t linear)
+// active. `linear` is the decoded flash offset (used only when the bus
+// is in normal-read mode, i.e. flash_state != 3 and != 8).
+uint8_t __not_in_flash_func(c2_flash_read)(c2_state_t *c2, uint16_t addr, uint32_t linear)
 {
     if (c2->flash_state == 3u)
     {
         return c2_autosel_id_read(addr);
     }
+    if (c2->flash_state == 8u)
+    {
+        c2->flash_status ^= C2_FLASH_DQ6;
+        return (uint8_t)(c2->flash_status | C2_FLASH_DQ5);
+    }
+    if (c2->flash_pool)
+    {
+        if (linear >= C2_FLASH_SIZE) return 0xFFu;
+        uint8_t slot = c2->flash_map[linear / C2_FLASH_SECTOR_SIZE];
+        if (slot == C2_FLASH_UNMAPPED) return 0xFFu;
+        return c2->flash_pool[(uint32_t)slot * C2_FLASH_SECTOR_SIZE + (linear % C2_FLASH_SECTOR_SIZE)];
+    }
     if (c2->ram_ptr && linear < c2->ram_size) return c2->ram_ptr[linear];
     return 0xFFu;
 }
@@ -2,13 +2,14 @@
 // (c) 2026 Cristiano Goncalves
 // The Retro Hacker
 //
-// c2_emu.h - Carnivore2 RAM-mode emulation for SROM /D15 support.
+// c2_emu.h - Carnivore2 RAM-mode and flash-mode emulation for SROM.
 //
 // The Carnivore2 multifunction cartridge lets Nextor's SROM tool upload a
-// ROM image into cartridge RAM and launch it directly, avoiding the flash
-// write cycle used by /F15. This module emulates the minimum subset of
-// the Carnivore2 register file, port 0xF0 detection protocol and bank-
-// window RAM read/write path required for SROM /D15 to succeed.
+// ROM image into cartridge RAM and launch it directly (/D15), or write it
+// to the cartridge flash (/F). This module emulates the Carnivore2 register
+// file, port 0xF0 detection protocol, the bank-window RAM read/write path
+// and an AMD-style flash chip (autoselect, byte program, sector and chip
+// erase) over a sparse PSRAM flash image.
 //
 // This work is licensed under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
 // License". https://creativecommons.org/licenses/by-nc-sa/4.0/
@@ -79,6 +80,22 @@ static inline uint32_t c2_mult_size(uint8_t mult)
     }
 }
 
+// Flash geometry (M29W640GB: 8MB, 64KB sectors, bottom boot block split
+// into eight 8KB parameter sectors). Only sectors that have been programmed
+// since their last erase are backed by a PSRAM slot; the rest read as 0xFF.
+// At most C2_FLASH_MAX_SLOTS sectors (2MB) can hold data at once, fewer when
+// the launch leaves less PSRAM for the pool. A byte program that needs a
+// slot when none is free fails the way the real chip does: reads return
+// the DQ5 timeout status until the next write resets the command machine.
+#define C2_FLASH_SIZE           0x800000u
+#define C2_FLASH_SECTOR_SIZE    0x10000u
+#define C2_FLASH_SECTORS        (C2_FLASH_SIZE / C2_FLASH_SECTOR_SIZE)
+#define C2_FLASH_BOOT_SECTOR    0x2000u     // parameter sector size in sector 0
+#define C2_FLASH_CHUNK_SIZE     0x1000u     // dirty-tracking granularity
+#define C2_FLASH_CHUNKS         (C2_FLASH_SECTOR_SIZE / C2_FLASH_CHUNK_SIZE)
+#define C2_FLASH_MAX_SLOTS      32u
+#define C2_FLASH_UNMAPPED       0xFFu
+
 // Port 0xF0 detection state machine (set by the most recent 'C'/'S' write).
 typedef enum {
     C2_PF0_IDLE = 0,
@@ -117,10 +134,27 @@ typedef struct {
     // used by the loader to know how much of the ROM has been uploaded.
     uint32_t max_written;
 
-    // AMD flash autoselect state machine (c2ramldr chip-ID probe):
+    // AMD flash command state machine:
     //   0 = idle, 1 = got AA, 2 = got AA/55, 3 = autoselect mode,
-    //   4 = byte-program target pending
+    //   4 = byte-program target pending, 5 = got erase setup (80),
+    //   6 = got 80/AA, 7 = got 80/AA/55 (erase target pending),
+    //   8 = byte program failed (reads return the DQ5 timeout status)
     uint8_t flash_state;
+    uint8_t flash_status; // DQ7/DQ6 status of the failed program
+
+    // Sparse flash image. flash_map[] gives the PSRAM slot backing each
+    // 64KB flash sector; flash_owner[] is the reverse map used to find a
+    // free slot. Core 0 marks flash_dirty[] (one byte per 4KB chunk of the
+    // pool, so both cores can update it without read-modify-write races)
+    // and flash_map_dirty, and bumps flash_gen on every change; the
+    // background saver clears them as it writes the image back.
+    uint8_t *flash_pool;  // NULL = no flash image, flash reads mirror RAM
+    uint8_t flash_slots;
+    uint8_t flash_map[C2_FLASH_SECTORS];
+    uint8_t flash_owner[C2_FLASH_MAX_SLOTS];
+    volatile uint8_t flash_dirty[C2_FLASH_MAX_SLOTS * C2_FLASH_CHUNKS];
+    volatile uint8_t flash_map_dirty;
+    volatile uint32_t flash_gen;
 
     // ----- Decoder cache (rebuilt on register writes) -----
     // Precomputed form of the four bank-config blocks so the hot-path
@@ -161,6 +195,11 @@ typedef struct {
 // Initialise the register file to the hardware power-on defaults.
 void c2_init(c2_state_t *c2, uint8_t *ram_ptr, uint32_t ram_size, uint8_t crslt);
 
+// Attach a PSRAM pool of `slots` 64KB sectors as the flash image. `map`
+// (C2_FLASH_SECTORS entries) restores a saved sector map, or NULL for a
+// blank (fully erased) chip. Call after c2_init().
+void c2_flash_attach(c2_state_t *c2, uint8_t *pool, uint8_t slots, const uint8_t *map);
+
 // CardMDR base address (0x0F80 / 0x4F80 / 0x8F80 / 0xCF80).
 static inline uint16_t c2_reg_base(const c2_state_t *c2)
 {
@@ -224,15 +263,18 @@ uint8_t c2_reg_read(const c2_state_t *c2, uint16_t addr);
 // if at least one bank latched the write.
 bool c2_bank_switch_write(c2_state_t *c2, uint16_t addr, uint8_t data);
 
-// AMD/Spansion flash autoselect state machine (c2ramldr chip-ID probe).
-// Feed writes captured by a flash-mode bank window (Mult.RAM=0,
-// Mult.WRITE_EN=1). Returns true if the write was absorbed by the
-// state machine (caller must not forward it to RAM).
-bool c2_flash_cmd_write(c2_state_t *c2, uint16_t addr, uint8_t data);
+// AMD/Spansion flash command state machine (autoselect, byte program,
+// sector/chip erase). Feed writes captured by a flash-mode bank window
+// (Mult.RAM=0, Mult.WRITE_EN=1); `linear` is the decoded flash offset.
+// Returns true if the write was absorbed by the state machine (caller
+// must not forward it to RAM).
+bool c2_flash_cmd_write(c2_state_t *c2, uint16_t addr, uint32_t linear, uint8_t data);
 
 // Returns the byte to drive on the bus for a flash-mode bank-window
-// read. When autoselect is armed, returns the M29W640G IDs; otherwise
-// returns the byte stored at the decoded linear RAM offset.
-uint8_t c2_flash_read(const c2_state_t *c2, uint16_t addr, uint32_t linear);
+// read. When autoselect is armed, returns the M29W640G IDs; after a failed
+// byte program, the status byte (DQ6 toggles on every read); otherwise the
+// flash image byte at the decoded linear offset (or the RAM byte when no
+// flash image is attached).
+uint8_t c2_flash_read(c2_state_t *c2, uint16_t addr, uint32_t linear);
 
 #endif // C2_EMU_H
@@ -12,6 +12,8 @@
 #include <ctype.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <malloc.h>
 #include "ff.h"
 #include "diskio.h"
 #include "pico/stdlib.h"
@@ -21,35 +23,56 @@
 #include "hardware/dma.h"
 #include "hardware/pio.h"
 #include "hardware/structs/qmi.h"
+#include "hardware/structs/systick.h"
 #include "hardware/regs/qmi.h"
 #include "hardware/structs/xip_ctrl.h"
+#include "hardware/xip_cache.h"
 #include "hardware/sync.h"
 #include "hardware/uart.h"
 #include "hardware/regs/uart.h"
 #include "hardware/irq.h"
 #include "hw_config.h"
 #include "explorer.h"
-#include "mapper_detect.h"
+// SHA-1 verification runs on core1 while a game is served: keep the block
+// transform out of flash.
+#define SHA1_TRANSFORM_ATTR __not_in_flash("sha1")
+#include "../../../../../common/mapper_detect.h"
+// The MAPPER_AUTO scoring runs in the RAM-resident bus write handler.
+#define MAPPER_AUTO_INLINE static __force_inline
+#include "../../../../../common/mapper_auto.h"
 #include "mp3.h"
 #include "c2_emu.h"
+#include "fh_unzip.h"
 #include "emu2212.h"
 #include "emu2149.h"
 #include "emu2413.h"
 #include "emu2151.h"
+#include "opl4_emu.h"
+#include "opl4_fm.h"
 #include "msx_bus.pio.h"
 #include "pico/audio_i2s.h"
 #include "sunrise_ide.h"
 #include "sunrise_sd.h"
+#include "sunrise_ramdisk.h"
+#include "usb_push.h"
+#if EXPLORER_USB_PUSH
+#include "usb_push_dev.h"
+#endif
 
 // config area and buffer for the ROM data
 #define ROM_NAME_MAX    71          // Maximum size of the ROM name on the 80-column detail screen
-#define MAX_ROM_RECORDS 1024        // Maximum ROM files supported (flash + SD)
+#define MAX_ROM_RECORDS 1024        // Menu records kept in SRAM when PSRAM is unavailable
+#define RECORD_STORE_CAPACITY 16384u // Menu records kept in the PSRAM record store
+#define RECORD_STORE_SIZE (2u * 1024u * 1024u) // PSRAM window below the recent-ROM table
+#define RECORD_STORE_OFFSET (RECENT_ROM_TABLE_OFFSET - RECORD_STORE_SIZE)
+#define SD_PATH_NONE    0xFFFFFFFFu // sd_path_offsets[] value for records without an SD path
 #define MAX_FLASH_RECORDS 128       // Maximum ROM files stored in flash
 #define ROM_RECORD_SIZE (ROM_NAME_MAX + 1 + (sizeof(uint32_t) * 2)) // Name + mapper + size + offset
 #define MENU_ROM_SIZE   (32u * 1024u) // Full menu ROM size stored before config records
 #define CONFIG_AREA_SIZE (16u * 1024u)
 #define ROM_SELECT_MENU 0xFEu
 #define ROM_SELECT_WIFI_CONFIG 0xFFF0u
+#define ROM_SELECT_USB_PUSH 0xFFF1u // Launch the image received over the USB push link
 #define WIFI_CONFIG_FLASH_OFFSET (MENU_ROM_SIZE + CONFIG_AREA_SIZE)
 #define WIFI_CONFIG_ROM_SIZE (8u * 1024u)
 #define WIFI_BIOS_FLASH_OFFSET (WIFI_CONFIG_FLASH_OFFSET + WIFI_CONFIG_ROM_SIZE)
@@ -58,8 +81,10 @@
 #define FMPAC_BIOS_ROM_SIZE (64u * 1024u)
 #define SFG_BIOS_FLASH_OFFSET (FMPAC_BIOS_FLASH_OFFSET + FMPAC_BIOS_ROM_SIZE)
 #define SFG_BIOS_ROM_SIZE (64u * 1024u)
+#define OPL4_WAVE_ROM_FLASH_OFFSET (SFG_BIOS_FLASH_OFFSET + SFG_BIOS_ROM_SIZE) // YRW801-M, OPL4_WAVE_ROM_SIZE bytes
 #define WIFI_CONFIG_RETURN_MENU 0xE0u
 #define MONITOR_ADDR    (0xBF7F)    // ROM select register just below the menu control window
+#define MONITOR_ADDR_H  (0xBF7E)    // ROM select high byte, written before MONITOR_ADDR
 #define CACHE_SIZE      (256u * 1024u)     // 256KB cache size for ROM data
 
 #define SOURCE_SD_FLAG  0x80 // Flag in the mapper byte indicating the ROM is on SD
@@ -126,6 +151,20 @@
 #define VDP_FREQ_DEFAULT 0u
 #define VDP_FREQ_60HZ    1u
 #define VDP_FREQ_50HZ    2u
+#define CTRL_VERIFY_STATUS    0xBFA1 // Control: loaded-image verification status (Pico -> MSX)
+#define CTRL_VERIFY_PROGRESS  0xBFA2 // Control: verification progress percent
+#define CTRL_PAGE_H     0xBFA3 // Control: current page index high byte, written before CTRL_PAGE
+#define CTRL_VERIFY_SHA1_BASE 0xBFA4 // Control: leading bytes of the image SHA-1
+#define CTRL_VERIFY_SHA1_SIZE 8u
+#define CTRL_BOOT_STAGE  0xBFAC // Control: boot timeline stage select (write) / stage count (read)
+#define CTRL_BOOT_TIME_L 0xBFAD // Control: selected stage time in ms since power-on, low byte
+#define CTRL_BOOT_TIME_H 0xBFAE // Control: selected stage time high byte (0xFFFF = not reached)
+#define VERIFY_IDLE           0u // No image verified since boot
+#define VERIFY_RUNNING        1u // Hash in progress
+#define VERIFY_OK_SIDECAR     2u // SHA-1 matches the <file>.sha1 sidecar
+#define VERIFY_OK_ROMDB       3u // SHA-1 is a known romdb.h dump
+#define VERIFY_UNKNOWN        4u // No reference to compare against
+#define VERIFY_MISMATCH       5u // SHA-1 differs from the sidecar
 #define FH_DATA_BASE    0xB900
 #define FH_RECORD_FLAG_OFFSET ROM_NAME_MAX
 #define FH_RECORD_SIZE_OFFSET (FH_RECORD_FLAG_OFFSET + 1u)
@@ -172,6 +211,7 @@
 #define AUDIO_PROFILE_YM2151_SFG01 8u
 #define AUDIO_PROFILE_MEGARAM_SCC 9u
 #define AUDIO_PROFILE_MEGARAM_SCC_PLUS 10u
+#define AUDIO_PROFILE_MOONSOUND 11u
 
 #define PSG_SAMPLE_RATE 44100
 #define PSG_CLOCK       1789773
@@ -214,6 +254,19 @@
 #define YM2151_PSG_VOLUME_SHIFT 0
 #define YM2151_BASE_VOLUME_PERCENT 200u
 
+#define OPL4_PORT_WAVE_REG    0x7Eu
+#define OPL4_PORT_WAVE_DATA   0x7Fu
+#define OPL4_PORT_FM_BASE     0xC4u   // 0xC4-0xC7: FM address/data, bank 0 and bank 1
+#define OPL4_WRITE_RING_SIZE  1024u
+#define OPL4_WRITE_RING_MASK  (OPL4_WRITE_RING_SIZE - 1u)
+#define OPL4_WRITE_FM         0x10000u  // ring entry tag: FM port write (else wave register)
+#define OPL4_CPU_BUDGET_PERCENT 70u     // share of a core 1 sample period the renderer may use
+#define OPL4_MIN_VOICES       6u
+#define OPL4_CALIBRATE_SAMPLES 256u
+#define OPL4_SAMPLE_RAM_MIN   (128u * 1024u)
+#define OPL4_WAVE_VOLUME_SHIFT 1
+#define OPL4_PSG_VOLUME_SHIFT 0
+
 #define WIFI_MEM_F2_ADDR      0x7F05u
 #define WIFI_MEM_CMD_ADDR     0x7F06u
 #define WIFI_MEM_DATA_ADDR    0x7F07u
@@ -232,6 +285,23 @@
 
 #define DATA_BASE_ADDR   0xB900 // Data buffer base address
 #define DATA_BUFFER_SIZE (FH_STATUS_TEXT_BASE - DATA_BASE_ADDR) // Data buffer size
+#define MBOX_BASE        DATA_BASE_ADDR // Mailbox frame, overlays the data buffer while mapped
+#define MBOX_STATUS      (MBOX_BASE + 0) // Mailbox: status (read) / 0 releases the frame (write)
+#define MBOX_SEQ         (MBOX_BASE + 1) // Mailbox: sequence number; writing it posts the request
+#define MBOX_CMD         (MBOX_BASE + 2) // Mailbox: command code
+#define MBOX_LEN_L       (MBOX_BASE + 4) // Mailbox: request/reply payload length low byte
+#define MBOX_LEN_H       (MBOX_BASE + 5) // Mailbox: request/reply payload length high byte
+#define MBOX_HEADER_SIZE 8u
+#define MBOX_PAYLOAD     (MBOX_BASE + MBOX_HEADER_SIZE) // Mailbox: request/reply payload
+#define MBOX_PAYLOAD_SIZE (DATA_BUFFER_SIZE - MBOX_HEADER_SIZE)
+#define MBOX_STATUS_IDLE  0x00u // No frame mapped
+#define MBOX_STATUS_BUSY  0x01u // Request accepted, reply not ready
+#define MBOX_STATUS_DONE  0x02u // Reply payload ready
+#define MBOX_STATUS_ERROR 0x03u // Unknown command or malformed request
+#define MBOX_REPLY_CTRL_SIZE 16u // Reply: CTRL_BASE_ADDR..+15 as the menu would read them
+#define MBOX_REPLY_VDP_FREQ  MBOX_REPLY_CTRL_SIZE // Reply: CTRL_VDP_FREQ
+#define MBOX_REPLY_PARTITION (MBOX_REPLY_VDP_FREQ + 1u) // Reply: SD partition info block
+#define MBOX_REPLY_SIZE      (MBOX_REPLY_PARTITION + CTRL_SD_PARTITION_INFO_SIZE)
 #define DATA_MAGIC_0     'P' // Data header magic bytes
 #define DATA_MAGIC_1     'V' // Data header magic bytes
 #define DATA_MAGIC_2     'E' // Data header magic bytes
@@ -273,6 +343,7 @@
 #define MP3_CTRL_TOTAL_L   (MP3_CTRL_BASE + 6)
 #define MP3_CTRL_TOTAL_H   (MP3_CTRL_BASE + 7)
 #define MP3_CTRL_MODE      (MP3_CTRL_BASE + 8)
+#define CTRL_USB_PUSH      (MP3_CTRL_BASE + 15) // Control: CTRL_MAGIC while a pushed ROM waits to run (Pico -> MSX)
 
 // MSX protocol command code for MP3 file selection (local to explorer.c)
 #define MP3_CMD_SELECT      0x01
@@ -295,13 +366,14 @@ typedef struct {
 } msx_pio_io_bus_t;
 
 static msx_pio_bus_t msx_bus;
-static bool msx_bus_programs_loaded = false;
+static bool msx_bus_write_program_loaded = false;
+static const pio_program_t *msx_bus_read_program = NULL; // read responder currently in pio0
 static msx_pio_io_bus_t msx_io_bus;
 static bool msx_io_read_program_loaded = false;
 static bool msx_io_write_program_loaded = false;
 
 typedef struct {
-    uint16_t rom_index;
+    uint32_t rom_index;
     bool rom_selected;
 } menu_select_ctx_t;
 
@@ -329,10 +401,17 @@ extern const uint8_t __flash_binary_end[];
 static uint8_t *rom_sram = NULL;
 static uint32_t active_rom_size = 0;
 static uint32_t rom_cached_size = 0; // Added for PIO implementation
+// Set by a loop that answers every read from on-chip SRAM (see
+// read_sram_copy()); picks the deadline responder. Cleared on every launch.
+static bool bus_reads_sram = false;
 // Effective cache capacity used by prepare_rom_source(). Some mappers (e.g.
 // Manbow2) reduce this so the tail of rom_sram can be repurposed (writable
 // flash sector emulation), matching multirom's behaviour.
 static uint32_t rom_cache_capacity = CACHE_SIZE;
+// ROM offset held at rom_sram[0], and the one the next prepare_rom_source()
+// should cache from (set by the title profile, 0 = the leading window).
+static uint32_t rom_cache_base = 0;
+static uint32_t rom_cache_window_plan = 0;
 static uint8_t page_buffer[DATA_BUFFER_SIZE];
 
 // pointer to the custom data
@@ -576,10 +655,13 @@ static psram_region_t sd_rom_region;
 static psram_region_t rom_cache_region;
 static psram_region_t mapper_region;
 static psram_region_t c2_rom_region;
+static psram_region_t c2_flash_region;
 static psram_region_t megaram_region;
 static psram_region_t mp3_buffer_region;
 static psram_region_t fh_list_region;
 static psram_region_t fh_download_region;
+static psram_region_t fh_zip_region;       // compressed archive staging for .zip downloads
+static psram_region_t opl4_ram_region;     // MoonSound sample RAM
 static bool psram_bring_up_once(void);
 static bool psram_prepare_mp3_buffer(void);
 
@@ -600,7 +682,8 @@ typedef struct {
     unsigned long Offset;
 } ROMRecord;
 
-ROMRecord records[MAX_ROM_RECORDS]; // Array to store the ROM records
+static ROMRecord records_sram[MAX_ROM_RECORDS];
+ROMRecord *records = records_sram; // ROM records (PSRAM record store once attached)
 
 #define SD_PATH_MAX        256
 #define SD_PATH_BUFFER_SIZE 19000
@@ -619,6 +702,9 @@ ROMRecord records[MAX_ROM_RECORDS]; // Array to store the ROM records
 #define MAPPER_MEGARAM_SD         19
 #define MAPPER_MEGARAM_USB        20
 #define MAPPER_MEGARAM            21
+#define MAPPER_AUTO               22 // 8/16KB megaROM, mapper inferred at runtime from bank writes
+#define MAPPER_AUTO_MIN_SIZE      (64u * 1024u)
+#define MAPPER_AUTO_CLOSE         15u // confidence gap under which the top two guesses are a toss-up
 
 static const char *MAPPER_DESCRIPTIONS[] = {
     "PLA-16", "PLA-32", "KonSCC", "PLN-48", "ASC-08",
@@ -628,20 +714,36 @@ static const char *MAPPER_DESCRIPTIONS[] = {
 
 #define MAPPER_DESCRIPTION_COUNT (sizeof(MAPPER_DESCRIPTIONS) / sizeof(MAPPER_DESCRIPTIONS[0]))
 
-static char sd_path_buffer[SD_PATH_BUFFER_SIZE];
-static uint16_t sd_path_offsets[MAX_ROM_RECORDS];
-static uint16_t sd_path_buffer_used = 0;
+static char sd_path_buffer_sram[SD_PATH_BUFFER_SIZE];
+static uint32_t sd_path_offsets_sram[MAX_ROM_RECORDS];
+static uint32_t filtered_indices_sram[MAX_ROM_RECORDS];
+static char *sd_path_buffer = sd_path_buffer_sram;
+static uint32_t *sd_path_offsets = sd_path_offsets_sram;
+static uint32_t sd_path_buffer_size = SD_PATH_BUFFER_SIZE;
+static uint32_t sd_path_buffer_used = 0;
+static uint32_t record_capacity = MAX_ROM_RECORDS;
+static bool record_store_guarded = false; // store window is off limits to psram_alloc()
 static uint16_t sd_record_count = 0;
 static bool sd_mounted = false;
 static uint8_t sd_mounted_partition = 0;
+static uint32_t sd_mounted_lba_base = 0; // card LBA of the mounted partition
 static uint8_t sd_browse_partition = 0;
 static bool sd_config_loaded = false;
 static sd_card_t *sd_card = NULL;
-static uint16_t total_record_count = 0;
-static uint16_t full_record_count = 0;
-static uint8_t current_page = 0;
-static uint16_t filtered_indices[MAX_ROM_RECORDS];
+static uint32_t total_record_count = 0;
+static uint32_t full_record_count = 0;
+static uint16_t current_page = 0;
+static uint8_t ctrl_page_high = 0;        // CTRL_PAGE_H latch, consumed by the next CTRL_PAGE write
+static uint8_t rom_select_high = 0;       // MONITOR_ADDR_H latch, consumed by the next MONITOR_ADDR write
+static uint32_t *filtered_indices = filtered_indices_sram;
 static char filter_query[CTRL_QUERY_SIZE];
+// Search index, kept in the PSRAM record store only (NULL without it): per
+// record, a mask of the characters in its name and how many leading
+// characters of search_index_query it contains.
+static uint32_t *search_masks = NULL;
+static uint8_t *search_depth = NULL;
+static bool search_index_valid = false;
+static char search_index_query[CTRL_QUERY_SIZE];
 static volatile uint8_t ctrl_cmd_state = 0;
 static volatile uint8_t ctrl_mapper_value = 0;
 static volatile uint8_t ctrl_ack_value = 0;
@@ -668,8 +770,8 @@ typedef enum {
 } refresh_state_t;
 static refresh_state_t refresh_state = REFRESH_IDLE;
 static DIR refresh_dir;
-static uint16_t refresh_record_index = 0;
-static uint16_t refresh_folder_count = 0;
+static uint32_t refresh_record_index = 0;
+static uint32_t refresh_folder_count = 0;
 static bool refresh_has_parent = false;
 static volatile uint16_t detect_mapper_index = 0;
 static volatile uint16_t mp3_selected_index = 0;
@@ -874,6 +976,7 @@ typedef enum {
     AUDIO_MODE_MSX_MUSIC,
     AUDIO_MODE_YM2151_SFG05,
     AUDIO_MODE_YM2151_SFG01,
+    AUDIO_MODE_MOONSOUND,
 } audio_mode_t;
 
 static const char *EXCLUDED_SD_FOLDERS[] = {
@@ -883,8 +986,7 @@ static const size_t EXCLUDED_SD_FOLDER_COUNT = sizeof(EXCLUDED_SD_FOLDERS) / siz
 
 static void write_u32_le(uint8_t *ptr, uint32_t value);
 static void write_u16_le(uint8_t *ptr, uint16_t value);
-static void build_page_buffer(uint8_t page_index);
-static void refresh_records_for_current_path(void);
+static void build_page_buffer(uint16_t page_index);
 static bool sd_mount_card(void);
 static void sd_unmount_card(void);
 static void cancel_refresh_work(void);
@@ -893,6 +995,69 @@ static void process_delete_sd_file_request(void);
 static void process_detect_mapper_request(uint16_t filtered_index);
 static void quiesce_mp3_core1_before_sd_work(void);
 
+// -----------------------------------------------------------------------
+// Boot timeline - time_us_32() stamps for each bring-up stage, taken the
+// first time the stage is reached after power-on. The table is printed
+// over stdio once the first directory scan finishes and can be read back
+// by the menu through CTRL_BOOT_STAGE/CTRL_BOOT_TIME_L/H.
+// -----------------------------------------------------------------------
+typedef enum {
+    BOOT_STAGE_MAIN = 0,        // main() entered
+    BOOT_STAGE_CLOCKS,          // system clock, stdio and GPIO set up
+    BOOT_STAGE_PSRAM,           // PSRAM detected and the ROM cache region allocated
+    BOOT_STAGE_MENU_ROM,        // menu ROM copied, /WAIT released
+    BOOT_STAGE_RECORDS,         // flash records parsed, record store attached
+    BOOT_STAGE_SD_MOUNT,        // first successful microSD mount
+    BOOT_STAGE_DIR_SCAN,        // first directory listing complete
+    BOOT_STAGE_MSX_FIRST_READ,  // first menu ROM read served to the MSX
+    BOOT_STAGE_COUNT
+} boot_stage_t;
+
+#define BOOT_STAGE_UNSET 0xFFFFFFFFu
+
+static const char *const boot_stage_names[BOOT_STAGE_COUNT] = {
+    "main", "clocks", "psram", "menu_rom", "records", "sd_mount", "dir_scan", "msx_first_read"
+};
+static uint32_t boot_timeline_us[BOOT_STAGE_COUNT] = {
+    BOOT_STAGE_UNSET, BOOT_STAGE_UNSET, BOOT_STAGE_UNSET, BOOT_STAGE_UNSET,
+    BOOT_STAGE_UNSET, BOOT_STAGE_UNSET, BOOT_STAGE_UNSET, BOOT_STAGE_UNSET
+};
+static bool boot_timeline_reported = false;
+static uint8_t ctrl_boot_stage = 0;
+
+static inline void boot_mark(boot_stage_t stage)
+{
+    if (boot_timeline_us[stage] == BOOT_STAGE_UNSET) {
+        boot_timeline_us[stage] = time_us_32();
+    }
+}
+
+// Milliseconds since power-on for a stage, 0xFFFF while it has not been reached.
+static uint16_t boot_stage_ms(uint8_t stage)
+{
+    if (stage >= BOOT_STAGE_COUNT || boot_timeline_us[stage] == BOOT_STAGE_UNSET) return 0xFFFFu;
+    uint32_t ms = boot_timeline_us[stage] / 1000u;
+    return (ms < 0xFFFFu) ? (uint16_t)ms : 0xFFFEu;
+}
+
+static void boot_timeline_report(void)
+{
+    if (boot_timeline_reported) return;
+    boot_timeline_reported = true;
+    uint32_t prev = 0;
+    for (uint8_t i = 0; i < BOOT_STAGE_COUNT; i++) {
+        uint32_t t = boot_timeline_us[i];
+        if (t == BOOT_STAGE_UNSET) {
+            printf("BOOT: %-14s --\n", boot_stage_names[i]);
+            continue;
+        }
+        printf("BOOT: %-14s %6lu.%03lu ms (+%lu us)\n", boot_stage_names[i],
+               (unsigned long)(t / 1000u), (unsigned long)(t % 1000u),
+               (unsigned long)(t - prev));
+        prev = t;
+    }
+}
+
 static bool is_system_mapper(uint8_t mapper) {
     return mapper == MAPPER_SUNRISE_USB ||
            mapper == MAPPER_SUNRISE_MAPPER_USB ||
@@ -905,6 +1070,12 @@ static bool is_system_mapper(uint8_t mapper) {
            mapper == MAPPER_MEGARAM;
 }
 
+// Mapper codes the menu may store as a per-ROM override.
+static bool mapper_is_selectable(uint8_t mapper) {
+    if (mapper == 0 || is_system_mapper(mapper)) return false;
+    return mapper < MAPPER_DESCRIPTION_COUNT || mapper == MAPPER_AUTO;
+}
+
 static bool is_sunrise_sd_mapper(uint8_t mapper) {
     return mapper == MAPPER_SUNRISE_SD || mapper == MAPPER_SUNRISE_MAPPER_SD ||
            mapper == MAPPER_C2_SD || mapper == MAPPER_MEGARAM_SD;
@@ -963,6 +1134,9 @@ static audio_mode_t resolve_audio_mode(uint8_t mapper, uint8_t requested_profile
     if (is_audio_system_mapper(mapper)) {
         return AUDIO_MODE_NONE;
     }
+    if (requested_profile == AUDIO_PROFILE_MOONSOUND) {
+        return AUDIO_MODE_MOONSOUND;
+    }
     if (requested_profile == AUDIO_PROFILE_MSX_MUSIC) {
         return AUDIO_MODE_MSX_MUSIC;
     }
@@ -1048,10 +1222,73 @@ static bool contains_ignore_case(const char *text, const char *query) {
     return false;
 }
 
+static uint32_t search_text_mask(const char *text) {
+    uint32_t mask = 0;
+    for (; *text; text++) {
+        unsigned char c = (unsigned char)toupper((unsigned char)*text);
+        if (c >= 'A' && c <= 'Z') {
+            mask |= 1u << (c - 'A');
+        } else if (c >= '0' && c <= '9') {
+            mask |= 1u << (26u + (c - '0') % 5u);
+        } else {
+            mask |= 1u << 31;
+        }
+    }
+    return mask;
+}
+
+// Bring search_depth[] up to filter_query. Typing a character only compares
+// the names that contained the query one character shorter (and have all of
+// its characters), and deleting one compares nothing, so the menu can send
+// every keystroke even with thousands of records.
+static void search_index_update(void) {
+    char name_buf[ROM_NAME_MAX + 1];
+    if (!search_index_valid) {
+        for (uint32_t i = 0; i < full_record_count; i++) {
+            trim_name_copy(name_buf, records[i].Name);
+            search_masks[i] = search_text_mask(name_buf);
+            search_depth[i] = 0;
+        }
+        search_index_query[0] = '\0';
+        search_index_valid = true;
+    }
+
+    size_t common = 0;
+    while (filter_query[common] != '\0' &&
+           toupper((unsigned char)filter_query[common]) == toupper((unsigned char)search_index_query[common])) {
+        common++;
+    }
+    if (strlen(search_index_query) > common) {
+        for (uint32_t i = 0; i < full_record_count; i++) {
+            if (search_depth[i] > common) {
+                search_depth[i] = (uint8_t)common;
+            }
+        }
+    }
+
+    size_t len = strlen(filter_query);
+    char prefix[CTRL_QUERY_SIZE];
+    for (size_t k = common + 1; k <= len; k++) {
+        memcpy(prefix, filter_query, k);
+        prefix[k] = '\0';
+        uint32_t mask = search_text_mask(prefix);
+        for (uint32_t i = 0; i < full_record_count; i++) {
+            if (search_depth[i] != k - 1 || (search_masks[i] & mask) != mask) {
+                continue;
+            }
+            trim_name_copy(name_buf, records[i].Name);
+            if (contains_ignore_case(name_buf, prefix)) {
+                search_depth[i] = (uint8_t)k;
+            }
+        }
+    }
+    memcpy(search_index_query, filter_query, len + 1);
+}
+
 static void apply_filter(void) {
     total_record_count = 0;
     if (filter_query[0] == '\0') {
-        for (uint16_t i = 0; i < full_record_count; i++) {
+        for (uint32_t i = 0; i < full_record_count; i++) {
             if (record_matches_source_mode(&records[i])) {
                 filtered_indices[total_record_count++] = i;
             }
@@ -1059,8 +1296,19 @@ static void apply_filter(void) {
         return;
     }
 
+    if (search_masks) {
+        search_index_update();
+        size_t len = strlen(filter_query);
+        for (uint32_t i = 0; i < full_record_count; i++) {
+            if (search_depth[i] >= len && record_matches_source_mode(&records[i])) {
+                filtered_indices[total_record_count++] = i;
+            }
+        }
+        return;
+    }
+
     char name_buf[ROM_NAME_MAX + 1];
-    for (uint16_t i = 0; i < full_record_count; i++) {
+    for (uint32_t i = 0; i < full_record_count; i++) {
         if (!record_matches_source_mode(&records[i])) {
             continue;
         }
@@ -1077,43 +1325,75 @@ static void find_first_match(void) {
         return;
     }
 
+    if (search_masks) {
+        search_index_update();
+        size_t len = strlen(filter_query);
+        for (uint32_t i = 0; i < total_record_count; i++) {
+            uint32_t record_index = filtered_indices[i];
+            if (record_index < full_record_count && search_depth[record_index] >= len) {
+                match_index = (uint16_t)i;
+                return;
+            }
+        }
+        return;
+    }
+
     char name_buf[ROM_NAME_MAX + 1];
-    for (uint16_t i = 0; i < total_record_count; i++) {
-        uint16_t record_index = filtered_indices[i];
+    for (uint32_t i = 0; i < total_record_count; i++) {
+        uint32_t record_index = filtered_indices[i];
         if (record_index >= full_record_count) {
             continue;
         }
         trim_name_copy(name_buf, records[record_index].Name);
         if (contains_ignore_case(name_buf, filter_query)) {
-            match_index = i;
+            match_index = (uint16_t)i;
             return;
         }
     }
 }
 
-static void swap_records(uint16_t a, uint16_t b) {
+static void swap_records(uint32_t a, uint32_t b) {
     if (a == b) {
         return;
     }
     ROMRecord temp = records[a];
     records[a] = records[b];
     records[b] = temp;
-    uint16_t path_temp = sd_path_offsets[a];
+    uint32_t path_temp = sd_path_offsets[a];
     sd_path_offsets[a] = sd_path_offsets[b];
     sd_path_offsets[b] = path_temp;
 }
 
-static void sort_records_range(uint16_t start, uint16_t count) {
+static void sift_down_records(uint32_t start, uint32_t root, uint32_t count) {
+    while (true) {
+        uint32_t child = root * 2u + 1u;
+        if (child >= count) {
+            return;
+        }
+        if (child + 1u < count &&
+            compare_record_names(&records[start + child], &records[start + child + 1u]) < 0) {
+            child++;
+        }
+        if (compare_record_names(&records[start + root], &records[start + child]) >= 0) {
+            return;
+        }
+        swap_records(start + root, start + child);
+        root = child;
+    }
+}
+
+// Heapsort: in place and O(n log n), so folders with thousands of entries
+// in the PSRAM store sort in a fraction of a second.
+static void sort_records_range(uint32_t start, uint32_t count) {
     if (count < 2) {
         return;
     }
-    uint16_t end = (uint16_t)(start + count);
-    for (uint16_t i = start; i + 1 < end; i++) {
-        for (uint16_t j = i + 1; j < end; j++) {
-            if (compare_record_names(&records[i], &records[j]) > 0) {
-                swap_records(i, j);
-            }
-        }
+    for (uint32_t i = count / 2u; i-- > 0u;) {
+        sift_down_records(start, i, count);
+    }
+    for (uint32_t end = count - 1u; end > 0u; end--) {
+        swap_records(start, start + end);
+        sift_down_records(start, 0, end);
     }
 }
 
@@ -1138,15 +1418,22 @@ static void write_config_area(uint8_t *config_area, const ROMRecord *list, uint1
     }
 }
 
-static void build_page_buffer(uint8_t page_index) {
+static void build_page_buffer(uint16_t page_index) {
     uint8_t *buffer = page_buffer;
     const uint16_t buffer_size = DATA_BUFFER_SIZE;
-    uint16_t start_index = (uint16_t)page_index * FILES_PER_PAGE;
+    uint32_t start_index = (uint32_t)page_index * FILES_PER_PAGE;
     uint16_t record_count = 0;
 
     if (start_index < total_record_count) {
-        uint16_t remaining = (uint16_t)(total_record_count - start_index);
-        record_count = (remaining > FILES_PER_PAGE) ? FILES_PER_PAGE : remaining;
+        uint32_t remaining = total_record_count - start_index;
+        record_count = (uint16_t)((remaining > FILES_PER_PAGE) ? FILES_PER_PAGE : remaining);
+    }
+
+    // Pull the page's records out of the store once; the two passes below
+    // then work from SRAM instead of going back to PSRAM per field.
+    static ROMRecord window[FILES_PER_PAGE];
+    for (uint16_t i = 0; i < record_count; i++) {
+        window[i] = records[filtered_indices[start_index + i]];
     }
 
     memset(buffer, 0xFF, buffer_size);
@@ -1164,10 +1451,8 @@ static void build_page_buffer(uint8_t page_index) {
     uint16_t string_cursor = 0;
     uint16_t max_name_bytes = record_count ? (uint16_t)(max_string_pool / record_count) : 0;
     for (uint16_t i = 0; i < record_count; i++) {
-        uint16_t filtered_index = (uint16_t)(start_index + i);
-        uint16_t record_index = filtered_indices[filtered_index];
         char name_buf[ROM_NAME_MAX + 1];
-        size_t name_len = trim_name_copy(name_buf, records[record_index].Name);
+        size_t name_len = trim_name_copy(name_buf, window[i].Name);
         if (max_name_bytes != 0u && name_len + 1u > max_name_bytes) {
             name_len = max_name_bytes - 1u;
             name_buf[name_len] = '\0';
@@ -1187,8 +1472,6 @@ static void build_page_buffer(uint8_t page_index) {
     uint16_t payload_cursor = 0;
 
     for (uint16_t i = 0; i < record_count; i++) {
-        uint16_t filtered_index = (uint16_t)(start_index + i);
-        uint16_t record_index = filtered_indices[filtered_index];
         uint8_t *entry = buffer + table_offset + (i * DATA_RECORD_TABLE_ENTRY_SIZE);
         uint16_t record_offset = (uint16_t)(payload_offset + payload_cursor);
         uint16_t record_length = DATA_RECORD_PAYLOAD_SIZE;
@@ -1202,10 +1485,10 @@ static void build_page_buffer(uint8_t page_index) {
         write_u16_le(rec + 2, name_offsets[i]);
         rec[4] = TLV_MAPPER;
         rec[5] = 1;
-        rec[6] = records[record_index].Mapper;
+        rec[6] = window[i].Mapper;
         rec[7] = TLV_SIZE;
         rec[8] = 4;
-        write_u32_le(rec + 9, (uint32_t)records[record_index].Size);
+        write_u32_le(rec + 9, (uint32_t)window[i].Size);
 
         payload_cursor = (uint16_t)(payload_cursor + record_length);
     }
@@ -1217,7 +1500,7 @@ static void build_page_buffer(uint8_t page_index) {
     buffer[4] = DATA_VERSION;
     buffer[5] = 0;
     write_u16_le(buffer + 6, DATA_HEADER_SIZE);
-    write_u16_le(buffer + 8, total_record_count);
+    write_u16_le(buffer + 8, (uint16_t)total_record_count);
     write_u16_le(buffer + 10, page_index);
     write_u16_le(buffer + 12, record_count);
     write_u16_le(buffer + 14, table_offset);
@@ -1411,7 +1694,7 @@ static bool has_wav_extension(const char *filename) {
     return equals_ignore_case(dot + 1, "WAV");
 }
 
-static bool build_pvc_options_path(uint16_t record_index, char *out, size_t out_size) {
+static bool build_pvc_options_path(uint32_t record_index, char *out, size_t out_size) {
     if (!out || out_size == 0 || record_index >= full_record_count) {
         return false;
     }
@@ -1426,7 +1709,7 @@ static bool build_pvc_options_path(uint16_t record_index, char *out, size_t out_
     }
 
     if ((rec->Mapper & SOURCE_SD_FLAG) != 0) {
-        if (sd_path_offsets[record_index] == 0xFFFF) {
+        if (sd_path_offsets[record_index] == SD_PATH_NONE) {
             return false;
         }
         const char *rom_path = sd_path_buffer + sd_path_offsets[record_index];
@@ -1461,7 +1744,7 @@ static void process_enter_dir_request(void) {
     if ((uint8_t)filter_query[2] == CTRL_MAGIC) {
         uint16_t filtered_index = query_filtered_index();
         if (filtered_index < total_record_count) {
-            uint16_t record_index = filtered_indices[filtered_index];
+            uint32_t record_index = filtered_indices[filtered_index];
             if (record_index < full_record_count && (records[record_index].Mapper & FOLDER_FLAG)) {
                 append_folder_to_path(records[record_index].Name);
             }
@@ -1483,7 +1766,7 @@ static void cancel_refresh_work(void) {
     refresh_requested = false;
 }
 
-static bool wavegame_assets_detected_for_record(uint16_t record_index);
+static bool wavegame_assets_detected_for_record(uint32_t record_index);
 
 static void set_sunrise_partition_text(const char *text) {
     size_t len = text ? strlen(text) : 0;
@@ -1621,7 +1904,7 @@ static void process_load_options_request(void) {
     if (index >= total_record_count) {
         return;
     }
-    uint16_t record_index = filtered_indices[index];
+    uint32_t record_index = filtered_indices[index];
     ROMRecord *rec = &records[record_index];
     bool sunrise_sd_options = is_sunrise_sd_mapper(mapper_code_from_record_byte(rec->Mapper));
     ctrl_wavegame_rom = wavegame_assets_detected_for_record(record_index) ? 1u : 0u;
@@ -1660,7 +1943,7 @@ static void process_load_options_request(void) {
     if (ctrl_wavegame_rom) {
         ctrl_audio_selection = AUDIO_PROFILE_NONE;
     }
-    if (br >= PVC_OPTIONS_MAPPER_SIZE && data[6] != 0 && !is_system_mapper(data[6]) && data[6] < MAPPER_DESCRIPTION_COUNT) {
+    if (br >= PVC_OPTIONS_MAPPER_SIZE && mapper_is_selectable(data[6])) {
         uint8_t flags = rec->Mapper & (SOURCE_SD_FLAG | FOLDER_FLAG | MP3_FLAG);
         if ((flags & (FOLDER_FLAG | MP3_FLAG)) == 0) {
             rec->Mapper = (uint8_t)(flags | data[6]);
@@ -1690,7 +1973,7 @@ static void process_save_options_request(void) {
     if (index >= total_record_count) {
         return;
     }
-    uint16_t record_index = filtered_indices[index];
+    uint32_t record_index = filtered_indices[index];
     uint8_t audio_selection = wavegame_assets_detected_for_record(record_index) ? AUDIO_PROFILE_NONE : (uint8_t)filter_query[2];
     uint8_t sd_partition = (uint8_t)filter_query[5];
     uint8_t audio_volume = (uint8_t)filter_query[6];
@@ -1744,7 +2027,7 @@ static void process_prepare_quick_run_request(void) {
         return;
     }
 
-    uint16_t record_index = filtered_indices[index];
+    uint32_t record_index = filtered_indices[index];
     if (record_index >= full_record_count) {
         return;
     }
@@ -1805,7 +2088,8 @@ static uint32_t fatfs_reader_cb(void *user, uint32_t offset, void *buf, uint32_t
 // Stream a ROM file from the SD card through the shared mapper detector.
 // Uses the same SHA1 + heuristic algorithm as the PC tool so that the firmware
 // produces identical mapper guesses for ROMs executed straight from microSD.
-static uint8_t detect_rom_type_from_file(const char *path, uint32_t size) {
+static uint8_t detect_rom_type_from_file(const char *path, uint32_t size, mapper_detect_result_t *result) {
+    memset(result, 0, sizeof(*result));
     if (size > MAX_ROM_SIZE || size < MIN_ROM_SIZE) {
         return 0;
     }
@@ -1817,14 +2101,21 @@ static uint8_t detect_rom_type_from_file(const char *path, uint32_t size) {
     }
 
     fatfs_reader_ctx_t ctx = { .fil = &fil, .cur_offset = 0, .failed = false };
-    uint8_t mapper = mapper_detect_stream(size, fatfs_reader_cb, &ctx);
+    uint8_t mapper = mapper_detect_stream_ranked(size, fatfs_reader_cb, &ctx, 0u, result);
     f_close(&fil);
     if (ctx.failed) {
+        memset(result, 0, sizeof(*result));
         return 0;
     }
     return mapper;
 }
 
+// True for the mappers loadrom_mapper_auto() can tell apart at runtime.
+static bool mapper_auto_covers(uint8_t mapper) {
+    return mapper == MAPPER_DETECT_KONAMI_SCC || mapper == MAPPER_DETECT_KONAMI ||
+           mapper == MAPPER_DETECT_ASCII8 || mapper == MAPPER_DETECT_ASCII16;
+}
+
 static bool sd_prepare_card(void) {
     if (!sd_init_driver()) return false;
     sd_card = sd_get_by_num(0);
@@ -1852,6 +2143,7 @@ static void sd_unmount_card(void) {
     }
     sd_mounted = false;
     sd_mounted_partition = 0;
+    sd_mounted_lba_base = 0;
     disk_set_partition_window(0, 0);
 }
 
@@ -1868,6 +2160,7 @@ static bool sd_mount_partition(const sunrise_sd_partition_t *parts, uint8_t coun
     }
     sd_mounted = true;
     sd_mounted_partition = parts[index].number;
+    sd_mounted_lba_base = parts[index].start_lba;
     return true;
 }
 
@@ -1929,6 +2222,7 @@ static bool sd_mount_card(void) {
     if (!sd_mount_partition(parts, count, sd_browse_partition)) return false;
     sd_browse_partition = sd_mounted_partition;
     update_browse_partition_text(parts, count, sd_browse_partition);
+    boot_mark(BOOT_STAGE_SD_MOUNT);
     return true;
 }
 
@@ -1971,8 +2265,8 @@ static void process_delete_sd_file_request(void) {
         return;
     }
 
-    uint16_t record_index = filtered_indices[index];
-    if (record_index >= full_record_count || sd_path_offsets[record_index] == 0xFFFF) {
+    uint32_t record_index = filtered_indices[index];
+    if (record_index >= full_record_count || sd_path_offsets[record_index] == SD_PATH_NONE) {
         ctrl_cmd_state = 0;
         return;
     }
@@ -1995,8 +2289,8 @@ static bool sd_is_mounted(void) {
     return sd_mounted && sd_card != NULL;
 }
 
-static uint16_t add_folder_record(uint16_t record_index, const char *name) {
-    if (record_index >= MAX_ROM_RECORDS) {
+static uint32_t add_folder_record(uint32_t record_index, const char *name) {
+    if (record_index >= record_capacity) {
         return record_index;
     }
     memset(records[record_index].Name, 0, sizeof(records[record_index].Name));
@@ -2004,8 +2298,8 @@ static uint16_t add_folder_record(uint16_t record_index, const char *name) {
     records[record_index].Mapper = (unsigned char)(FOLDER_FLAG | SOURCE_SD_FLAG);
     records[record_index].Size = 0;
     records[record_index].Offset = 0;
-    sd_path_offsets[record_index] = 0xFFFF;
-    return (uint16_t)(record_index + 1);
+    sd_path_offsets[record_index] = SD_PATH_NONE;
+    return record_index + 1u;
 }
 
 static bool wavegame_asset_exists_in_dir(const char *dir, const char *name) {
@@ -2026,8 +2320,8 @@ static bool wavegame_asset_exists_in_dir(const char *dir, const char *name) {
     return f_stat(path, &info) == FR_OK && !(info.fattrib & AM_DIR) && info.fsize > 0;
 }
 
-static bool wavegame_assets_detected_for_record(uint16_t record_index) {
-    if (record_index >= full_record_count || sd_path_offsets[record_index] == 0xFFFF) {
+static bool wavegame_assets_detected_for_record(uint32_t record_index) {
+    if (record_index >= full_record_count || sd_path_offsets[record_index] == SD_PATH_NONE) {
         return false;
     }
     ROMRecord const *rec = &records[record_index];
@@ -2066,17 +2360,17 @@ static bool wavegame_assets_detected_for_record(uint16_t record_index) {
     return false;
 }
 
-static uint16_t add_sd_rom_record(uint16_t record_index, const char *path, const char *filename, uint32_t size, uint8_t mapper) {
-    if (record_index >= MAX_ROM_RECORDS) {
+static uint32_t add_sd_rom_record(uint32_t record_index, const char *path, const char *filename, uint32_t size, uint8_t mapper) {
+    if (record_index >= record_capacity) {
         return record_index;
     }
     size_t path_len = strlen(path);
-    if (sd_path_buffer_used + path_len + 1 > SD_PATH_BUFFER_SIZE) {
+    if (sd_path_buffer_used + path_len + 1 > sd_path_buffer_size) {
         return record_index;
     }
     sd_path_offsets[record_index] = sd_path_buffer_used;
     memcpy(sd_path_buffer + sd_path_buffer_used, path, path_len + 1);
-    sd_path_buffer_used = (uint16_t)(sd_path_buffer_used + path_len + 1);
+    sd_path_buffer_used += (uint32_t)(path_len + 1);
 
     char display_name[ROM_NAME_MAX + 1];
     build_display_name(filename, display_name, sizeof(display_name));
@@ -2086,20 +2380,20 @@ static uint16_t add_sd_rom_record(uint16_t record_index, const char *path, const
     records[record_index].Mapper = (unsigned char)(mapper | SOURCE_SD_FLAG);
     records[record_index].Size = (unsigned long)size;
     records[record_index].Offset = (unsigned long)record_index;
-    return (uint16_t)(record_index + 1);
+    return record_index + 1u;
 }
 
-static uint16_t add_sd_mp3_record(uint16_t record_index, const char *path, const char *filename, uint32_t size, bool is_wav) {
-    if (record_index >= MAX_ROM_RECORDS) {
+static uint32_t add_sd_mp3_record(uint32_t record_index, const char *path, const char *filename, uint32_t size, bool is_wav) {
+    if (record_index >= record_capacity) {
         return record_index;
     }
     size_t path_len = strlen(path);
-    if (sd_path_buffer_used + path_len + 1 > SD_PATH_BUFFER_SIZE) {
+    if (sd_path_buffer_used + path_len + 1 > sd_path_buffer_size) {
         return record_index;
     }
     sd_path_offsets[record_index] = sd_path_buffer_used;
     memcpy(sd_path_buffer + sd_path_buffer_used, path, path_len + 1);
-    sd_path_buffer_used = (uint16_t)(sd_path_buffer_used + path_len + 1);
+    sd_path_buffer_used += (uint32_t)(path_len + 1);
 
     char display_name[ROM_NAME_MAX + 1];
     build_display_name(filename, display_name, sizeof(display_name));
@@ -2109,141 +2403,10 @@ static uint16_t add_sd_mp3_record(uint16_t record_index, const char *path, const
     records[record_index].Mapper = (unsigned char)(MP3_FLAG | SOURCE_SD_FLAG | (is_wav ? AUDIO_TYPE_WAV : 0u));
     records[record_index].Size = (unsigned long)size;
     records[record_index].Offset = (unsigned long)record_index;
-    return (uint16_t)(record_index + 1);
-}
-
-static void refresh_records_for_current_path(void) {
-    sd_record_count = 0;
-    sd_path_buffer_used = 0;
-    for (uint16_t i = 0; i < MAX_ROM_RECORDS; i++) {
-        sd_path_offsets[i] = 0xFFFF;
-    }
-
-    uint16_t record_index = 0;
-    bool has_parent = !is_root_path(sd_current_path);
-
-    if (has_parent) {
-        record_index = add_folder_record(record_index, "..");
-    }
-
-    uint16_t folder_count = record_index;
-    if (sd_mount_card()) {
-        DIR dir;
-        FILINFO fno;
-        FRESULT fr = f_opendir(&dir, sd_current_path);
-        if (fr == FR_OK) {
-            while (record_index < MAX_ROM_RECORDS) {
-                fr = f_readdir(&dir, &fno);
-                if (fr != FR_OK || fno.fname[0] == '\0') {
-                    break;
-                }
-                if (!(fno.fattrib & AM_DIR)) {
-                    continue;
-                }
-                if (is_excluded_folder(fno.fname)) {
-                    continue;
-                }
-                record_index = add_folder_record(record_index, fno.fname);
-            }
-        }
-        f_closedir(&dir);
-
-        folder_count = record_index;
-        uint16_t folder_sort_start = has_parent ? 1u : 0u;
-        if (folder_count > folder_sort_start) {
-            sort_records_range(folder_sort_start, (uint16_t)(folder_count - folder_sort_start));
-        }
-
-        fr = f_opendir(&dir, sd_current_path);
-        if (fr == FR_OK) {
-            while (record_index < MAX_ROM_RECORDS) {
-                fr = f_readdir(&dir, &fno);
-                if (fr != FR_OK || fno.fname[0] == '\0') {
-                    break;
-                }
-                if (fno.fattrib & AM_DIR) {
-                    continue;
-                }
-                bool is_mp3 = has_mp3_extension(fno.fname);
-                bool is_wav = has_wav_extension(fno.fname);
-                bool is_rom = has_rom_extension(fno.fname);
-#if EXPLORER_MP3_DISABLED
-                // MP3 player temporarily disabled — skip MP3 entries.
-                if (is_mp3 || is_wav) continue;
-#endif
-
-                if (!is_mp3 && !is_wav && !is_rom) {
-                    continue;
-                }
-
-                char path[SD_PATH_MAX];
-                int written;
-                if (is_root_path(sd_current_path)) {
-                    written = snprintf(path, sizeof(path), "/%s", fno.fname);
-                } else {
-                    written = snprintf(path, sizeof(path), "%s/%s", sd_current_path, fno.fname);
-                }
-                if (written <= 0 || (size_t)written >= sizeof(path)) {
-                    continue;
-                }
-
-                if (is_mp3 || is_wav) {
-                    if (fno.fsize == 0) {
-                        continue;
-                    }
-                    record_index = add_sd_mp3_record(record_index, path, fno.fname, (uint32_t)fno.fsize, is_wav);
-                    sd_record_count++;
-                    continue;
-                }
-
-                if (fno.fsize < MIN_ROM_SIZE || fno.fsize > MAX_ROM_SIZE) {
-                    continue;
-                }
-                if (fno.fsize > SD_ROM_MAX_SIZE) {
-                    continue;
-                }
-
-                uint8_t mapper = mapper_number_from_filename(fno.fname);
-                record_index = add_sd_rom_record(record_index, path, fno.fname, (uint32_t)fno.fsize, mapper);
-                sd_record_count++;
-            }
-        }
-        f_closedir(&dir);
-    }
-
-    if (is_root_path(sd_current_path) && flash_record_count > 0) {
-        for (uint16_t i = 0; i < flash_record_count && record_index < MAX_ROM_RECORDS; i++) {
-            records[record_index] = flash_records[i];
-            sd_path_offsets[record_index] = 0xFFFF;
-            record_index++;
-        }
-    }
-
-    uint16_t rom_count = (uint16_t)(record_index - folder_count);
-    if (rom_count > 1) {
-        uint16_t system_insert = folder_count;
-        for (uint16_t i = folder_count; i < record_index; i++) {
-            if (is_system_record(&records[i])) {
-                swap_records(i, system_insert);
-                system_insert++;
-            }
-        }
-
-        uint16_t system_count = (uint16_t)(system_insert - folder_count);
-        uint16_t non_system_count = (uint16_t)(record_index - system_insert);
-        if (non_system_count > 1) {
-            sort_records_range(system_insert, non_system_count);
-        }
-    }
-
-    full_record_count = record_index;
-    memset(filter_query, 0, sizeof(filter_query));
-    apply_filter();
-    current_page = 0;
-    build_page_buffer(current_page);
+    return record_index + 1u;
 }
 
-// Chunked version of refresh_records_for_current_path.
+// Chunked directory refresh.
 // Processes up to REFRESH_CHUNK_SIZE SD reads per call, then returns false
 // to yield back to the MP3 decode loop. Returns true when done (or idle).
 static bool refresh_records_chunked(void) {
@@ -2257,9 +2420,6 @@ static bool refresh_records_chunked(void) {
     case REFRESH_INIT:
         sd_record_count = 0;
         sd_path_buffer_used = 0;
-        for (uint16_t i = 0; i < MAX_ROM_RECORDS; i++) {
-            sd_path_offsets[i] = 0xFFFF;
-        }
         refresh_record_index = 0;
         refresh_has_parent = !is_root_path(sd_current_path);
         if (refresh_has_parent) {
@@ -2291,7 +2451,7 @@ static bool refresh_records_chunked(void) {
 
     case REFRESH_SCAN_FOLDERS: {
         int reads = 0;
-        while (reads < REFRESH_CHUNK_SIZE && refresh_record_index < MAX_ROM_RECORDS) {
+        while (reads < REFRESH_CHUNK_SIZE && refresh_record_index < record_capacity) {
             fr = f_readdir(&refresh_dir, &fno);
             reads++;
             if (fr != FR_OK || fno.fname[0] == '\0') {
@@ -2303,7 +2463,7 @@ static bool refresh_records_chunked(void) {
             if (is_excluded_folder(fno.fname)) continue;
             refresh_record_index = add_folder_record(refresh_record_index, fno.fname);
         }
-        if (refresh_record_index >= MAX_ROM_RECORDS) {
+        if (refresh_record_index >= record_capacity) {
             f_closedir(&refresh_dir);
             refresh_state = REFRESH_SORT_FOLDERS;
         }
@@ -2312,9 +2472,9 @@ static bool refresh_records_chunked(void) {
 
     case REFRESH_SORT_FOLDERS: {
         refresh_folder_count = refresh_record_index;
-        uint16_t folder_sort_start = refresh_has_parent ? 1u : 0u;
+        uint32_t folder_sort_start = refresh_has_parent ? 1u : 0u;
         if (refresh_folder_count > folder_sort_start) {
-            sort_records_range(folder_sort_start, (uint16_t)(refresh_folder_count - folder_sort_start));
+            sort_records_range(folder_sort_start, refresh_folder_count - folder_sort_start);
         }
         fr = f_opendir(&refresh_dir, sd_current_path);
         if (fr != FR_OK) {
@@ -2327,7 +2487,7 @@ static bool refresh_records_chunked(void) {
 
     case REFRESH_SCAN_FILES: {
         int reads = 0;
-        while (reads < REFRESH_CHUNK_SIZE && refresh_record_index < MAX_ROM_RECORDS) {
+        while (reads < REFRESH_CHUNK_SIZE && refresh_record_index < record_capacity) {
             fr = f_readdir(&refresh_dir, &fno);
             reads++;
             if (fr != FR_OK || fno.fname[0] == '\0') {
@@ -2370,7 +2530,7 @@ static bool refresh_records_chunked(void) {
             refresh_record_index = add_sd_rom_record(refresh_record_index, path, fno.fname, (uint32_t)fno.fsize, mapper);
             sd_record_count++;
         }
-        if (refresh_record_index >= MAX_ROM_RECORDS) {
+        if (refresh_record_index >= record_capacity) {
             f_closedir(&refresh_dir);
             refresh_state = REFRESH_FINALIZE;
         }
@@ -2379,30 +2539,31 @@ static bool refresh_records_chunked(void) {
 
     case REFRESH_FINALIZE: {
         if (is_root_path(sd_current_path) && flash_record_count > 0) {
-            for (uint16_t i = 0; i < flash_record_count && refresh_record_index < MAX_ROM_RECORDS; i++) {
+            for (uint16_t i = 0; i < flash_record_count && refresh_record_index < record_capacity; i++) {
                 records[refresh_record_index] = flash_records[i];
-                sd_path_offsets[refresh_record_index] = 0xFFFF;
+                sd_path_offsets[refresh_record_index] = SD_PATH_NONE;
                 refresh_record_index++;
             }
         }
 
-        uint16_t rom_count = (uint16_t)(refresh_record_index - refresh_folder_count);
+        uint32_t rom_count = refresh_record_index - refresh_folder_count;
         if (rom_count > 1) {
-            uint16_t system_insert = refresh_folder_count;
-            for (uint16_t i = refresh_folder_count; i < refresh_record_index; i++) {
+            uint32_t system_insert = refresh_folder_count;
+            for (uint32_t i = refresh_folder_count; i < refresh_record_index; i++) {
                 if (is_system_record(&records[i])) {
                     swap_records(i, system_insert);
                     system_insert++;
                 }
             }
-            uint16_t system_count = (uint16_t)(system_insert - refresh_folder_count);
-            uint16_t non_system_count = (uint16_t)(refresh_record_index - system_insert);
+            uint32_t system_count = system_insert - refresh_folder_count;
+            uint32_t non_system_count = refresh_record_index - system_insert;
             if (non_system_count > 1) {
                 sort_records_range(system_insert, non_system_count);
             }
         }
 
         full_record_count = refresh_record_index;
+        search_index_valid = false;
         memset(filter_query, 0, sizeof(filter_query));
         apply_filter();
         current_page = 0;
@@ -2431,7 +2592,7 @@ static void process_detect_mapper_request(uint16_t filtered_index) {
         return;
     }
 
-    uint16_t record_index = filtered_indices[filtered_index];
+    uint32_t record_index = filtered_indices[filtered_index];
     if (record_index >= full_record_count) {
         ctrl_cmd_state = 0;
         return;
@@ -2440,7 +2601,7 @@ static void process_detect_mapper_request(uint16_t filtered_index) {
     ROMRecord *rec = &records[record_index];
     uint8_t flags = rec->Mapper & (SOURCE_SD_FLAG | FOLDER_FLAG | MP3_FLAG);
 
-    if (!(flags & SOURCE_SD_FLAG) || (flags & (FOLDER_FLAG | MP3_FLAG)) || sd_path_offsets[record_index] == 0xFFFF) {
+    if (!(flags & SOURCE_SD_FLAG) || (flags & (FOLDER_FLAG | MP3_FLAG)) || sd_path_offsets[record_index] == SD_PATH_NONE) {
         ctrl_mapper_value = mapper_code_from_record_byte(rec->Mapper);
         ctrl_cmd_state = 0;
         return;
@@ -2451,7 +2612,22 @@ static void process_detect_mapper_request(uint16_t filtered_index) {
 
     uint8_t mapper = mapper_number_from_filename(filename);
     if (mapper == 0) {
-        mapper = detect_rom_type_from_file(path, (uint32_t)rec->Size);
+        mapper_detect_result_t detect;
+        mapper = detect_rom_type_from_file(path, (uint32_t)rec->Size, &detect);
+        printf("MAPPER: %s -> %u (source %u, confidence %u)\n", filename, mapper,
+               detect.source, detect.count ? detect.cand[0].confidence : 0u);
+        // An unrecognised megaROM-sized image, or a heuristic guess whose
+        // Konami/ASCII runner-up is nearly as likely, is resolved from its
+        // own bank writes instead. A guess that clearly leads, even a low
+        // one, is kept: it launched correctly before MAPPER_AUTO existed.
+        bool weak = (mapper == 0) ||
+                    (detect.source != MAPPER_DETECT_SRC_ROMDB && detect.count >= 2u &&
+                     mapper_auto_covers(detect.cand[0].mapper) && mapper_auto_covers(detect.cand[1].mapper) &&
+                     (uint8_t)(detect.cand[0].confidence - detect.cand[1].confidence) < MAPPER_AUTO_CLOSE);
+        if (weak && rec->Size >= MAPPER_AUTO_MIN_SIZE && rec->Size <= SD_ROM_MAX_SIZE &&
+            (rec->Size & 0x1FFFu) == 0u) {
+            mapper = MAPPER_AUTO;
+        }
     }
 
     ctrl_mapper_value = mapper;
@@ -2478,8 +2654,8 @@ static uint16_t find_mp3_filtered_index(uint16_t current, uint8_t mode, int dire
 
     if (mode == MP3_PLAY_MODE_RANDOM) {
         uint16_t mp3_count = 0;
-        for (uint16_t i = 0; i < total_record_count; i++) {
-            uint16_t ri = filtered_indices[i];
+        for (uint32_t i = 0; i < total_record_count; i++) {
+            uint32_t ri = filtered_indices[i];
             if (ri < full_record_count && (records[ri].Mapper & MP3_FLAG))
                 mp3_count++;
         }
@@ -2488,10 +2664,10 @@ static uint16_t find_mp3_filtered_index(uint16_t current, uint8_t mode, int dire
         // Use microsecond timer as entropy for random pick
         uint16_t target = (uint16_t)(time_us_32() % mp3_count);
         uint16_t ord = 0;
-        for (uint16_t i = 0; i < total_record_count; i++) {
-            uint16_t ri = filtered_indices[i];
+        for (uint32_t i = 0; i < total_record_count; i++) {
+            uint32_t ri = filtered_indices[i];
             if (ri < full_record_count && (records[ri].Mapper & MP3_FLAG)) {
-                if (ord == target) return i;
+                if (ord == target) return (uint16_t)i;
                 ord++;
             }
         }
@@ -2500,9 +2676,9 @@ static uint16_t find_mp3_filtered_index(uint16_t current, uint8_t mode, int dire
 
     if (direction < 0) {
         uint16_t start = (current != 0xFFFF && current > 0) ? (uint16_t)(current - 1u) : (uint16_t)(total_record_count - 1u);
-        for (uint16_t count = 0; count < total_record_count; count++) {
+        for (uint32_t count = 0; count < total_record_count; count++) {
             uint16_t i = (uint16_t)((start + total_record_count - count) % total_record_count);
-            uint16_t ri = filtered_indices[i];
+            uint32_t ri = filtered_indices[i];
             if (ri < full_record_count && (records[ri].Mapper & MP3_FLAG)) {
                 return i;
             }
@@ -2511,9 +2687,9 @@ static uint16_t find_mp3_filtered_index(uint16_t current, uint8_t mode, int dire
     }
 
     uint16_t start = (current != 0xFFFF && current + 1 < total_record_count) ? (uint16_t)(current + 1u) : 0;
-    for (uint16_t count = 0; count < total_record_count; count++) {
+    for (uint32_t count = 0; count < total_record_count; count++) {
         uint16_t i = (start + count) % total_record_count;
-        uint16_t ri = filtered_indices[i];
+        uint32_t ri = filtered_indices[i];
         if (ri < full_record_count && (records[ri].Mapper & MP3_FLAG)) {
             return i;
         }
@@ -2525,8 +2701,8 @@ static bool mp3_play_filtered_index(uint16_t filtered_index) {
     if (filtered_index >= total_record_count) {
         return false;
     }
-    uint16_t record_index = filtered_indices[filtered_index];
-    if (record_index >= full_record_count || !(records[record_index].Mapper & MP3_FLAG) || sd_path_offsets[record_index] == 0xFFFF) {
+    uint32_t record_index = filtered_indices[filtered_index];
+    if (record_index >= full_record_count || !(records[record_index].Mapper & MP3_FLAG) || sd_path_offsets[record_index] == SD_PATH_NONE) {
         return false;
     }
     const char *path = sd_path_buffer + sd_path_offsets[record_index];
@@ -2596,10 +2772,10 @@ static void wavegame_clear(void)
     mp3_wavegame_set_psg_callbacks(NULL, NULL);
 }
 
-static void wavegame_prepare_for_rom(uint16_t record_index, bool enabled)
+static void wavegame_prepare_for_rom(uint32_t record_index, bool enabled)
 {
     wavegame_clear();
-    if (!enabled || record_index >= MAX_ROM_RECORDS || sd_path_offsets[record_index] == 0xFFFF)
+    if (!enabled || record_index >= full_record_count || sd_path_offsets[record_index] == SD_PATH_NONE)
         return;
 
     const char *rom_path = sd_path_buffer + sd_path_offsets[record_index];
@@ -2786,12 +2962,15 @@ static void quiesce_mp3_core1_before_sd_work(void) {
 // avoids FatFS reentrancy issues and removes the freeze observed when
 // folder navigation raced with MP3 work on Core 1.
 static void fh_save_background_work(void);
+static void rom_verify_idle_step(void);
 static void core1_bg_work(void) {
     if (fh_save_state == FH_SAVE_RUNNING) {
         fh_save_background_work();
         return;
     }
 
+    rom_verify_idle_step();
+
     // Bridge MP3 commands queued by handle_menu_write_explorer() to the
     // mp3.c command queue. Lazy-launch Core 1 the first time an MP3
     // command actually arrives.
@@ -2799,10 +2978,10 @@ static void core1_bg_work(void) {
         uint16_t pending_index = mp3_pending_index;
         mp3_pending_select = false;
         if (pending_index < total_record_count) {
-            uint16_t record_index = filtered_indices[pending_index];
+            uint32_t record_index = filtered_indices[pending_index];
             if (record_index < full_record_count) {
                 ROMRecord const *rec = &records[record_index];
-                if ((rec->Mapper & MP3_FLAG) && (sd_path_offsets[record_index] != 0xFFFF)) {
+                if ((rec->Mapper & MP3_FLAG) && (sd_path_offsets[record_index] != SD_PATH_NONE)) {
                     const char *path = sd_path_buffer + sd_path_offsets[record_index];
                     printf("MP3: select path=%s size=%lu\n", path, (unsigned long)rec->Size);
                     ensure_mp3_core1_started();
@@ -2840,7 +3019,7 @@ static void core1_bg_work(void) {
         if ((st & MP3_STATUS_EOF) && !(st & MP3_STATUS_PLAYING)) {
             uint16_t next = find_mp3_filtered_index(mp3_playing_filtered_index, mp3_play_mode, 1);
             if (next != 0xFFFF) {
-                uint16_t ri = filtered_indices[next];
+                uint32_t ri = filtered_indices[next];
                 const char *path = sd_path_buffer + sd_path_offsets[ri];
                 printf("MP3: auto-advance to index %u path=%s\n", (unsigned)next, path);
                 mp3_auto_play(path, (uint32_t)records[ri].Size);
@@ -2862,6 +3041,10 @@ static void core1_bg_work(void) {
         if (done) {
             refresh_in_progress = false;
             ctrl_cmd_state = 0;
+            if (!boot_timeline_reported) {
+                boot_mark(BOOT_STAGE_DIR_SCAN);
+                boot_timeline_report();
+            }
         }
         return;
     }
@@ -2880,154 +3063,790 @@ static void core1_bg_work(void) {
     }
 }
 
-static bool load_rom_from_sd(uint16_t record_index, uint32_t size) {
-    if (!sd_mount_card()) {
-        printf("SDLOAD: mount failed\n");
-        return false;
-    }
-    if (record_index >= full_record_count || record_index >= MAX_ROM_RECORDS) {
-        printf("SDLOAD: bad record=%u full=%u\n", (unsigned)record_index, (unsigned)full_record_count);
-        return false;
-    }
-    if (sd_path_offsets[record_index] == 0xFFFF) {
-        printf("SDLOAD: missing path record=%u\n", (unsigned)record_index);
-        return false;
-    }
-
-    // SD ROMs are streamed into the 4MB PSRAM region so rom_sram remains
-    // available for flash-resident mapper caching. Bring PSRAM up lazily.
-    if (!psram_bring_up_once()) {
-        printf("SDLOAD: psram bring-up failed\n");
-        return false;
-    }
-    if (size > sd_rom_region.size) {
-        printf("SDLOAD: too large size=%lu region=%lu\n", (unsigned long)size, (unsigned long)sd_rom_region.size);
-        return false;
-    }
-
-    const char *path = sd_path_buffer + sd_path_offsets[record_index];
-    printf("SDLOAD: record=%u size=%lu path=%s\n", (unsigned)record_index, (unsigned long)size, path);
-
-    FIL fil;
-    FRESULT fr = f_open(&fil, path, FA_READ);
-    if (fr != FR_OK) {
-        printf("SDLOAD: open failed fr=%d\n", (int)fr);
-        return false;
-    }
-
-    gpio_init(PIN_WAIT);
-    gpio_set_dir(PIN_WAIT, GPIO_OUT);
-    gpio_put(PIN_WAIT, 0);
+// -----------------------------------------------------------------------
+// Recent SD ROM images - a small table at the top of PSRAM remembers which
+// images are still resident in sd_rom_region. PSRAM stays powered across a
+// warm restart of the Pico, so relaunching a title that is still resident
+// skips the SD read. Every hit is re-verified against the stored CRC32, so
+// contents lost across a reset simply fall back to a normal SD load.
+// -----------------------------------------------------------------------
+#define RECENT_ROM_MAGIC        0x31564352u // "RCV1"
+#define RECENT_ROM_SLOTS        8u
+#define RECENT_ROM_ALIGN        4096u
+#define RECENT_ROM_TABLE_SIZE   4096u       // reserved, never handed out by psram_alloc()
+#define RECENT_ROM_TABLE_OFFSET (PSRAM_TOTAL_SIZE - RECENT_ROM_TABLE_SIZE)
 
-    uint8_t *dst = sd_rom_region.ptr;
-    memset(dst, 0, size);
+typedef struct {
+    uint32_t key;       // FNV-1a of the SD path (0 = free slot)
+    uint32_t size;      // image size in bytes
+    uint32_t stamp;     // FatFS fdate << 16 | ftime of the source file
+    uint32_t offset;    // image offset within sd_rom_region
+    uint32_t crc;       // CRC32 (DMA sniffer) of the resident image
+    uint32_t seq;       // last-use sequence for LRU eviction
+} recent_rom_entry_t;
 
-    UINT total = 0;
-    while (total < size) {
-        UINT to_read = (UINT)((size - total) > 4096 ? 4096 : (size - total));
-        UINT br = 0;
-        fr = f_read(&fil, dst + total, to_read, &br);
-        if (fr != FR_OK || br == 0) {
-            printf("SDLOAD: read stopped fr=%d br=%u total=%u target=%lu\n", (int)fr, (unsigned)br, (unsigned)total, (unsigned long)size);
-            break;
-        }
-        total += br;
-    }
+typedef struct {
+    uint32_t magic;
+    uint32_t next_offset;   // ring placement cursor within sd_rom_region
+    uint32_t seq;
+    recent_rom_entry_t slot[RECENT_ROM_SLOTS];
+    uint32_t check;         // FNV-1a of everything above
+} recent_rom_table_t;
 
-    f_close(&fil);
-    gpio_set_dir(PIN_WAIT, GPIO_IN);
+static recent_rom_table_t recent_roms;
+static bool recent_roms_attached = false;
+static uint32_t rom_verify_drop_key = 0;   // image that failed its SHA-1 check, 0 = none
 
-    if (total != size) {
-        printf("SDLOAD: short read total=%u target=%lu\n", (unsigned)total, (unsigned long)size);
-        return false;
+static uint32_t __not_in_flash_func(recent_rom_fnv)(const void *data, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t h = 0x811C9DC5u;
+    for (uint32_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 0x01000193u;
     }
-    printf("SDLOAD: loaded %u bytes\n", (unsigned)total);
-    return true;
+    return h;
 }
 
-// Initialize GPIO pins
-static inline void setup_gpio()
+// CRC32 of a PSRAM range using the DMA sniffer, read through the uncached
+// alias so the check sees what is really stored in the chip.
+static uint32_t psram_crc32(uint32_t offset, uint32_t size)
 {
+    static uint32_t sink;
+    const uint8_t *src = (const uint8_t *)(PSRAM_NOCACHE_ADDR + offset);
+    int chan = dma_claim_unused_channel(true);
 
-    for (int i = 0; i <= 23; i++) {
-        gpio_init(i);
-        gpio_set_input_hysteresis_enabled(i, true);
-    }
+    dma_sniffer_set_data_accumulator(0xFFFFFFFFu);
+    dma_sniffer_enable((uint)chan, DMA_SNIFF_CTRL_CALC_VALUE_CRC32, true);
 
-    for (int i = 0; i <= 15; i++) {
-        gpio_set_dir(i, GPIO_IN);
+    uint32_t words = size >> 2;
+    uint32_t tail = size & 3u;
+    dma_channel_config cfg = dma_channel_get_default_config(chan);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_sniff_enable(&cfg, true);
+    if (words) {
+        channel_config_set_transfer_data_size(&cfg, DMA_SIZE_32);
+        dma_channel_configure(chan, &cfg, &sink, src, words, true);
+        dma_channel_wait_for_finish_blocking(chan);
+    }
+    if (tail) {
+        channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+        dma_channel_configure(chan, &cfg, &sink, src + (words << 2), tail, true);
+        dma_channel_wait_for_finish_blocking(chan);
     }
 
-    // Initialize control pins as input
-    gpio_init(PIN_RD); gpio_set_dir(PIN_RD, GPIO_IN);    
-    gpio_init(PIN_WR); gpio_set_dir(PIN_WR, GPIO_IN); 
-    gpio_init(PIN_IORQ); gpio_set_dir(PIN_IORQ, GPIO_IN); 
-    gpio_init(PIN_SLTSL); gpio_set_dir(PIN_SLTSL, GPIO_IN); 
-    gpio_init(PIN_BUSSDIR); gpio_set_dir(PIN_BUSSDIR, GPIO_IN); 
+    uint32_t crc = dma_sniffer_get_data_accumulator();
+    dma_sniffer_disable();
+    dma_channel_unclaim(chan);
+    return crc;
+}
 
-    gpio_init(I2S_MUTE_PIN);
-    gpio_set_dir(I2S_MUTE_PIN, GPIO_OUT);
-    gpio_put(I2S_MUTE_PIN, 1);
+static void recent_rom_table_save(void)
+{
+    recent_roms.check = recent_rom_fnv(&recent_roms, offsetof(recent_rom_table_t, check));
+    memcpy((void *)(PSRAM_NOCACHE_ADDR + RECENT_ROM_TABLE_OFFSET), &recent_roms, sizeof(recent_roms));
 }
 
-// read_ulong - Read a 4-byte value from the memory area
-// This function will read a 4-byte value from the memory area pointed by ptr and return the value as an unsigned long
-// Parameters:
-//   ptr - Pointer to the memory area to read the value from
-// Returns:
-//   The 4-byte value as an unsigned long 
-unsigned long __no_inline_not_in_flash_func(read_ulong)(const unsigned char *ptr) {
-    return (unsigned long)ptr[0] |
-           ((unsigned long)ptr[1] << 8) |
-           ((unsigned long)ptr[2] << 16) |
-           ((unsigned long)ptr[3] << 24);
+static void recent_rom_forget_all(void)
+{
+    memset(&recent_roms, 0, sizeof(recent_roms));
+    recent_roms.magic = RECENT_ROM_MAGIC;
+    recent_rom_table_save();
 }
 
-// isEndOfData - Check if the memory area is the end of the data
-// This function will check if the memory area pointed by memory is the end of the data. The end of the data is defined by all bytes being 0xFF.
-// Parameters:
-//   memory - Pointer to the memory area to check
-// Returns:
-//   1 if the memory area is the end of the data, 0 otherwise
-int __no_inline_not_in_flash_func(isEndOfData)(const unsigned char *memory) {
-    for (int i = 0; i < ROM_RECORD_SIZE; i++) {
-        if (memory[i] != 0xFF) {
-            return 0;
-        }
+// An image that failed its SHA-1 check is never served from PSRAM again.
+static void recent_rom_drop_failed(void)
+{
+    if (rom_verify_drop_key == 0u) return;
+    for (uint32_t i = 0; i < RECENT_ROM_SLOTS; i++) {
+        if (recent_roms.slot[i].key == rom_verify_drop_key)
+            recent_roms.slot[i].key = 0;
     }
-    return 1;
+    rom_verify_drop_key = 0;
+    recent_rom_table_save();
 }
 
-// -----------------------------------------------------------------------
-// External PSRAM (QMI CS1) - hardware init + bump allocator.
-// Mirrors the implementation in multirom so the same code paths work
-// across the two firmwares. Used for SD-cached ROM storage so that
-// rom_sram remains fully available for flash-resident mapper caching.
-// -----------------------------------------------------------------------
-static inline void __not_in_flash_func(psram_delay_cycles)(uint32_t cycles)
+// Pick up the table left in PSRAM by a previous boot, once per boot. Call
+// only after psram_bring_up_once() succeeded.
+static void recent_rom_table_attach(void)
 {
-    for (volatile uint32_t cycle = 0; cycle < cycles; ++cycle)
+    if (recent_roms_attached) return;
+    recent_roms_attached = true;
+
+    memcpy(&recent_roms, (const void *)(PSRAM_NOCACHE_ADDR + RECENT_ROM_TABLE_OFFSET), sizeof(recent_roms));
+    if (recent_roms.magic != RECENT_ROM_MAGIC ||
+        recent_roms.check != recent_rom_fnv(&recent_roms, offsetof(recent_rom_table_t, check)) ||
+        recent_roms.next_offset > sd_rom_region.size)
     {
-        __asm volatile ("nop");
+        printf("SDLOAD: recent table cold\n");
+        recent_rom_forget_all();
+        return;
     }
+    printf("SDLOAD: recent table warm\n");
+    recent_rom_drop_failed();
 }
 
-static inline void __not_in_flash_func(psram_wait_direct_done)(void)
+static int recent_rom_find(uint32_t key, uint32_t size, uint32_t stamp)
 {
-    while ((qmi_hw->direct_csr & QMI_DIRECT_CSR_TXEMPTY_BITS) == 0) { }
-    while ((qmi_hw->direct_csr & QMI_DIRECT_CSR_BUSY_BITS) != 0) { }
+    for (uint32_t i = 0; i < RECENT_ROM_SLOTS; i++) {
+        const recent_rom_entry_t *e = &recent_roms.slot[i];
+        if (e->key == key && e->size == size && e->stamp == stamp &&
+            e->offset + e->size <= sd_rom_region.size)
+            return (int)i;
+    }
+    return -1;
 }
 
-static inline void __not_in_flash_func(psram_send_direct_cmd)(uint8_t cmd, bool quad_width)
+// Reserve room for a new image in the sd_rom_region ring, evicting every
+// resident image it overlaps. Returns the offset and the slot to fill.
+static uint32_t recent_rom_place(uint32_t size, uint32_t *slot_out)
 {
-    qmi_hw->direct_csr |= QMI_DIRECT_CSR_ASSERT_CS1N_BITS;
-    if (quad_width)
-    {
-        qmi_hw->direct_tx = QMI_DIRECT_TX_OE_BITS |
-                            (QMI_DIRECT_TX_IWIDTH_VALUE_Q << QMI_DIRECT_TX_IWIDTH_LSB) |
-                            cmd;
+    uint32_t offset = recent_roms.next_offset;
+    if (offset + size > sd_rom_region.size) offset = 0;
+
+    uint32_t free_slot = RECENT_ROM_SLOTS;
+    uint32_t oldest = 0;
+    for (uint32_t i = 0; i < RECENT_ROM_SLOTS; i++) {
+        recent_rom_entry_t *e = &recent_roms.slot[i];
+        if (e->key != 0 && e->offset < offset + size && offset < e->offset + e->size)
+            e->key = 0;
+        if (e->key == 0) {
+            if (free_slot == RECENT_ROM_SLOTS) free_slot = i;
+        } else if (e->seq < recent_roms.slot[oldest].seq || recent_roms.slot[oldest].key == 0) {
+            oldest = i;
+        }
     }
-    else
+    *slot_out = (free_slot != RECENT_ROM_SLOTS) ? free_slot : oldest;
+
+    uint32_t next = (offset + size + RECENT_ROM_ALIGN - 1u) & ~(RECENT_ROM_ALIGN - 1u);
+    recent_roms.next_offset = (next >= sd_rom_region.size) ? 0 : next;
+    return offset;
+}
+
+// -----------------------------------------------------------------------
+// Loaded-image verification. Images staged into PSRAM (SD launches and
+// File Hunter downloads) are SHA-1 hashed in the background and checked
+// against a "<file>.sha1" sidecar or, failing that, romdb.h. Hashing reads
+// the uncached PSRAM alias so it never evicts the running game's XIP cache
+// lines. Launches whose audio profile leaves core1 free hash there while
+// the game runs; menu-side jobs are stepped from the idle pump instead.
+//
+// The verdict is kept in the PSRAM table page, so it survives the launch
+// reset and the next menu boot reports it. Core1 only writes that record:
+// the romdb lookup and dropping a mismatching resident image are done by
+// core0 when it picks the record up.
+// -----------------------------------------------------------------------
+#define VERIFY_STEP_BYTES     4096u
+#define VERIFY_RECORD_MAGIC   0x31465256u // "VRF1"
+#define VERIFY_RECORD_OFFSET  (RECENT_ROM_TABLE_OFFSET + 1024u)
+
+typedef struct {
+    const uint8_t *data;
+    uint32_t size;
+    uint32_t done;
+    sha1_ctx ctx;
+    uint8_t sidecar[20];
+    bool have_sidecar;
+    uint32_t recent_key;    // recent-ROM key to drop on mismatch, 0 = none
+} rom_verify_job_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t recent_key;    // recent-ROM key to drop on mismatch, 0 = none
+    uint32_t size;
+    uint8_t status;         // VERIFY_*
+    uint8_t romdb_pending;  // no sidecar: core0 still has to look up romdb.h
+    uint8_t reserved[2];
+    uint8_t digest[20];
+    uint32_t check;         // FNV-1a of everything above
+} rom_verify_record_t;
+
+static rom_verify_job_t rom_verify_job;
+static volatile uint8_t rom_verify_status = VERIFY_IDLE;
+static volatile uint8_t rom_verify_progress = 0;
+static volatile bool rom_verify_on_core1 = false;
+static uint8_t rom_verify_digest[20];
+
+static int verify_hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Reads "<path>.sha1" in sha1sum format (40 hex digits, optional filename).
+static bool rom_verify_read_sidecar(const char *path, uint8_t digest[20])
+{
+    char sidecar_path[SD_PATH_MAX];
+    char text[41];
+    FIL fil;
+    UINT br = 0;
+
+    if (snprintf(sidecar_path, sizeof(sidecar_path), "%s.sha1", path) >= (int)sizeof(sidecar_path))
+        return false;
+    if (f_open(&fil, sidecar_path, FA_READ) != FR_OK)
+        return false;
+    FRESULT fr = f_read(&fil, text, 40, &br);
+    f_close(&fil);
+    if (fr != FR_OK || br != 40)
+        return false;
+
+    for (int i = 0; i < 20; i++) {
+        int hi = verify_hex_nibble(text[i * 2]);
+        int lo = verify_hex_nibble(text[i * 2 + 1]);
+        if (hi < 0 || lo < 0) return false;
+        digest[i] = (uint8_t)((hi << 4) | lo);
+    }
+    return true;
+}
+
+static void rom_verify_begin(uint32_t psram_offset, uint32_t size, const uint8_t *sidecar, int recent_slot)
+{
+    // A new job supersedes the record of the previous one.
+    ((volatile rom_verify_record_t *)(PSRAM_NOCACHE_ADDR + VERIFY_RECORD_OFFSET))->magic = 0;
+
+    rom_verify_job.data = (const uint8_t *)(PSRAM_NOCACHE_ADDR + psram_offset);
+    rom_verify_job.size = size;
+    rom_verify_job.done = 0;
+    rom_verify_job.have_sidecar = (sidecar != NULL);
+    if (sidecar) memcpy(rom_verify_job.sidecar, sidecar, 20);
+    rom_verify_job.recent_key = (recent_slot >= 0) ? recent_roms.slot[recent_slot].key : 0u;
+    sha1_init(&rom_verify_job.ctx);
+    memset(rom_verify_digest, 0, sizeof(rom_verify_digest));
+    rom_verify_progress = 0;
+    rom_verify_on_core1 = false;
+    rom_verify_status = (size != 0u) ? VERIFY_RUNNING : VERIFY_IDLE;
+}
+
+// Hashes up to budget bytes. Returns true while more work remains.
+static bool __no_inline_not_in_flash_func(rom_verify_step)(uint32_t budget)
+{
+    if (rom_verify_status != VERIFY_RUNNING) return false;
+
+    rom_verify_job_t *job = &rom_verify_job;
+    uint32_t n = job->size - job->done;
+    if (n > budget) n = budget;
+    sha1_update(&job->ctx, job->data + job->done, n);
+    job->done += n;
+    rom_verify_progress = (uint8_t)(((uint64_t)job->done * 100u) / job->size);
+    if (job->done < job->size) return true;
+
+    rom_verify_record_t rec;
+    sha1_final(&job->ctx, rec.digest);
+    rec.magic = VERIFY_RECORD_MAGIC;
+    rec.recent_key = job->recent_key;
+    rec.size = job->size;
+    rec.status = VERIFY_UNKNOWN;
+    rec.romdb_pending = !job->have_sidecar;
+    rec.reserved[0] = rec.reserved[1] = 0;
+    if (job->have_sidecar) {
+        uint8_t diff = 0;
+        for (int i = 0; i < 20; i++) diff |= (uint8_t)(rec.digest[i] ^ job->sidecar[i]);
+        rec.status = (diff == 0) ? VERIFY_OK_SIDECAR : VERIFY_MISMATCH;
+    }
+    rec.check = recent_rom_fnv(&rec, offsetof(rom_verify_record_t, check));
+
+    volatile uint32_t *dst = (volatile uint32_t *)(PSRAM_NOCACHE_ADDR + VERIFY_RECORD_OFFSET);
+    const uint32_t *src = (const uint32_t *)&rec;
+    for (uint32_t i = 0; i < sizeof(rec) / 4u; i++) dst[i] = src[i];
+    rom_verify_status = rec.status;
+    return false;
+}
+
+// Core0: pick up a finished record (from this boot or the one before the
+// launch reset), finish the romdb lookup and publish the verdict to the
+// menu. A mismatching image is dropped from the resident set the next time
+// the recent table is attached.
+static void rom_verify_record_attach(void)
+{
+    rom_verify_record_t rec;
+    memcpy(&rec, (const void *)(PSRAM_NOCACHE_ADDR + VERIFY_RECORD_OFFSET), sizeof(rec));
+    if (rec.magic != VERIFY_RECORD_MAGIC ||
+        rec.check != recent_rom_fnv(&rec, offsetof(rom_verify_record_t, check)))
+        return;
+
+    if (rec.romdb_pending)
+        rec.status = romdb_lookup(rec.digest) != 0 ? VERIFY_OK_ROMDB : VERIFY_UNKNOWN;
+    if (rec.status == VERIFY_MISMATCH && rec.recent_key != 0u) {
+        rom_verify_drop_key = rec.recent_key;
+        if (recent_roms_attached) recent_rom_drop_failed();
+    }
+
+    memcpy(rom_verify_digest, rec.digest, sizeof(rom_verify_digest));
+    rom_verify_progress = 100;
+    rom_verify_status = rec.status;
+    // Report each verdict once.
+    ((volatile rom_verify_record_t *)(PSRAM_NOCACHE_ADDR + VERIFY_RECORD_OFFSET))->magic = 0;
+
+    printf("VERIFY: %lu bytes status=%u sha1=", (unsigned long)rec.size, (unsigned)rec.status);
+    for (int i = 0; i < 20; i++) printf("%02x", rec.digest[i]);
+    printf("\n");
+}
+
+// Core1 entry for launches that leave core1 otherwise idle.
+static void __no_inline_not_in_flash_func(rom_verify_core1_task)(void)
+{
+    while (rom_verify_step(VERIFY_STEP_BYTES))
+        tight_loop_contents();
+    while (true)
+        __wfe();
+}
+
+// Menu-side jobs (File Hunter downloads) hash a small slice per idle pass.
+static void rom_verify_idle_step(void)
+{
+    if (!rom_verify_on_core1 && rom_verify_status == VERIFY_RUNNING &&
+        !rom_verify_step(VERIFY_STEP_BYTES / 4u))
+        rom_verify_record_attach();
+}
+
+// Called by the plain, linear and banked loaders. core1_idle is false when
+// the launch runs PSG, cartridge audio or WAVEGAME on core1.
+static void rom_verify_start_on_core1(bool core1_idle)
+{
+    if (!core1_idle || rom_verify_status != VERIFY_RUNNING) return;
+    rom_verify_on_core1 = true;
+    multicore_launch_core1(rom_verify_core1_task);
+}
+
+// Sector size used for the direct multi-block path. SD/SDHC/SDXC cards are
+// always 512-byte sector devices, matching the FatFS FF_MIN_SS default.
+#define SDLOAD_SECTOR_SIZE   512u
+// Fast-seek cluster link map: 1 size word + 2 words per fragment + terminator.
+// 64 words cover 31 fragments, far more than a freshly copied ROM file has.
+#define SDLOAD_CLMT_WORDS    64u
+
+#if FF_USE_FASTSEEK
+static DWORD sdload_clmt[SDLOAD_CLMT_WORDS];
+static uint8_t sdload_tail_sector[SDLOAD_SECTOR_SIZE];
+
+// Load an open file straight into PSRAM by walking its cluster runs and
+// issuing one disk_read() per contiguous run, so the SD driver can stream
+// every run as a single multi-block transfer. The destination is the
+// uncached PSRAM alias: data leaves the SPI FIFO once and lands directly in
+// its final location without passing through the XIP write-through cache.
+// Returns the number of bytes loaded; 0 means the caller should fall back
+// to plain f_read() (fast seek unavailable or file too fragmented).
+static uint32_t sd_load_cluster_runs(FIL *fil, uint8_t *dst, uint32_t size)
+{
+    FATFS *fs = fil->obj.fs;
+    if (!fs || fs->csize == 0) return 0;
+
+    fil->cltbl = sdload_clmt;
+    sdload_clmt[0] = SDLOAD_CLMT_WORDS;
+    FRESULT fr = f_lseek(fil, CREATE_LINKMAP);
+    if (fr != FR_OK) {
+        printf("SDLOAD: linkmap unavailable fr=%d\n", (int)fr);
+        fil->cltbl = NULL;
+        return 0;
+    }
+
+    const uint32_t cluster_bytes = (uint32_t)fs->csize * SDLOAD_SECTOR_SIZE;
+    const DWORD *run = &sdload_clmt[1];
+    uint32_t total = 0;
+    uint32_t runs = 0;
+
+    while (total < size && run[0] != 0) {
+        DWORD run_clusters = run[0];
+        DWORD first_cluster = run[1];
+        run += 2;
+        runs++;
+
+        LBA_t sector = fs->database + (LBA_t)fs->csize * (first_cluster - 2u);
+        uint32_t run_bytes = (uint32_t)run_clusters * cluster_bytes;
+        uint32_t want = size - total;
+        if (want > run_bytes) want = run_bytes;
+
+        // Whole sectors go straight to PSRAM in one multi-block read.
+        UINT full_sectors = (UINT)(want / SDLOAD_SECTOR_SIZE);
+        if (full_sectors != 0) {
+            if (disk_read(fs->pdrv, dst + total, sector, full_sectors) != RES_OK) {
+                printf("SDLOAD: run read failed lba=%lu n=%u\n", (unsigned long)sector, (unsigned)full_sectors);
+                break;
+            }
+            total += (uint32_t)full_sectors * SDLOAD_SECTOR_SIZE;
+            sector += full_sectors;
+        }
+
+        // A partial trailing sector only happens at end of file.
+        uint32_t tail = want % SDLOAD_SECTOR_SIZE;
+        if (tail != 0) {
+            if (disk_read(fs->pdrv, sdload_tail_sector, sector, 1) != RES_OK) {
+                printf("SDLOAD: tail read failed lba=%lu\n", (unsigned long)sector);
+                break;
+            }
+            memcpy(dst + total, sdload_tail_sector, tail);
+            total += tail;
+        }
+    }
+
+    fil->cltbl = NULL;
+    printf("SDLOAD: %lu bytes in %lu run(s)\n", (unsigned long)total, (unsigned long)runs);
+    return total;
+}
+#endif
+
+static bool load_rom_from_sd(uint32_t record_index, uint32_t size, uint32_t *offset_out) {
+    if (!sd_mount_card()) {
+        printf("SDLOAD: mount failed\n");
+        return false;
+    }
+    if (record_index >= full_record_count) {
+        printf("SDLOAD: bad record=%u full=%u\n", (unsigned)record_index, (unsigned)full_record_count);
+        return false;
+    }
+    if (sd_path_offsets[record_index] == SD_PATH_NONE) {
+        printf("SDLOAD: missing path record=%u\n", (unsigned)record_index);
+        return false;
+    }
+
+    // SD ROMs are streamed into the 4MB PSRAM region so rom_sram remains
+    // available for flash-resident mapper caching. Bring PSRAM up lazily.
+    if (!psram_bring_up_once()) {
+        printf("SDLOAD: psram bring-up failed\n");
+        return false;
+    }
+    if (size > sd_rom_region.size) {
+        printf("SDLOAD: too large size=%lu region=%lu\n", (unsigned long)size, (unsigned long)sd_rom_region.size);
+        return false;
+    }
+
+    const char *path = sd_path_buffer + sd_path_offsets[record_index];
+    printf("SDLOAD: record=%u size=%lu path=%s\n", (unsigned)record_index, (unsigned long)size, path);
+
+    recent_rom_table_attach();
+    FILINFO fno;
+    uint32_t key = recent_rom_fnv(path, (uint32_t)strlen(path)) | 1u;
+    uint32_t stamp = (f_stat(path, &fno) == FR_OK) ? (((uint32_t)fno.fdate << 16) | fno.ftime) : 0u;
+    int hit = recent_rom_find(key, size, stamp);
+    if (hit >= 0) {
+        recent_rom_entry_t *e = &recent_roms.slot[hit];
+        if (psram_crc32(sd_rom_region.offset + e->offset, size) == e->crc) {
+            e->seq = ++recent_roms.seq;
+            recent_rom_table_save();
+            *offset_out = e->offset;
+            printf("SDLOAD: resident in PSRAM at %lu, SD read skipped\n", (unsigned long)e->offset);
+            uint8_t sidecar[20];
+            bool have_sidecar = rom_verify_read_sidecar(path, sidecar);
+            rom_verify_begin(sd_rom_region.offset + e->offset, size, have_sidecar ? sidecar : NULL, hit);
+            return true;
+        }
+        printf("SDLOAD: resident copy failed CRC, reloading\n");
+        e->key = 0;
+    }
+
+    uint32_t slot;
+    uint32_t image_offset = recent_rom_place(size, &slot);
+
+    FIL fil;
+    FRESULT fr = f_open(&fil, path, FA_READ);
+    if (fr != FR_OK) {
+        printf("SDLOAD: open failed fr=%d\n", (int)fr);
+        return false;
+    }
+
+    gpio_init(PIN_WAIT);
+    gpio_set_dir(PIN_WAIT, GPIO_OUT);
+    gpio_put(PIN_WAIT, 0);
+
+    // Write through the uncached alias; the whole image is overwritten, so
+    // no pre-fill is needed. Stale cached lines are invalidated afterwards.
+    uint8_t *dst = (uint8_t *)(PSRAM_NOCACHE_ADDR + sd_rom_region.offset + image_offset);
+    uint32_t total = 0;
+
+#if FF_USE_FASTSEEK
+    total = sd_load_cluster_runs(&fil, dst, size);
+#endif
+
+    if (total != size) {
+        // Fallback: let FatFS resolve the chain. Reads are issued in large
+        // chunks so f_read still transfers whole clusters directly.
+        if (f_lseek(&fil, total) == FR_OK) {
+            while (total < size) {
+                UINT to_read = (UINT)((size - total) > 65536u ? 65536u : (size - total));
+                UINT br = 0;
+                fr = f_read(&fil, dst + total, to_read, &br);
+                if (fr != FR_OK || br == 0) {
+                    printf("SDLOAD: read stopped fr=%d br=%u total=%lu target=%lu\n", (int)fr, (unsigned)br, (unsigned long)total, (unsigned long)size);
+                    break;
+                }
+                total += br;
+            }
+        }
+    }
+
+    f_close(&fil);
+    xip_cache_invalidate_range((PSRAM_BASE_ADDR - XIP_BASE) + sd_rom_region.offset + image_offset, size);
+    gpio_set_dir(PIN_WAIT, GPIO_IN);
+
+    if (total != size) {
+        printf("SDLOAD: short read total=%lu target=%lu\n", (unsigned long)total, (unsigned long)size);
+        recent_rom_table_save();
+        return false;
+    }
+
+    recent_rom_entry_t *e = &recent_roms.slot[slot];
+    e->key = key;
+    e->size = size;
+    e->stamp = stamp;
+    e->offset = image_offset;
+    e->crc = psram_crc32(sd_rom_region.offset + image_offset, size);
+    e->seq = ++recent_roms.seq;
+    recent_rom_table_save();
+
+    *offset_out = image_offset;
+    printf("SDLOAD: loaded %lu bytes at %lu\n", (unsigned long)total, (unsigned long)image_offset);
+    uint8_t sidecar[20];
+    bool have_sidecar = rom_verify_read_sidecar(path, sidecar);
+    rom_verify_begin(sd_rom_region.offset + image_offset, size, have_sidecar ? sidecar : NULL, (int)slot);
+    return true;
+}
+
+// -----------------------------------------------------------------------
+// Sunrise RAM disk. When SUNRISE_RAMDISK_IMAGE_PATH exists on the mounted
+// partition, the image is restored into the top of sd_rom_region - free in
+// Sunrise modes, where Nextor runs from flash or occupies only a few hundred
+// KB of it - and offered to Nextor as the IDE slave device. The image's
+// cluster runs are resolved to card LBAs here so Core 1 can write it back
+// in place on request without touching the file system under Nextor.
+// -----------------------------------------------------------------------
+#if FF_USE_FASTSEEK
+static bool sunrise_ramdisk_load_image(FIL *fil, uint32_t rom_end)
+{
+    FATFS *fs = fil->obj.fs;
+    uint32_t bytes = (uint32_t)f_size(fil) & ~(SDLOAD_SECTOR_SIZE - 1u);
+    uint32_t floor = (rom_end + RECENT_ROM_ALIGN - 1u) & ~(RECENT_ROM_ALIGN - 1u);
+
+    if (!psram_bring_up_once() || fs == NULL || fs->csize == 0 || bytes == 0) return false;
+    recent_rom_table_attach();
+    if (floor >= sd_rom_region.size) return false;
+    if (bytes > sd_rom_region.size - floor) {
+        bytes = (sd_rom_region.size - floor) & ~(RECENT_ROM_ALIGN - 1u);
+        printf("RAMDISK: image trimmed to %lu bytes\n", (unsigned long)bytes);
+    }
+
+    fil->cltbl = sdload_clmt;
+    sdload_clmt[0] = SDLOAD_CLMT_WORDS;
+    FRESULT fr = f_lseek(fil, CREATE_LINKMAP);
+    fil->cltbl = NULL;
+    if (fr != FR_OK) {
+        printf("RAMDISK: linkmap unavailable fr=%d\n", (int)fr);
+        return false;
+    }
+
+    sunrise_ramdisk_run_t runs[SUNRISE_RAMDISK_MAX_RUNS];
+    uint8_t run_count = 0;
+    for (const DWORD *run = &sdload_clmt[1]; run[0] != 0 && run_count < SUNRISE_RAMDISK_MAX_RUNS; run += 2) {
+        runs[run_count].lba = sd_mounted_lba_base + (uint32_t)(fs->database + (LBA_t)fs->csize * (run[1] - 2u));
+        runs[run_count].sectors = (uint32_t)run[0] * fs->csize;
+        run_count++;
+    }
+
+    // Resident SD images under the RAM disk window are gone from now on.
+    uint32_t offset = sd_rom_region.size - bytes;
+    for (uint32_t i = 0; i < RECENT_ROM_SLOTS; i++) {
+        recent_rom_entry_t *e = &recent_roms.slot[i];
+        if (e->key != 0 && e->offset + e->size > offset)
+            e->key = 0;
+    }
+    recent_rom_table_save();
+
+    sunrise_ramdisk_attach(sd_rom_region.ptr + offset, bytes / SDLOAD_SECTOR_SIZE, runs, run_count);
+    if (!sunrise_ramdisk_restore()) {
+        sunrise_ramdisk_detach();
+        return false;
+    }
+    printf("RAMDISK: %lu KB at %lu\n", (unsigned long)(bytes / 1024u), (unsigned long)offset);
+    return true;
+}
+
+static bool sunrise_ramdisk_prepare(uint32_t rom_end)
+{
+    sunrise_ramdisk_detach();
+    if (!sd_mount_card()) return false;
+
+    FIL fil;
+    if (f_open(&fil, SUNRISE_RAMDISK_IMAGE_PATH, FA_READ) != FR_OK) return false;
+    bool ok = sunrise_ramdisk_load_image(&fil, rom_end);
+    f_close(&fil);
+    return ok;
+}
+#else
+static bool sunrise_ramdisk_prepare(uint32_t rom_end)
+{
+    (void)rom_end;
+    sunrise_ramdisk_detach();
+    return false;
+}
+#endif
+
+// -----------------------------------------------------------------------
+// USB push and run. In EXPLORER_USB_PUSH builds the menu polls a vendor
+// bulk device (usb_push_dev.c) and pvpush on a PC streams a ROM straight
+// into sd_rom_region. The image is placed through the recent-ROM ring like
+// an SD load but never remembered, since it has no file to key it by. RUN
+// raises CTRL_USB_PUSH; the menu then resets the MSX and main() launches
+// usb_push_record from PSRAM with the options sent in BEGIN.
+// -----------------------------------------------------------------------
+static ROMRecord usb_push_record;
+static usb_push_begin_t usb_push_opts;
+static volatile bool usb_push_launch_pending = false;
+
+static void usb_push_apply_options(void)
+{
+    ctrl_audio_selection = usb_push_opts.audio;
+    ctrl_psg_emulation = usb_push_opts.psg ? 1u : 0u;
+    ctrl_audio_volume = usb_push_opts.volume ? usb_push_opts.volume : AUDIO_VOLUME_DEFAULT;
+    ctrl_vdp_frequency = usb_push_opts.vdp_freq;
+}
+
+#if EXPLORER_USB_PUSH
+static uint32_t usb_push_offset = 0;
+
+static uint8_t usb_push_begin(void *user, uint32_t size, const usb_push_begin_t *opts)
+{
+    (void)user;
+    if (!mapper_is_selectable(opts->mapper) || opts->audio > AUDIO_PROFILE_MOONSOUND ||
+        opts->volume > AUDIO_VOLUME_MAX || opts->vdp_freq > VDP_FREQ_50HZ)
+        return USB_PUSH_STATUS_BAD_OPTION;
+    if (!psram_bring_up_once() || size > sd_rom_region.size)
+        return USB_PUSH_STATUS_TOO_LARGE;
+
+    uint32_t slot;
+    usb_push_launch_pending = false;
+    recent_rom_table_attach();
+    usb_push_offset = recent_rom_place(size, &slot);
+    recent_rom_table_save();
+    usb_push_opts = *opts;
+    printf("USBPUSH: begin '%s' size=%lu mapper=%u at %lu\n", opts->name, (unsigned long)size,
+           opts->mapper, (unsigned long)usb_push_offset);
+    return USB_PUSH_STATUS_OK;
+}
+
+static void usb_push_write(void *user, uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    (void)user;
+    memcpy((uint8_t *)(PSRAM_NOCACHE_ADDR + sd_rom_region.offset + usb_push_offset + offset), data, len);
+}
+
+static uint8_t usb_push_end(void *user, uint32_t size)
+{
+    (void)user;
+    xip_cache_invalidate_range((PSRAM_BASE_ADDR - XIP_BASE) + sd_rom_region.offset + usb_push_offset, size);
+
+    memset(&usb_push_record, 0, sizeof(usb_push_record));
+    strncpy(usb_push_record.Name, usb_push_opts.name, sizeof(usb_push_record.Name) - 1u);
+    usb_push_record.Mapper = usb_push_opts.mapper;
+    usb_push_record.Size = size;
+    usb_push_record.Offset = usb_push_offset;
+    rom_verify_begin(sd_rom_region.offset + usb_push_offset, size, NULL, -1);
+    printf("USBPUSH: image complete\n");
+    return USB_PUSH_STATUS_OK;
+}
+
+static uint8_t usb_push_run(void *user)
+{
+    (void)user;
+    usb_push_launch_pending = true;
+    printf("USBPUSH: run requested\n");
+    return USB_PUSH_STATUS_OK;
+}
+
+static const usb_push_sink_t usb_push_sink = {
+    .capacity = SD_ROM_MAX_SIZE,
+    .user = NULL,
+    .begin = usb_push_begin,
+    .write = usb_push_write,
+    .end = usb_push_end,
+    .run = usb_push_run,
+};
+#endif
+
+// Initialize GPIO pins
+static inline void setup_gpio()
+{
+
+    for (int i = 0; i <= 23; i++) {
+        gpio_init(i);
+        gpio_set_input_hysteresis_enabled(i, true);
+    }
+
+    for (int i = 0; i <= 15; i++) {
+        gpio_set_dir(i, GPIO_IN);
+    }
+
+    // Initialize control pins as input
+    gpio_init(PIN_RD); gpio_set_dir(PIN_RD, GPIO_IN);    
+    gpio_init(PIN_WR); gpio_set_dir(PIN_WR, GPIO_IN); 
+    gpio_init(PIN_IORQ); gpio_set_dir(PIN_IORQ, GPIO_IN); 
+    gpio_init(PIN_SLTSL); gpio_set_dir(PIN_SLTSL, GPIO_IN); 
+    gpio_init(PIN_BUSSDIR); gpio_set_dir(PIN_BUSSDIR, GPIO_IN); 
+
+    gpio_init(I2S_MUTE_PIN);
+    gpio_set_dir(I2S_MUTE_PIN, GPIO_OUT);
+    gpio_put(I2S_MUTE_PIN, 1);
+}
+
+// read_ulong - Read a 4-byte value from the memory area
+// This function will read a 4-byte value from the memory area pointed by ptr and return the value as an unsigned long
+// Parameters:
+//   ptr - Pointer to the memory area to read the value from
+// Returns:
+//   The 4-byte value as an unsigned long 
+unsigned long __no_inline_not_in_flash_func(read_ulong)(const unsigned char *ptr) {
+    return (unsigned long)ptr[0] |
+           ((unsigned long)ptr[1] << 8) |
+           ((unsigned long)ptr[2] << 16) |
+           ((unsigned long)ptr[3] << 24);
+}
+
+// isEndOfData - Check if the memory area is the end of the data
+// This function will check if the memory area pointed by memory is the end of the data. The end of the data is defined by all bytes being 0xFF.
+// Parameters:
+//   memory - Pointer to the memory area to check
+// Returns:
+//   1 if the memory area is the end of the data, 0 otherwise
+int __no_inline_not_in_flash_func(isEndOfData)(const unsigned char *memory) {
+    for (int i = 0; i < ROM_RECORD_SIZE; i++) {
+        if (memory[i] != 0xFF) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// -----------------------------------------------------------------------
+// External PSRAM (QMI CS1) - hardware init + bump allocator.
+// Mirrors the implementation in multirom so the same code paths work
+// across the two firmwares. Used for SD-cached ROM storage so that
+// rom_sram remains fully available for flash-resident mapper caching.
+// -----------------------------------------------------------------------
+static inline void __not_in_flash_func(psram_delay_cycles)(uint32_t cycles)
+{
+    for (volatile uint32_t cycle = 0; cycle < cycles; ++cycle)
+    {
+        __asm volatile ("nop");
+    }
+}
+
+static inline void __not_in_flash_func(psram_wait_direct_done)(void)
+{
+    while ((qmi_hw->direct_csr & QMI_DIRECT_CSR_TXEMPTY_BITS) == 0) { }
+    while ((qmi_hw->direct_csr & QMI_DIRECT_CSR_BUSY_BITS) != 0) { }
+}
+
+static inline void __not_in_flash_func(psram_send_direct_cmd)(uint8_t cmd, bool quad_width)
+{
+    qmi_hw->direct_csr |= QMI_DIRECT_CSR_ASSERT_CS1N_BITS;
+    if (quad_width)
+    {
+        qmi_hw->direct_tx = QMI_DIRECT_TX_OE_BITS |
+                            (QMI_DIRECT_TX_IWIDTH_VALUE_Q << QMI_DIRECT_TX_IWIDTH_LSB) |
+                            cmd;
+    }
+    else
     {
         qmi_hw->direct_tx = cmd;
     }
@@ -3036,6 +3855,115 @@ static inline void __not_in_flash_func(psram_send_direct_cmd)(uint8_t cmd, bool
     (void)qmi_hw->direct_rx;
 }
 
+static void wait_stats_report_previous(void);
+
+// QMI M1 timing candidates for the 210 MHz system clock, fastest first.
+// psram_init() validates each one against a scratch window and keeps the
+// first that passes every round, so good parts run at 105 MHz SCK while
+// marginal ones settle on the slower entries. MAX_SELECT (x64 sys clocks)
+// keeps every burst under the 8 us tCEM refresh limit at 210 MHz.
+typedef struct {
+    uint8_t clkdiv;
+    uint8_t rxdelay;
+    uint8_t max_select;
+    uint8_t min_deselect;
+} psram_timing_t;
+
+static const psram_timing_t psram_timing_table[] = {
+    { 1u, 3u, 26u, 5u },    // 105 MHz
+    { 1u, 2u, 26u, 5u },    // 105 MHz, earlier sample point
+    { 2u, 2u, 26u, 5u },    // 52.5 MHz - the former hard-coded setting
+    { 2u, 3u, 26u, 5u },    // 52.5 MHz, later sample point
+    { 3u, 3u, 26u, 6u },    // 35 MHz fallback
+};
+#define PSRAM_TIMING_COUNT    (sizeof(psram_timing_table) / sizeof(psram_timing_table[0]))
+#define PSRAM_TIMING_DEFAULT  2u
+#define PSRAM_TIMING_ROUNDS   3u
+#define PSRAM_TIMING_TEST_SIZE   (32u * 1024u)
+// Scratch window just below the recent-ROM table; nothing lives there
+// before the allocator runs, and resident images sit at the bottom.
+#define PSRAM_TIMING_TEST_OFFSET (RECENT_ROM_TABLE_OFFSET - PSRAM_TIMING_TEST_SIZE)
+
+static uint8_t psram_timing_index = PSRAM_TIMING_DEFAULT;
+static uint32_t psram_miss_ns = 0;
+
+static inline uint32_t psram_timing_word(const psram_timing_t *t)
+{
+    return (QMI_M0_TIMING_PAGEBREAK_VALUE_1024 << QMI_M0_TIMING_PAGEBREAK_LSB) |
+           (1u << QMI_M0_TIMING_SELECT_HOLD_LSB) |
+           (1u << QMI_M0_TIMING_COOLDOWN_LSB) |
+           ((uint32_t)t->rxdelay << QMI_M0_TIMING_RXDELAY_LSB) |
+           ((uint32_t)t->max_select << QMI_M0_TIMING_MAX_SELECT_LSB) |
+           ((uint32_t)t->min_deselect << QMI_M0_TIMING_MIN_DESELECT_LSB) |
+           ((uint32_t)t->clkdiv << QMI_M0_TIMING_CLKDIV_LSB);
+}
+
+// Pattern test through the uncached alias: xorshift fill, read back, then
+// the inverted pattern so every data line sees both levels.
+static bool __no_inline_not_in_flash_func(psram_timing_validate)(uint32_t seed)
+{
+    volatile uint32_t *win = (volatile uint32_t *)(PSRAM_NOCACHE_ADDR + PSRAM_TIMING_TEST_OFFSET);
+    const uint32_t words = PSRAM_TIMING_TEST_SIZE / 4u;
+
+    for (uint32_t invert = 0; invert < 2u; invert++) {
+        uint32_t mask = invert ? 0xFFFFFFFFu : 0u;
+        uint32_t x = seed;
+        for (uint32_t i = 0; i < words; i++) {
+            x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+            win[i] = x ^ mask;
+        }
+        x = seed;
+        for (uint32_t i = 0; i < words; i++) {
+            x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+            if (win[i] != (x ^ mask)) return false;
+        }
+    }
+    return true;
+}
+
+// Average cost of an isolated PSRAM read: scattered uncached word reads,
+// each a full QMI transaction, i.e. what an XIP cache miss costs.
+static uint32_t __no_inline_not_in_flash_func(psram_measure_miss_ns)(void)
+{
+    const volatile uint32_t *win = (const volatile uint32_t *)(PSRAM_NOCACHE_ADDR + PSRAM_TIMING_TEST_OFFSET);
+    const uint32_t reads = 4096u;
+    uint32_t idx = 1u;
+    uint32_t sink = 0;
+
+    uint64_t t0 = time_us_64();
+    for (uint32_t i = 0; i < reads; i++) {
+        idx = (idx * 1103515245u + 12345u);
+        sink += win[(idx >> 8) & ((PSRAM_TIMING_TEST_SIZE / 4u) - 1u)];
+    }
+    uint64_t elapsed = time_us_64() - t0;
+    (void)sink;
+    return (uint32_t)((elapsed * 1000u) / reads);
+}
+
+static void psram_select_timing(void)
+{
+    uint8_t chosen = PSRAM_TIMING_COUNT - 1u;
+    for (uint8_t i = 0; i < PSRAM_TIMING_COUNT; i++) {
+        qmi_hw->m[1].timing = psram_timing_word(&psram_timing_table[i]);
+        bool ok = true;
+        for (uint32_t round = 0; round < PSRAM_TIMING_ROUNDS && ok; round++)
+            ok = psram_timing_validate(0x9E3779B9u + round * 0x01000193u);
+        if (ok) {
+            chosen = i;
+            break;
+        }
+        printf("PSRAM: timing #%u rejected\n", (unsigned)i);
+    }
+    qmi_hw->m[1].timing = psram_timing_word(&psram_timing_table[chosen]);
+    psram_timing_index = chosen;
+    psram_miss_ns = psram_measure_miss_ns();
+    printf("PSRAM: timing #%u clkdiv=%u rxdelay=%u miss=%luns\n",
+           (unsigned)chosen,
+           (unsigned)psram_timing_table[chosen].clkdiv,
+           (unsigned)psram_timing_table[chosen].rxdelay,
+           (unsigned long)psram_miss_ns);
+}
+
 static bool __no_inline_not_in_flash_func(psram_init)(void)
 {
     gpio_set_function(PIN_PSRAM, GPIO_FUNC_XIP_CS1);
@@ -3062,15 +3990,9 @@ static bool __no_inline_not_in_flash_func(psram_init)(void)
 
     qmi_hw->direct_csr &= ~(QMI_DIRECT_CSR_ASSERT_CS1N_BITS | QMI_DIRECT_CSR_EN_BITS);
 
-    // PSRAM QMI timing - tuned for 210 MHz system clock (CLKDIV=2 -> ~52.5 MHz).
-    qmi_hw->m[1].timing =
-        (QMI_M0_TIMING_PAGEBREAK_VALUE_1024 << QMI_M0_TIMING_PAGEBREAK_LSB) |
-        (1u << QMI_M0_TIMING_SELECT_HOLD_LSB) |
-        (1u << QMI_M0_TIMING_COOLDOWN_LSB) |
-        (2u << QMI_M0_TIMING_RXDELAY_LSB) |
-        (26u << QMI_M0_TIMING_MAX_SELECT_LSB) |
-        (5u << QMI_M0_TIMING_MIN_DESELECT_LSB) |
-        (2u << QMI_M0_TIMING_CLKDIV_LSB);
+    // Start from the known-good 52.5 MHz setting; psram_select_timing()
+    // refines it once the window is writable.
+    qmi_hw->m[1].timing = psram_timing_word(&psram_timing_table[PSRAM_TIMING_DEFAULT]);
     qmi_hw->m[1].rfmt =
         (QMI_M0_RFMT_PREFIX_WIDTH_VALUE_Q << QMI_M0_RFMT_PREFIX_WIDTH_LSB) |
         (QMI_M0_RFMT_ADDR_WIDTH_VALUE_Q << QMI_M0_RFMT_ADDR_WIDTH_LSB) |
@@ -3096,8 +4018,11 @@ static bool __no_inline_not_in_flash_func(psram_init)(void)
 
     restore_interrupts(irq_state);
 
+    psram_select_timing();
+    wait_stats_report_previous();
+
     // Verify PSRAM via uncached window (bypass XIP cache).
-    volatile uint32_t *psram_test = (volatile uint32_t *)0x15000000u;
+    volatile uint32_t *psram_test = (volatile uint32_t *)PSRAM_NOCACHE_ADDR;
     psram_test[0] = 0x12345678u;
     return psram_test[0] == 0x12345678u;
 }
@@ -3118,17 +4043,26 @@ static void psram_mem_init(void)
     rom_sram = NULL;
     memset(&mapper_region, 0, sizeof(mapper_region));
     memset(&c2_rom_region, 0, sizeof(c2_rom_region));
+    memset(&c2_flash_region, 0, sizeof(c2_flash_region));
     memset(&megaram_region, 0, sizeof(megaram_region));
     memset(&mp3_buffer_region, 0, sizeof(mp3_buffer_region));
     memset(&fh_list_region, 0, sizeof(fh_list_region));
     memset(&fh_download_region, 0, sizeof(fh_download_region));
+    memset(&fh_zip_region, 0, sizeof(fh_zip_region));
     fh_download_size = 0;
     memset(fh_download_name, 0, sizeof(fh_download_name));
 }
 
+// The top of PSRAM holds the recent-ROM table and must survive re-init.
+// While the menu owns the record store, the window below it is out too.
+static uint32_t psram_alloc_limit(void)
+{
+    return record_store_guarded ? RECORD_STORE_OFFSET : RECENT_ROM_TABLE_OFFSET;
+}
+
 static bool psram_alloc(uint32_t size, psram_region_t *region)
 {
-    if (psram_mgr.next_free + size > PSRAM_TOTAL_SIZE)
+    if (psram_mgr.next_free + size > psram_alloc_limit())
         return false;
     region->offset = psram_mgr.next_free;
     region->size   = size;
@@ -3171,6 +4105,19 @@ static bool psram_prepare_megaram_region(void)
     return psram_alloc(MEGARAM_SIZE, &megaram_region);
 }
 
+// The OPL4 addresses 2MB of sample RAM; smaller PSRAM leftovers are
+// mirrored, which is what a MoonSound with less RAM fitted does too.
+static bool psram_prepare_opl4_ram_region(void)
+{
+    if (!psram_bring_up_once()) return false;
+    if (opl4_ram_region.size) return true;
+    for (uint32_t size = OPL4_WAVE_RAM_MAX; size >= OPL4_SAMPLE_RAM_MIN; size >>= 1)
+    {
+        if (psram_alloc(size, &opl4_ram_region)) return true;
+    }
+    return false;
+}
+
 static bool psram_prepare_mp3_buffer(void)
 {
     if (!psram_bring_up_once()) return false;
@@ -3200,6 +4147,65 @@ static bool fh_prepare_list_region(void)
     return psram_alloc(FH_HTTP_BUFFER_SIZE, &fh_list_region);
 }
 
+// -----------------------------------------------------------------------
+// Menu record store. While the menu runs, records[], sd_path_offsets[],
+// filtered_indices[], the search index and the SD path pool live in a 2MB
+// PSRAM window just below the recent-ROM table, holding
+// RECORD_STORE_CAPACITY entries instead of the MAX_ROM_RECORDS that fit in
+// SRAM. The window is only needed by the
+// menu, so launch-time regions (mapper RAM, C2, MegaRAM) may reuse it once
+// record_store_release() has run; every menu entry rebuilds the records.
+// -----------------------------------------------------------------------
+#define RECORD_STORE_PATH_SIZE (RECORD_STORE_SIZE - RECORD_STORE_CAPACITY * \
+                                (sizeof(ROMRecord) + 3u * sizeof(uint32_t) + 1u))
+
+static void record_store_attach(void)
+{
+    // Menu-lifetime regions must sit below the window, so claim the MP3 and
+    // File Hunter buffers before any launch can push next_free past it.
+    bool psram_ok = psram_bring_up_once() &&
+                    psram_prepare_mp3_buffer() &&
+                    fh_prepare_list_region();
+
+    if (!psram_ok)
+    {
+        records = records_sram;
+        sd_path_offsets = sd_path_offsets_sram;
+        filtered_indices = filtered_indices_sram;
+        search_masks = NULL;
+        search_depth = NULL;
+        search_index_valid = false;
+        sd_path_buffer = sd_path_buffer_sram;
+        sd_path_buffer_size = SD_PATH_BUFFER_SIZE;
+        record_capacity = MAX_ROM_RECORDS;
+        record_store_guarded = false;
+        printf("RECORDS: PSRAM unavailable, %u entries in SRAM\n", (unsigned)record_capacity);
+        return;
+    }
+
+    uint8_t *base = (uint8_t *)(PSRAM_BASE_ADDR + RECORD_STORE_OFFSET);
+    records = (ROMRecord *)base;
+    base += RECORD_STORE_CAPACITY * sizeof(ROMRecord);
+    sd_path_offsets = (uint32_t *)base;
+    base += RECORD_STORE_CAPACITY * sizeof(uint32_t);
+    filtered_indices = (uint32_t *)base;
+    base += RECORD_STORE_CAPACITY * sizeof(uint32_t);
+    search_masks = (uint32_t *)base;
+    base += RECORD_STORE_CAPACITY * sizeof(uint32_t);
+    search_depth = base;
+    base += RECORD_STORE_CAPACITY;
+    search_index_valid = false;
+    sd_path_buffer = (char *)base;
+    sd_path_buffer_size = RECORD_STORE_PATH_SIZE;
+    record_capacity = RECORD_STORE_CAPACITY;
+    record_store_guarded = true;
+}
+
+static void record_store_release(void)
+{
+    record_store_guarded = false;
+}
+
 static inline void __not_in_flash_func(prepare_rom_source)(
     uint32_t offset,
     bool cache_enable,
@@ -3219,11 +4225,21 @@ static inline void __not_in_flash_func(prepare_rom_source)(
         available_length = preferred_size;
     }
 
+    // A planned window only replaces the leading one for plain whole-image
+    // caching; the INIT patch below needs the header in rom_sram.
+    uint32_t window = rom_cache_window_plan;
+    rom_cache_window_plan = 0;
+    if (preferred_size != 0u || rom_cache_capacity != CACHE_SIZE || vdp_freq_launch != VDP_FREQ_DEFAULT ||
+        window + CACHE_SIZE > available_length)
+    {
+        window = 0;
+    }
+
     if (cache_enable && available_length > 0u && psram_prepare_rom_cache())
     {
         uint32_t cap = rom_cache_capacity;
         if (cap > CACHE_SIZE) cap = CACHE_SIZE;
-        uint32_t bytes_to_cache = (available_length > cap) ? cap : available_length;
+        uint32_t bytes_to_cache = (available_length - window > cap) ? cap : available_length - window;
 
         gpio_init(PIN_WAIT);
         gpio_set_dir(PIN_WAIT, GPIO_OUT);
@@ -3239,13 +4255,14 @@ static inline void __not_in_flash_func(prepare_rom_source)(
         channel_config_set_write_increment(&dma_cfg, true);
         dma_channel_configure(dma_chan, &dma_cfg,
             rom_sram,
-            rom_base,
+            rom_base + window,
             bytes_to_cache,
             true);
         dma_channel_wait_for_finish_blocking(dma_chan);
         dma_channel_unclaim(dma_chan);
         gpio_set_dir(PIN_WAIT, GPIO_IN);
 
+        rom_cache_base = window;
         rom_cached_size = bytes_to_cache;
         // If we cached everything, we can just point to SRAM
         if (active_rom_size <= cap)
@@ -3286,6 +4303,7 @@ static inline void __not_in_flash_func(prepare_rom_source)(
     }
     else
     {
+        rom_cache_base = 0;
         rom_cached_size = 0;
     }
 
@@ -3321,6 +4339,7 @@ static inline void __not_in_flash_func(prepare_sunrise_mapper_rom_source)(
         dma_channel_wait_for_finish_blocking(dma_chan);
         dma_channel_unclaim(dma_chan);
 
+        rom_cache_base = 0;
         rom_cached_size = bytes_to_cache;
         if (available_length <= CACHE_SIZE)
         {
@@ -3329,6 +4348,7 @@ static inline void __not_in_flash_func(prepare_sunrise_mapper_rom_source)(
     }
     else
     {
+        rom_cache_base = 0;
         rom_cached_size = 0;
     }
 
@@ -3337,35 +4357,246 @@ static inline void __not_in_flash_func(prepare_sunrise_mapper_rom_source)(
 }
 
 
-static void msx_pio_bus_init(void)
+#ifndef EXPLORER_READ_DEADLINE_NS
+#define EXPLORER_READ_DEADLINE_NS 100
+#endif
+
+#define READ_DEADLINE_IRQ_FLAG    4u  // raised by the fast and DMA responders on a late read
+#define READ_DEADLINE_LOOP_CYCLES 3u  // PIO cycles per poll loop
+#define READ_DEADLINE_MIN_NS      48u // shorter deadlines cannot be met by the CPU loops
+#define READ_DMA_EDGE_CYCLES      6u  // /RD sync to the end of the DMA responder's push
+
+// -----------------------------------------------------------------------
+// Bus clock probe. EXPLORER_READ_DEADLINE_NS is tuned for 3.58 MHz and
+// 7 MHz hosts; a faster turbo kit samples /WAIT before that deadline runs
+// out, so a late read would return garbage instead of stretching the cycle.
+// While the menu runs, msx_bus_clock_probe times /RD pulses on pio0 SM2.
+// The MSX adds a wait state to every M1 cycle, so the shortest pulses are
+// plain memory reads (2 T-states). The read deadline is scaled down from
+// there in the ratio the default was tuned at (100 ns of a 140 ns T-state).
+// The result is patched into the DMA responder that serves plain and linear
+// ROMs and into the deadline responder of their SRAM-copy fallback; every
+// other mapper loop asserts /WAIT on every read and does not use it. When
+// even that is too short, those responders assert /WAIT on every read too.
+// -----------------------------------------------------------------------
+#define BUS_PROBE_SM            2u
+#define BUS_PROBE_SAMPLES       512u    // pulses timed per menu session
+#define BUS_PROBE_MIN_HITS      8u      // pulses needed at the shortest width
+#define BUS_PROBE_FLOOR_NS      50u     // shorter pulses are treated as glitches
+#define BUS_PROBE_LOOP_CYCLES   2u
+#define BUS_PROBE_EDGE_CYCLES   4u      // input sync + mov before the first loop
+
+static uint bus_probe_offset = 0;
+static bool bus_probe_running = false;
+static uint32_t bus_probe_samples = 0;
+static uint32_t bus_probe_min_loops = 0;
+static uint32_t bus_probe_hits = 0;
+static uint32_t bus_rd_min_ns = 0;      // shortest /RD pulse last measured, 0 = unknown
+
+static uint32_t bus_probe_ns(uint32_t loops)
+{
+    uint32_t cycles = loops * BUS_PROBE_LOOP_CYCLES + BUS_PROBE_EDGE_CYCLES;
+    return (uint32_t)(((uint64_t)cycles * 1000000000u) / clock_get_hz(clk_sys));
+}
+
+// Effective read deadline for the measured host.
+static uint32_t bus_read_deadline_ns(void)
+{
+    uint32_t deadline = EXPLORER_READ_DEADLINE_NS;
+    if (bus_rd_min_ns != 0u)
+    {
+        uint32_t t_state_ns = bus_rd_min_ns / 2u;
+        uint32_t fit = t_state_ns * 5u / 7u;
+        if (fit < deadline) deadline = fit;
+    }
+    return deadline;
+}
+
+// Start timing /RD pulses. Called with pio0 SM0/SM1 already running the
+// menu responders; the probe only reads pins.
+static void bus_probe_start(void)
+{
+    if (bus_probe_running) return;
+    PIO pio = msx_bus.pio;
+    bus_probe_offset = pio_add_program(pio, &msx_bus_clock_probe_program);
+    pio_sm_config cfg = msx_bus_clock_probe_program_get_default_config(bus_probe_offset);
+    sm_config_set_in_shift(&cfg, false, false, 32);
+    sm_config_set_jmp_pin(&cfg, PIN_RD);
+    sm_config_set_clkdiv(&cfg, 1.0f);
+    pio_sm_init(pio, BUS_PROBE_SM, bus_probe_offset, &cfg);
+    pio_sm_set_enabled(pio, BUS_PROBE_SM, true);
+    bus_probe_samples = 0;
+    bus_probe_min_loops = UINT32_MAX;
+    bus_probe_hits = 0;
+    bus_probe_running = true;
+}
+
+// Free the state machine and program. A probe that collected enough pulses
+// at its shortest width updates bus_rd_min_ns; otherwise the last value stays.
+static void bus_probe_stop(void)
+{
+    if (!bus_probe_running) return;
+    PIO pio = msx_bus.pio;
+    pio_sm_set_enabled(pio, BUS_PROBE_SM, false);
+    pio_sm_clear_fifos(pio, BUS_PROBE_SM);
+    pio_remove_program(pio, &msx_bus_clock_probe_program, bus_probe_offset);
+    bus_probe_running = false;
+
+    if (bus_probe_hits < BUS_PROBE_MIN_HITS)
+    {
+        printf("BUS: probe inconclusive (%lu pulses)\n", (unsigned long)bus_probe_samples);
+        return;
+    }
+    bus_rd_min_ns = bus_probe_ns(bus_probe_min_loops);
+    uint32_t t_state_ns = bus_rd_min_ns / 2u;
+    uint32_t deadline = bus_read_deadline_ns();
+    printf("BUS: shortest /RD %lu ns, T-state ~%lu ns (~%lu kHz), read deadline %lu ns%s\n",
+           (unsigned long)bus_rd_min_ns, (unsigned long)t_state_ns,
+           (unsigned long)(t_state_ns ? 1000000u / t_state_ns : 0u), (unsigned long)deadline,
+           deadline < READ_DEADLINE_MIN_NS ? " (too short, always /WAIT)" : "");
+}
+
+// Drain the probe FIFO from the menu idle loop.
+static void bus_probe_poll(void)
+{
+    if (!bus_probe_running) return;
+    PIO pio = msx_bus.pio;
+    uint32_t floor_loops = 0;
+    while (bus_probe_ns(floor_loops) < BUS_PROBE_FLOOR_NS) floor_loops++;
+
+    while (!pio_sm_is_rx_fifo_empty(pio, BUS_PROBE_SM))
+    {
+        uint32_t loops = pio_sm_get(pio, BUS_PROBE_SM);
+        if (loops < floor_loops) continue;
+        bus_probe_samples++;
+        if (loops + 1u < bus_probe_min_loops)
+        {
+            // Widths within one loop of the minimum count as the same pulse.
+            bus_probe_min_loops = loops;
+            bus_probe_hits = 1;
+        }
+        else if (loops <= bus_probe_min_loops + 1u)
+        {
+            if (loops < bus_probe_min_loops) bus_probe_min_loops = loops;
+            bus_probe_hits++;
+        }
+    }
+    if (bus_probe_samples >= BUS_PROBE_SAMPLES)
+        bus_probe_stop();
+}
+
+// Deadline loop count for msx_read_responder_fast at the current clock.
+static uint32_t read_deadline_loops(void)
+{
+    uint32_t cycles = (uint32_t)(((uint64_t)clock_get_hz(clk_sys) * bus_read_deadline_ns()) / 1000000000u);
+    uint32_t loops = cycles / READ_DEADLINE_LOOP_CYCLES;
+    if (loops < 1u) loops = 1u;
+    if (loops > 31u) loops = 31u;
+    return loops;
+}
+
+// Patches the deadline of msx_read_responder_dma: a single delay, since the
+// DMA latency does not vary. A delay capped below the deadline only checks
+// the FIFO earlier, which is safe.
+static void read_dma_patch_deadline(uint16_t *instructions)
+{
+    uint32_t deadline = bus_read_deadline_ns();
+    if (deadline < READ_DEADLINE_MIN_NS)
+    {
+        instructions[msx_read_responder_dma_offset_deadline] = (uint16_t)pio_encode_set(pio_pindirs, 1);
+        instructions[msx_read_responder_dma_offset_late] = (uint16_t)pio_encode_nop();
+        return;
+    }
+    uint32_t cycles = (uint32_t)(((uint64_t)clock_get_hz(clk_sys) * deadline) / 1000000000u);
+    uint32_t delay = cycles > READ_DMA_EDGE_CYCLES ? cycles - READ_DMA_EDGE_CYCLES : 0u;
+    if (delay > 31u) delay = 31u;
+    instructions[msx_read_responder_dma_offset_deadline] = (uint16_t)(pio_encode_nop() | pio_encode_delay(delay));
+}
+
+// pio0 cannot hold every read responder next to the write captor, so only
+// the one in use is loaded and it is swapped when a launch needs another.
+// The deadline and DMA responders are loaded from a copy with their
+// deadline patched.
+static void msx_pio_bus_load_read_program(const pio_program_t *program)
+{
+    if (msx_bus_read_program == program)
+        return;
+    if (msx_bus_read_program)
+        pio_remove_program(msx_bus.pio, msx_bus_read_program, msx_bus.offset_read);
+
+    if (program == &msx_read_responder_fast_program || program == &msx_read_responder_dma_program)
+    {
+        static uint16_t patched_instructions[PIO_INSTRUCTION_COUNT];
+        pio_program_t patched = *program;
+        memcpy(patched_instructions, program->instructions, program->length * sizeof(uint16_t));
+        if (program == &msx_read_responder_fast_program)
+            patched_instructions[msx_read_responder_fast_offset_deadline] = (uint16_t)pio_encode_set(pio_x, read_deadline_loops());
+        else
+            read_dma_patch_deadline(patched_instructions);
+        patched.instructions = patched_instructions;
+        msx_bus.offset_read = pio_add_program(msx_bus.pio, &patched);
+    }
+    else
+    {
+        msx_bus.offset_read = pio_add_program(msx_bus.pio, program);
+    }
+    msx_bus_read_program = program;
+}
+
+// Starts the memory-bus state machines. With dma_table set, SM0 runs
+// msx_read_responder_dma instead of the CPU-fed responder and X is preloaded
+// with the upper half of the (64KB-aligned) table address; that responder
+// also only asserts /WAIT when its byte misses the deadline. Otherwise
+// fast_reads selects msx_read_responder_fast, which only asserts /WAIT when
+// the CPU misses the read deadline.
+static void msx_pio_bus_start(const uint8_t *dma_table, bool fast_reads)
 {
     msx_bus.pio = pio0;
     msx_bus.sm_read  = 0;
     msx_bus.sm_write = 1;
 
-    if (!msx_bus_programs_loaded)
+    pio_sm_set_enabled(msx_bus.pio, msx_bus.sm_read, false);
+    pio_sm_set_enabled(msx_bus.pio, msx_bus.sm_write, false);
+
+    const pio_program_t *read_program = dma_table ? &msx_read_responder_dma_program
+                                      : fast_reads ? &msx_read_responder_fast_program
+                                      : &msx_read_responder_program;
+    msx_pio_bus_load_read_program(read_program);
+    if (!msx_bus_write_program_loaded)
     {
-        msx_bus.offset_read  = pio_add_program(msx_bus.pio, &msx_read_responder_program);
         msx_bus.offset_write = pio_add_program(msx_bus.pio, &msx_write_captor_program);
-        msx_bus_programs_loaded = true;
+        msx_bus_write_program_loaded = true;
     }
 
-    pio_sm_set_enabled(msx_bus.pio, msx_bus.sm_read, false);
-    pio_sm_set_enabled(msx_bus.pio, msx_bus.sm_write, false);
     pio_sm_clear_fifos(msx_bus.pio, msx_bus.sm_read);
     pio_sm_clear_fifos(msx_bus.pio, msx_bus.sm_write);
     pio_sm_restart(msx_bus.pio, msx_bus.sm_read);
     pio_sm_restart(msx_bus.pio, msx_bus.sm_write);
-
-    pio_sm_config cfg_read = msx_read_responder_program_get_default_config(msx_bus.offset_read);
+    pio_interrupt_clear(msx_bus.pio, READ_DEADLINE_IRQ_FLAG);
+
+    uint offset_read = msx_bus.offset_read;
+    pio_sm_config cfg_read = dma_table
+        ? msx_read_responder_dma_program_get_default_config(offset_read)
+        : fast_reads
+        ? msx_read_responder_fast_program_get_default_config(offset_read)
+        : msx_read_responder_program_get_default_config(offset_read);
+    if (dma_table || fast_reads)
+        sm_config_set_mov_status(&cfg_read, STATUS_TX_LESSTHAN, 1);
     sm_config_set_in_pins(&cfg_read, PIN_A0);
-    sm_config_set_in_shift(&cfg_read, false, false, 16);
+    sm_config_set_in_shift(&cfg_read, false, false, dma_table ? 32 : 16);
     sm_config_set_out_pins(&cfg_read, PIN_D0, 8);
     sm_config_set_out_shift(&cfg_read, true, false, 32);
     sm_config_set_set_pins(&cfg_read, PIN_WAIT, 1);
     sm_config_set_jmp_pin(&cfg_read, PIN_RD);
     sm_config_set_clkdiv(&cfg_read, 1.0f);
-    pio_sm_init(msx_bus.pio, msx_bus.sm_read, msx_bus.offset_read, &cfg_read);
+    pio_sm_init(msx_bus.pio, msx_bus.sm_read, offset_read, &cfg_read);
+
+    if (dma_table)
+    {
+        pio_sm_put(msx_bus.pio, msx_bus.sm_read, (uint32_t)(uintptr_t)dma_table >> 16);
+        pio_sm_exec(msx_bus.pio, msx_bus.sm_read, pio_encode_pull(false, false));
+        pio_sm_exec(msx_bus.pio, msx_bus.sm_read, pio_encode_mov(pio_x, pio_osr));
+    }
 
     pio_sm_config cfg_write = msx_write_captor_program_get_default_config(msx_bus.offset_write);
     sm_config_set_in_pins(&cfg_write, PIN_A0);
@@ -3391,6 +4622,71 @@ static void msx_pio_bus_init(void)
     pio_sm_set_enabled(msx_bus.pio, msx_bus.sm_write, true);
 }
 
+// Mapper loops call this after preparing their ROM source. Only a loop that
+// set bus_reads_sram (the plain and linear fallback when the DMA responder
+// is unavailable) answers fast enough to skip /WAIT, so it gets the deadline
+// responder; anything that may read flash or PSRAM (rom_sram is a PSRAM
+// region too), or a host measured too fast for any deadline, keeps the
+// responder that holds the Z80 on every read.
+static void msx_pio_bus_init(void)
+{
+    bool fast = bus_reads_sram && bus_read_deadline_ns() >= READ_DEADLINE_MIN_NS;
+    msx_pio_bus_start(NULL, fast);
+}
+
+// -----------------------------------------------------------------------
+// I/O read ownership. msx_io_read_responder only hands the CPU reads of
+// the 8-port blocks the running mode owns (bit n = ports n*8..n*8+7);
+// every other port read completes without the CPU seeing it. The block
+// numbers are patched into the program's compare slots, so it is reloaded
+// whenever the set changes.
+// -----------------------------------------------------------------------
+#define IO_PORT_BLOCK(port) (1u << ((port) >> 3))
+#define IO_READ_SLOTS       3u
+
+static uint32_t msx_io_read_owned = 0;  // blocks owned by the running mode
+static uint32_t msx_io_read_loaded = 0; // blocks the loaded program answers
+
+static void msx_io_read_load_program(uint32_t owned)
+{
+    if (msx_io_read_program_loaded)
+    {
+        if (owned == msx_io_read_loaded)
+            return;
+        pio_remove_program(msx_io_bus.pio_read, &msx_io_read_responder_program, msx_io_bus.offset_io_read);
+    }
+
+    uint16_t instructions[sizeof(msx_io_read_responder_program_instructions) / sizeof(uint16_t)];
+    memcpy(instructions, msx_io_read_responder_program_instructions, sizeof(instructions));
+
+    uint32_t slot = 0;
+    for (uint32_t block = 0; block < 32u; ++block)
+    {
+        if (!(owned & (1u << block)))
+            continue;
+        if (slot == IO_READ_SLOTS)
+        {
+            // More blocks than slots: pass every read to the CPU.
+            printf("IO: %08lx owns too many port blocks, filter off\n", (unsigned long)owned);
+            instructions[msx_io_read_responder_offset_slots + 1u] = (uint16_t)pio_encode_jmp(msx_io_read_responder_offset_respond);
+            break;
+        }
+        instructions[msx_io_read_responder_offset_slots + 3u * slot] = (uint16_t)pio_encode_set(pio_y, block);
+        slot++;
+    }
+    for (; slot < IO_READ_SLOTS; ++slot)
+        instructions[msx_io_read_responder_offset_slots + 3u * slot + 2u] = (uint16_t)pio_encode_jmp(msx_io_read_responder_offset_ignore);
+
+    pio_program_t program = msx_io_read_responder_program;
+    program.instructions = instructions;
+    msx_io_bus.offset_io_read = pio_add_program(msx_io_bus.pio_read, &program);
+    msx_io_read_loaded = owned;
+    msx_io_read_program_loaded = true;
+}
+
+// Starts the I/O bus state machines for the ports currently in
+// msx_io_read_owned. Audio set-up calls this too, so the mode's ports
+// survive a late PSG/OPLL start.
 static void msx_pio_io_bus_init(void)
 {
     msx_io_bus.pio_read = pio2;
@@ -3398,19 +4694,16 @@ static void msx_pio_io_bus_init(void)
     msx_io_bus.sm_io_read  = 0;
     msx_io_bus.sm_io_write = 1;
 
-    if (!msx_io_read_program_loaded)
-    {
-        msx_io_bus.offset_io_read = pio_add_program(msx_io_bus.pio_read, &msx_io_read_responder_program);
-        msx_io_read_program_loaded = true;
-    }
+    pio_sm_set_enabled(msx_io_bus.pio_read, msx_io_bus.sm_io_read, false);
+    pio_sm_set_enabled(msx_io_bus.pio_write, msx_io_bus.sm_io_write, false);
+
+    msx_io_read_load_program(msx_io_read_owned);
     if (!msx_io_write_program_loaded)
     {
         msx_io_bus.offset_io_write = pio_add_program(msx_io_bus.pio_write, &msx_io_write_captor_program);
         msx_io_write_program_loaded = true;
     }
 
-    pio_sm_set_enabled(msx_io_bus.pio_read, msx_io_bus.sm_io_read, false);
-    pio_sm_set_enabled(msx_io_bus.pio_write, msx_io_bus.sm_io_write, false);
     pio_sm_clear_fifos(msx_io_bus.pio_read, msx_io_bus.sm_io_read);
     pio_sm_clear_fifos(msx_io_bus.pio_write, msx_io_bus.sm_io_write);
     pio_sm_restart(msx_io_bus.pio_read, msx_io_bus.sm_io_read);
@@ -3433,46 +4726,468 @@ static void msx_pio_io_bus_init(void)
     sm_config_set_clkdiv(&cfg_io_write, 1.0f);
     pio_sm_init(msx_io_bus.pio_write, msx_io_bus.sm_io_write, msx_io_bus.offset_io_write, &cfg_io_write);
 
-    pio_sm_set_consecutive_pindirs(msx_io_bus.pio_read, msx_io_bus.sm_io_read, PIN_D0, 8, false);
+    pio_sm_set_consecutive_pindirs(msx_io_bus.pio_read, msx_io_bus.sm_io_read, PIN_D0, 8, false);
+
+    pio_sm_set_enabled(msx_io_bus.pio_read, msx_io_bus.sm_io_read, true);
+    pio_sm_set_enabled(msx_io_bus.pio_write, msx_io_bus.sm_io_write, true);
+}
+
+// Mapper loops declare the I/O ports they answer before starting the bus.
+static void msx_pio_io_bus_init_ports(uint32_t owned_blocks)
+{
+    msx_io_read_owned = owned_blocks;
+    msx_pio_io_bus_init();
+}
+
+static void msx_pio_io_write_bus_init(void)
+{
+    msx_io_bus.pio_write = pio2;
+    msx_io_bus.sm_io_write = 1;
+
+    if (!msx_io_write_program_loaded)
+    {
+        msx_io_bus.offset_io_write = pio_add_program(msx_io_bus.pio_write, &msx_io_write_captor_program);
+        msx_io_write_program_loaded = true;
+    }
+
+    pio_sm_set_enabled(msx_io_bus.pio_write, msx_io_bus.sm_io_write, false);
+    pio_sm_clear_fifos(msx_io_bus.pio_write, msx_io_bus.sm_io_write);
+    pio_sm_restart(msx_io_bus.pio_write, msx_io_bus.sm_io_write);
+
+    pio_sm_config cfg_io_write = msx_io_write_captor_program_get_default_config(msx_io_bus.offset_io_write);
+    sm_config_set_in_pins(&cfg_io_write, PIN_A0);
+    sm_config_set_in_shift(&cfg_io_write, false, false, 32);
+    sm_config_set_fifo_join(&cfg_io_write, PIO_FIFO_JOIN_RX);
+    sm_config_set_jmp_pin(&cfg_io_write, PIN_WR);
+    sm_config_set_clkdiv(&cfg_io_write, 1.0f);
+    pio_sm_init(msx_io_bus.pio_write, msx_io_bus.sm_io_write, msx_io_bus.offset_io_write, &cfg_io_write);
+    pio_sm_set_enabled(msx_io_bus.pio_write, msx_io_bus.sm_io_write, true);
+}
+
+static inline uint8_t __not_in_flash_func(read_rom_byte)(const uint8_t *rom_base, uint32_t rel)
+{
+    uint32_t cached = rel - rom_cache_base; // wraps above rom_cached_size below the window
+    return (cached < rom_cached_size) ? rom_sram[cached] : rom_base[rel];
+}
+
+static inline uint16_t __not_in_flash_func(pio_build_token)(bool drive, uint8_t data)
+{
+    uint8_t dir_mask = drive ? 0xFFu : 0x00u;
+    return (uint16_t)data | ((uint16_t)dir_mask << 8);
+}
+
+// -----------------------------------------------------------------------
+// WAIT-length statistics (EXPLORER_WAIT_STATS builds only). Measures the
+// sys-clock cycles between taking a read address from the responder and
+// handing back its token - the part of each /WAIT the firmware controls -
+// into power-of-two buckets (bucket n covers < 64 << n cycles). It also
+// counts the reads where the deadline responder had to assert /WAIT, and
+// tags the record with the mapper it was taken under. The histogram is
+// flushed to the PSRAM table page every 2^20 reads, so the next boot can
+// report what the last session saw.
+// -----------------------------------------------------------------------
+#define WAIT_STATS_BUCKETS      8u
+#define WAIT_STATS_MAGIC        0x32535457u // "WTS2"
+#define WAIT_STATS_PSRAM_OFFSET (RECENT_ROM_TABLE_OFFSET + 2048u)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t mode;          // mapper code of the session
+    uint32_t fast_reads;    // 1 when the deadline responder was running
+    uint32_t samples;
+    uint32_t late;          // reads that still needed /WAIT
+    uint32_t max_cycles;
+    uint32_t hist[WAIT_STATS_BUCKETS];
+} wait_stats_t;
+
+#if EXPLORER_WAIT_STATS
+static wait_stats_t wait_stats;
+static uint8_t wait_stats_mode;
+
+static inline void wait_stats_set_mode(uint8_t mapper)
+{
+    wait_stats_mode = mapper;
+}
+
+static void wait_stats_reset(void)
+{
+    memset(&wait_stats, 0, sizeof(wait_stats));
+    wait_stats.magic = WAIT_STATS_MAGIC;
+    wait_stats.mode = wait_stats_mode;
+    wait_stats.fast_reads = (msx_bus_read_program == &msx_read_responder_fast_program) ? 1u : 0u;
+    systick_hw->rvr = 0x00FFFFFFu;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5u; // processor clock, counter enabled, no IRQ
+}
+
+static inline uint32_t __not_in_flash_func(wait_stats_begin)(void)
+{
+    return systick_hw->cvr;
+}
+
+static inline void __not_in_flash_func(wait_stats_end)(uint32_t start)
+{
+    uint32_t cycles = (start - systick_hw->cvr) & 0x00FFFFFFu;
+    uint32_t bucket = (cycles < 64u) ? 0u : (32u - (uint32_t)__builtin_clz(cycles >> 6));
+    if (bucket >= WAIT_STATS_BUCKETS) bucket = WAIT_STATS_BUCKETS - 1u;
+    wait_stats.hist[bucket]++;
+    if (cycles > wait_stats.max_cycles) wait_stats.max_cycles = cycles;
+    // The flag is sticky, so a late read seen a few cycles after its token
+    // was handed over is counted on the next read instead.
+    if (msx_bus.pio->irq & (1u << READ_DEADLINE_IRQ_FLAG))
+    {
+        msx_bus.pio->irq = 1u << READ_DEADLINE_IRQ_FLAG;
+        wait_stats.late++;
+    }
+    if ((++wait_stats.samples & 0xFFFFFu) == 0u && psram_mgr.initialised)
+        memcpy((void *)(PSRAM_NOCACHE_ADDR + WAIT_STATS_PSRAM_OFFSET), &wait_stats, sizeof(wait_stats));
+}
+#else
+static inline void wait_stats_set_mode(uint8_t mapper) { (void)mapper; }
+static inline void wait_stats_reset(void) { }
+static inline uint32_t wait_stats_begin(void) { return 0u; }
+static inline void wait_stats_end(uint32_t start) { (void)start; }
+#endif
+
+// Prints (and clears) the histogram left by the previous session.
+static void wait_stats_report_previous(void)
+{
+    wait_stats_t prev;
+    memcpy(&prev, (const void *)(PSRAM_NOCACHE_ADDR + WAIT_STATS_PSRAM_OFFSET), sizeof(prev));
+    if (prev.magic != WAIT_STATS_MAGIC || prev.samples == 0u) return;
+
+    uint32_t mhz = clock_get_hz(clk_sys) / 1000000u;
+    printf("WAIT: mapper %lu, %s responder, %lu reads, %lu needed /WAIT, max %lu ns\n",
+           (unsigned long)prev.mode, prev.fast_reads ? "deadline" : "always-wait",
+           (unsigned long)prev.samples, (unsigned long)prev.late,
+           (unsigned long)((prev.max_cycles * 1000u) / mhz));
+    for (uint32_t i = 0; i < WAIT_STATS_BUCKETS; i++)
+        printf("WAIT:  <%5lu ns %lu\n", (unsigned long)(((64u << i) * 1000u) / mhz), (unsigned long)prev.hist[i]);
+
+    prev.magic = 0;
+    memcpy((void *)(PSRAM_NOCACHE_ADDR + WAIT_STATS_PSRAM_OFFSET), &prev, sizeof(prev));
+}
+
+// -----------------------------------------------------------------------
+// Per-title runtime profiles. While a title runs, the firmware notes which
+// emulated chips it really drives, the peak register writes per second of
+// each, the 8 KB banks it maps and the seconds in which a read missed its
+// deadline. Once a second the profile is published to the PSRAM table page,
+// so it survives the reset that ends the session. The next launch moves it
+// to a .PVR file next to the title's .PVC (merged with what earlier sessions
+// saw) and reads back the profile of the title being launched:
+//  - titles without a saved .PVC drop the default SCC or PSG mirror when the
+//    chip was emulated for TITLE_PROFILE_MIN_SECONDS and never made a sound;
+//  - images larger than the ROM cache get the cache window that holds most
+//    of the banks the title used, instead of always the first CACHE_SIZE.
+// The audio core publishes after a buffer. Without one, the bank-switch path
+// only flags that a publish is due, and the core0 read loop runs it while no
+// read is pending.
+// -----------------------------------------------------------------------
+#define TITLE_PROFILE_MAGIC         0x31525650u // "PVR1"
+#define TITLE_PROFILE_PSRAM_OFFSET  (RECENT_ROM_TABLE_OFFSET + 3072u)
+#define TITLE_PROFILE_PATH_OFFSET   (RECENT_ROM_TABLE_OFFSET + 3328u)
+#define TITLE_PROFILE_MIN_SECONDS   30u
+#define TITLE_PROFILE_BANKS         256u        // 8 KB banks tracked (2MB)
+
+enum {
+    TITLE_CHIP_PSG,
+    TITLE_CHIP_SCC,
+    TITLE_CHIP_OPLL,
+    TITLE_CHIP_OPM,
+    TITLE_CHIP_OPL4,
+    TITLE_CHIP_COUNT
+};
+
+typedef struct {
+    uint32_t magic;
+    uint32_t key;           // FNV-1a of the .PVR path
+    uint32_t seconds;       // profiled run time, summed over sessions
+    uint32_t late_seconds;  // seconds in which a read needed /WAIT past its deadline
+    uint8_t mapper;
+    uint8_t observed;       // chips emulated while profiling (bit per TITLE_CHIP_*)
+    uint8_t used;           // chips the title made sound with
+    uint8_t reserved;
+    uint16_t peak_writes[TITLE_CHIP_COUNT]; // register writes per second (SCC writes are not counted)
+    uint16_t reserved2;
+    uint32_t banks[TITLE_PROFILE_BANKS / 32u];
+    uint32_t check;         // FNV-1a of everything above
+} title_profile_t;
+
+static title_profile_t title_profile;
+static char title_profile_path[SD_PATH_MAX];
+static bool title_profile_path_valid = false;
+static volatile bool title_profile_running = false;
+static volatile bool title_profile_audio_ticks = false;
+static volatile bool title_profile_due = false;
+static volatile uint32_t title_profile_writes[TITLE_CHIP_COUNT];
+static uint32_t title_profile_last_writes[TITLE_CHIP_COUNT];
+static uint32_t title_profile_last_tick;
+static volatile bool title_profile_psg_audible;
+static volatile bool title_profile_scc_audible;
+static uint8_t title_profile_psg_latch;
+
+static bool title_profile_valid(const title_profile_t *p)
+{
+    return p->magic == TITLE_PROFILE_MAGIC &&
+           p->check == recent_rom_fnv(p, offsetof(title_profile_t, check));
+}
+
+static void __no_inline_not_in_flash_func(title_profile_store)(void)
+{
+    // core0 may set bank bits while this runs; check a stable copy.
+    title_profile_t snap = title_profile;
+    snap.check = recent_rom_fnv(&snap, offsetof(title_profile_t, check));
+    memcpy((void *)(PSRAM_NOCACHE_ADDR + TITLE_PROFILE_PSRAM_OFFSET), &snap, sizeof(snap));
+}
+
+static void __no_inline_not_in_flash_func(title_profile_publish)(uint32_t elapsed_us)
+{
+    uint32_t secs = elapsed_us / 1000000u;
+    title_profile.seconds += secs;
+    for (uint32_t i = 0; i < TITLE_CHIP_COUNT; i++)
+    {
+        uint32_t count = title_profile_writes[i];
+        uint32_t rate = (count - title_profile_last_writes[i]) / secs;
+        title_profile_last_writes[i] = count;
+        if (rate > 0xFFFFu) rate = 0xFFFFu;
+        if (rate > title_profile.peak_writes[i]) title_profile.peak_writes[i] = (uint16_t)rate;
+        // The BIOS initialises the PSG on every boot, so only a raised
+        // volume counts for it; any data write counts for the others.
+        if (i >= TITLE_CHIP_OPLL && count != 0u) title_profile.used |= (uint8_t)(1u << i);
+    }
+    if (title_profile_psg_audible) title_profile.used |= 1u << TITLE_CHIP_PSG;
+    if (title_profile_scc_audible) title_profile.used |= 1u << TITLE_CHIP_SCC;
+    if (msx_bus.pio->irq & (1u << READ_DEADLINE_IRQ_FLAG))
+    {
+        title_profile.late_seconds++;
+#if !EXPLORER_WAIT_STATS
+        msx_bus.pio->irq = 1u << READ_DEADLINE_IRQ_FLAG;
+#endif
+    }
+
+    title_profile_store();
+}
+
+static inline void __not_in_flash_func(title_profile_tick)(void)
+{
+    if (!title_profile_running)
+        return;
+    uint32_t elapsed = time_us_32() - title_profile_last_tick;
+    if (elapsed < 1000000u)
+        return;
+    title_profile_last_tick += elapsed;
+    title_profile_publish(elapsed);
+}
+
+static inline void __not_in_flash_func(title_profile_audio_tick)(void)
+{
+    title_profile_audio_ticks = true;
+    if (!title_profile_running)
+        return;
+    if ((title_profile.observed & (1u << TITLE_CHIP_SCC)) &&
+        (scc_instance.volume[0] | scc_instance.volume[1] | scc_instance.volume[2] |
+         scc_instance.volume[3] | scc_instance.volume[4]) != 0u)
+        title_profile_scc_audible = true;
+    title_profile_tick();
+}
+
+static inline void __not_in_flash_func(title_profile_note_bank)(uint32_t block)
+{
+    if (block < TITLE_PROFILE_BANKS)
+        title_profile.banks[block >> 5] |= 1u << (block & 31u);
+    if (!title_profile_audio_ticks && title_profile_running &&
+        time_us_32() - title_profile_last_tick >= 1000000u)
+        title_profile_due = true;
+}
+
+// Read loops without an audio core call this between reads.
+static inline void __not_in_flash_func(title_profile_idle)(void)
+{
+    if (title_profile_due && pio_sm_is_rx_fifo_empty(msx_bus.pio, msx_bus.sm_read))
+    {
+        title_profile_due = false;
+        title_profile_tick();
+    }
+}
 
-    pio_sm_set_enabled(msx_io_bus.pio_read, msx_io_bus.sm_io_read, true);
-    pio_sm_set_enabled(msx_io_bus.pio_write, msx_io_bus.sm_io_write, true);
+static inline void __not_in_flash_func(title_profile_note_write)(uint32_t chip)
+{
+    title_profile_writes[chip]++;
 }
 
-static void msx_pio_io_write_bus_init(void)
+static inline void __not_in_flash_func(title_profile_note_psg)(uint8_t port, uint8_t data)
 {
-    msx_io_bus.pio_write = pio2;
-    msx_io_bus.sm_io_write = 1;
+    if (port == MAIN_PSG_PORT_REG)
+    {
+        title_profile_psg_latch = data;
+        return;
+    }
+    title_profile_writes[TITLE_CHIP_PSG]++;
+    if (title_profile_psg_latch >= 8u && title_profile_psg_latch <= 10u && (data & 0x1Fu) != 0u)
+        title_profile_psg_audible = true;
+}
 
-    if (!msx_io_write_program_loaded)
+// Move the profile of the previous session from PSRAM to its .PVR file,
+// merged with what earlier sessions recorded. Call with the card mounted.
+static void title_profile_collect(void)
+{
+    title_profile_t prof;
+    char path[SD_PATH_MAX];
+    memcpy(&prof, (const void *)(PSRAM_NOCACHE_ADDR + TITLE_PROFILE_PSRAM_OFFSET), sizeof(prof));
+    memcpy(path, (const void *)(PSRAM_NOCACHE_ADDR + TITLE_PROFILE_PATH_OFFSET), sizeof(path));
+    path[sizeof(path) - 1] = '\0';
+    if (!title_profile_valid(&prof) || prof.key != recent_rom_fnv(path, (uint32_t)strlen(path)))
+        return;
+
+    uint32_t cleared = 0;
+    memcpy((void *)(PSRAM_NOCACHE_ADDR + TITLE_PROFILE_PSRAM_OFFSET), &cleared, sizeof(cleared));
+    if (prof.seconds == 0u)
+        return;
+
+    FIL fil;
+    title_profile_t old;
+    UINT br = 0;
+    if (f_open(&fil, path, FA_READ) == FR_OK)
     {
-        msx_io_bus.offset_io_write = pio_add_program(msx_io_bus.pio_write, &msx_io_write_captor_program);
-        msx_io_write_program_loaded = true;
+        if (f_read(&fil, &old, sizeof(old), &br) == FR_OK && br == sizeof(old) &&
+            title_profile_valid(&old) && old.key == prof.key)
+        {
+            prof.seconds += old.seconds;
+            prof.late_seconds += old.late_seconds;
+            prof.observed |= old.observed;
+            prof.used |= old.used;
+            for (uint32_t i = 0; i < TITLE_CHIP_COUNT; i++)
+                if (old.peak_writes[i] > prof.peak_writes[i]) prof.peak_writes[i] = old.peak_writes[i];
+            for (uint32_t i = 0; i < TITLE_PROFILE_BANKS / 32u; i++)
+                prof.banks[i] |= old.banks[i];
+        }
+        f_close(&fil);
     }
+    prof.check = recent_rom_fnv(&prof, offsetof(title_profile_t, check));
 
-    pio_sm_set_enabled(msx_io_bus.pio_write, msx_io_bus.sm_io_write, false);
-    pio_sm_clear_fifos(msx_io_bus.pio_write, msx_io_bus.sm_io_write);
-    pio_sm_restart(msx_io_bus.pio_write, msx_io_bus.sm_io_write);
+    UINT bw = 0;
+    if (f_open(&fil, path, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+        return;
+    FRESULT fr = f_write(&fil, &prof, sizeof(prof), &bw);
+    FRESULT close_fr = f_close(&fil);
+    printf("PROFILE: %s %lus, chips used %02X of %02X, %lus late%s\n", path,
+           (unsigned long)prof.seconds, prof.used, prof.observed, (unsigned long)prof.late_seconds,
+           (fr == FR_OK && close_fr == FR_OK && bw == sizeof(prof)) ? "" : " (write failed)");
+}
 
-    pio_sm_config cfg_io_write = msx_io_write_captor_program_get_default_config(msx_io_bus.offset_io_write);
-    sm_config_set_in_pins(&cfg_io_write, PIN_A0);
-    sm_config_set_in_shift(&cfg_io_write, false, false, 32);
-    sm_config_set_fifo_join(&cfg_io_write, PIO_FIFO_JOIN_RX);
-    sm_config_set_jmp_pin(&cfg_io_write, PIN_WR);
-    sm_config_set_clkdiv(&cfg_io_write, 1.0f);
-    pio_sm_init(msx_io_bus.pio_write, msx_io_bus.sm_io_write, msx_io_bus.offset_io_write, &cfg_io_write);
-    pio_sm_set_enabled(msx_io_bus.pio_write, msx_io_bus.sm_io_write, true);
+// Window of CACHE_SIZE bytes holding most of the banks in the profile, or
+// 0 when the leading window is as good.
+static uint32_t title_profile_cache_window(const title_profile_t *prof, uint32_t rom_size)
+{
+    uint32_t blocks = (rom_size + 0x1FFFu) >> 13;
+    uint32_t window = CACHE_SIZE >> 13;
+    if (blocks > TITLE_PROFILE_BANKS) blocks = TITLE_PROFILE_BANKS;
+    if (blocks <= window)
+        return 0u;
+
+    uint8_t hot[TITLE_PROFILE_BANKS];
+    memset(hot, 0, sizeof(hot));
+    for (uint32_t b = 0; b < TITLE_PROFILE_BANKS; b++)
+        if (prof->banks[b >> 5] & (1u << (b & 31u)))
+            hot[(b < blocks) ? b : (b & (blocks - 1u))] = 1u; // same wrap as the mapper loops
+
+    uint32_t count = 0;
+    for (uint32_t b = 0; b < window; b++) count += hot[b];
+    uint32_t best = count, best_start = 0;
+    for (uint32_t start = 1; start + window <= blocks; start++)
+    {
+        count += hot[start + window - 1u];
+        count -= hot[start - 1u];
+        if (count > best)
+        {
+            best = count;
+            best_start = start;
+        }
+    }
+    return best_start << 13;
 }
 
-static inline uint8_t __not_in_flash_func(read_rom_byte)(const uint8_t *rom_base, uint32_t rel)
+// Collect the last session's profile, then read back the profile of the
+// title about to launch and tune its options. Runs while /WAIT is held.
+static void title_profile_prepare_launch(uint32_t record_index, uint32_t rom_size)
 {
-    return (rel < rom_cached_size) ? rom_sram[rel] : rom_base[rel];
+    title_profile_running = false;
+    title_profile_path_valid = false;
+    rom_cache_window_plan = 0;
+    // Flash titles only use the card when it is already mounted, so their
+    // launch does not wait for an SD mount. The previous session's profile
+    // then stays in PSRAM for the next launch that has the card.
+    bool sd_title = record_index < full_record_count && (records[record_index].Mapper & SOURCE_SD_FLAG) != 0;
+    if (!psram_bring_up_once() || (!sd_title && !sd_mounted) || !sd_mount_card())
+        return;
+    title_profile_collect();
+
+    char pvc_path[SD_PATH_MAX];
+    if (!build_pvc_options_path(record_index, pvc_path, sizeof(pvc_path)))
+        return;
+    size_t len = strlen(pvc_path);
+    memcpy(title_profile_path, pvc_path, len + 1u);
+    title_profile_path[len - 1u] = 'R'; // .PVC -> .PVR
+    title_profile_path_valid = true;
+
+    FIL fil;
+    title_profile_t prof;
+    UINT br = 0;
+    if (f_open(&fil, title_profile_path, FA_READ) != FR_OK)
+        return;
+    FRESULT fr = f_read(&fil, &prof, sizeof(prof), &br);
+    f_close(&fil);
+    if (fr != FR_OK || br != sizeof(prof) || !title_profile_valid(&prof) ||
+        prof.key != recent_rom_fnv(title_profile_path, (uint32_t)len))
+        return;
+
+    rom_cache_window_plan = title_profile_cache_window(&prof, rom_size);
+    if (rom_cache_window_plan != 0u)
+        printf("PROFILE: caching from 0x%06lX\n", (unsigned long)rom_cache_window_plan);
+
+    // Options saved by hand always win.
+    FILINFO info;
+    if (f_stat(pvc_path, &info) == FR_OK || prof.seconds < TITLE_PROFILE_MIN_SECONDS)
+        return;
+    uint8_t silent = prof.observed & (uint8_t)~prof.used;
+    if (ctrl_audio_selection == AUDIO_PROFILE_SCC && (silent & (1u << TITLE_CHIP_SCC)))
+    {
+        ctrl_audio_selection = AUDIO_PROFILE_NONE;
+        printf("PROFILE: SCC never used, not emulated\n");
+    }
+    if (ctrl_psg_emulation && (silent & (1u << TITLE_CHIP_PSG)))
+    {
+        ctrl_psg_emulation = 0;
+        printf("PROFILE: PSG never audible, mirror off\n");
+    }
 }
 
-static inline uint16_t __not_in_flash_func(pio_build_token)(bool drive, uint8_t data)
+// Start profiling the launched title; observed has a bit per TITLE_CHIP_*
+// the session emulates.
+static void title_profile_begin(uint8_t mapper, uint8_t observed)
 {
-    uint8_t dir_mask = drive ? 0xFFu : 0x00u;
-    return (uint16_t)data | ((uint16_t)dir_mask << 8);
+    if (!title_profile_path_valid)
+        return;
+    memset(&title_profile, 0, sizeof(title_profile));
+    title_profile.magic = TITLE_PROFILE_MAGIC;
+    title_profile.key = recent_rom_fnv(title_profile_path, (uint32_t)strlen(title_profile_path));
+    title_profile.mapper = mapper;
+    title_profile.observed = observed;
+    for (uint32_t i = 0; i < TITLE_CHIP_COUNT; i++)
+    {
+        title_profile_writes[i] = 0;
+        title_profile_last_writes[i] = 0;
+    }
+    title_profile_psg_audible = false;
+    title_profile_scc_audible = false;
+    title_profile_audio_ticks = false;
+    title_profile_due = false;
+    memcpy((void *)(PSRAM_NOCACHE_ADDR + TITLE_PROFILE_PATH_OFFSET), title_profile_path, sizeof(title_profile_path));
+    title_profile_store();
+    title_profile_last_tick = time_us_32();
+    __dmb();
+    title_profile_running = true;
 }
 
 static inline bool __not_in_flash_func(pio_try_get_write)(uint16_t *addr_out, uint8_t *data_out)
@@ -3653,6 +5368,7 @@ static inline bool __not_in_flash_func(main_psg_handle_io_write)(uint8_t port, u
         return false;
     if (port == MAIN_PSG_PORT_REG || port == MAIN_PSG_PORT_DATA)
     {
+        title_profile_note_psg(port, data);
         if (!main_psg_core1_services_io)
         {
             // Called from core0 while it owns the MSX I/O write FIFO (mapper mode).
@@ -3840,6 +5556,7 @@ static void __no_inline_not_in_flash_func(core1_dual_psg_audio)(void)
                 }
                 buffer->sample_count = SCC_AUDIO_BUFFER_SAMPLES;
                 give_audio_buffer(dual_psg_audio_pool, buffer);
+                title_profile_audio_tick();
                 break;
             }
             tight_loop_contents();
@@ -3942,6 +5659,7 @@ static inline void __not_in_flash_func(dual_psg_audio_service_buffer)(void)
     }
     buffer->sample_count = SCC_AUDIO_BUFFER_SAMPLES;
     give_audio_buffer(dual_psg_audio_pool, buffer);
+    title_profile_audio_tick();
 }
 
 static void __no_inline_not_in_flash_func(core1_main_psg_audio)(void)
@@ -3964,6 +5682,7 @@ static void __no_inline_not_in_flash_func(core1_main_psg_audio)(void)
                 }
                 buffer->sample_count = SCC_AUDIO_BUFFER_SAMPLES;
                 give_audio_buffer(main_psg_audio_pool, buffer);
+                title_profile_audio_tick();
                 break;
             }
             tight_loop_contents();
@@ -4054,6 +5773,7 @@ static inline void __not_in_flash_func(main_psg_audio_service_buffer)(void)
     }
     buffer->sample_count = SCC_AUDIO_BUFFER_SAMPLES;
     give_audio_buffer(main_psg_audio_pool, buffer);
+    title_profile_audio_tick();
 }
 
 static void start_main_psg_audio(bool service_io_on_core1)
@@ -4320,6 +6040,8 @@ static inline void __not_in_flash_func(msx_music_write_io)(uint8_t port, uint8_t
 {
     if (!msx_music_ready)
         return;
+    if (port == MSX_MUSIC_PORT_DATA)
+        title_profile_note_write(TITLE_CHIP_OPLL);
 
     if (!msx_music_core1_services_io)
     {
@@ -4417,6 +6139,7 @@ static void __no_inline_not_in_flash_func(core1_msx_music_audio)(void)
                 }
                 buffer->sample_count = SCC_AUDIO_BUFFER_SAMPLES;
                 give_audio_buffer(msx_music_audio_pool, buffer);
+                title_profile_audio_tick();
                 break;
             }
             tight_loop_contents();
@@ -4521,6 +6244,7 @@ static inline void __not_in_flash_func(msx_music_audio_service_buffer)(void)
     }
     buffer->sample_count = SCC_AUDIO_BUFFER_SAMPLES;
     give_audio_buffer(msx_music_audio_pool, buffer);
+    title_profile_audio_tick();
 }
 
 static void ym2151_init(ym2151_sfg_variant_t variant)
@@ -4599,91 +6323,378 @@ static inline void __not_in_flash_func(ym2151_service_writes_locked)(uint32_t bu
     }
 }
 
-static inline uint8_t __not_in_flash_func(ym2151_read_status)(void)
+static inline uint8_t __not_in_flash_func(ym2151_read_status)(void)
+{
+    if (!ym2151_ready)
+        return 0xFFu;
+
+    ym2151_write_queue_overflow = false;
+    return ym2151_status_latch;
+}
+
+static inline void __not_in_flash_func(ym2151_select_register)(uint8_t reg)
+{
+    ym2151_address_latch = reg;
+}
+
+static inline void __not_in_flash_func(ym2151_write_register_data)(uint8_t data)
+{
+    if (!ym2151_ready)
+        return;
+    title_profile_note_write(TITLE_CHIP_OPM);
+
+    uint32_t save = spin_lock_blocking(ym2151_lock);
+    ym2151_queue_register_write_locked(ym2151_address_latch, data);
+    spin_unlock(ym2151_lock, save);
+}
+
+static inline void __not_in_flash_func(ym2151_calc_stereo_sample)(int16_t *samples, int index)
+{
+    int32_t opm_out[2] = {0, 0};
+
+    if (ym2151_ready)
+    {
+        ym2151_service_writes_locked(YM2151_WRITE_SERVICE_BUDGET);
+        ym2151_clock_accum += YM2151_CLOCK;
+        while (ym2151_clock_accum >= (YM2151_SAMPLE_RATE * YM2151_FRAME_DIVIDER))
+        {
+            ym2151_clock_frame_locked();
+            ym2151_clock_accum -= (YM2151_SAMPLE_RATE * YM2151_FRAME_DIVIDER);
+        }
+        ym2151_status_latch = (uint8_t)(OPM_Read(&ym2151_instance, 1u) & 0x7Fu);
+        opm_out[0] = scale_sample_percent_i32(ym2151_last_output[0], YM2151_BASE_VOLUME_PERCENT);
+        opm_out[1] = scale_sample_percent_i32(ym2151_last_output[1], YM2151_BASE_VOLUME_PERCENT);
+    }
+
+    int16_t psg = 0;
+    (void)main_psg_calc_audible_sample_shifted(YM2151_PSG_VOLUME_SHIFT, &psg);
+    samples[index * 2] = apply_audio_volume(opm_out[0] + psg);
+    samples[index * 2 + 1] = apply_audio_volume(opm_out[1] + psg);
+}
+
+static inline void __not_in_flash_func(ym2151_audio_service_buffer)(bool service_psg_io)
+{
+    if (!ym2151_audio_started || !ym2151_audio_pool)
+        return;
+
+    if (service_psg_io)
+        main_psg_service_io();
+
+    struct audio_buffer *buffer = take_audio_buffer(ym2151_audio_pool, false);
+    if (!buffer)
+        return;
+
+    int16_t *samples = (int16_t *)buffer->buffer->bytes;
+    for (int i = 0; i < SCC_AUDIO_BUFFER_SAMPLES; i++)
+    {
+        if (service_psg_io)
+            main_psg_service_io();
+        ym2151_calc_stereo_sample(samples, i);
+    }
+    buffer->sample_count = SCC_AUDIO_BUFFER_SAMPLES;
+    give_audio_buffer(ym2151_audio_pool, buffer);
+    title_profile_audio_tick();
+}
+
+static void __no_inline_not_in_flash_func(core1_ym2151_audio)(void)
+{
+    while (true)
+    {
+        ym2151_audio_service_buffer(true);
+        tight_loop_contents();
+    }
+}
+
+static void ym2151_audio_init(void)
+{
+    if (ym2151_audio_started)
+        return;
+
+    gpio_init(I2S_MUTE_PIN);
+    gpio_set_dir(I2S_MUTE_PIN, GPIO_OUT);
+    gpio_put(I2S_MUTE_PIN, 1);
+
+    struct audio_buffer_pool *handoff_pool = claim_rom_audio_handoff_pool();
+    if (handoff_pool)
+    {
+        ym2151_audio_pool = handoff_pool;
+        ym2151_audio_started = true;
+        return;
+    }
+
+    static audio_format_t ym2151_audio_format = {
+        .sample_freq = YM2151_SAMPLE_RATE,
+        .format = AUDIO_BUFFER_FORMAT_PCM_S16,
+        .channel_count = 2,
+    };
+
+    static struct audio_buffer_format ym2151_producer_format = {
+        .format = &ym2151_audio_format,
+        .sample_stride = 4,
+    };
+
+    ym2151_audio_pool = audio_new_producer_pool(&ym2151_producer_format, 3, SCC_AUDIO_BUFFER_SAMPLES);
+
+    int dma_channel = -1;
+    for (int ch = 0; ch < NUM_DMA_CHANNELS; ch++) {
+        if (!dma_channel_is_claimed(ch)) {
+            dma_channel = ch;
+            break;
+        }
+    }
+    if (dma_channel < 0) {
+        ym2151_audio_pool = NULL;
+        return;
+    }
+
+    static struct audio_i2s_config ym2151_i2s_config = {
+        .data_pin = I2S_DATA_PIN,
+        .clock_pin_base = I2S_BCLK_PIN,
+        .dma_channel = 0,
+        .pio_sm = 2,
+    };
+    ym2151_i2s_config.dma_channel = (uint)dma_channel;
+
+    audio_i2s_setup(&ym2151_audio_format, &ym2151_i2s_config);
+    audio_i2s_connect(ym2151_audio_pool);
+    audio_i2s_set_enabled(true);
+    gpio_put(I2S_MUTE_PIN, 0);
+    ym2151_audio_started = true;
+}
+
+static void start_ym2151_audio_output(void)
+{
+    ym2151_audio_init();
+    if (ym2151_audio_pool)
+        multicore_launch_core1(core1_ym2151_audio);
+}
+
+// -----------------------------------------------------------------------
+// MoonSound (OPL4). Core 0 serves the game and the OPL4 ports: register
+// latches, the wave memory port and status reads are answered there, so an
+// I/O read never waits for audio. Writes that change the sound reach core 1
+// through a lock-free ring; core 1 owns the YMF262, the wave voices and the
+// I2S pool. Before core 1 starts, the renderer is timed on this clock to
+// pick the output rate, interpolation and voice ceiling.
+// -----------------------------------------------------------------------
+typedef struct {
+    uint32_t rate;
+    bool interpolate;
+} opl4_quality_t;
+
+// Best first. 22.05 kHz runs the FM part twice per output sample.
+static const opl4_quality_t opl4_quality_tiers[] = {
+    { OPL4_WAVE_NATIVE_RATE, true },
+    { OPL4_WAVE_NATIVE_RATE, false },
+    { OPL4_WAVE_NATIVE_RATE / 2u, false },
+};
+
+static opl4_wave_t opl4_wave;
+static struct audio_buffer_pool *opl4_audio_pool;
+static uint32_t opl4_write_ring[OPL4_WRITE_RING_SIZE];
+static volatile uint32_t opl4_write_ring_head; // written by producer (core0)
+static volatile uint32_t opl4_write_ring_tail; // written by consumer (core1)
+static volatile uint8_t opl4_fm_status_latch = 0;
+static uint8_t opl4_wave_reg_latch = 0;
+static uint32_t opl4_voice_cap = OPL4_WAVE_VOICES;   // calibrated ceiling
+static uint32_t opl4_voice_limit = OPL4_WAVE_VOICES; // adapted per buffer on core1
+static uint32_t opl4_buffer_budget_us = 0;
+
+static inline void __not_in_flash_func(opl4_write_ring_push)(uint32_t entry)
+{
+    uint32_t head = opl4_write_ring_head;
+    uint32_t next = (head + 1u) & OPL4_WRITE_RING_MASK;
+    if (next == opl4_write_ring_tail)
+        return; // ring full: drop write (audio only; mapper state unaffected)
+    opl4_write_ring[head] = entry;
+    __dmb();
+    opl4_write_ring_head = next;
+}
+
+static inline void __not_in_flash_func(opl4_drain_write_ring)(void)
+{
+    uint32_t tail = opl4_write_ring_tail;
+    while (tail != opl4_write_ring_head)
+    {
+        __dmb();
+        uint32_t entry = opl4_write_ring[tail];
+        uint8_t reg = (uint8_t)(entry >> 8);
+        uint8_t data = (uint8_t)(entry & 0xFFu);
+        if (entry & OPL4_WRITE_FM)
+            opl4_fm_write(reg, data);
+        else
+            opl4_wave_apply_reg(&opl4_wave, reg, data);
+        tail = (tail + 1u) & OPL4_WRITE_RING_MASK;
+    }
+    opl4_write_ring_tail = tail;
+}
+
+static inline bool __not_in_flash_func(opl4_io_write)(uint8_t port, uint8_t data)
+{
+    if (port == OPL4_PORT_WAVE_REG)
+    {
+        opl4_wave_reg_latch = data;
+        return true;
+    }
+    if (port == OPL4_PORT_WAVE_DATA)
+    {
+        title_profile_note_write(TITLE_CHIP_OPL4);
+        if (opl4_wave_host_write(&opl4_wave, opl4_wave_reg_latch, data))
+            opl4_write_ring_push(((uint32_t)opl4_wave_reg_latch << 8) | data);
+        return true;
+    }
+    if ((port & 0xFCu) == OPL4_PORT_FM_BASE)
+    {
+        if (port & 1u)
+            title_profile_note_write(TITLE_CHIP_OPL4);
+        opl4_write_ring_push(OPL4_WRITE_FM | ((uint32_t)(port & 3u) << 8) | data);
+        return true;
+    }
+    return false;
+}
+
+// Only the OPL4 ports drive the bus; the rest of the owned 8-port blocks
+// (0x78-0x7D, 0xC0-0xC3) are left to whatever else sits there.
+static inline bool __not_in_flash_func(opl4_io_read)(uint8_t port, uint8_t *data)
+{
+    switch (port)
+    {
+        case OPL4_PORT_WAVE_REG:
+            *data = 0xFFu;
+            return true;
+        case OPL4_PORT_WAVE_DATA:
+            *data = opl4_wave_read_reg(&opl4_wave, opl4_wave_reg_latch);
+            return true;
+        case OPL4_PORT_FM_BASE:
+            *data = opl4_fm_status_latch; // BUSY and LD never set
+            return true;
+        case OPL4_PORT_FM_BASE + 1u:
+        case OPL4_PORT_FM_BASE + 2u:
+        case OPL4_PORT_FM_BASE + 3u:
+            *data = 0xFFu;
+            return true;
+    }
+    return false;
+}
+
+static uint32_t opl4_cycles_per_sample(uint32_t start_us, uint32_t samples)
 {
-    if (!ym2151_ready)
-        return 0xFFu;
-
-    ym2151_write_queue_overflow = false;
-    return ym2151_status_latch;
+    uint64_t us = (uint64_t)(time_us_32() - start_us);
+    return (uint32_t)((us * (clock_get_hz(clk_sys) / 1000000u)) / samples);
 }
 
-static inline void __not_in_flash_func(ym2151_select_register)(uint8_t reg)
+static uint32_t opl4_calibrate_fm(void)
 {
-    ym2151_address_latch = reg;
+    int32_t out[2];
+    opl4_fm_reset();
+    uint32_t start = time_us_32();
+    for (uint32_t i = 0; i < OPL4_CALIBRATE_SAMPLES; i++)
+        opl4_fm_generate(out);
+    uint32_t cycles = opl4_cycles_per_sample(start, OPL4_CALIBRATE_SAMPLES);
+    opl4_fm_reset();
+    return cycles;
 }
 
-static inline void __not_in_flash_func(ym2151_write_register_data)(uint8_t data)
+// Key voices on ROM tones spread over the wave ROM and time the mix.
+static uint32_t opl4_calibrate_wave(uint32_t voices, bool interpolate)
 {
-    if (!ym2151_ready)
-        return;
+    int32_t out[2];
+    opl4_wave_init(&opl4_wave, flash_rom + OPL4_WAVE_ROM_FLASH_OFFSET, NULL, 0u, OPL4_WAVE_NATIVE_RATE);
+    opl4_wave_set_quality(&opl4_wave, OPL4_WAVE_NATIVE_RATE, interpolate);
+    for (uint32_t v = 0; v < voices; v++)
+    {
+        opl4_wave_write_reg(&opl4_wave, (uint8_t)(0x20u + v), 0x00u);
+        opl4_wave_write_reg(&opl4_wave, (uint8_t)(0x38u + v), 0x00u);
+        opl4_wave_write_reg(&opl4_wave, (uint8_t)(0x08u + v), (uint8_t)(v * 9u));
+        opl4_wave_write_reg(&opl4_wave, (uint8_t)(0x68u + v), 0x80u);
+    }
+    opl4_wave_schedule(&opl4_wave, OPL4_WAVE_VOICES);
 
-    uint32_t save = spin_lock_blocking(ym2151_lock);
-    ym2151_queue_register_write_locked(ym2151_address_latch, data);
-    spin_unlock(ym2151_lock, save);
+    uint32_t start = time_us_32();
+    for (uint32_t i = 0; i < OPL4_CALIBRATE_SAMPLES; i++)
+        opl4_wave_calc(&opl4_wave, out);
+    return opl4_cycles_per_sample(start, OPL4_CALIBRATE_SAMPLES);
 }
 
-static inline void __not_in_flash_func(ym2151_calc_stereo_sample)(int16_t *samples, int index)
+static opl4_quality_t opl4_choose_quality(bool handoff_pool)
 {
-    int32_t opm_out[2] = {0, 0};
+    uint32_t fm_cycles = opl4_calibrate_fm();
+    uint32_t base_cycles = opl4_calibrate_wave(0u, false);
+    uint32_t voice_cycles[2];
+    for (uint32_t interpolate = 0; interpolate < 2u; interpolate++)
+    {
+        uint32_t all = opl4_calibrate_wave(OPL4_WAVE_VOICES, interpolate != 0u);
+        voice_cycles[interpolate] = all > base_cycles ? (all - base_cycles) / OPL4_WAVE_VOICES : 1u;
+        if (voice_cycles[interpolate] == 0u)
+            voice_cycles[interpolate] = 1u;
+    }
 
-    if (ym2151_ready)
+    uint32_t best = 0;
+    uint32_t best_voices = 0;
+    for (uint32_t i = 0; i < sizeof(opl4_quality_tiers) / sizeof(opl4_quality_tiers[0]); i++)
     {
-        ym2151_service_writes_locked(YM2151_WRITE_SERVICE_BUDGET);
-        ym2151_clock_accum += YM2151_CLOCK;
-        while (ym2151_clock_accum >= (YM2151_SAMPLE_RATE * YM2151_FRAME_DIVIDER))
+        const opl4_quality_t *tier = &opl4_quality_tiers[i];
+        // A handed-off MP3 pool keeps running at 44.1 kHz.
+        if (handoff_pool && tier->rate != OPL4_WAVE_NATIVE_RATE)
+            continue;
+        uint32_t budget = (uint32_t)(((uint64_t)clock_get_hz(clk_sys) * OPL4_CPU_BUDGET_PERCENT) / (100u * tier->rate));
+        uint32_t fixed = base_cycles + fm_cycles * (OPL4_WAVE_NATIVE_RATE / tier->rate);
+        uint32_t voices = budget > fixed ? (budget - fixed) / voice_cycles[tier->interpolate ? 1 : 0] : 0u;
+        if (voices > OPL4_WAVE_VOICES)
+            voices = OPL4_WAVE_VOICES;
+        if (voices > best_voices)
         {
-            ym2151_clock_frame_locked();
-            ym2151_clock_accum -= (YM2151_SAMPLE_RATE * YM2151_FRAME_DIVIDER);
+            best = i;
+            best_voices = voices;
         }
-        ym2151_status_latch = (uint8_t)(OPM_Read(&ym2151_instance, 1u) & 0x7Fu);
-        opm_out[0] = scale_sample_percent_i32(ym2151_last_output[0], YM2151_BASE_VOLUME_PERCENT);
-        opm_out[1] = scale_sample_percent_i32(ym2151_last_output[1], YM2151_BASE_VOLUME_PERCENT);
+        if (voices == OPL4_WAVE_VOICES)
+            break;
     }
 
-    int16_t psg = 0;
-    (void)main_psg_calc_audible_sample_shifted(YM2151_PSG_VOLUME_SHIFT, &psg);
-    samples[index * 2] = apply_audio_volume(opm_out[0] + psg);
-    samples[index * 2 + 1] = apply_audio_volume(opm_out[1] + psg);
+    opl4_voice_cap = best_voices < OPL4_MIN_VOICES ? OPL4_MIN_VOICES : best_voices;
+    printf("OPL4: fm %lu, voice %lu/%lu cycles -> %lu Hz%s, %lu voices\n",
+           (unsigned long)fm_cycles, (unsigned long)voice_cycles[0], (unsigned long)voice_cycles[1],
+           (unsigned long)opl4_quality_tiers[best].rate,
+           opl4_quality_tiers[best].interpolate ? " interpolated" : "",
+           (unsigned long)opl4_voice_cap);
+    return opl4_quality_tiers[best];
 }
 
-static inline void __not_in_flash_func(ym2151_audio_service_buffer)(bool service_psg_io)
+static void opl4_init(void)
 {
-    if (!ym2151_audio_started || !ym2151_audio_pool)
-        return;
-
-    if (service_psg_io)
-        main_psg_service_io();
-
-    struct audio_buffer *buffer = take_audio_buffer(ym2151_audio_pool, false);
-    if (!buffer)
-        return;
+    opl4_quality_t quality = opl4_choose_quality(rom_audio_handoff_pool != NULL);
 
-    int16_t *samples = (int16_t *)buffer->buffer->bytes;
-    for (int i = 0; i < SCC_AUDIO_BUFFER_SAMPLES; i++)
+    uint8_t *ram = NULL;
+    uint32_t ram_size = 0;
+    if (psram_prepare_opl4_ram_region())
     {
-        if (service_psg_io)
-            main_psg_service_io();
-        ym2151_calc_stereo_sample(samples, i);
+        ram = opl4_ram_region.ptr;
+        ram_size = opl4_ram_region.size;
+        memset(ram, 0, ram_size);
     }
-    buffer->sample_count = SCC_AUDIO_BUFFER_SAMPLES;
-    give_audio_buffer(ym2151_audio_pool, buffer);
-}
+    printf("OPL4: sample RAM %lu KB\n", (unsigned long)(ram_size / 1024u));
 
-static void __no_inline_not_in_flash_func(core1_ym2151_audio)(void)
-{
-    while (true)
+    opl4_wave_init(&opl4_wave, flash_rom + OPL4_WAVE_ROM_FLASH_OFFSET, ram, ram_size, quality.rate);
+    opl4_wave_set_quality(&opl4_wave, quality.rate, quality.interpolate);
+    opl4_fm_reset();
+    opl4_write_ring_head = 0;
+    opl4_write_ring_tail = 0;
+    opl4_fm_status_latch = 0;
+    opl4_wave_reg_latch = 0;
+    opl4_voice_limit = opl4_voice_cap;
+    opl4_buffer_budget_us = (uint32_t)(((uint64_t)SCC_AUDIO_BUFFER_SAMPLES * 1000000u * OPL4_CPU_BUDGET_PERCENT) /
+                                       (100u * quality.rate));
+
+    if (main_psg_ready && quality.rate != PSG_SAMPLE_RATE)
     {
-        ym2151_audio_service_buffer(true);
-        tight_loop_contents();
+        uint32_t save = spin_lock_blocking(main_psg_lock);
+        PSG_setRate(&main_psg_instance, quality.rate);
+        spin_unlock(main_psg_lock, save);
     }
 }
 
-static void ym2151_audio_init(void)
+static void opl4_audio_init(uint32_t rate)
 {
-    if (ym2151_audio_started)
-        return;
-
     gpio_init(I2S_MUTE_PIN);
     gpio_set_dir(I2S_MUTE_PIN, GPIO_OUT);
     gpio_put(I2S_MUTE_PIN, 1);
@@ -4691,23 +6702,23 @@ static void ym2151_audio_init(void)
     struct audio_buffer_pool *handoff_pool = claim_rom_audio_handoff_pool();
     if (handoff_pool)
     {
-        ym2151_audio_pool = handoff_pool;
-        ym2151_audio_started = true;
+        opl4_audio_pool = handoff_pool;
         return;
     }
 
-    static audio_format_t ym2151_audio_format = {
-        .sample_freq = YM2151_SAMPLE_RATE,
+    static audio_format_t opl4_audio_format = {
+        .sample_freq = OPL4_WAVE_NATIVE_RATE,
         .format = AUDIO_BUFFER_FORMAT_PCM_S16,
         .channel_count = 2,
     };
+    opl4_audio_format.sample_freq = rate;
 
-    static struct audio_buffer_format ym2151_producer_format = {
-        .format = &ym2151_audio_format,
+    static struct audio_buffer_format opl4_producer_format = {
+        .format = &opl4_audio_format,
         .sample_stride = 4,
     };
 
-    ym2151_audio_pool = audio_new_producer_pool(&ym2151_producer_format, 3, SCC_AUDIO_BUFFER_SAMPLES);
+    opl4_audio_pool = audio_new_producer_pool(&opl4_producer_format, 3, SCC_AUDIO_BUFFER_SAMPLES);
 
     int dma_channel = -1;
     for (int ch = 0; ch < NUM_DMA_CHANNELS; ch++) {
@@ -4717,30 +6728,101 @@ static void ym2151_audio_init(void)
         }
     }
     if (dma_channel < 0) {
-        ym2151_audio_pool = NULL;
+        opl4_audio_pool = NULL;
         return;
     }
 
-    static struct audio_i2s_config ym2151_i2s_config = {
+    static struct audio_i2s_config opl4_i2s_config = {
         .data_pin = I2S_DATA_PIN,
         .clock_pin_base = I2S_BCLK_PIN,
         .dma_channel = 0,
         .pio_sm = 2,
     };
-    ym2151_i2s_config.dma_channel = (uint)dma_channel;
+    opl4_i2s_config.dma_channel = (uint)dma_channel;
 
-    audio_i2s_setup(&ym2151_audio_format, &ym2151_i2s_config);
-    audio_i2s_connect(ym2151_audio_pool);
+    audio_i2s_setup(&opl4_audio_format, &opl4_i2s_config);
+    audio_i2s_connect(opl4_audio_pool);
     audio_i2s_set_enabled(true);
     gpio_put(I2S_MUTE_PIN, 0);
-    ym2151_audio_started = true;
 }
 
-static void start_ym2151_audio_output(void)
+static inline void __not_in_flash_func(opl4_calc_stereo_sample)(int16_t *samples, int index, bool half_rate)
 {
-    ym2151_audio_init();
-    if (ym2151_audio_pool)
-        multicore_launch_core1(core1_ym2151_audio);
+    int32_t fm[2];
+    int32_t pcm[2];
+
+    main_psg_service_io();
+    opl4_drain_write_ring();
+
+    opl4_fm_generate(fm);
+    if (half_rate)
+    {
+        int32_t fm2[2];
+        opl4_fm_generate(fm2);
+        fm[0] = (fm[0] + fm2[0]) >> 1;
+        fm[1] = (fm[1] + fm2[1]) >> 1;
+    }
+    opl4_fm_status_latch = opl4_fm_status();
+    opl4_wave_calc(&opl4_wave, pcm);
+
+    int16_t psg = 0;
+    (void)main_psg_calc_audible_sample_shifted(OPL4_PSG_VOLUME_SHIFT, &psg);
+    int32_t left = ((fm[0] * opl4_wave_fm_gain(&opl4_wave, 0u)) >> 15) + (pcm[0] >> OPL4_WAVE_VOLUME_SHIFT) + psg;
+    int32_t right = ((fm[1] * opl4_wave_fm_gain(&opl4_wave, 1u)) >> 15) + (pcm[1] >> OPL4_WAVE_VOLUME_SHIFT) + psg;
+    samples[index * 2] = apply_audio_volume(left);
+    samples[index * 2 + 1] = apply_audio_volume(right);
+}
+
+// One buffer per call. The voice limit follows the time the last buffer
+// took, so a busy passage drops the quietest voices instead of the output
+// running late.
+static inline void __not_in_flash_func(opl4_audio_service_buffer)(void)
+{
+    main_psg_service_io();
+
+    struct audio_buffer *buffer = take_audio_buffer(opl4_audio_pool, false);
+    if (!buffer)
+        return;
+
+    uint32_t start = time_us_32();
+    bool half_rate = opl4_wave.rate_shift != 0u;
+    opl4_drain_write_ring();
+    opl4_wave_schedule(&opl4_wave, opl4_voice_limit);
+
+    int16_t *samples = (int16_t *)buffer->buffer->bytes;
+    for (int i = 0; i < SCC_AUDIO_BUFFER_SAMPLES; i++)
+        opl4_calc_stereo_sample(samples, i, half_rate);
+    buffer->sample_count = SCC_AUDIO_BUFFER_SAMPLES;
+    give_audio_buffer(opl4_audio_pool, buffer);
+    title_profile_audio_tick();
+
+    uint32_t elapsed = time_us_32() - start;
+    if (elapsed > opl4_buffer_budget_us)
+    {
+        if (opl4_voice_limit > OPL4_MIN_VOICES)
+            opl4_voice_limit--;
+    }
+    else if (elapsed < (opl4_buffer_budget_us * 3u) / 4u && opl4_voice_limit < opl4_voice_cap)
+    {
+        opl4_voice_limit++;
+    }
+}
+
+static void __no_inline_not_in_flash_func(core1_opl4_audio)(void)
+{
+    while (true)
+    {
+        opl4_audio_service_buffer();
+        tight_loop_contents();
+    }
+}
+
+static void start_opl4_audio_output(void)
+{
+    opl4_init();
+    opl4_audio_init(opl4_wave.rate);
+    if (opl4_audio_pool)
+        multicore_launch_core1(core1_opl4_audio);
 }
 
 static inline uint8_t __not_in_flash_func(mapper_page_from_reg)(uint8_t reg)
@@ -4825,6 +6907,157 @@ static inline void __not_in_flash_func(handle_sunrise_write)(uint16_t addr, uint
     }
 }
 
+// -----------------------------------------------------------------------
+// Expanded-slot (subslot) device table
+//
+// Modes that expose several devices behind the 0xFFFF subslot register
+// describe them once at launch: each subslot gets a device descriptor with
+// read/write hooks and the mask of CPU pages it decodes. A write to 0xFFFF
+// rebuilds the per-page table, so the bus loop resolves any access with a
+// single indexed call instead of re-decoding the subslot register and
+// walking an if-chain. Pages whose selected subslot has no device (or a
+// device that does not decode that page) point at an empty descriptor that
+// leaves the bus undriven.
+// -----------------------------------------------------------------------
+
+#define SUBSLOT_COUNT      4u
+#define SUBSLOT_PAGE(p)    (1u << (p))
+#define SUBSLOT_PAGES_ALL  0x0Fu
+
+typedef bool (*subslot_read_fn_t)(void *ctx, uint16_t addr, uint8_t *data);
+typedef void (*subslot_write_fn_t)(void *ctx, uint16_t addr, uint8_t data);
+
+typedef struct {
+    subslot_read_fn_t read;
+    subslot_write_fn_t write;
+    void *ctx;
+    uint8_t pages;                                  // SUBSLOT_PAGE() mask this device decodes
+} subslot_device_t;
+
+typedef struct {
+    subslot_device_t devices[SUBSLOT_COUNT];        // indexed by subslot number
+    const subslot_device_t *page[4];                // active device per CPU page
+    uint8_t reg;                                    // last value written to 0xFFFF
+} subslot_map_t;
+
+static bool __not_in_flash_func(subslot_empty_read)(void *ctx, uint16_t addr, uint8_t *data)
+{
+    (void)ctx;
+    (void)addr;
+    (void)data;
+    return false;
+}
+
+static void __not_in_flash_func(subslot_empty_write)(void *ctx, uint16_t addr, uint8_t data)
+{
+    (void)ctx;
+    (void)addr;
+    (void)data;
+}
+
+static const subslot_device_t subslot_empty_device = {
+    .read = subslot_empty_read,
+    .write = subslot_empty_write,
+    .ctx = NULL,
+    .pages = 0u,
+};
+
+static void __not_in_flash_func(subslot_map_select)(subslot_map_t *map, uint8_t value)
+{
+    map->reg = value;
+    for (uint8_t page = 0; page < 4u; ++page)
+    {
+        const subslot_device_t *dev = &map->devices[(value >> (page * 2u)) & 0x03u];
+        map->page[page] = (dev->pages & SUBSLOT_PAGE(page)) ? dev : &subslot_empty_device;
+    }
+}
+
+static void subslot_map_init(subslot_map_t *map, uint8_t initial_reg)
+{
+    for (uint8_t slot = 0; slot < SUBSLOT_COUNT; ++slot)
+        map->devices[slot] = subslot_empty_device;
+    subslot_map_select(map, initial_reg);
+}
+
+// Attach a device to a subslot. Call before the bus loop starts; the page
+// table is rebuilt so the device is live for the current 0xFFFF value.
+static void subslot_map_attach(subslot_map_t *map, uint8_t subslot, uint8_t pages,
+                               subslot_read_fn_t read, subslot_write_fn_t write, void *ctx)
+{
+    subslot_device_t *dev = &map->devices[subslot & 0x03u];
+    dev->read = read ? read : subslot_empty_read;
+    dev->write = write ? write : subslot_empty_write;
+    dev->ctx = ctx;
+    dev->pages = pages;
+    subslot_map_select(map, map->reg);
+}
+
+// pio_drain_writes() handler: ctx is the subslot_map_t.
+static inline void __not_in_flash_func(subslot_map_handle_write)(uint16_t addr, uint8_t data, void *ctx)
+{
+    subslot_map_t *map = (subslot_map_t *)ctx;
+    if (addr == 0xFFFFu)
+    {
+        subslot_map_select(map, data);
+        return;
+    }
+    const subslot_device_t *dev = map->page[addr >> 14];
+    dev->write(dev->ctx, addr, data);
+}
+
+static inline bool __not_in_flash_func(subslot_map_read)(const subslot_map_t *map, uint16_t addr, uint8_t *data)
+{
+    if (addr == 0xFFFFu)
+    {
+        *data = (uint8_t)~map->reg;
+        return true;
+    }
+    const subslot_device_t *dev = map->page[addr >> 14];
+    return dev->read(dev->ctx, addr, data);
+}
+
+// Sunrise IDE interface plus its Nextor ROM (page 1 only).
+typedef struct {
+    sunrise_ide_t *ide;
+    const uint8_t *rom_base;
+    uint32_t available_length;
+} subslot_sunrise_ctx_t;
+
+static bool __not_in_flash_func(subslot_sunrise_read)(void *ctx, uint16_t addr, uint8_t *data)
+{
+    subslot_sunrise_ctx_t *sctx = (subslot_sunrise_ctx_t *)ctx;
+    if (!sunrise_ide_handle_read(sctx->ide, addr, data))
+    {
+        uint32_t rel = ((uint32_t)sctx->ide->segment << 14) + (addr & 0x3FFFu);
+        *data = (sctx->available_length == 0u || rel < sctx->available_length)
+            ? read_rom_byte(sctx->rom_base, rel) : 0xFFu;
+    }
+    return true;
+}
+
+static void __not_in_flash_func(subslot_sunrise_write)(void *ctx, uint16_t addr, uint8_t data)
+{
+    subslot_sunrise_ctx_t *sctx = (subslot_sunrise_ctx_t *)ctx;
+    sunrise_ide_handle_write(sctx->ide, addr, data);
+}
+
+// Memory-mapper RAM in PSRAM; ctx is the uint8_t[4] segment register file
+// driven by I/O ports 0xFC-0xFF.
+static bool __not_in_flash_func(subslot_mapper_read)(void *ctx, uint16_t addr, uint8_t *data)
+{
+    const uint8_t *mapper_reg = (const uint8_t *)ctx;
+    uint8_t mapper_page = mapper_page_from_reg(mapper_reg[addr >> 14]);
+    *data = mapper_read_byte(((uint32_t)mapper_page << 14) | (addr & 0x3FFFu));
+    return true;
+}
+
+static void __not_in_flash_func(subslot_mapper_write)(void *ctx, uint16_t addr, uint8_t data)
+{
+    const uint8_t *mapper_reg = (const uint8_t *)ctx;
+    uint8_t mapper_page = mapper_page_from_reg(mapper_reg[addr >> 14]);
+    mapper_write_byte(((uint32_t)mapper_page << 14) | (addr & 0x3FFFu), data);
+}
+
 static inline bool __not_in_flash_func(fmpac_sram_enabled)(const fmpac_state_t *fmpac)
 {
     return fmpac->sram_key_5ffe == 0x4Du && fmpac->sram_key_5fff == 0x69u;
@@ -4911,6 +7144,8 @@ static inline void __not_in_flash_func(handle_konamiscc_write)(uint16_t addr, ui
     else if (addr >= 0x7000u && addr <= 0x77FFu) regs[1] = data;
     else if (addr >= 0x9000u && addr <= 0x97FFu) regs[2] = data;
     else if (addr >= 0xB000u && addr <= 0xB7FFu) regs[3] = data;
+    else return;
+    title_profile_note_bank(data);
 }
 
 static inline void __not_in_flash_func(handle_konami_write)(uint16_t addr, uint8_t data, void *ctx)
@@ -4919,6 +7154,8 @@ static inline void __not_in_flash_func(handle_konami_write)(uint16_t addr, uint8
     if      (addr >= 0x6000u && addr <= 0x67FFu) regs[1] = data;
     else if (addr >= 0x8000u && addr <= 0x87FFu) regs[2] = data;
     else if (addr >= 0xA000u && addr <= 0xA7FFu) regs[3] = data;
+    else return;
+    title_profile_note_bank(data);
 }
 
 static inline void __not_in_flash_func(handle_ascii8_write)(uint16_t addr, uint8_t data, void *ctx)
@@ -4928,6 +7165,8 @@ static inline void __not_in_flash_func(handle_ascii8_write)(uint16_t addr, uint8
     else if (addr >= 0x6800u && addr <= 0x6FFFu) regs[1] = data;
     else if (addr >= 0x7000u && addr <= 0x77FFu) regs[2] = data;
     else if (addr >= 0x7800u && addr <= 0x7FFFu) regs[3] = data;
+    else return;
+    title_profile_note_bank(data);
 }
 
 static inline void __not_in_flash_func(handle_ascii16_write)(uint16_t addr, uint8_t data, void *ctx)
@@ -4935,6 +7174,9 @@ static inline void __not_in_flash_func(handle_ascii16_write)(uint16_t addr, uint
     uint8_t *regs = ((bank8_ctx_t *)ctx)->bank_regs;
     if      (addr >= 0x6000u && addr <= 0x67FFu) regs[0] = data;
     else if (addr >= 0x7000u && addr <= 0x77FFu) regs[1] = data;
+    else return;
+    title_profile_note_bank((uint32_t)data << 1);
+    title_profile_note_bank(((uint32_t)data << 1) + 1u);
 }
 
 static inline void __not_in_flash_func(handle_neo8_write)(uint16_t addr, uint8_t data, void *ctx)
@@ -5001,34 +7243,147 @@ static void __no_inline_not_in_flash_func(banked8_loop)(
     uint32_t nrBlocks  = (available_length != 0u) ? ((available_length + 0x1FFFu) >> 13) : 0u;
     uint32_t blockMask = (nrBlocks != 0u) ? (nrBlocks - 1u) : 0u;
 
-    while (true)
+    wait_stats_reset();
+
+    while (true)
+    {
+        title_profile_idle();
+        pio_drain_writes(write_handler, &ctx);
+
+        uint16_t addr = (uint16_t)pio_sm_get_blocking(msx_bus.pio, msx_bus.sm_read);
+        uint32_t wait_start = wait_stats_begin();
+
+        pio_drain_writes(write_handler, &ctx);
+
+        bool in_window = (addr >= 0x4000u) && (addr <= 0xBFFFu);
+        uint8_t data = 0xFFu;
+
+        if (in_window)
+        {
+            uint32_t block = bank_regs[(addr - 0x4000u) >> 13];
+            if (nrBlocks != 0u && block >= nrBlocks)
+                block &= blockMask;
+            uint32_t rel = (block << 13) | (addr & 0x1FFFu);
+            if (available_length == 0u || rel < available_length)
+                data = read_rom_byte(rom_base, rel);
+        }
+
+        pio_sm_put_blocking(msx_bus.pio, msx_bus.sm_read, pio_build_token(in_window, data));
+        wait_stats_end(wait_start);
+    }
+}
+
+static void __no_inline_not_in_flash_func(ascii16_loop)(
+    const uint8_t *rom_base,
+    uint32_t available_length,
+    uint8_t *bank_regs)
+{
+    bank8_ctx_t ctx = { .bank_regs = bank_regs };
+
+    // openMSX-style block handling for non power-of-two 16 KB ROMs.
+    uint32_t nrBlocks  = (available_length != 0u) ? ((available_length + 0x3FFFu) >> 14) : 0u;
+    uint32_t blockMask = (nrBlocks != 0u) ? (nrBlocks - 1u) : 0u;
+
+    while (true)
+    {
+        title_profile_idle();
+        pio_drain_writes(handle_ascii16_write, &ctx);
+
+        uint16_t addr = (uint16_t)pio_sm_get_blocking(msx_bus.pio, msx_bus.sm_read);
+
+        pio_drain_writes(handle_ascii16_write, &ctx);
+
+        bool in_window = (addr >= 0x4000u) && (addr <= 0xBFFFu);
+        uint8_t data = 0xFFu;
+
+        if (in_window)
+        {
+            uint8_t bank = (addr >> 15) & 1;
+            uint32_t block = bank_regs[bank];
+            if (nrBlocks != 0u && block >= nrBlocks)
+                block &= blockMask;
+            uint32_t rel = (block << 14) | (addr & 0x3FFFu);
+            if (available_length == 0u || rel < available_length)
+                data = read_rom_byte(rom_base, rel);
+        }
+
+        pio_sm_put_blocking(msx_bus.pio, msx_bus.sm_read, pio_build_token(in_window, data));
+    }
+}
+
+// -----------------------------------------------------------------------
+// Runtime mapper inference (MAPPER_AUTO). The candidates and their scoring
+// live in mapper_auto.h, shared with the mapper_bench trace self-test; this
+// loop serves reads from the leading candidate until one locks, then hands
+// its registers to that mapper's regular loop.
+// -----------------------------------------------------------------------
+static void __not_in_flash_func(handle_mapper_auto_write)(uint16_t addr, uint8_t data, void *ctx)
+{
+    mapper_auto_write((mapper_auto_ctx_t *)ctx, addr, data);
+}
+
+static void __no_inline_not_in_flash_func(mapper_auto_loop)(
+    const uint8_t *rom_base,
+    uint32_t available_length)
+{
+    static mapper_auto_ctx_t ctx;
+    mapper_auto_init(&ctx, available_length);
+
+    while (!ctx.locked)
     {
-        pio_drain_writes(write_handler, &ctx);
+        pio_drain_writes(handle_mapper_auto_write, &ctx);
+        if (ctx.locked) break;
 
         uint16_t addr = (uint16_t)pio_sm_get_blocking(msx_bus.pio, msx_bus.sm_read);
 
-        pio_drain_writes(write_handler, &ctx);
+        pio_drain_writes(handle_mapper_auto_write, &ctx);
 
         bool in_window = (addr >= 0x4000u) && (addr <= 0xBFFFu);
         uint8_t data = 0xFFu;
 
         if (in_window)
         {
-            uint32_t block = bank_regs[(addr - 0x4000u) >> 13];
-            if (nrBlocks != 0u && block >= nrBlocks)
-                block &= blockMask;
-            uint32_t rel = (block << 13) | (addr & 0x1FFFu);
+            const mapper_auto_candidate_t *c = &ctx.cand[ctx.active];
+            uint32_t block;
+            uint32_t rel;
+            if (c->mapper == MAPPER_DETECT_ASCII16) {
+                block = c->regs[(addr >> 15) & 1u];
+                if (c->blocks != 0u && block >= c->blocks) block &= (c->blocks - 1u);
+                rel = (block << 14) | (addr & 0x3FFFu);
+            } else {
+                block = c->regs[(addr - 0x4000u) >> 13];
+                if (c->blocks != 0u && block >= c->blocks) block &= (c->blocks - 1u);
+                rel = (block << 13) | (addr & 0x1FFFu);
+            }
             if (available_length == 0u || rel < available_length)
                 data = read_rom_byte(rom_base, rel);
+            ctx.last_read = addr;
         }
 
         pio_sm_put_blocking(msx_bus.pio, msx_bus.sm_read, pio_build_token(in_window, data));
     }
+
+    mapper_auto_candidate_t *c = &ctx.cand[ctx.active];
+    switch (c->mapper)
+    {
+        case MAPPER_DETECT_KONAMI_SCC:
+            banked8_loop(rom_base, available_length, c->regs, handle_konamiscc_write);
+            break;
+        case MAPPER_DETECT_KONAMI:
+            banked8_loop(rom_base, available_length, c->regs, handle_konami_write);
+            break;
+        case MAPPER_DETECT_ASCII8:
+            banked8_loop(rom_base, available_length, c->regs, handle_ascii8_write);
+            break;
+        default:
+            ascii16_loop(rom_base, available_length, c->regs);
+            break;
+    }
 }
 
 typedef struct {
     bool rom_selected;
-    uint16_t rom_index;
+    uint32_t rom_index;
 } explorer_menu_ctx_t;
 
 static void fh_copy_query_from_buffer(char *out, size_t out_size);
@@ -5114,10 +7469,264 @@ static void __not_in_flash_func(handle_menu_fh_command)(uint8_t data, explorer_m
     fh_service_menu_window = false;
 }
 
+// Runs a menu command exactly as a CTRL_CMD write does. Commands that finish
+// in the background (folder refresh, mapper detection, SD delete) leave
+// ctrl_cmd_state set until the idle work clears it.
+static void ctrl_dispatch_command(uint8_t cmd, explorer_menu_ctx_t *menu_ctx)
+{
+    ctrl_cmd_state = cmd;
+    if (cmd == CMD_APPLY_FILTER)
+    {
+        filter_query[CTRL_QUERY_SIZE - 1] = '\0';
+        apply_filter();
+        current_page = 0;
+        build_page_buffer(current_page);
+    }
+    else if (cmd == CMD_FIND_FIRST)
+    {
+        filter_query[CTRL_QUERY_SIZE - 1] = '\0';
+        find_first_match();
+    }
+    else if (cmd == CMD_ENTER_DIR)
+    {
+        process_enter_dir_request();
+        // ctrl_cmd_state stays CMD_ENTER_DIR until the listing is rebuilt.
+    }
+    else if (cmd == CMD_DETECT_MAPPER)
+    {
+         uint16_t index = (uint16_t)((uint8_t)filter_query[0]) |
+                                     (uint16_t)(((uint8_t)filter_query[1]) << 8);
+         detect_mapper_index = index;
+         detect_mapper_pending = true;
+         ctrl_mapper_value = 0;
+    }
+    else if (cmd == CMD_SET_MAPPER)
+    {
+         uint16_t index = (uint16_t)((uint8_t)filter_query[0]) |
+                                     (uint16_t)(((uint8_t)filter_query[1]) << 8);
+         uint8_t mapper = (uint8_t)filter_query[2];
+         
+         ctrl_ack_value = 0;
+         if (index < total_record_count && mapper_is_selectable(mapper)) {
+             uint32_t record_index = filtered_indices[index];
+             if (record_index < full_record_count) {
+                ROMRecord *rec = &records[record_index];
+                uint8_t flags = rec->Mapper & (SOURCE_SD_FLAG | FOLDER_FLAG | MP3_FLAG);
+                if ((flags & (FOLDER_FLAG | MP3_FLAG)) == 0) {
+                    rec->Mapper = (uint8_t)(flags | mapper);
+                    ctrl_ack_value = 1;
+                }
+             }
+         }
+    }
+    else if (cmd == CMD_SET_SOURCE)
+    {
+        uint8_t mode = (uint8_t)filter_query[0];
+        if (mode > SOURCE_MODE_SD) {
+            mode = SOURCE_MODE_ALL;
+        }
+        cancel_refresh_work();
+        fh_menu_window_active = false;
+        browse_source_mode = mode;
+        sd_current_path[0] = '/';
+        sd_current_path[1] = '\0';
+        memset(filter_query, 0, sizeof(filter_query));
+        refresh_requested = true;
+    }
+    else if (cmd == CMD_LOAD_OPTIONS)
+    {
+        process_load_options_request();
+    }
+    else if (cmd == CMD_SAVE_OPTIONS)
+    {
+        process_save_options_request();
+    }
+    else if (cmd == CMD_PREPARE_QUICK_RUN)
+    {
+        process_prepare_quick_run_request();
+    }
+    else if (cmd == CMD_CYCLE_SD_PARTITION)
+    {
+        process_cycle_sd_partition_request();
+    }
+    else if (cmd == CMD_DELETE_SD_FILE)
+    {
+        process_delete_sd_file_request();
+    }
+    else if (cmd == CMD_FH_LIST_PAGE || cmd == CMD_FH_SEARCH ||
+             cmd == CMD_FH_DOWNLOAD || cmd == CMD_FH_WIFI_STATUS ||
+             cmd == CMD_FH_WIFI_CONFIG)
+    {
+        cancel_refresh_work();
+        handle_menu_fh_command(cmd, menu_ctx);
+    }
+
+    if (cmd != CMD_ENTER_DIR && cmd != CMD_DETECT_MAPPER && cmd != CMD_DELETE_SD_FILE) {
+        ctrl_cmd_state = 0;
+    }
+}
+
+// Value of one CTRL_BASE_ADDR register, as the menu loop serves it.
+static uint8_t __not_in_flash_func(ctrl_register_read)(uint16_t addr)
+{
+    if (fh_menu_window_active)
+    {
+        switch (addr)
+        {
+            case CTRL_COUNT_L: return (uint8_t)(fh_catalog_count & 0xFFu);
+            case CTRL_COUNT_H: return (uint8_t)((fh_catalog_count >> 8) & 0xFFu);
+            case CTRL_PAGE:    return fh_page_index;
+            case CTRL_STATUS:  return fh_status;
+            case CTRL_CMD:     return ctrl_cmd_state;
+            case CTRL_MATCH_L: return (uint8_t)(fh_selected_index & 0xFFu);
+            case CTRL_MATCH_H: return (uint8_t)((fh_selected_index >> 8) & 0xFFu);
+            case CTRL_MAPPER:  return (uint8_t)(fh_progress_percent & 0xFFu);
+            case CTRL_ACK:     return (uint8_t)((fh_progress_percent >> 8) & 0xFFu);
+            case CTRL_AUDIO:   return fh_result;
+            default:           return 0;
+        }
+    }
+    switch (addr)
+    {
+        case CTRL_COUNT_L: return (uint8_t)(total_record_count & 0xFFu);
+        case CTRL_COUNT_H: return (uint8_t)((total_record_count >> 8) & 0xFFu);
+        case CTRL_PAGE:    return (uint8_t)current_page;
+        case CTRL_STATUS:  return ctrl_status_value;
+        case CTRL_CMD:     return ctrl_cmd_state;
+        case CTRL_MATCH_L: return (uint8_t)(match_index & 0xFFu);
+        case CTRL_MATCH_H: return (uint8_t)((match_index >> 8) & 0xFFu);
+        case CTRL_MAPPER:  return ctrl_mapper_value;
+        case CTRL_ACK:     return ctrl_ack_value;
+        case CTRL_AUDIO:   return ctrl_audio_selection;
+        case CTRL_WIFI_SUPPORT: return ctrl_wifi_support;
+        case CTRL_PSG_EMULATION: return ctrl_psg_emulation;
+        case CTRL_WAVEGAME_ROM: return ctrl_wavegame_rom;
+        case CTRL_SD_PARTITION: return ctrl_sd_partition;
+        case CTRL_SD_BROWSE_PARTITION: return sd_browse_partition;
+        case CTRL_AUDIO_VOLUME: return ctrl_audio_volume;
+        default:           return 0xFFu;
+    }
+}
+
+// -----------------------------------------------------------------------
+// Menu mailbox
+// -----------------------------------------------------------------------
+// A framed request/reply channel over the data buffer window, so the menu
+// can run a command with one block write, one status poll and one LDIR
+// instead of a Poke per parameter and a Peek per result register.
+//
+// The MSX writes CMD, LEN and the payload into the frame (writes to the
+// data buffer are otherwise ignored), then writes a non-zero sequence number
+// to MBOX_SEQ. From that write on, reads of the data buffer window return the
+// frame: STATUS reads BUSY until the reply is ready, SEQ echoes the request
+// and LEN holds the reply length. Writing 0 to MBOX_STATUS releases the frame
+// and maps the data buffer back.
+//
+// Menu commands take their parameters from the payload (copied into the
+// query buffer, zero padded) and reply with the control registers, the VDP
+// frequency byte and the SD partition info block.
+static uint8_t mbox_frame[DATA_BUFFER_SIZE];
+static bool mbox_mapped = false;
+static bool mbox_pending = false;
+
+static void mbox_reply(uint8_t status, uint16_t length)
+{
+    mbox_frame[MBOX_LEN_L - MBOX_BASE] = (uint8_t)(length & 0xFFu);
+    mbox_frame[MBOX_LEN_H - MBOX_BASE] = (uint8_t)(length >> 8);
+    mbox_pending = false;
+    mbox_frame[MBOX_STATUS - MBOX_BASE] = status;
+}
+
+static void mbox_reply_ctrl(void)
+{
+    uint8_t *reply = &mbox_frame[MBOX_HEADER_SIZE];
+    for (uint16_t i = 0; i < MBOX_REPLY_CTRL_SIZE; i++)
+        reply[i] = ctrl_register_read((uint16_t)(CTRL_BASE_ADDR + i));
+    reply[MBOX_REPLY_VDP_FREQ] = ctrl_vdp_frequency;
+    memcpy(&reply[MBOX_REPLY_PARTITION], ctrl_sd_partition_info, CTRL_SD_PARTITION_INFO_SIZE);
+    mbox_reply(MBOX_STATUS_DONE, MBOX_REPLY_SIZE);
+}
+
+static bool mbox_command_known(uint8_t cmd)
+{
+    return (cmd >= CMD_APPLY_FILTER && cmd <= CMD_DELETE_SD_FILE) ||
+           (cmd >= CMD_FH_LIST_PAGE && cmd <= CMD_FH_WIFI_CONFIG);
+}
+
+static void mbox_post(uint8_t seq, explorer_menu_ctx_t *menu_ctx)
+{
+    uint8_t cmd = mbox_frame[MBOX_CMD - MBOX_BASE];
+    uint16_t length = (uint16_t)(mbox_frame[MBOX_LEN_L - MBOX_BASE] |
+                                 ((uint16_t)mbox_frame[MBOX_LEN_H - MBOX_BASE] << 8));
+    const uint8_t *payload = &mbox_frame[MBOX_HEADER_SIZE];
+
+    mbox_frame[MBOX_SEQ - MBOX_BASE] = seq;
+    mbox_frame[MBOX_STATUS - MBOX_BASE] = MBOX_STATUS_BUSY;
+    mbox_mapped = true;
+
+    if (!mbox_command_known(cmd) || length > CTRL_QUERY_SIZE)
+    {
+        mbox_reply(MBOX_STATUS_ERROR, 0);
+        return;
+    }
+    for (uint16_t i = 0; i < CTRL_QUERY_SIZE; i++)
+    {
+        uint8_t value = i < length ? payload[i] : 0u;
+        filter_query[i] = (char)value;
+        if (i < FH_QUERY_SIZE)
+            fh_query[i] = value;
+    }
+    ctrl_dispatch_command(cmd, menu_ctx);
+    if (ctrl_cmd_state == 0)
+        mbox_reply_ctrl();
+    else
+        mbox_pending = true;
+}
+
+static void __not_in_flash_func(mbox_handle_write)(uint16_t addr, uint8_t data, explorer_menu_ctx_t *menu_ctx)
+{
+    if (addr == MBOX_STATUS)
+    {
+        if (data == 0u)
+        {
+            mbox_mapped = false;
+            mbox_pending = false;
+            mbox_frame[MBOX_STATUS - MBOX_BASE] = MBOX_STATUS_IDLE;
+        }
+        return;
+    }
+    if (addr == MBOX_SEQ)
+    {
+        if (data != 0u && !mbox_pending)
+            mbox_post(data, menu_ctx);
+        return;
+    }
+    // A new request is being written: drop any reply still mapped.
+    if (mbox_mapped && !mbox_pending)
+    {
+        mbox_mapped = false;
+        mbox_frame[MBOX_STATUS - MBOX_BASE] = MBOX_STATUS_IDLE;
+    }
+    mbox_frame[addr - MBOX_BASE] = data;
+}
+
+// Completes a mailbox request whose command finished in the background.
+static inline void mbox_service(void)
+{
+    if (mbox_pending && ctrl_cmd_state == 0)
+        mbox_reply_ctrl();
+}
+
 static inline void __not_in_flash_func(handle_menu_write_explorer)(uint16_t addr, uint8_t data, void *ctx)
 {
     explorer_menu_ctx_t *menu_ctx = (explorer_menu_ctx_t *)ctx;
 
+    if (addr >= MBOX_BASE && addr < (MBOX_BASE + DATA_BUFFER_SIZE))
+    {
+        mbox_handle_write(addr, data, menu_ctx);
+        return;
+    }
+
     if (addr >= CTRL_QUERY_BASE && addr < (CTRL_QUERY_BASE + CTRL_QUERY_SIZE))
     {
         uint16_t query_offset = addr - CTRL_QUERY_BASE;
@@ -5129,99 +7738,7 @@ static inline void __not_in_flash_func(handle_menu_write_explorer)(uint16_t addr
 
     if (addr == CTRL_CMD)
     {
-        ctrl_cmd_state = data;
-        if (data == CMD_APPLY_FILTER)
-        {
-            filter_query[CTRL_QUERY_SIZE - 1] = '\0';
-            apply_filter();
-            current_page = 0;
-            build_page_buffer(current_page);
-        }
-        else if (data == CMD_FIND_FIRST)
-        {
-            filter_query[CTRL_QUERY_SIZE - 1] = '\0';
-            find_first_match();
-        }
-        else if (data == CMD_ENTER_DIR)
-        {
-            process_enter_dir_request();
-            // Keep ctrl_cmd_state as CMD_ENTER_DIR to signal busy/done?
-            // Original code: ctrl_cmd_state = CMD_ENTER_DIR;
-            // Then it checked if (cmd != CMD_ENTER_DIR...) ctrl_cmd_state = 0;
-            // Here data is CMD_ENTER_DIR.
-        }
-        else if (data == CMD_DETECT_MAPPER)
-        {
-             uint16_t index = (uint16_t)((uint8_t)filter_query[0]) |
-                                         (uint16_t)(((uint8_t)filter_query[1]) << 8);
-             detect_mapper_index = index;
-             detect_mapper_pending = true;
-             ctrl_mapper_value = 0;
-        }
-        else if (data == CMD_SET_MAPPER)
-        {
-             uint16_t index = (uint16_t)((uint8_t)filter_query[0]) |
-                                         (uint16_t)(((uint8_t)filter_query[1]) << 8);
-             uint8_t mapper = (uint8_t)filter_query[2];
-             
-             ctrl_ack_value = 0;
-             if (index < total_record_count && mapper != 0 && !is_system_mapper(mapper) && mapper < MAPPER_DESCRIPTION_COUNT) {
-                 uint16_t record_index = filtered_indices[index];
-                 if (record_index < full_record_count) {
-                    ROMRecord *rec = &records[record_index];
-                    uint8_t flags = rec->Mapper & (SOURCE_SD_FLAG | FOLDER_FLAG | MP3_FLAG);
-                    if ((flags & (FOLDER_FLAG | MP3_FLAG)) == 0) {
-                        rec->Mapper = (uint8_t)(flags | mapper);
-                        ctrl_ack_value = 1;
-                    }
-                 }
-             }
-        }
-        else if (data == CMD_SET_SOURCE)
-        {
-            uint8_t mode = (uint8_t)filter_query[0];
-            if (mode > SOURCE_MODE_SD) {
-                mode = SOURCE_MODE_ALL;
-            }
-            cancel_refresh_work();
-            fh_menu_window_active = false;
-            browse_source_mode = mode;
-            sd_current_path[0] = '/';
-            sd_current_path[1] = '\0';
-            memset(filter_query, 0, sizeof(filter_query));
-            refresh_requested = true;
-        }
-        else if (data == CMD_LOAD_OPTIONS)
-        {
-            process_load_options_request();
-        }
-        else if (data == CMD_SAVE_OPTIONS)
-        {
-            process_save_options_request();
-        }
-        else if (data == CMD_PREPARE_QUICK_RUN)
-        {
-            process_prepare_quick_run_request();
-        }
-        else if (data == CMD_CYCLE_SD_PARTITION)
-        {
-            process_cycle_sd_partition_request();
-        }
-        else if (data == CMD_DELETE_SD_FILE)
-        {
-            process_delete_sd_file_request();
-        }
-        else if (data == CMD_FH_LIST_PAGE || data == CMD_FH_SEARCH ||
-                 data == CMD_FH_DOWNLOAD || data == CMD_FH_WIFI_STATUS ||
-                 data == CMD_FH_WIFI_CONFIG)
-        {
-            cancel_refresh_work();
-            handle_menu_fh_command(data, menu_ctx);
-        }
-        
-           if (data != CMD_ENTER_DIR && data != CMD_DETECT_MAPPER && data != CMD_DELETE_SD_FILE) {
-             ctrl_cmd_state = 0;
-        }
+        ctrl_dispatch_command(data, menu_ctx);
         return;
     }
 
@@ -5282,24 +7799,42 @@ static inline void __not_in_flash_func(handle_menu_write_explorer)(uint16_t addr
         return;
     }
 
+    if (addr == CTRL_PAGE_H) {
+        ctrl_page_high = data;
+        return;
+    }
+
+    if (addr == CTRL_BOOT_STAGE) {
+        ctrl_boot_stage = data;
+        return;
+    }
+
     if (addr == CTRL_PAGE) {
+        uint16_t page = (uint16_t)(((uint16_t)ctrl_page_high << 8) | data);
+        ctrl_page_high = 0;
         if (fh_menu_window_active) {
             fh_page_index = data;
-        } else if (data != current_page) {
-            current_page = data;
+        } else if (page != current_page) {
+            current_page = page;
             build_page_buffer(current_page);
         }
         return;
     }
 
+    if (addr == MONITOR_ADDR_H) {
+        rom_select_high = data;
+        return;
+    }
+
     if (addr == MONITOR_ADDR) {
-        uint8_t selected_index = data;
+        uint16_t selected_index = (uint16_t)(((uint16_t)rom_select_high << 8) | data);
+        rom_select_high = 0;
         if (selected_index == ROM_SELECT_MENU) {
             menu_ctx->rom_selected = false;
             return;
         }
         if (selected_index < total_record_count) {
-            menu_ctx->rom_index = (uint8_t)filtered_indices[selected_index];
+            menu_ctx->rom_index = filtered_indices[selected_index];
             menu_ctx->rom_selected = true;
         }
         return;
@@ -5385,6 +7920,10 @@ static uint8_t __not_in_flash_func(fh_read_menu_window_byte)(uint16_t addr, bool
         {
             data = (uint8_t)fh_wifi_status_text[addr - FH_STATUS_TEXT_BASE];
         }
+        else if (mbox_mapped && addr >= MBOX_BASE && addr < (MBOX_BASE + DATA_BUFFER_SIZE))
+        {
+            data = mbox_frame[addr - MBOX_BASE];
+        }
         else if (addr >= FH_DATA_BASE && addr < (FH_DATA_BASE + (FH_RECORD_SIZE * FH_FILES_PER_PAGE)))
         {
             data = page_buffer[addr - FH_DATA_BASE];
@@ -5828,6 +8367,11 @@ static void fh_wifi_tcp_close(uint8_t connection)
 
 typedef bool (*fh_http_body_callback_t)(const uint8_t *data, uint16_t len, void *ctx);
 
+// Work the HTTP receive loop runs while the Wi-Fi module has no data
+// pending. NULL when the current transfer has none.
+static void (*fh_http_idle_work)(void *ctx) = NULL;
+static void *fh_http_idle_ctx = NULL;
+
 typedef struct {
     bool chunked;
     bool done;
@@ -6159,6 +8703,8 @@ static bool fh_http_get_url(const char *url, fh_http_body_callback_t callback, v
         }
         if (bytes_read == 0)
         {
+            if (fh_http_idle_work)
+                fh_http_idle_work(fh_http_idle_ctx);
             fh_service_msx_reads_for(10000u);
             continue;
         }
@@ -6441,9 +8987,16 @@ typedef struct {
     uint32_t expected_size;
     uint32_t written;
     uint16_t fallback_size_kb;
+    bool zip;                   // body is a .zip, inflated while it streams in
+    bool unzip_failed;
+    fh_unzip_result_t unzip_result;
     bool failed;
 } fh_psram_download_t;
 
+// Inflate state for zipped downloads. Static because the Huffman tables are
+// too large for the stack.
+static fh_unzip_t fh_unzip;
+
 static uint32_t fh_parse_download_size(const char *line, uint16_t fallback_size_kb)
 {
     const char *ptr = strstr(line, "size:");
@@ -6479,6 +9032,8 @@ static bool fh_prepare_download_region(uint32_t size)
 
     if (size <= sd_rom_region.size)
     {
+        // The download overwrites whatever SD images were resident.
+        recent_rom_forget_all();
         fh_download_region = sd_rom_region;
         return true;
     }
@@ -6487,12 +9042,100 @@ static bool fh_prepare_download_region(uint32_t size)
     return psram_alloc(size, &fh_download_region);
 }
 
+// Zipped downloads stage the archive in its own region and inflate into the
+// full SD ROM region, since the extracted size is only known from the entry
+// header once it arrives. The staging region is sized from the archive's
+// announced size, rounded up to FH_ZIP_STAGING_STEP, and never grows past
+// FH_ZIP_STAGING_MAX_SIZE. It is reused by later downloads.
+#define FH_ZIP_STAGING_MAX_SIZE (1024u * 1024u)
+#define FH_ZIP_STAGING_STEP     (64u * 1024u)
+
+// Largest archive a zipped download can stage without claiming more PSRAM
+// than the cap allows.
+static uint32_t fh_zip_capacity(void)
+{
+    if (!psram_bring_up_once()) return 0u;
+    uint32_t limit = psram_alloc_limit();
+    uint32_t next_free = psram_mgr.next_free;
+    if (fh_zip_region.ptr && fh_zip_region.offset + fh_zip_region.size == next_free)
+        next_free = fh_zip_region.offset;
+    uint32_t avail = (limit > next_free) ? (limit - next_free) : 0u;
+    if (fh_zip_region.ptr && fh_zip_region.size > avail) avail = fh_zip_region.size;
+    return (avail > FH_ZIP_STAGING_MAX_SIZE) ? FH_ZIP_STAGING_MAX_SIZE : avail;
+}
+
+static bool fh_prepare_zip_region(uint32_t size)
+{
+    if (size == 0u || size > FH_ZIP_STAGING_MAX_SIZE) return false;
+    if (!fh_prepare_download_region(SD_ROM_MAX_SIZE)) return false;
+    if (fh_zip_region.ptr && size <= fh_zip_region.size) return true;
+
+    uint32_t staging = (size + FH_ZIP_STAGING_STEP - 1u) & ~(FH_ZIP_STAGING_STEP - 1u);
+    if (staging > FH_ZIP_STAGING_MAX_SIZE) staging = FH_ZIP_STAGING_MAX_SIZE;
+    uint32_t next_free = psram_mgr.next_free;
+    if (fh_zip_region.ptr)
+    {
+        // Grow in place when nothing was allocated after it; otherwise leave
+        // the old region behind once and take the full cap so it never moves
+        // again.
+        if (fh_zip_region.offset + fh_zip_region.size == next_free)
+            psram_mgr.next_free = fh_zip_region.offset;
+        else
+            staging = FH_ZIP_STAGING_MAX_SIZE;
+    }
+    psram_region_t region;
+    if (!psram_alloc(staging, &region))
+    {
+        psram_mgr.next_free = next_free;
+        return false;
+    }
+    fh_zip_region = region;
+    printf("FH: zip staging region %lu bytes\n", (unsigned long)staging);
+    return true;
+}
+
+static void fh_psram_download_unzip_result(fh_psram_download_t *download)
+{
+    if (download->unzip_result == FH_UNZIP_ERROR)
+    {
+        printf("FH: unzip failed at %lu bytes: %s\n", (unsigned long)download->written,
+               fh_unzip.error ? fh_unzip.error : "?");
+        download->unzip_failed = true;
+    }
+}
+
+// One inflater slice over what is staged so far. The HTTP receive loop runs
+// it while no data is pending, so inflating never delays the transfer.
+static void fh_psram_download_unzip_idle(void *ctx)
+{
+    fh_psram_download_t *download = (fh_psram_download_t *)ctx;
+    if (!download->metadata_done || download->unzip_failed || download->unzip_result == FH_UNZIP_DONE) return;
+    download->unzip_result = fh_unzip_feed(&fh_unzip, fh_zip_region.ptr, download->written, false);
+    fh_psram_download_unzip_result(download);
+}
+
+// Inflate the rest once the archive is complete. Between work slices the
+// MSX keeps getting served so the progress screen stays alive.
+static void fh_psram_download_unzip_finish(fh_psram_download_t *download)
+{
+    if (download->unzip_failed || download->unzip_result == FH_UNZIP_DONE) return;
+    do
+    {
+        download->unzip_result = fh_unzip_feed(&fh_unzip, fh_zip_region.ptr, download->written, true);
+        fh_service_msx_reads();
+    } while (download->unzip_result == FH_UNZIP_BUSY);
+    fh_psram_download_unzip_result(download);
+}
+
 static bool fh_psram_download_body_callback(const uint8_t *data, uint16_t len, void *ctx)
 {
     fh_psram_download_t *download = (fh_psram_download_t *)ctx;
     const uint8_t *ptr = data;
     uint16_t remaining = len;
 
+    if (download->unzip_failed)
+        return false;
+
     while (!download->metadata_done && remaining > 0u)
     {
         uint8_t ch = *ptr++;
@@ -6501,11 +9144,14 @@ static bool fh_psram_download_body_callback(const uint8_t *data, uint16_t len, v
         {
             download->metadata_line[download->metadata_len] = '\0';
             download->expected_size = fh_parse_download_size(download->metadata_line, download->fallback_size_kb);
-            if (!fh_prepare_download_region(download->expected_size))
+            if (download->zip ? !fh_prepare_zip_region(download->expected_size)
+                              : !fh_prepare_download_region(download->expected_size))
             {
                 download->failed = true;
                 return false;
             }
+            if (download->zip)
+                fh_unzip_init(&fh_unzip, fh_download_region.ptr, fh_download_region.size);
             download->metadata_done = true;
             fh_progress_percent = 0;
             break;
@@ -6520,15 +9166,16 @@ static bool fh_psram_download_body_callback(const uint8_t *data, uint16_t len, v
     if (remaining > 0u)
     {
         uint32_t to_copy = remaining;
+        psram_region_t *dst = download->zip ? &fh_zip_region : &fh_download_region;
 
-        if (!fh_download_region.ptr || download->written > fh_download_region.size ||
-            to_copy > (fh_download_region.size - download->written))
+        if (!dst->ptr || download->written > dst->size ||
+            to_copy > (dst->size - download->written))
         {
             download->failed = true;
             return false;
         }
 
-        memcpy(fh_download_region.ptr + download->written, ptr, to_copy);
+        memcpy(dst->ptr + download->written, ptr, to_copy);
         download->written += to_copy;
     }
 
@@ -6724,23 +9371,58 @@ static bool fh_download_selected(void)
         fh_copy_status_prefix("Download blocked: >4MB");
         return false;
     }
+    if (fh_unzip_is_zip_name(fh_catalog[fh_selected_index].name) &&
+        ((uint32_t)fh_catalog[fh_selected_index].size_kb * 1024u) > fh_zip_capacity())
+    {
+        fh_copy_status_prefix("Download blocked: zip too big");
+        return false;
+    }
 
     fh_build_http_path(path, sizeof(path), fh_active_query, (int)fh_selected_index);
 
     memset(&download, 0, sizeof(download));
     download.fallback_size_kb = fh_catalog[fh_selected_index].size_kb;
+    download.zip = fh_unzip_is_zip_name(fh_catalog[fh_selected_index].name);
     fh_progress_percent = 0;
+    if (download.zip)
+    {
+        fh_http_idle_work = fh_psram_download_unzip_idle;
+        fh_http_idle_ctx = &download;
+    }
     http_ok = fh_http_get(path, fh_psram_download_body_callback, &download, 20000000u);
+    fh_http_idle_work = NULL;
+    fh_http_idle_ctx = NULL;
     ok = http_ok &&
          download.metadata_done && !download.failed &&
             download.written != 0u &&
             (download.expected_size == 0u || download.written >= download.expected_size);
+    if (ok && download.zip)
+    {
+        // Most of the archive has been inflated already; finish the tail.
+        fh_psram_download_unzip_finish(&download);
+        ok = download.unzip_result == FH_UNZIP_DONE && fh_unzip.out_len != 0u;
+        if (!ok) download.unzip_failed = true;
+    }
     if (ok)
     {
         fh_progress_percent = 100u;
-        fh_download_size = download.written;
-        strncpy(fh_download_name, fh_catalog[fh_selected_index].name, sizeof(fh_download_name) - 1u);
+        if (download.zip)
+        {
+            // Save under the name of the extracted entry, without its folder.
+            const char *inner = strrchr(fh_unzip.name, '/');
+            inner = inner ? inner + 1 : fh_unzip.name;
+            fh_download_size = fh_unzip.out_len;
+            strncpy(fh_download_name, *inner ? inner : fh_catalog[fh_selected_index].name, sizeof(fh_download_name) - 1u);
+            printf("FH: extracted %s (%lu bytes) from %s\n", fh_download_name,
+                   (unsigned long)fh_download_size, fh_catalog[fh_selected_index].name);
+        }
+        else
+        {
+            fh_download_size = download.written;
+            strncpy(fh_download_name, fh_catalog[fh_selected_index].name, sizeof(fh_download_name) - 1u);
+        }
         fh_download_name[sizeof(fh_download_name) - 1u] = '\0';
+        rom_verify_begin(fh_download_region.offset, fh_download_size, NULL, -1);
         fh_result = FH_RESULT_SAVING;
         fh_copy_status_prefix("Saving to microSD card...");
         fh_service_msx_reads_for(250000u);
@@ -6754,7 +9436,9 @@ static bool fh_download_selected(void)
             percent = (download.written * 100u) / download.expected_size;
             if (percent > 100u) percent = 100u;
         }
-        if (!http_ok)
+        if (download.unzip_failed)
+            fh_copy_status_prefix("Download failed: unzip");
+        else if (!http_ok)
             snprintf(fh_wifi_status_text, sizeof(fh_wifi_status_text), "Download failed: TCP %u %lu%%", (unsigned int)fh_tcp_last_error, (unsigned long)percent);
         else if (!download.metadata_done)
             fh_copy_status_prefix("Download failed: no size");
@@ -6992,7 +9676,7 @@ static inline void __not_in_flash_func(handle_fh_write)(uint16_t addr, uint8_t d
 
 static int __no_inline_not_in_flash_func(loadrom_filehunter)(void)
 {
-    msx_pio_bus_init();
+    msx_pio_bus_start(NULL, false);
 
     bool exit_requested = false;
     fh_page_index = 0;
@@ -7055,6 +9739,7 @@ int __no_inline_not_in_flash_func(loadrom_msx_menu)(uint32_t offset)
     {
         return 0xFFFF;
     }
+    boot_mark(BOOT_STAGE_PSRAM);
 
     //setup the rom_sram buffer for the 32KB ROM
     gpio_init(PIN_WAIT); // Init wait signal pin
@@ -7063,6 +9748,7 @@ int __no_inline_not_in_flash_func(loadrom_msx_menu)(uint32_t offset)
     memset(rom_sram, 0, MENU_ROM_SIZE); // Clear the SRAM buffer
     memcpy(rom_sram, flash_rom + offset, MENU_ROM_SIZE); // Load full 32KB menu ROM
     gpio_set_dir(PIN_WAIT, GPIO_IN); // Lets go!
+    boot_mark(BOOT_STAGE_MENU_ROM);
 
     int record_count = 0; // Record count
     const uint8_t *record_ptr = flash_rom + offset + MENU_ROM_SIZE; // Pointer to the ROM records
@@ -7085,8 +9771,20 @@ int __no_inline_not_in_flash_func(loadrom_msx_menu)(uint32_t offset)
         record_count++; // Increment the record count
     }
     flash_record_count = (uint16_t)record_count;
+    record_store_attach();
+    if (psram_bring_up_once())
+        rom_verify_record_attach();
+    boot_mark(BOOT_STAGE_RECORDS);
     set_root_path();
-    refresh_records_for_current_path();
+
+    // The first directory listing (SD mount included) is not done here:
+    // it is queued for the chunked refresh below, so the menu ROM is served
+    // from the first bus cycle and the listing streams in during bus idle.
+    // CTRL_CMD reads CMD_ENTER_DIR until it is ready, which the menu waits
+    // on exactly as it does after entering a folder.
+    cancel_refresh_work();
+    ctrl_cmd_state = CMD_ENTER_DIR;
+    refresh_requested = true;
 
     // Core 1 is intentionally NOT launched here. Folder navigation,
     // mapper detection, and SD enumeration all run on Core 0 from the
@@ -7097,11 +9795,13 @@ int __no_inline_not_in_flash_func(loadrom_msx_menu)(uint32_t offset)
     // SELECT+PLAY (issued ~10 ms apart by the menu) both fit while
     // mp3_init() is still running on Core 1.
 
-    uint16_t rom_index = 0;
+    uint32_t rom_index = 0;
     gpio_set_dir_in_masked(0xFF << 16); // Set data bus to input mode
     bool rom_selected = false; // ROM selected flag
+    rom_cache_base = 0;
     rom_cached_size = MENU_ROM_SIZE;
-    msx_pio_bus_init();
+    msx_pio_bus_start(NULL, false); // live control registers: always hold the Z80
+    bus_probe_start(); // re-measured every session: a turbo R may have changed CPU
 
     explorer_menu_ctx_t menu_ctx = {0};
 
@@ -7123,11 +9823,22 @@ int __no_inline_not_in_flash_func(loadrom_msx_menu)(uint32_t offset)
             // SD directory refresh, mapper detection, and bridging MP3
             // commands to Core 1 (lazy-launched on first MP3 command).
             core1_bg_work();
+            mbox_service();
+            bus_probe_poll();
+#if EXPLORER_USB_PUSH
+            usb_push_dev_task(&usb_push_sink);
+            if (usb_push_launch_pending && !menu_ctx.rom_selected)
+            {
+                menu_ctx.rom_index = ROM_SELECT_USB_PUSH;
+                menu_ctx.rom_selected = true;
+            }
+#endif
             tight_loop_contents();
             continue;
         }
 
         uint16_t addr = (uint16_t)pio_sm_get_blocking(msx_bus.pio, msx_bus.sm_read);
+        boot_mark(BOOT_STAGE_MSX_FIRST_READ);
 
         pio_drain_writes(handle_menu_write_explorer, &menu_ctx);
 
@@ -7148,47 +9859,7 @@ int __no_inline_not_in_flash_func(loadrom_msx_menu)(uint32_t offset)
 
             if (addr >= CTRL_BASE_ADDR && addr <= (CTRL_BASE_ADDR + 0x0F))
             {
-                if (fh_menu_window_active)
-                {
-                    switch (addr)
-                    {
-                        case CTRL_COUNT_L: data = (uint8_t)(fh_catalog_count & 0xFFu); break;
-                        case CTRL_COUNT_H: data = (uint8_t)((fh_catalog_count >> 8) & 0xFFu); break;
-                        case CTRL_PAGE:    data = fh_page_index; break;
-                        case CTRL_STATUS:  data = fh_status; break;
-                        case CTRL_CMD:     data = ctrl_cmd_state; break;
-                        case CTRL_MATCH_L: data = (uint8_t)(fh_selected_index & 0xFFu); break;
-                        case CTRL_MATCH_H: data = (uint8_t)((fh_selected_index >> 8) & 0xFFu); break;
-                        case CTRL_MAPPER:  data = (uint8_t)(fh_progress_percent & 0xFFu); break;
-                        case CTRL_ACK:     data = (uint8_t)((fh_progress_percent >> 8) & 0xFFu); break;
-                        case CTRL_AUDIO:   data = fh_result; break;
-                        case CTRL_WIFI_SUPPORT: data = 0; break;
-                        case CTRL_PSG_EMULATION: data = 0; break;
-                        case CTRL_WAVEGAME_ROM: data = 0; break;
-                        case CTRL_SD_PARTITION: data = 0; break;
-                        case CTRL_SD_BROWSE_PARTITION: data = 0; break;
-                        case CTRL_AUDIO_VOLUME: data = 0; break;
-                    }
-                }
-                else switch (addr)
-                {
-                    case CTRL_COUNT_L: data = (uint8_t)(total_record_count & 0xFFu); break;
-                    case CTRL_COUNT_H: data = (uint8_t)((total_record_count >> 8) & 0xFFu); break;
-                    case CTRL_PAGE:    data = current_page; break;
-                    case CTRL_STATUS:  data = ctrl_status_value; break;
-                    case CTRL_CMD:     data = ctrl_cmd_state; break;
-                    case CTRL_MATCH_L: data = (uint8_t)(match_index & 0xFFu); break;
-                    case CTRL_MATCH_H: data = (uint8_t)((match_index >> 8) & 0xFFu); break;
-                    case CTRL_MAPPER:  data = ctrl_mapper_value; break;
-                    case CTRL_ACK:     data = ctrl_ack_value; break;
-                    case CTRL_AUDIO:   data = ctrl_audio_selection; break;
-                    case CTRL_WIFI_SUPPORT: data = ctrl_wifi_support; break;
-                    case CTRL_PSG_EMULATION: data = ctrl_psg_emulation; break;
-                    case CTRL_WAVEGAME_ROM: data = ctrl_wavegame_rom; break;
-                    case CTRL_SD_PARTITION: data = ctrl_sd_partition; break;
-                    case CTRL_SD_BROWSE_PARTITION: data = sd_browse_partition; break;
-                    case CTRL_AUDIO_VOLUME: data = ctrl_audio_volume; break;
-                }
+                data = ctrl_register_read(addr);
             }
             else if (addr >= MP3_CTRL_BASE && addr <= (MP3_CTRL_BASE + 0x0F))
             {
@@ -7204,6 +9875,7 @@ int __no_inline_not_in_flash_func(loadrom_msx_menu)(uint32_t offset)
                     case MP3_CTRL_INDEX_L:   data = (uint8_t)(mp3_selected_index & 0xFFu); break;
                     case MP3_CTRL_INDEX_H:   data = (uint8_t)((mp3_selected_index >> 8) & 0xFFu); break;
                     case MP3_CTRL_MODE:      data = mp3_play_mode; break;
+                    case CTRL_USB_PUSH:      data = usb_push_launch_pending ? CTRL_MAGIC : 0x00u; break;
                 }
             }
             else if (addr >= CTRL_SD_PARTITION_INFO_BASE && addr < (CTRL_SD_PARTITION_INFO_BASE + CTRL_SD_PARTITION_INFO_SIZE))
@@ -7218,10 +9890,28 @@ int __no_inline_not_in_flash_func(loadrom_msx_menu)(uint32_t offset)
             {
                 data = ctrl_vdp_frequency;
             }
+            else if (!fh_menu_window_active && addr >= CTRL_BOOT_STAGE && addr <= CTRL_BOOT_TIME_H)
+            {
+                uint16_t ms = boot_stage_ms(ctrl_boot_stage);
+                if (addr == CTRL_BOOT_STAGE) data = BOOT_STAGE_COUNT;
+                else if (addr == CTRL_BOOT_TIME_L) data = (uint8_t)(ms & 0xFFu);
+                else data = (uint8_t)(ms >> 8);
+            }
+            else if (!fh_menu_window_active && addr >= CTRL_VERIFY_STATUS && addr < (CTRL_VERIFY_SHA1_BASE + CTRL_VERIFY_SHA1_SIZE))
+            {
+                if (addr == CTRL_VERIFY_STATUS) data = rom_verify_status;
+                else if (addr == CTRL_VERIFY_PROGRESS) data = rom_verify_progress;
+                else if (addr >= CTRL_VERIFY_SHA1_BASE) data = rom_verify_digest[addr - CTRL_VERIFY_SHA1_BASE];
+                else data = 0;
+            }
             else if (fh_menu_window_active && addr >= FH_STATUS_TEXT_BASE && addr < (FH_STATUS_TEXT_BASE + FH_STATUS_TEXT_SIZE))
             {
                 data = (uint8_t)fh_wifi_status_text[addr - FH_STATUS_TEXT_BASE];
             }
+            else if (mbox_mapped && addr >= MBOX_BASE && addr < (MBOX_BASE + DATA_BUFFER_SIZE))
+            {
+                data = mbox_frame[addr - MBOX_BASE];
+            }
             else if (addr >= DATA_BASE_ADDR && addr < (DATA_BASE_ADDR + DATA_BUFFER_SIZE))
             {
                 data = page_buffer[addr - DATA_BASE_ADDR];
@@ -7299,8 +9989,8 @@ int __no_inline_not_in_flash_func(loadrom_msx_menu)(uint32_t offset)
                         uint8_t mapper = (uint8_t)filter_query[2];
                         ctrl_ack_value = 0;
 
-                        if (index < total_record_count && mapper != 0 && !is_system_mapper(mapper) && mapper < MAPPER_DESCRIPTION_COUNT) {
-                            uint16_t record_index = filtered_indices[index];
+                        if (index < total_record_count && mapper_is_selectable(mapper)) {
+                            uint32_t record_index = filtered_indices[index];
                             if (record_index < full_record_count) {
                                 ROMRecord *rec = &records[record_index];
                                 uint8_t flags = rec->Mapper & (SOURCE_SD_FLAG | FOLDER_FLAG | MP3_FLAG);
@@ -7504,29 +10194,151 @@ int __no_inline_not_in_flash_func(loadrom_msx_menu)(uint32_t offset)
                         continue;
                     }
 
-                    gpio_set_dir_out_masked(0xFF << 16); // Set data bus to output mode
-                    uint8_t data;
-                    if (addr >= DATA_BASE_ADDR && addr < (DATA_BASE_ADDR + DATA_BUFFER_SIZE)) {
-                        data = page_buffer[addr - DATA_BASE_ADDR];
-                    } else {
-                        uint32_t rom_addr = (uint32_t)(addr - 0x4000); // Offset within 32KB menu ROM
-                        data = rom_sram[rom_addr];
-                    }
-                    gpio_put_masked(0xFF0000, (uint32_t)data << 16); // Write the data to the data bus
-                    while (!(gpio_get(PIN_RD))) { // Wait until the read cycle completes (RD goes high)
-                        tight_loop_contents();
-                    }
-                    gpio_set_dir_in_masked(0xFF << 16); // Set data bus to input mode
-                }
-            } 
-        }
+                    gpio_set_dir_out_masked(0xFF << 16); // Set data bus to output mode
+                    uint8_t data;
+                    if (addr >= DATA_BASE_ADDR && addr < (DATA_BASE_ADDR + DATA_BUFFER_SIZE)) {
+                        data = page_buffer[addr - DATA_BASE_ADDR];
+                    } else {
+                        uint32_t rom_addr = (uint32_t)(addr - 0x4000); // Offset within 32KB menu ROM
+                        data = rom_sram[rom_addr];
+                    }
+                    gpio_put_masked(0xFF0000, (uint32_t)data << 16); // Write the data to the data bus
+                    while (!(gpio_get(PIN_RD))) { // Wait until the read cycle completes (RD goes high)
+                        tight_loop_contents();
+                    }
+                    gpio_set_dir_in_masked(0xFF << 16); // Set data bus to input mode
+                }
+            } 
+        }
+
+        if (rd && addr == 0x0000 && rom_selected)   // lets return the rom_index and load the selected ROM
+        {
+            return rom_index;
+        }
+    }
+    */
+}
+
+// -----------------------------------------------------------------------
+// DMA read responder
+//
+// Plain and linear ROM modes have no mapper state: every read is a fixed
+// function of the address. For those the whole 64KB slot image is laid out
+// as a byte table in SRAM and the bus is served without the CPU:
+//
+//   SM0 (msx_read_responder_dma) pushes table + address (table is 64KB-aligned)
+//   address channel: RX FIFO -> data channel READ_ADDR_TRIG (endless)
+//   data channel:    table[address] -> TX FIFO (one byte)
+//
+// Read latency no longer depends on core0 (flash/PSRAM misses, IRQs,
+// wavegame servicing), so the responder holds /WAIT only when a byte misses
+// the measured read deadline. Addresses outside the ROM window are driven as
+// 0xFF instead of left floating, which reads the same on the MSX side. The
+// table is heap-allocated at launch; if the heap or the DMA channels cannot
+// provide it the caller keeps its CPU loop.
+// WAIT-statistics builds always use the CPU loop, since there is nothing
+// left to measure otherwise.
+// -----------------------------------------------------------------------
+
+#define READ_DMA_TABLE_SIZE 0x10000u
+
+// Builds the table (0xFF outside [window_base, window_base + window_size)
+// and past the end of the image) and hands the bus to the DMA. Returns
+// false, with nothing started, when the responder cannot be set up.
+static bool read_dma_start(const uint8_t *rom_base, uint32_t available_length,
+                           uint32_t window_base, uint32_t window_size)
+{
+#if EXPLORER_WAIT_STATS
+    (void)rom_base; (void)available_length; (void)window_base; (void)window_size;
+    return false;
+#else
+    uint8_t *table = (uint8_t *)memalign(READ_DMA_TABLE_SIZE, READ_DMA_TABLE_SIZE);
+    if (!table)
+    {
+        printf("DMA: no SRAM for the read table, using the CPU responder\n");
+        return false;
+    }
+
+    int addr_chan = dma_claim_unused_channel(false);
+    int data_chan = dma_claim_unused_channel(false);
+    if (addr_chan < 0 || data_chan < 0)
+    {
+        if (addr_chan >= 0) dma_channel_unclaim((uint)addr_chan);
+        if (data_chan >= 0) dma_channel_unclaim((uint)data_chan);
+        free(table);
+        printf("DMA: no free channels, using the CPU responder\n");
+        return false;
+    }
+
+    // Hold the Z80 while the table is filled from flash/PSRAM.
+    gpio_init(PIN_WAIT);
+    gpio_set_dir(PIN_WAIT, GPIO_OUT);
+    gpio_put(PIN_WAIT, 0);
+
+    for (uint32_t addr = 0; addr < READ_DMA_TABLE_SIZE; ++addr)
+    {
+        uint32_t rel = addr - window_base;
+        uint8_t data = 0xFFu;
+        if (addr >= window_base && rel < window_size && (available_length == 0u || rel < available_length))
+            data = read_rom_byte(rom_base, rel);
+        table[addr] = data;
+    }
 
-        if (rd && addr == 0x0000 && rom_selected)   // lets return the rom_index and load the selected ROM
-        {
-            return rom_index;
-        }
+    msx_pio_bus_start(table, false);
+
+    dma_channel_config cfg = dma_channel_get_default_config((uint)data_chan);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+    channel_config_set_read_increment(&cfg, false);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, pio_get_dreq(msx_bus.pio, msx_bus.sm_read, true));
+    dma_channel_configure((uint)data_chan, &cfg, &msx_bus.pio->txf[msx_bus.sm_read], table, 1, false);
+
+    cfg = dma_channel_get_default_config((uint)addr_chan);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_32);
+    channel_config_set_read_increment(&cfg, false);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, pio_get_dreq(msx_bus.pio, msx_bus.sm_read, false));
+    dma_channel_configure((uint)addr_chan, &cfg, &dma_hw->ch[data_chan].al3_read_addr_trig,
+                          &msx_bus.pio->rxf[msx_bus.sm_read], dma_encode_endless_transfer_count(), true);
+
+    printf("DMA: read responder on channels %d/%d, table at %p\n", addr_chan, data_chan, (void *)table);
+    return true;
+#endif
+}
+
+// CPU fallback of the plain and linear loops: the window is copied into a
+// heap buffer so every read comes from on-chip SRAM, and the loop runs
+// under the deadline responder. Returns rom_base unchanged when the heap
+// cannot spare the copy.
+static const uint8_t *read_sram_copy(const uint8_t *rom_base, uint32_t available_length, uint32_t window_size)
+{
+    uint32_t length = (available_length == 0u || available_length > window_size) ? window_size : available_length;
+    uint8_t *copy = (uint8_t *)malloc(length);
+    if (!copy)
+        return rom_base;
+
+    gpio_init(PIN_WAIT);
+    gpio_set_dir(PIN_WAIT, GPIO_OUT);
+    gpio_put(PIN_WAIT, 0);
+    for (uint32_t rel = 0; rel < length; ++rel)
+        copy[rel] = read_rom_byte(rom_base, rel);
+    gpio_set_dir(PIN_WAIT, GPIO_IN);
+
+    rom_cache_base = 0;
+    rom_cached_size = 0; // read_rom_byte() now goes straight to the copy
+    bus_reads_sram = true;
+    return copy;
+}
+
+// Core0 has nothing left to do for the bus once the DMA responder runs;
+// it only keeps servicing the wavegame I/O ports.
+static void __no_inline_not_in_flash_func(read_dma_idle)(void)
+{
+    while (true)
+    {
+        wavegame_service_io();
+        tight_loop_contents();
     }
-    */
 }
 
 // loadrom_plain32 - Load a simple 32KB (or less) ROM into the MSX directly from the pico flash
@@ -7535,18 +10347,25 @@ int __no_inline_not_in_flash_func(loadrom_msx_menu)(uint32_t offset)
 // AB is on 0x0000, 0x0001
 // 16KB ROMS have only one page in the 0x4000-0x7FFF area
 // AB is on 0x0000, 0x0001
-void __no_inline_not_in_flash_func(loadrom_plain32)(uint32_t offset, bool cache_enable)
+void __no_inline_not_in_flash_func(loadrom_plain32)(uint32_t offset, bool cache_enable, bool core1_idle)
 {
     const uint8_t *rom_base;
     uint32_t available_length;
     prepare_rom_source(offset, cache_enable, 32768u, &rom_base, &available_length);
+    rom_verify_start_on_core1(core1_idle);
 
+    if (read_dma_start(rom_base, available_length, 0x4000u, 0x8000u))
+        read_dma_idle();
+
+    rom_base = read_sram_copy(rom_base, available_length, 0x8000u);
     msx_pio_bus_init();
+    wait_stats_reset();
 
     while (true)
     {
         wavegame_service_io();
         uint16_t addr = (uint16_t)pio_sm_get_blocking(msx_bus.pio, msx_bus.sm_read);
+        uint32_t wait_start = wait_stats_begin();
         wavegame_service_io();
 
         bool in_window = (addr >= 0x4000u) && (addr <= 0xBFFFu);
@@ -7560,6 +10379,7 @@ void __no_inline_not_in_flash_func(loadrom_plain32)(uint32_t offset, bool cache_
         }
 
         pio_sm_put_blocking(msx_bus.pio, msx_bus.sm_read, pio_build_token(in_window, data));
+        wait_stats_end(wait_start);
     }
 }
 
@@ -7567,18 +10387,25 @@ void __no_inline_not_in_flash_func(loadrom_plain32)(uint32_t offset, bool cache_
 // Those ROMs have three pages of 16Kb each in the following areas:
 // 0x0000-0x3FFF, 0x4000-0x7FFF and 0x8000-0xBFFF
 // AB is on 0x4000, 0x4001
-void __no_inline_not_in_flash_func(loadrom_linear48)(uint32_t offset, bool cache_enable)
+void __no_inline_not_in_flash_func(loadrom_linear48)(uint32_t offset, bool cache_enable, bool core1_idle)
 {
     const uint8_t *rom_base;
     uint32_t available_length;
     prepare_rom_source(offset, cache_enable, 49152u, &rom_base, &available_length);
+    rom_verify_start_on_core1(core1_idle);
+
+    if (read_dma_start(rom_base, available_length, 0x0000u, 0xC000u))
+        read_dma_idle();
 
+    rom_base = read_sram_copy(rom_base, available_length, 0xC000u);
     msx_pio_bus_init();
+    wait_stats_reset();
 
     while (true)
     {
         wavegame_service_io();
         uint16_t addr = (uint16_t)pio_sm_get_blocking(msx_bus.pio, msx_bus.sm_read);
+        uint32_t wait_start = wait_stats_begin();
         wavegame_service_io();
 
         bool in_window = (addr <= 0xBFFFu);
@@ -7587,6 +10414,7 @@ void __no_inline_not_in_flash_func(loadrom_linear48)(uint32_t offset, bool cache
             data = read_rom_byte(rom_base, addr);
 
         pio_sm_put_blocking(msx_bus.pio, msx_bus.sm_read, pio_build_token(in_window, data));
+        wait_stats_end(wait_start);
     }
 }
 
@@ -7597,12 +10425,13 @@ void __no_inline_not_in_flash_func(loadrom_linear48)(uint32_t offset, bool cache
 // And the address to change banks are:
 // Bank 1: 5000h - 57FFh (5000h used), Bank 2: 7000h - 77FFh (7000h used), Bank 3: 9000h - 97FFh (9000h used), Bank 4: B000h - B7FFh (B000h used)
 // AB is on 0x0000, 0x0001
-void __no_inline_not_in_flash_func(loadrom_konamiscc)(uint32_t offset, bool cache_enable)
+void __no_inline_not_in_flash_func(loadrom_konamiscc)(uint32_t offset, bool cache_enable, bool core1_idle)
 {
     uint8_t bank_registers[4] = {0, 1, 2, 3};
     const uint8_t *rom_base;
     uint32_t available_length;
     prepare_rom_source(offset, cache_enable, 0u, &rom_base, &available_length);
+    rom_verify_start_on_core1(core1_idle);
 
     msx_pio_bus_init();
     banked8_loop(rom_base, available_length, bank_registers, handle_konamiscc_write);
@@ -7637,6 +10466,7 @@ static void __no_inline_not_in_flash_func(core1_scc_audio)(void)
         }
         buffer->sample_count = SCC_AUDIO_BUFFER_SAMPLES;
         give_audio_buffer(scc_audio_pool, buffer);
+        title_profile_audio_tick();
     }
 }
 
@@ -7736,6 +10566,7 @@ static inline void __not_in_flash_func(scc_audio_service_buffer)(void)
     }
     buffer->sample_count = SCC_AUDIO_BUFFER_SAMPLES;
     give_audio_buffer(scc_audio_pool, buffer);
+    title_profile_audio_tick();
 }
 
 // -----------------------------------------------------------------------
@@ -7744,6 +10575,7 @@ static inline void __not_in_flash_func(scc_audio_service_buffer)(void)
 void __no_inline_not_in_flash_func(loadrom_konamiscc_scc)(uint32_t offset, bool cache_enable, uint32_t scc_type)
 {
     uint8_t bank_registers[4] = {0, 1, 2, 3};
+    bank8_ctx_t bank_ctx = { .bank_regs = bank_registers };
     const uint8_t *rom_base;
     uint32_t available_length;
     prepare_rom_source(offset, cache_enable, 0u, &rom_base, &available_length);
@@ -7770,10 +10602,7 @@ void __no_inline_not_in_flash_func(loadrom_konamiscc_scc)(uint32_t offset, bool
         uint8_t  wdata;
         while (pio_try_get_write(&waddr, &wdata))
         {
-            if      (waddr >= 0x5000u && waddr <= 0x57FFu) bank_registers[0] = wdata;
-            else if (waddr >= 0x7000u && waddr <= 0x77FFu) bank_registers[1] = wdata;
-            else if (waddr >= 0x9000u && waddr <= 0x97FFu) bank_registers[2] = wdata;
-            else if (waddr >= 0xB000u && waddr <= 0xB7FFu) bank_registers[3] = wdata;
+            handle_konamiscc_write(waddr, wdata, &bank_ctx);
 
             // Forward to SCC emulator (handles enable + register writes)
             SCC_write(&scc_instance, waddr, wdata);
@@ -7785,10 +10614,7 @@ void __no_inline_not_in_flash_func(loadrom_konamiscc_scc)(uint32_t offset, bool
         // drain writes that arrived while waiting
         while (pio_try_get_write(&waddr, &wdata))
         {
-            if      (waddr >= 0x5000u && waddr <= 0x57FFu) bank_registers[0] = wdata;
-            else if (waddr >= 0x7000u && waddr <= 0x77FFu) bank_registers[1] = wdata;
-            else if (waddr >= 0x9000u && waddr <= 0x97FFu) bank_registers[2] = wdata;
-            else if (waddr >= 0xB000u && waddr <= 0xB7FFu) bank_registers[3] = wdata;
+            handle_konamiscc_write(waddr, wdata, &bank_ctx);
             SCC_write(&scc_instance, waddr, wdata);
         }
 
@@ -7833,12 +10659,13 @@ void __no_inline_not_in_flash_func(loadrom_konamiscc_scc)(uint32_t offset, bool
 // And the addresses to change banks are:
 //	Bank 1: <none>, Bank 2: 6000h - 67FFh (6000h used), Bank 3: 8000h - 87FFh (8000h used), Bank 4: A000h - A7FFh (A000h used)
 // AB is on 0x0000, 0x0001
-void __no_inline_not_in_flash_func(loadrom_konami)(uint32_t offset, bool cache_enable)
+void __no_inline_not_in_flash_func(loadrom_konami)(uint32_t offset, bool cache_enable, bool core1_idle)
 {
     uint8_t bank_registers[4] = {0, 1, 2, 3};
     const uint8_t *rom_base;
     uint32_t available_length;
     prepare_rom_source(offset, cache_enable, 0u, &rom_base, &available_length);
+    rom_verify_start_on_core1(core1_idle);
 
     msx_pio_bus_init();
     banked8_loop(rom_base, available_length, bank_registers, handle_konami_write);
@@ -7851,7 +10678,7 @@ void __no_inline_not_in_flash_func(loadrom_konami)(uint32_t offset, bool cache_e
 // And the address to change banks are:
 // Bank 1: 6000h - 67FFh (6000h used), Bank 2: 6800h - 6FFFh (6800h used), Bank 3: 7000h - 77FFh (7000h used), Bank 4: 7800h - 7FFFh (7800h used)
 // AB is on 0x0000, 0x0001
-void __no_inline_not_in_flash_func(loadrom_ascii8)(uint32_t offset, bool cache_enable)
+void __no_inline_not_in_flash_func(loadrom_ascii8)(uint32_t offset, bool cache_enable, bool core1_idle)
 {
     // openMSX RomAscii8kB::reset() maps all four switchable 8 KB windows
     // (0x4000-0xBFFF) to block 0 at startup, not to a 0,1,2,3 linear layout.
@@ -7859,6 +10686,7 @@ void __no_inline_not_in_flash_func(loadrom_ascii8)(uint32_t offset, bool cache_e
     const uint8_t *rom_base;
     uint32_t available_length;
     prepare_rom_source(offset, cache_enable, 0u, &rom_base, &available_length);
+    rom_verify_start_on_core1(core1_idle);
 
     msx_pio_bus_init();
     banked8_loop(rom_base, available_length, bank_registers, handle_ascii8_write);
@@ -7870,45 +10698,30 @@ void __no_inline_not_in_flash_func(loadrom_ascii8)(uint32_t offset, bool cache_e
 // Bank 1: 4000h - 7FFFh , Bank 2: 8000h - BFFFh
 // And the address to change banks are:
 // Bank 1: 6000h - 67FFh (6000h used), Bank 2: 7000h - 77FFh (7000h and 77FFh used)
-void __no_inline_not_in_flash_func(loadrom_ascii16)(uint32_t offset, bool cache_enable)
+void __no_inline_not_in_flash_func(loadrom_ascii16)(uint32_t offset, bool cache_enable, bool core1_idle)
 {
     uint8_t bank_registers[2] = {0, 1};
     const uint8_t *rom_base;
     uint32_t available_length;
     prepare_rom_source(offset, cache_enable, 0u, &rom_base, &available_length);
+    rom_verify_start_on_core1(core1_idle);
 
     msx_pio_bus_init();
+    ascii16_loop(rom_base, available_length, bank_registers);
+}
 
-    bank8_ctx_t ctx = { .bank_regs = bank_registers };
-
-    // openMSX-style block handling for non power-of-two 16 KB ROMs.
-    uint32_t nrBlocks  = (available_length != 0u) ? ((available_length + 0x3FFFu) >> 14) : 0u;
-    uint32_t blockMask = (nrBlocks != 0u) ? (nrBlocks - 1u) : 0u;
-
-    while (true)
-    {
-        pio_drain_writes(handle_ascii16_write, &ctx);
-
-        uint16_t addr = (uint16_t)pio_sm_get_blocking(msx_bus.pio, msx_bus.sm_read);
-
-        pio_drain_writes(handle_ascii16_write, &ctx);
-
-        bool in_window = (addr >= 0x4000u) && (addr <= 0xBFFFu);
-        uint8_t data = 0xFFu;
-
-        if (in_window)
-        {
-            uint8_t bank = (addr >> 15) & 1;
-            uint32_t block = bank_registers[bank];
-            if (nrBlocks != 0u && block >= nrBlocks)
-                block &= blockMask;
-            uint32_t rel = (block << 14) | (addr & 0x3FFFu);
-            if (available_length == 0u || rel < available_length)
-                data = read_rom_byte(rom_base, rel);
-        }
+// loadrom_mapper_auto - Load an 8/16KB megaROM whose mapper is not known
+// The ROM starts under the provisional mapper (Konami SCC) and the mapper is
+// settled from the game's first bank-register writes; see mapper_auto_loop().
+void __no_inline_not_in_flash_func(loadrom_mapper_auto)(uint32_t offset, bool cache_enable, bool core1_idle)
+{
+    const uint8_t *rom_base;
+    uint32_t available_length;
+    prepare_rom_source(offset, cache_enable, 0u, &rom_base, &available_length);
+    rom_verify_start_on_core1(core1_idle);
 
-        pio_sm_put_blocking(msx_bus.pio, msx_bus.sm_read, pio_build_token(in_window, data));
-    }
+    msx_pio_bus_init();
+    mapper_auto_loop(rom_base, available_length);
 }
 
 
@@ -8139,11 +10952,17 @@ void __no_inline_not_in_flash_func(loadrom_sunrise_mapper)(uint32_t offset, bool
     }
 
     uint8_t mapper_reg[4] = { 3, 2, 1, 0 };
-    uint8_t subslot_reg = 0x10;
+
+    // Subslot 0: Sunrise IDE + Nextor ROM, subslot 1: 1MB memory mapper.
+    subslot_sunrise_ctx_t sunrise_dev = { .ide = &ide, .rom_base = rom_base, .available_length = available_length };
+    static subslot_map_t slots;
+    subslot_map_init(&slots, 0x10u);
+    subslot_map_attach(&slots, 0u, SUBSLOT_PAGE(1), subslot_sunrise_read, subslot_sunrise_write, &sunrise_dev);
+    subslot_map_attach(&slots, 1u, SUBSLOT_PAGES_ALL, subslot_mapper_read, subslot_mapper_write, mapper_reg);
 
     mapper_fill_ff();
 
-    msx_pio_io_bus_init();
+    msx_pio_io_bus_init_ports(IO_PORT_BLOCK(0xFCu));
     system_audio_init_for_sunrise(false);
     msx_pio_bus_init();
 
@@ -8152,26 +10971,7 @@ void __no_inline_not_in_flash_func(loadrom_sunrise_mapper)(uint32_t offset, bool
         uint16_t waddr;
         uint8_t wdata;
         while (pio_try_get_write(&waddr, &wdata))
-        {
-            if (waddr == 0xFFFFu)
-                subslot_reg = wdata;
-            else
-            {
-                uint8_t page = (waddr >> 14) & 0x03u;
-                uint8_t active_subslot = (subslot_reg >> (page * 2)) & 0x03u;
-                if (active_subslot == 0)
-                {
-                    if (waddr >= 0x4000u && waddr <= 0x7FFFu)
-                        sunrise_ide_handle_write(&ide, waddr, wdata);
-                }
-                else if (active_subslot == 1)
-                {
-                    uint8_t mapper_page = mapper_page_from_reg(mapper_reg[page]);
-                    uint32_t mapper_offset = ((uint32_t)mapper_page << 14) | (waddr & 0x3FFFu);
-                    mapper_write_byte(mapper_offset, wdata);
-                }
-            }
-        }
+            subslot_map_handle_write(waddr, wdata, &slots);
 
         uint16_t io_addr;
         uint8_t io_data;
@@ -8205,42 +11005,7 @@ void __no_inline_not_in_flash_func(loadrom_sunrise_mapper)(uint32_t offset, bool
         {
             uint16_t addr = (uint16_t)pio_sm_get(msx_bus.pio, msx_bus.sm_read);
             uint8_t data = 0xFFu;
-            bool in_window = false;
-
-            if (addr == 0xFFFFu)
-            {
-                in_window = true;
-                data = (uint8_t)~subslot_reg;
-            }
-            else
-            {
-                uint8_t page = (addr >> 14) & 0x03u;
-                uint8_t active_subslot = (subslot_reg >> (page * 2)) & 0x03u;
-                if (active_subslot == 0)
-                {
-                    if (addr >= 0x4000u && addr <= 0x7FFFu)
-                    {
-                        in_window = true;
-                        uint8_t ide_data;
-                        if (sunrise_ide_handle_read(&ide, addr, &ide_data))
-                            data = ide_data;
-                        else
-                        {
-                            uint8_t seg = ide.segment;
-                            uint32_t rel = ((uint32_t)seg << 14) + (addr & 0x3FFFu);
-                            if (available_length == 0u || rel < available_length)
-                                data = read_rom_byte(rom_base, rel);
-                        }
-                    }
-                }
-                else if (active_subslot == 1)
-                {
-                    in_window = true;
-                    uint8_t mapper_page = mapper_page_from_reg(mapper_reg[page]);
-                    uint32_t mapper_offset = ((uint32_t)mapper_page << 14) | (addr & 0x3FFFu);
-                    data = mapper_read_byte(mapper_offset);
-                }
-            }
+            bool in_window = subslot_map_read(&slots, addr, &data);
 
             pio_sm_put_blocking(msx_bus.pio, msx_bus.sm_read, pio_build_token(in_window, data));
         }
@@ -8380,9 +11145,15 @@ void __no_inline_not_in_flash_func(loadrom_sunrise_mapper_sd)(uint32_t offset, b
     multicore_launch_core1(sunrise_sd_task);
 
     uint8_t mapper_reg[4] = { 3, 2, 1, 0 };
-    uint8_t subslot_reg = 0x10;
 
-    msx_pio_io_bus_init();
+    // Subslot 0: Sunrise IDE + Nextor ROM, subslot 1: 1MB memory mapper.
+    subslot_sunrise_ctx_t sunrise_dev = { .ide = &ide, .rom_base = rom_base, .available_length = available_length };
+    static subslot_map_t slots;
+    subslot_map_init(&slots, 0x10u);
+    subslot_map_attach(&slots, 0u, SUBSLOT_PAGE(1), subslot_sunrise_read, subslot_sunrise_write, &sunrise_dev);
+    subslot_map_attach(&slots, 1u, SUBSLOT_PAGES_ALL, subslot_mapper_read, subslot_mapper_write, mapper_reg);
+
+    msx_pio_io_bus_init_ports(IO_PORT_BLOCK(0xFCu));
     system_audio_init_for_sunrise(false);
     msx_pio_bus_init();
 
@@ -8391,26 +11162,7 @@ void __no_inline_not_in_flash_func(loadrom_sunrise_mapper_sd)(uint32_t offset, b
         uint16_t waddr;
         uint8_t wdata;
         while (pio_try_get_write(&waddr, &wdata))
-        {
-            if (waddr == 0xFFFFu)
-                subslot_reg = wdata;
-            else
-            {
-                uint8_t page = (waddr >> 14) & 0x03u;
-                uint8_t active_subslot = (subslot_reg >> (page * 2)) & 0x03u;
-                if (active_subslot == 0)
-                {
-                    if (waddr >= 0x4000u && waddr <= 0x7FFFu)
-                        sunrise_ide_handle_write(&ide, waddr, wdata);
-                }
-                else if (active_subslot == 1)
-                {
-                    uint8_t mapper_page = mapper_page_from_reg(mapper_reg[page]);
-                    uint32_t mapper_offset = ((uint32_t)mapper_page << 14) | (waddr & 0x3FFFu);
-                    mapper_write_byte(mapper_offset, wdata);
-                }
-            }
-        }
+            subslot_map_handle_write(waddr, wdata, &slots);
 
         uint16_t io_addr;
         uint8_t io_data;
@@ -8444,46 +11196,256 @@ void __no_inline_not_in_flash_func(loadrom_sunrise_mapper_sd)(uint32_t offset, b
         {
             uint16_t addr = (uint16_t)pio_sm_get(msx_bus.pio, msx_bus.sm_read);
             uint8_t data = 0xFFu;
-            bool in_window = false;
+            bool in_window = subslot_map_read(&slots, addr, &data);
 
-            if (addr == 0xFFFFu)
-            {
-                in_window = true;
-                data = (uint8_t)~subslot_reg;
-            }
-            else
-            {
-                uint8_t page = (addr >> 14) & 0x03u;
-                uint8_t active_subslot = (subslot_reg >> (page * 2)) & 0x03u;
-                if (active_subslot == 0)
-                {
-                    if (addr >= 0x4000u && addr <= 0x7FFFu)
-                    {
-                        in_window = true;
-                        uint8_t ide_data;
-                        if (sunrise_ide_handle_read(&ide, addr, &ide_data))
-                            data = ide_data;
-                        else
-                        {
-                            uint8_t seg = ide.segment;
-                            uint32_t rel = ((uint32_t)seg << 14) + (addr & 0x3FFFu);
-                            if (available_length == 0u || rel < available_length)
-                                data = read_rom_byte(rom_base, rel);
-                        }
-                    }
-                }
-                else if (active_subslot == 1)
-                {
-                    in_window = true;
-                    uint8_t mapper_page = mapper_page_from_reg(mapper_reg[page]);
-                    uint32_t mapper_offset = ((uint32_t)mapper_page << 14) | (addr & 0x3FFFu);
-                    data = mapper_read_byte(mapper_offset);
-                }
-            }
+            pio_sm_put_blocking(msx_bus.pio, msx_bus.sm_read, pio_build_token(in_window, data));
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+// Carnivore2 flash image. The sparse flash emulated by c2_emu.c lives in a
+// PSRAM pool of 64KB slots and is backed by C2_FLASH_IMAGE_PATH on the
+// microSD card: sector 0 holds a header with the sector map, followed by
+// one 64KB block per pool slot. The file is created once at full size; after
+// that only its contents are rewritten, with raw writes to its cluster runs,
+// so Core 1 can save while Nextor owns the card. Saving starts once the
+// flash has been idle for C2_FLASH_SAVE_IDLE_US, one dirty 4KB chunk per
+// pass of the storage task loop, and the map sector goes last.
+// -----------------------------------------------------------------------
+#define C2_FLASH_IMAGE_PATH     "/C2FLASH.IMG"
+#define C2_FLASH_IMAGE_MAGIC    0x31463243u // "C2F1"
+#define C2_FLASH_HEADER_SECTORS 1u
+#define C2_FLASH_SAVE_IDLE_US   1000000u
+#define C2_FLASH_POOL_RESERVE   (256u * 1024u) // PSRAM kept free for later launch allocations
+#define C2_FLASH_MAX_RUNS       ((SDLOAD_CLMT_WORDS - 2u) / 2u)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t slots;
+    uint8_t map[C2_FLASH_SECTORS];
+} c2_flash_header_t;
+
+typedef struct {
+    uint32_t lba;
+    uint32_t sectors;
+} c2_flash_run_t;
+
+static c2_state_t *c2_flash_ctx = NULL;     // set while the image file is writable
+static c2_flash_run_t c2_flash_runs[C2_FLASH_MAX_RUNS];
+static BYTE c2_flash_pdrv = 0;
+static uint8_t c2_flash_run_count = 0;
+static uint8_t c2_flash_sector[SDLOAD_SECTOR_SIZE];
+static uint8_t c2_flash_bounce[C2_FLASH_CHUNK_SIZE];
+static uint32_t c2_flash_seen_gen = 0;      // Core 1 only from here on
+static uint64_t c2_flash_seen_us = 0;
+static uint32_t c2_flash_clean_gen = 0;
+static uint32_t c2_flash_cursor = 0;
+
+// Create the image at full size with an empty map.
+static bool c2_flash_create_image(uint8_t slots)
+{
+    FIL fil;
+    if (f_open(&fil, C2_FLASH_IMAGE_PATH, FA_CREATE_NEW | FA_WRITE) != FR_OK) return false;
+
+    c2_flash_header_t *hdr = (c2_flash_header_t *)c2_flash_sector;
+    memset(c2_flash_sector, 0, sizeof(c2_flash_sector));
+    hdr->magic = C2_FLASH_IMAGE_MAGIC;
+    hdr->slots = slots;
+    memset(hdr->map, C2_FLASH_UNMAPPED, sizeof(hdr->map));
+
+    UINT bw = 0;
+    FSIZE_t size = (FSIZE_t)C2_FLASH_HEADER_SECTORS * SDLOAD_SECTOR_SIZE + (FSIZE_t)slots * C2_FLASH_SECTOR_SIZE;
+    bool ok = f_write(&fil, c2_flash_sector, sizeof(c2_flash_sector), &bw) == FR_OK && bw == sizeof(c2_flash_sector) &&
+              f_lseek(&fil, size) == FR_OK && f_tell(&fil) == size;
+    f_close(&fil);
+    if (!ok) f_unlink(C2_FLASH_IMAGE_PATH);
+    printf("C2FLASH: created %s (%u slots)\n", ok ? "ok" : "failed", (unsigned)slots);
+    return ok;
+}
+
+#if FF_USE_FASTSEEK
+// Resolve the image's clusters to card LBAs for the raw background writes.
+static bool c2_flash_resolve_runs(FIL *fil)
+{
+    FATFS *fs = fil->obj.fs;
+    if (!fs || fs->csize == 0) return false;
+
+    fil->cltbl = sdload_clmt;
+    sdload_clmt[0] = SDLOAD_CLMT_WORDS;
+    FRESULT fr = f_lseek(fil, CREATE_LINKMAP);
+    fil->cltbl = NULL;
+    if (fr != FR_OK) {
+        printf("C2FLASH: linkmap unavailable fr=%d\n", (int)fr);
+        return false;
+    }
+
+    c2_flash_pdrv = fs->pdrv;
+    c2_flash_run_count = 0;
+    for (const DWORD *run = &sdload_clmt[1]; run[0] != 0 && c2_flash_run_count < C2_FLASH_MAX_RUNS; run += 2) {
+        c2_flash_runs[c2_flash_run_count].lba = sd_mounted_lba_base + (uint32_t)(fs->database + (LBA_t)fs->csize * (run[1] - 2u));
+        c2_flash_runs[c2_flash_run_count].sectors = (uint32_t)run[0] * fs->csize;
+        c2_flash_run_count++;
+    }
+    return c2_flash_run_count != 0;
+}
+#else
+static bool c2_flash_resolve_runs(FIL *fil)
+{
+    (void)fil;
+    return false;
+}
+#endif
+
+// Load the saved map and the slots it uses. Slots go straight to the
+// uncached PSRAM alias, as in the SD ROM loader.
+static bool c2_flash_load_image(c2_state_t *c2, uint8_t pool_slots)
+{
+    FIL fil;
+    if (f_open(&fil, C2_FLASH_IMAGE_PATH, FA_READ) != FR_OK) {
+        if (!c2_flash_create_image(pool_slots) || f_open(&fil, C2_FLASH_IMAGE_PATH, FA_READ) != FR_OK)
+            return false;
+    }
+
+    UINT br = 0;
+    c2_flash_header_t *hdr = (c2_flash_header_t *)c2_flash_sector;
+    bool ok = f_read(&fil, c2_flash_sector, sizeof(c2_flash_sector), &br) == FR_OK && br == sizeof(c2_flash_sector) &&
+              hdr->magic == C2_FLASH_IMAGE_MAGIC && hdr->slots != 0u && hdr->slots <= C2_FLASH_MAX_SLOTS &&
+              f_size(&fil) >= (FSIZE_t)C2_FLASH_HEADER_SECTORS * SDLOAD_SECTOR_SIZE + (FSIZE_t)hdr->slots * C2_FLASH_SECTOR_SIZE;
+    if (!ok) {
+        printf("C2FLASH: image header invalid\n");
+        f_close(&fil);
+        return false;
+    }
+    if (hdr->slots > pool_slots)
+        printf("C2FLASH: image has %lu slots, pool holds %u\n", (unsigned long)hdr->slots, (unsigned)pool_slots);
+
+    uint8_t slots = (hdr->slots < pool_slots) ? (uint8_t)hdr->slots : pool_slots;
+    c2_flash_attach(c2, c2_flash_region.ptr, slots, hdr->map);
+
+    for (uint8_t slot = 0; ok && slot < slots; slot++) {
+        if (c2->flash_owner[slot] == C2_FLASH_UNMAPPED) continue;
+        uint32_t pool_off = (uint32_t)slot * C2_FLASH_SECTOR_SIZE;
+        ok = f_lseek(&fil, (FSIZE_t)C2_FLASH_HEADER_SECTORS * SDLOAD_SECTOR_SIZE + pool_off) == FR_OK &&
+             f_read(&fil, (void *)(PSRAM_NOCACHE_ADDR + c2_flash_region.offset + pool_off), C2_FLASH_SECTOR_SIZE, &br) == FR_OK &&
+             br == C2_FLASH_SECTOR_SIZE;
+    }
+    xip_cache_invalidate_range((PSRAM_BASE_ADDR - XIP_BASE) + c2_flash_region.offset, c2_flash_region.size);
+
+    // Slots beyond a smaller pool are dropped; the trimmed map is saved.
+    if (ok && slots < hdr->slots) c2->flash_map_dirty = 1u;
+    if (ok) ok = c2_flash_resolve_runs(&fil);
+    f_close(&fil);
+    return ok;
+}
+
+// Carve the flash pool out of the PSRAM left after the C2 regions, attach
+// it and, when the card allows, load and keep saving the image file.
+static void c2_flash_prepare(c2_state_t *c2)
+{
+    c2_flash_ctx = NULL;
+    if (c2_flash_region.size == 0) {
+        uint32_t free_bytes = psram_alloc_limit() - psram_mgr.next_free;
+        uint32_t slots = free_bytes > C2_FLASH_POOL_RESERVE ? (free_bytes - C2_FLASH_POOL_RESERVE) / C2_FLASH_SECTOR_SIZE : 0u;
+        if (slots > C2_FLASH_MAX_SLOTS) slots = C2_FLASH_MAX_SLOTS;
+        if (slots == 0 || !psram_alloc(slots * C2_FLASH_SECTOR_SIZE, &c2_flash_region)) {
+            printf("C2FLASH: no PSRAM for the flash image\n");
+            return;
+        }
+    }
+    uint8_t pool_slots = (uint8_t)(c2_flash_region.size / C2_FLASH_SECTOR_SIZE);
+    // Programs that need a slot past this fail with the DQ5 timeout status.
+    printf("C2FLASH: pool %u KB, up to %u of %u sectors can hold data\n",
+           (unsigned)(c2_flash_region.size / 1024u), (unsigned)pool_slots, (unsigned)C2_FLASH_SECTORS);
+
+    if (!sd_mount_card() || !c2_flash_load_image(c2, pool_slots)) {
+        // Flash still works, it just does not survive a power cycle.
+        c2_flash_attach(c2, c2_flash_region.ptr, pool_slots, NULL);
+        printf("C2FLASH: %u slots, not persisted\n", (unsigned)pool_slots);
+        return;
+    }
+
+    c2_flash_seen_gen = c2->flash_gen;
+    c2_flash_clean_gen = c2->flash_map_dirty ? c2->flash_gen - 1u : c2->flash_gen;
+    c2_flash_seen_us = 0;
+    c2_flash_cursor = 0;
+    c2_flash_ctx = c2;
+    printf("C2FLASH: %u slots, image %u run(s)\n", (unsigned)c2->flash_slots, (unsigned)c2_flash_run_count);
+}
+
+// Write whole image sectors, splitting at cluster-run boundaries.
+static bool __not_in_flash_func(c2_flash_write_sectors)(uint32_t sector, const uint8_t *buf, uint32_t count)
+{
+    uint32_t base = 0;
+    for (uint8_t r = 0; r < c2_flash_run_count && count != 0; r++) {
+        const c2_flash_run_t *run = &c2_flash_runs[r];
+        while (count != 0 && sector < base + run->sectors) {
+            uint32_t n = base + run->sectors - sector;
+            if (n > count) n = count;
+            if (disk_write_raw(c2_flash_pdrv, buf, run->lba + (sector - base), n) != RES_OK) return false;
+            buf += n * SDLOAD_SECTOR_SIZE;
+            sector += n;
+            count -= n;
+        }
+        base += run->sectors;
+    }
+    return count == 0;
+}
 
-            pio_sm_put_blocking(msx_bus.pio, msx_bus.sm_read, pio_build_token(in_window, data));
+static void __not_in_flash_func(c2_flash_save_step)(void)
+{
+    c2_state_t *c2 = c2_flash_ctx;
+    if (c2 == NULL) return;
+
+    uint32_t gen = c2->flash_gen;
+    if (gen == c2_flash_clean_gen) return;
+
+    uint64_t now = time_us_64();
+    if (gen != c2_flash_seen_gen) {
+        c2_flash_seen_gen = gen;
+        c2_flash_seen_us = now;
+        return;
+    }
+    if (now - c2_flash_seen_us < C2_FLASH_SAVE_IDLE_US) return;
+
+    uint32_t chunks = (uint32_t)c2->flash_slots * C2_FLASH_CHUNKS;
+    for (uint32_t n = 0; n < chunks; n++) {
+        uint32_t i = c2_flash_cursor;
+        c2_flash_cursor = (i + 1u < chunks) ? i + 1u : 0u;
+        if (!c2->flash_dirty[i]) continue;
+
+        // Clear first: a program landing during the copy marks it again.
+        c2->flash_dirty[i] = 0u;
+        __dmb();
+        memcpy(c2_flash_bounce, c2->flash_pool + i * C2_FLASH_CHUNK_SIZE, C2_FLASH_CHUNK_SIZE);
+        uint32_t sector = C2_FLASH_HEADER_SECTORS + i * (C2_FLASH_CHUNK_SIZE / SDLOAD_SECTOR_SIZE);
+        if (!c2_flash_write_sectors(sector, c2_flash_bounce, C2_FLASH_CHUNK_SIZE / SDLOAD_SECTOR_SIZE)) {
+            c2->flash_dirty[i] = 1u;
+            c2_flash_seen_us = now;     // back off before retrying
+        }
+        return;
+    }
+
+    if (c2->flash_map_dirty) {
+        c2->flash_map_dirty = 0u;
+        __dmb();
+        c2_flash_header_t *hdr = (c2_flash_header_t *)c2_flash_bounce;
+        memset(c2_flash_bounce, 0, SDLOAD_SECTOR_SIZE);
+        hdr->magic = C2_FLASH_IMAGE_MAGIC;
+        hdr->slots = c2->flash_slots;
+        memcpy(hdr->map, c2->flash_map, sizeof(hdr->map));
+        if (!c2_flash_write_sectors(0, c2_flash_bounce, 1)) {
+            c2->flash_map_dirty = 1u;
+            c2_flash_seen_us = now;
+            return;
         }
     }
+    c2_flash_clean_gen = gen;
+}
+
+void __not_in_flash_func(service_storage_background)(void)
+{
+    c2_flash_save_step();
 }
 
 typedef void (*sunrise_backend_task_fn_t)(void);
@@ -8543,7 +11505,7 @@ static inline void __not_in_flash_func(c2_handle_memory_write)(
                 }
                 else if (is_we && !is_ram)
                 {
-                    c2_flash_cmd_write(c2, waddr, wdata);
+                    c2_flash_cmd_write(c2, waddr, linear, wdata);
                 }
             }
         }
@@ -8629,6 +11591,12 @@ static void __no_inline_not_in_flash_func(loadrom_c2_common)(
     }
     mapper_fill_ff();
 
+    // The flash image is read through FatFS, so it has to be in place
+    // before Core 1 takes over the card.
+    static c2_state_t c2;
+    c2_init(&c2, c2_rom_region.ptr, c2_rom_region.size, 0x01u);
+    c2_flash_prepare(&c2);
+
     static sunrise_ide_t ide;
     sunrise_ide_init(&ide);
 
@@ -8638,14 +11606,11 @@ static void __no_inline_not_in_flash_func(loadrom_c2_common)(
     uint8_t mapper_reg[4] = { 3, 2, 1, 0 };
     uint8_t subslot_reg = 0x10u;
 
-    static c2_state_t c2;
-    c2_init(&c2, c2_rom_region.ptr, c2_rom_region.size, 0x01u);
-
     static const uint8_t c2_descr[8] = { 'C', 'M', 'F', 'C', 'C', 'F', 'R', 'C' };
     bool c2_signature_overlay_armed = false;
     uint8_t c2_signature_overlay_index = 0u;
 
-    msx_pio_io_bus_init();
+    msx_pio_io_bus_init_ports(IO_PORT_BLOCK(0xFCu) | IO_PORT_BLOCK(0xF0u));
     system_audio_init_for_sunrise(false);
 
     bool external_scc_audio = system_audio_profile == SYSTEM_AUDIO_PROFILE_SCC_EXTERNAL ||
@@ -8653,6 +11618,7 @@ static void __no_inline_not_in_flash_func(loadrom_c2_common)(
     bool sfg_audio = system_audio_profile == SYSTEM_AUDIO_PROFILE_YM2151_SFG05 ||
                      system_audio_profile == SYSTEM_AUDIO_PROFILE_YM2151_SFG01;
     bool c2_scc_enabled = external_scc_audio;
+
     ym2151_sfg_variant_t sfg_variant = system_audio_profile == SYSTEM_AUDIO_PROFILE_YM2151_SFG01 ? YM2151_SFG01 : YM2151_SFG05;
     const uint32_t sfg_variant_offset = (sfg_variant == YM2151_SFG01) ? SFG_BIOS_VARIANT_SIZE : 0u;
     const uint8_t *sfg_bios_base = flash_rom + SFG_BIOS_FLASH_OFFSET + sfg_variant_offset;
@@ -8925,7 +11891,7 @@ static void __not_in_flash_func(loadrom_sunrise_megaram_common)(
     mapper_fill_ff();
     megaram_fill_ff();
 
-    msx_pio_io_bus_init();
+    msx_pio_io_bus_init_ports(IO_PORT_BLOCK(0xFCu) | IO_PORT_BLOCK(0x8Eu));
     system_audio_init_for_sunrise(false);
     bool megaram_scc_audio = megaram_scc_audio_selected();
     msx_pio_bus_init();
@@ -9064,6 +12030,109 @@ void __no_inline_not_in_flash_func(loadrom_sunrise_megaram_usb)(uint32_t offset,
     loadrom_sunrise_megaram_common(offset, cache_enable, sunrise_usb_task, sunrise_usb_set_ide_ctx);
 }
 
+// -----------------------------------------------------------------------
+// Split bus service for the plain MegaRAM mode when core 1 has no audio to
+// run. Core 0 only answers memory reads, from a page table it never
+// writes. Core 1 drains the memory-write and I/O FIFOs, applies them and
+// republishes the table. The busy flag is raised before core 1 takes the
+// first entry and dropped, after a barrier, once every entry is applied. A
+// read therefore waits only while a write issued before it is still in
+// flight, and the time a PSRAM write takes never lands on the read path.
+// With MegaRAM SCC/SCC+ core 1 renders audio instead, and core 0 drains
+// everything itself; it still publishes the same page table on each bank
+// switch, so a read is one pointer load rather than a bank-register decode.
+// -----------------------------------------------------------------------
+static uint8_t *megaram_split_page[4];          // indexed by megaram_page_from_addr()
+static uint8_t megaram_split_bank_reg[4];
+static bool megaram_split_write_enabled = false;
+static volatile bool megaram_split_busy = false;
+
+static inline void __not_in_flash_func(megaram_split_set_bank)(uint8_t page, uint8_t bank)
+{
+    megaram_split_bank_reg[page] = bank & 0x7Fu;
+    megaram_split_page[page] = megaram_region.ptr + ((uint32_t)megaram_split_bank_reg[page] << 13);
+}
+
+static inline bool __not_in_flash_func(megaram_split_pending)(void)
+{
+    return !pio_sm_is_rx_fifo_empty(msx_bus.pio, msx_bus.sm_write) ||
+           !pio_sm_is_rx_fifo_empty(msx_io_bus.pio_write, msx_io_bus.sm_io_write) ||
+           !pio_sm_is_rx_fifo_empty(msx_io_bus.pio_read, msx_io_bus.sm_io_read);
+}
+
+static void __no_inline_not_in_flash_func(core1_megaram_split_writes)(void)
+{
+    while (true)
+    {
+        if (!megaram_split_pending())
+            continue;
+
+        megaram_split_busy = true;
+        __dmb();
+
+        // I/O first: an IN/OUT on 0x8E arms or disarms the RAM writes that
+        // follow it.
+        uint16_t io_addr;
+        uint8_t io_data;
+        while (pio_try_get_io_write(&io_addr, &io_data))
+        {
+            uint8_t port = io_addr & 0xFFu;
+            if (port == 0x8Eu || port == 0x8Fu)
+                megaram_split_write_enabled = false;
+        }
+        while (pio_try_get_io_read(&io_addr))
+        {
+            uint8_t port = io_addr & 0xFFu;
+            if (port == 0x8Eu || port == 0x8Fu)
+                megaram_split_write_enabled = true;
+            pio_sm_put_blocking(msx_io_bus.pio_read, msx_io_bus.sm_io_read, pio_build_token(false, 0xFFu));
+        }
+
+        uint16_t waddr;
+        uint8_t wdata;
+        while (pio_try_get_write(&waddr, &wdata))
+        {
+            if (waddr < 0x4000u || waddr > 0xBFFFu)
+                continue;
+            uint8_t page = megaram_page_from_addr(waddr);
+            if (megaram_split_write_enabled)
+                megaram_split_page[page][waddr & 0x1FFFu] = wdata;
+            else
+                megaram_split_set_bank(page, wdata);
+        }
+
+        __dmb();
+        megaram_split_busy = false;
+    }
+}
+
+static void __no_inline_not_in_flash_func(megaram_split_loop)(void)
+{
+    for (uint8_t page = 0; page < 4u; page++)
+        megaram_split_set_bank(page, page);
+    megaram_split_write_enabled = false;
+    megaram_split_busy = false;
+    __dmb();
+    multicore_launch_core1(core1_megaram_split_writes);
+
+    while (true)
+    {
+        uint16_t addr = (uint16_t)pio_sm_get_blocking(msx_bus.pio, msx_bus.sm_read);
+
+        // FIFO before flag: a write core 1 has already taken keeps the flag
+        // up until it is applied.
+        while (!pio_sm_is_rx_fifo_empty(msx_bus.pio, msx_bus.sm_write) || megaram_split_busy)
+            tight_loop_contents();
+        __dmb();
+
+        bool in_window = addr >= 0x4000u && addr <= 0xBFFFu;
+        uint8_t data = 0xFFu;
+        if (in_window)
+            data = megaram_split_page[megaram_page_from_addr(addr)][addr & 0x1FFFu];
+        pio_sm_put_blocking(msx_bus.pio, msx_bus.sm_read, pio_build_token(in_window, data));
+    }
+}
+
 void __no_inline_not_in_flash_func(loadrom_megaram)(uint32_t offset, bool cache_enable)
 {
     (void)offset;
@@ -9076,18 +12145,21 @@ void __no_inline_not_in_flash_func(loadrom_megaram)(uint32_t offset, bool cache_
         while (true) { tight_loop_contents(); }
     }
 
-    uint8_t megaram_bank_reg[4] = { 0, 1, 2, 3 };
     bool megaram_write_enabled = false;
     bool megaram_scc_audio = megaram_scc_audio_selected();
     megaram_fill_ff();
 
-    msx_pio_io_bus_init();
-    if (megaram_scc_audio)
-    {
-        scc_audio_init_for_type(megaram_scc_type_selected());
-        i2s_audio_init_scc();
-        multicore_launch_core1(core1_scc_audio);
-    }
+    msx_pio_io_bus_init_ports(IO_PORT_BLOCK(0x8Eu));
+    if (!megaram_scc_audio)
+        megaram_split_loop();
+
+    // Core 1 renders the SCC, so this loop serves reads, writes and I/O. It
+    // drains the writes, so it keeps the page table itself.
+    for (uint8_t page = 0; page < 4u; page++)
+        megaram_split_set_bank(page, page);
+    scc_audio_init_for_type(megaram_scc_type_selected());
+    i2s_audio_init_scc();
+    multicore_launch_core1(core1_scc_audio);
 
     while (true)
     {
@@ -9097,12 +12169,13 @@ void __no_inline_not_in_flash_func(loadrom_megaram)(uint32_t offset, bool cache_
         {
             if (waddr >= 0x4000u && waddr <= 0xBFFFu)
             {
-                if (megaram_scc_audio && !megaram_write_enabled && megaram_scc_write(waddr, wdata))
+                if (!megaram_write_enabled && megaram_scc_write(waddr, wdata))
                     continue;
+                uint8_t page = megaram_page_from_addr(waddr);
                 if (megaram_write_enabled)
-                    megaram_write_byte(waddr, wdata, megaram_bank_reg);
+                    megaram_split_page[page][waddr & 0x1FFFu] = wdata;
                 else
-                    megaram_bank_switch_write(waddr, wdata, megaram_bank_reg);
+                    megaram_split_set_bank(page, wdata);
             }
         }
 
@@ -9128,8 +12201,8 @@ void __no_inline_not_in_flash_func(loadrom_megaram)(uint32_t offset, bool cache_
             uint16_t addr = (uint16_t)pio_sm_get(msx_bus.pio, msx_bus.sm_read);
             bool in_window = addr >= 0x4000u && addr <= 0xBFFFu;
             uint8_t data = 0xFFu;
-            if (in_window && (!megaram_scc_audio || !megaram_scc_read(addr, &data)))
-                data = megaram_read_byte(addr, megaram_bank_reg);
+            if (in_window && !megaram_scc_read(addr, &data))
+                data = megaram_split_page[megaram_page_from_addr(addr)][addr & 0x1FFFu];
             pio_sm_put_blocking(msx_bus.pio, msx_bus.sm_read, pio_build_token(in_window, data));
         }
     }
@@ -9218,7 +12291,7 @@ static void __no_inline_not_in_flash_func(loadrom_sunrise_wifi_common)(
 
     if (mapper_enable)
     {
-        msx_pio_io_bus_init();
+        msx_pio_io_bus_init_ports(IO_PORT_BLOCK(0xFCu));
     }
 
     system_audio_init_for_sunrise(!mapper_enable);
@@ -10275,6 +13348,29 @@ static inline bool __not_in_flash_func(megaram_scc_read)(uint16_t addr, uint8_t
     return false;
 }
 
+// Subslot device hooks for the external SCC/SFG modes (see subslot_map_t).
+static bool __not_in_flash_func(subslot_scc_game_read)(void *ctx, uint16_t addr, uint8_t *data)
+{
+    return external_scc_game_read((external_scc_game_t *)ctx, addr, data);
+}
+
+static void __not_in_flash_func(subslot_scc_game_write)(void *ctx, uint16_t addr, uint8_t data)
+{
+    external_scc_game_write((external_scc_game_t *)ctx, addr, data);
+}
+
+static bool __not_in_flash_func(subslot_scc_read)(void *ctx, uint16_t addr, uint8_t *data)
+{
+    (void)ctx;
+    return external_scc_read(addr, data);
+}
+
+static void __not_in_flash_func(subslot_scc_write)(void *ctx, uint16_t addr, uint8_t data)
+{
+    (void)ctx;
+    SCC_write(&scc_instance, addr, data);
+}
+
 void __no_inline_not_in_flash_func(loadrom_external_scc)(uint32_t offset, bool cache_enable, uint8_t mapper, uint32_t scc_type)
 {
     fmpac_wait_for_expanded_bootstrap();
@@ -10311,7 +13407,11 @@ void __no_inline_not_in_flash_func(loadrom_external_scc)(uint32_t offset, bool c
     i2s_audio_init_scc();
     multicore_launch_core1(core1_scc_audio);
 
-    uint8_t subslot_reg = 0x00u;
+    // Subslot 0: the game mapper, subslot 1: the SCC surface.
+    static subslot_map_t slots;
+    subslot_map_init(&slots, 0x00u);
+    subslot_map_attach(&slots, 0u, SUBSLOT_PAGES_ALL, subslot_scc_game_read, subslot_scc_game_write, &game);
+    subslot_map_attach(&slots, 1u, SUBSLOT_PAGES_ALL, subslot_scc_read, subslot_scc_write, NULL);
 
     msx_pio_bus_init();
 
@@ -10320,41 +13420,13 @@ void __no_inline_not_in_flash_func(loadrom_external_scc)(uint32_t offset, bool c
         uint16_t waddr;
         uint8_t wdata;
         while (pio_try_get_write(&waddr, &wdata))
-        {
-            if (waddr == 0xFFFFu)
-            {
-                subslot_reg = wdata;
-                continue;
-            }
-
-            uint8_t page = (waddr >> 14) & 0x03u;
-            uint8_t active_subslot = (subslot_reg >> (page * 2)) & 0x03u;
-            if (active_subslot == 0)
-                external_scc_game_write(&game, waddr, wdata);
-            else if (active_subslot == 1)
-                SCC_write(&scc_instance, waddr, wdata);
-        }
+            subslot_map_handle_write(waddr, wdata, &slots);
 
         if (!pio_sm_is_rx_fifo_empty(msx_bus.pio, msx_bus.sm_read))
         {
             uint16_t addr = (uint16_t)pio_sm_get(msx_bus.pio, msx_bus.sm_read);
             uint8_t data = 0xFFu;
-            bool in_window = false;
-
-            if (addr == 0xFFFFu)
-            {
-                in_window = true;
-                data = (uint8_t)~subslot_reg;
-            }
-            else
-            {
-                uint8_t page = (addr >> 14) & 0x03u;
-                uint8_t active_subslot = (subslot_reg >> (page * 2)) & 0x03u;
-                if (active_subslot == 0)
-                    in_window = external_scc_game_read(&game, addr, &data);
-                else if (active_subslot == 1)
-                    in_window = external_scc_read(addr, &data);
-            }
+            bool in_window = subslot_map_read(&slots, addr, &data);
 
             pio_sm_put_blocking(msx_bus.pio, msx_bus.sm_read, pio_build_token(in_window, data));
         }
@@ -10419,6 +13491,17 @@ static inline bool __not_in_flash_func(sfg_read)(const uint8_t *bios_base, uint1
     return true;
 }
 
+static bool __not_in_flash_func(subslot_sfg_read)(void *ctx, uint16_t addr, uint8_t *data)
+{
+    return sfg_read((const uint8_t *)ctx, addr, data);
+}
+
+static void __not_in_flash_func(subslot_sfg_write)(void *ctx, uint16_t addr, uint8_t data)
+{
+    (void)ctx;
+    sfg_write(addr, data);
+}
+
 // Drain every pending MSX write from the capture FIFO and apply it to the
 // active subslot (game mapper in subslot 0, SFG surface in subslot 1). This is
 // called both before AND after dequeuing a read address so the read response
@@ -10428,25 +13511,12 @@ static inline bool __not_in_flash_func(sfg_read)(const uint8_t *bios_base, uint1
 // bank/device, returning a single corrupt byte. banked8_loop (the plain ASCII8
 // path) already re-drains after dequeuing the read; the combined SFG loop must
 // do the same or odd-paced ASCII8 games freeze after some time.
-static inline void __not_in_flash_func(external_sfg_drain_writes)(external_scc_game_t *game, uint8_t *subslot_reg)
+static inline void __not_in_flash_func(external_sfg_drain_writes)(subslot_map_t *slots)
 {
     uint16_t waddr;
     uint8_t wdata;
     while (pio_try_get_write(&waddr, &wdata))
-    {
-        if (waddr == 0xFFFFu)
-        {
-            *subslot_reg = wdata;
-            continue;
-        }
-
-        uint8_t page = (waddr >> 14) & 0x03u;
-        uint8_t active_subslot = (*subslot_reg >> (page * 2)) & 0x03u;
-        if (active_subslot == 0)
-            external_scc_game_write(game, waddr, wdata);
-        else if (active_subslot == 1)
-            sfg_write(waddr, wdata);
-    }
+        subslot_map_handle_write(waddr, wdata, slots);
 }
 
 void __no_inline_not_in_flash_func(loadrom_external_sfg)(uint32_t offset, bool cache_enable, uint8_t mapper, ym2151_sfg_variant_t variant)
@@ -10486,13 +13556,17 @@ void __no_inline_not_in_flash_func(loadrom_external_sfg)(uint32_t offset, bool c
     const uint32_t sfg_variant_offset = (variant == YM2151_SFG01) ? SFG_BIOS_VARIANT_SIZE : 0u;
     const uint8_t *sfg_bios_base = flash_rom + SFG_BIOS_FLASH_OFFSET + sfg_variant_offset;
 
-    uint8_t subslot_reg = 0x00u;
+    // Subslot 0: the game mapper, subslot 1: the SFG BIOS and YM2151 registers.
+    static subslot_map_t slots;
+    subslot_map_init(&slots, 0x00u);
+    subslot_map_attach(&slots, 0u, SUBSLOT_PAGES_ALL, subslot_scc_game_read, subslot_scc_game_write, &game);
+    subslot_map_attach(&slots, 1u, SUBSLOT_PAGES_ALL, subslot_sfg_read, subslot_sfg_write, (void *)sfg_bios_base);
 
     msx_pio_bus_init();
 
     while (true)
     {
-        external_sfg_drain_writes(&game, &subslot_reg);
+        external_sfg_drain_writes(&slots);
 
         if (!pio_sm_is_rx_fifo_empty(msx_bus.pio, msx_bus.sm_read))
         {
@@ -10500,27 +13574,94 @@ void __no_inline_not_in_flash_func(loadrom_external_sfg)(uint32_t offset, bool c
 
             // Re-drain: apply any write captured between the drain above and
             // dequeuing this read so the response uses up-to-date bank/subslot.
-            external_sfg_drain_writes(&game, &subslot_reg);
+            external_sfg_drain_writes(&slots);
 
             uint8_t data = 0xFFu;
-            bool in_window = false;
+            bool in_window = subslot_map_read(&slots, addr, &data);
 
-            if (addr == 0xFFFFu)
-            {
-                in_window = true;
-                data = (uint8_t)~subslot_reg;
-            }
-            else
-            {
-                uint8_t page = (addr >> 14) & 0x03u;
-                uint8_t active_subslot = (subslot_reg >> (page * 2)) & 0x03u;
-                if (active_subslot == 0)
-                {
-                    in_window = external_scc_game_read(&game, addr, &data);
-                }
-                else if (active_subslot == 1)
-                    in_window = sfg_read(sfg_bios_base, addr, &data);
-            }
+            pio_sm_put_blocking(msx_bus.pio, msx_bus.sm_read, pio_build_token(in_window, data));
+        }
+
+        tight_loop_contents();
+    }
+}
+
+static inline void __not_in_flash_func(moonsound_drain_writes)(external_scc_game_t *game)
+{
+    uint16_t waddr;
+    uint8_t wdata;
+    while (pio_try_get_write(&waddr, &wdata))
+        external_scc_game_write(game, waddr, wdata);
+}
+
+// Game mapper in the slot, MoonSound on the I/O bus. Core 0 also mirrors
+// the main PSG writes to core 1, which mixes them with the OPL4 output.
+void __no_inline_not_in_flash_func(loadrom_moonsound)(uint32_t offset, bool cache_enable, uint8_t mapper)
+{
+    external_scc_game_t game;
+    external_scc_game_init(&game, mapper);
+
+    if (mapper == 14u)
+    {
+        static const uint32_t WRITABLE_SECTOR_SIZE   = 0x10000u;
+        static const uint32_t WRITABLE_SECTOR_OFFSET = 0x70000u;
+        loadrom_manbow2_setup(offset, &game.rom_base, &game.available_length, &game.manbow2_writable_sram,
+                              WRITABLE_SECTOR_OFFSET, WRITABLE_SECTOR_SIZE);
+        game.manbow2.bank_regs[0] = 0;
+        game.manbow2.bank_regs[1] = 1;
+        game.manbow2.bank_regs[2] = 2;
+        game.manbow2.bank_regs[3] = 3;
+        game.manbow2.state = MBW2_READ;
+        game.manbow2.writable_sram = game.manbow2_writable_sram;
+        game.manbow2.writable_offset = WRITABLE_SECTOR_OFFSET;
+        game.manbow2.writable_size = WRITABLE_SECTOR_SIZE;
+    }
+    else
+    {
+        prepare_rom_source(offset, cache_enable, 0u, &game.rom_base, &game.available_length);
+    }
+
+    gpio_init(PIN_WAIT);
+    gpio_set_dir(PIN_WAIT, GPIO_OUT);
+    gpio_put(PIN_WAIT, 0);
+
+    main_psg_core1_services_io = false;
+    start_opl4_audio_output();
+
+    msx_pio_io_bus_init_ports(IO_PORT_BLOCK(OPL4_PORT_WAVE_REG) | IO_PORT_BLOCK(OPL4_PORT_FM_BASE));
+    msx_pio_bus_init();
+
+    while (true)
+    {
+        moonsound_drain_writes(&game);
+
+        uint16_t io_addr;
+        uint8_t io_data;
+        while (pio_try_get_io_write(&io_addr, &io_data))
+        {
+            uint8_t port = io_addr & 0xFFu;
+            if (main_psg_handle_io_write(port, io_data))
+                continue;
+            (void)opl4_io_write(port, io_data);
+        }
+
+        while (pio_try_get_io_read(&io_addr))
+        {
+            uint8_t data = 0xFFu;
+            bool drive = opl4_io_read((uint8_t)(io_addr & 0xFFu), &data);
+            pio_sm_put_blocking(msx_io_bus.pio_read, msx_io_bus.sm_io_read, pio_build_token(drive, data));
+        }
+
+        if (!pio_sm_is_rx_fifo_empty(msx_bus.pio, msx_bus.sm_read))
+        {
+            uint16_t addr = (uint16_t)pio_sm_get(msx_bus.pio, msx_bus.sm_read);
+
+            // Re-drain so a bank switch captured after the drain above is
+            // applied before this read is answered.
+            moonsound_drain_writes(&game);
+
+            uint8_t data = 0xFFu;
+            bool in_window = external_scc_game_read(&game, addr, &data);
 
             pio_sm_put_blocking(msx_bus.pio, msx_bus.sm_read, pio_build_token(in_window, data));
         }
@@ -10618,7 +13759,7 @@ static void __no_inline_not_in_flash_func(loadrom_sunrise_sfg_common)(
     const uint32_t sfg_variant_offset = (variant == YM2151_SFG01) ? SFG_BIOS_VARIANT_SIZE : 0u;
     const uint8_t *sfg_bios_base = flash_rom + SFG_BIOS_FLASH_OFFSET + sfg_variant_offset;
 
-    msx_pio_io_bus_init();
+    msx_pio_io_bus_init_ports(mapper_enable ? IO_PORT_BLOCK(0xFCu) : 0u);
     system_audio_init_for_sunrise(false);
     msx_pio_bus_init();
 
@@ -10880,7 +14021,7 @@ static void __no_inline_not_in_flash_func(loadrom_sunrise_fmpac_common)(
     memset(&fmpac, 0, sizeof(fmpac));
     fmpac.control = 0x10u;
 
-    msx_pio_io_bus_init();
+    msx_pio_io_bus_init_ports(mapper_enable ? IO_PORT_BLOCK(0xFCu) : 0u);
     system_audio_init_for_sunrise(false);
     msx_pio_bus_init();
 
@@ -11071,7 +14212,7 @@ static void __no_inline_not_in_flash_func(loadrom_sunrise_scc_common)(
     const uint8_t mapper_subslot = wifi_enable ? 2u : 1u;
     const uint8_t scc_subslot = wifi_enable ? 3u : 2u;
 
-    msx_pio_io_bus_init();
+    msx_pio_io_bus_init_ports(mapper_enable ? IO_PORT_BLOCK(0xFCu) : 0u);
     system_audio_init_for_sunrise(false);
     msx_pio_bus_init();
 
@@ -11502,15 +14643,28 @@ void __no_inline_not_in_flash_func(loadrom_wifi_config_setup)(uint32_t offset)
 // Main function running on core 0
 int __no_inline_not_in_flash_func(main)()
 {
+    boot_mark(BOOT_STAGE_MAIN);
     qmi_hw->m[0].timing = 0x40000202; // Set the QMI timing for the MSX bus
     set_sys_clock_khz(210000, true);     // Set system clock to 210Mhz
 
     stdio_init_all();     // Initialize stdio
     init_pico_chip_id();
     setup_gpio();     // Initialize GPIO
+    boot_mark(BOOT_STAGE_CLOCKS);
 
     while (true) {
+#if EXPLORER_USB_PUSH
+    usb_push_dev_start();
+#endif
     int rom_index = loadrom_msx_menu(0x0000); //load the first 32KB ROM into the MSX (The MSX PICOVERSE MENU)
+#if EXPLORER_USB_PUSH
+    usb_push_dev_stop(); // no USB interrupts while a ROM is served
+#endif
+    bus_probe_stop();
+    bus_reads_sram = false;
+    // A push that lost the race to a menu selection is dropped.
+    bool is_push_rom = ((uint16_t)rom_index == ROM_SELECT_USB_PUSH);
+    usb_push_launch_pending = false;
 
     if ((uint16_t)rom_index == ROM_SELECT_WIFI_CONFIG) {
         active_rom_size = WIFI_CONFIG_ROM_SIZE;
@@ -11520,10 +14674,15 @@ int __no_inline_not_in_flash_func(main)()
         continue;
     }
 
-    ROMRecord const *selected = &records[rom_index];
+    ROMRecord const *selected = is_push_rom ? &usb_push_record : &records[rom_index];
     active_rom_size = selected->Size;
+    if (is_push_rom) {
+        usb_push_apply_options();
+    }
 
     uint8_t mapper = mapper_code_from_record_byte(selected->Mapper);
+    wait_stats_set_mode(mapper);
+    msx_io_read_owned = 0; // mapper loops claim their I/O ports
     audio_mode_t audio_mode = resolve_audio_mode(mapper, ctrl_audio_selection);
     // PSG Mirror is unstable on Sunrise Nextor + 1MB mapper: heavy disk I/O can
     // drop mapper segment-register writes, so force it off for those variants.
@@ -11539,6 +14698,12 @@ int __no_inline_not_in_flash_func(main)()
     }
     debug_trace("DBG launch hold wait");
     hold_msx_wait();
+    if (!is_push_rom && !is_system_mapper(mapper)) {
+        // Only ever turns SCC/PSG emulation off, so the core1 handoff above stands.
+        title_profile_prepare_launch((uint32_t)rom_index, (uint32_t)selected->Size);
+        audio_mode = resolve_audio_mode(mapper, ctrl_audio_selection);
+        hold_msx_wait();
+    }
 
     uint32_t rom_offset = selected->Offset;
     rom_data = flash_rom;
@@ -11547,16 +14712,22 @@ int __no_inline_not_in_flash_func(main)()
     bool is_sd_rom = (selected->Mapper & SOURCE_SD_FLAG) != 0;
     if (is_sd_rom) {
         debug_trace("DBG launch load sd");
-        if (!load_rom_from_sd((uint16_t)rom_index, (uint32_t)selected->Size)) {
+        uint32_t sd_offset = 0;
+        if (!load_rom_from_sd((uint32_t)rom_index, (uint32_t)selected->Size, &sd_offset)) {
             printf("Debug: Failed to load ROM from SD card\n");
             while (true) { tight_loop_contents(); }
         }
         rom_data = sd_rom_region.ptr;
         rom_data_in_ram = true;
-        rom_offset = 0;
+        rom_offset = sd_offset;
         debug_trace("DBG launch sd loaded hold wait");
         hold_msx_wait();
     }
+    if (is_push_rom) {
+        // Already resident in PSRAM; selected->Offset is its place there.
+        rom_data = sd_rom_region.ptr;
+        rom_data_in_ram = true;
+    }
 
     // Cache the leading window into rom_sram for both flash- and PSRAM-resident
     // ROMs (SD ROMs are staged to PSRAM, so caching them into SRAM mirrors the
@@ -11567,15 +14738,21 @@ int __no_inline_not_in_flash_func(main)()
                       audio_mode == AUDIO_MODE_MEGARAM_SCC || audio_mode == AUDIO_MODE_MEGARAM_SCC_PLUS);
     bool external_scc_audio = (audio_mode == AUDIO_MODE_SCC_EXTERNAL || audio_mode == AUDIO_MODE_SCC_PLUS_EXTERNAL);
     bool sfg_audio = (audio_mode == AUDIO_MODE_YM2151_SFG05 || audio_mode == AUDIO_MODE_YM2151_SFG01);
-    bool cartridge_audio = scc_audio || sfg_audio || audio_mode == AUDIO_MODE_DUAL_PSG || audio_mode == AUDIO_MODE_MSX_MUSIC;
+    bool cartridge_audio = scc_audio || sfg_audio || audio_mode == AUDIO_MODE_DUAL_PSG || audio_mode == AUDIO_MODE_MSX_MUSIC ||
+                           audio_mode == AUDIO_MODE_MOONSOUND;
     bool psg_emulation = (ctrl_psg_emulation != 0u);
     bool system_mapper = is_system_mapper(mapper);
     // The 50/60Hz INIT patch only applies to regular game ROMs; the system ROMs
     // (Nextor/Sunrise/C2/MegaRAM) manage their own boot and must not be patched.
     vdp_freq_launch = system_mapper ? VDP_FREQ_DEFAULT : ctrl_vdp_frequency;
-    bool wavegame_detected = wavegame_assets_detected_for_record((uint16_t)rom_index);
-    wavegame_prepare_for_rom((uint16_t)rom_index,
+    bool wavegame_detected = wavegame_assets_detected_for_record((uint32_t)rom_index);
+    wavegame_prepare_for_rom((uint32_t)rom_index,
         is_sd_rom && wavegame_detected && !system_mapper && audio_mode == AUDIO_MODE_NONE);
+    // Last use of the menu records; the loaders below may reuse their window.
+    record_store_release();
+    // Plain game launches leave core1 idle, so the loaders that run them hash
+    // a staged image there while the game is already running.
+    bool core1_idle = !cartridge_audio && !psg_emulation && !wavegame_active;
     if (wavegame_active) {
         msx_pio_io_write_bus_init();
     }
@@ -11625,6 +14802,16 @@ int __no_inline_not_in_flash_func(main)()
 
     bool wifi_support = (ctrl_wifi_support != 0u) && is_system_mapper(mapper);
 
+    if (!is_push_rom && !system_mapper) {
+        uint8_t observed = 0;
+        if (psg_emulation) observed |= 1u << TITLE_CHIP_PSG;
+        if (scc_audio) observed |= 1u << TITLE_CHIP_SCC;
+        if (audio_mode == AUDIO_MODE_MSX_MUSIC) observed |= 1u << TITLE_CHIP_OPLL;
+        if (sfg_audio) observed |= 1u << TITLE_CHIP_OPM;
+        if (audio_mode == AUDIO_MODE_MOONSOUND) observed |= 1u << TITLE_CHIP_OPL4;
+        title_profile_begin(mapper, observed);
+    }
+
     if (audio_mode == AUDIO_MODE_MSX_MUSIC && !system_mapper) {
         debug_trace("DBG launch load fmpac");
         loadrom_fmpac(rom_offset, cache_enable, mapper);
@@ -11644,36 +14831,49 @@ int __no_inline_not_in_flash_func(main)()
         continue;
     }
 
+    if (audio_mode == AUDIO_MODE_MOONSOUND && !system_mapper) {
+        debug_trace("DBG launch load moonsound");
+        loadrom_moonsound(rom_offset, cache_enable, mapper);
+        continue;
+    }
+
     ym2151_sfg_variant_t sfg_variant = audio_mode == AUDIO_MODE_YM2151_SFG01 ? YM2151_SFG01 : YM2151_SFG05;
 
     if (is_sunrise_sd_mapper(mapper)) {
         sunrise_sd_select_partition(ctrl_sd_partition);
     }
 
+    // The plain MegaRAM mapper has no IDE; every other system ROM gets the
+    // RAM disk slave when its backing image is present.
+    if (system_mapper && mapper != MAPPER_MEGARAM) {
+        sunrise_ramdisk_prepare(rom_data_in_ram ? rom_offset + active_rom_size : 0u);
+        hold_msx_wait();
+    }
+
     // Load the selected ROM into the MSX according to the mapper
     switch (mapper) {
        
         case 1:
         case 2:
-            loadrom_plain32(rom_offset, cache_enable);
+            loadrom_plain32(rom_offset, cache_enable, core1_idle);
             break;
         case 3:
             if (scc_audio)
                 loadrom_konamiscc_scc(rom_offset, cache_enable, audio_mode == AUDIO_MODE_SCC_PLUS ? SCC_ENHANCED : SCC_STANDARD);
             else
-                loadrom_konamiscc(rom_offset, cache_enable);
+                loadrom_konamiscc(rom_offset, cache_enable, core1_idle);
             break;
         case 4:
-            loadrom_linear48(rom_offset, cache_enable);
+            loadrom_linear48(rom_offset, cache_enable, core1_idle);
             break;
         case 5:
-            loadrom_ascii8(rom_offset, cache_enable); 
+            loadrom_ascii8(rom_offset, cache_enable, core1_idle); 
             break;
         case 6:
-            loadrom_ascii16(rom_offset, cache_enable); 
+            loadrom_ascii16(rom_offset, cache_enable, core1_idle); 
             break;
         case 7:
-            loadrom_konami(rom_offset, cache_enable); 
+            loadrom_konami(rom_offset, cache_enable, core1_idle); 
             break;
         case 8:
             loadrom_neo8(rom_offset); 
@@ -11780,6 +14980,9 @@ int __no_inline_not_in_flash_func(main)()
             else
                 loadrom_manbow2(rom_offset, cache_enable);
             break;
+        case MAPPER_AUTO:
+            loadrom_mapper_auto(rom_offset, cache_enable, core1_idle);
+            break;
         default:
                 printf("Debug: Unsupported ROM mapper: %d\n", mapper);
             break;
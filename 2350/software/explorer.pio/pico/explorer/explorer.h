@@ -53,6 +53,7 @@
 
 // External PSRAM (8MB on QMI CS1)
 #define PSRAM_BASE_ADDR  0x11000000u // Cached CS1 QMI window for external PSRAM (write-through)
+#define PSRAM_NOCACHE_ADDR 0x15000000u // Uncached alias of the same CS1 window (bypasses the XIP cache)
 #define PSRAM_TOTAL_SIZE 0x800000u   // 8 MB total external PSRAM
 #define MAPPER_SIZE      1048576u    // 1 MB memory mapper RAM in external PSRAM
 #define MAPPER_PAGES     64u         // 1 MB / 16 KB = 64 pages
@@ -82,13 +83,14 @@ unsigned long __no_inline_not_in_flash_func(read_ulong)(const unsigned char *ptr
 int isEndOfData(const unsigned char *memory);
 
 int __no_inline_not_in_flash_func(loadrom_msx_menu)(uint32_t offset);
-void __no_inline_not_in_flash_func(loadrom_plain32)(uint32_t offset, bool cache_enable);
-void __no_inline_not_in_flash_func(loadrom_linear48)(uint32_t offset, bool cache_enable);
-void __no_inline_not_in_flash_func(loadrom_konamiscc)(uint32_t offset, bool cache_enable);
+void __no_inline_not_in_flash_func(loadrom_plain32)(uint32_t offset, bool cache_enable, bool core1_idle);
+void __no_inline_not_in_flash_func(loadrom_linear48)(uint32_t offset, bool cache_enable, bool core1_idle);
+void __no_inline_not_in_flash_func(loadrom_konamiscc)(uint32_t offset, bool cache_enable, bool core1_idle);
 void __no_inline_not_in_flash_func(loadrom_konamiscc_scc)(uint32_t offset, bool cache_enable, uint32_t scc_type);
-void __no_inline_not_in_flash_func(loadrom_konami)(uint32_t offset, bool cache_enable);
-void __no_inline_not_in_flash_func(loadrom_ascii8)(uint32_t offset, bool cache_enable);
-void __no_inline_not_in_flash_func(loadrom_ascii16)(uint32_t offset, bool cache_enable);
+void __no_inline_not_in_flash_func(loadrom_konami)(uint32_t offset, bool cache_enable, bool core1_idle);
+void __no_inline_not_in_flash_func(loadrom_ascii8)(uint32_t offset, bool cache_enable, bool core1_idle);
+void __no_inline_not_in_flash_func(loadrom_ascii16)(uint32_t offset, bool cache_enable, bool core1_idle);
+void __no_inline_not_in_flash_func(loadrom_mapper_auto)(uint32_t offset, bool cache_enable, bool core1_idle);
 void __no_inline_not_in_flash_func(loadrom_sunrise)(uint32_t offset, bool cache_enable);
 void __no_inline_not_in_flash_func(loadrom_sunrise_mapper)(uint32_t offset, bool cache_enable);
 void __no_inline_not_in_flash_func(loadrom_c2_usb)(uint32_t offset, bool cache_enable);
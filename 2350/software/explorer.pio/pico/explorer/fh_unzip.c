@@ -0,0 +1,478 @@
+// MSX PICOVERSE PROJECT
+// (c) 2026 Cristiano Goncalves
+// The Retro Hacker
+//
+// fh_unzip.c - Streaming ZIP (stored/deflate) extractor for File Hunter
+// downloads.
+//
+// Deflate decoding follows RFC 1951 with canonical Huffman tables decoded
+// bit by bit (tinf style). All state needed to resume lives in fh_unzip_t;
+// back-references are served from the output buffer itself, so no window
+// copy is kept.
+//
+// This work is licensed under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+// License". https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+#include <string.h>
+#include <ctype.h>
+#include "fh_unzip.h"
+
+// Output bytes produced per fh_unzip_feed() call before it yields, so the
+// caller can keep servicing MSX reads between slices.
+#define FH_UNZIP_BUDGET (16u * 1024u)
+
+#define ZIP_SIG_LOCAL    0x04034B50u
+#define ZIP_SIG_CENTRAL  0x02014B50u
+#define ZIP_SIG_END      0x06054B50u
+#define ZIP_SIG_DESC     0x08074B50u
+#define ZIP_FLAG_CRYPT   0x0001u
+#define ZIP_FLAG_DESC    0x0008u
+
+enum {
+    ST_LOCAL_HEADER = 0,
+    ST_SKIP,
+    ST_STORED_ENTRY,
+    ST_BLOCK_HEADER,
+    ST_STORED_BLOCK,
+    ST_CODES,
+    ST_FINISH,
+    ST_DONE,
+    ST_ERROR
+};
+
+enum { UNIT_OK = 0, UNIT_UNDERFLOW, UNIT_ERROR };
+
+static const uint16_t length_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t length_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t dist_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t dist_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+static const uint8_t clen_order[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+static const uint32_t crc_nibble[16] = {
+    0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu,
+    0x76DC4190u, 0x6B6B51F4u, 0x4DB26158u, 0x5005713Cu,
+    0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu,
+    0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu
+};
+
+// -----------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------
+static uint32_t rd16(const uint8_t *p) { return (uint32_t)p[0] | ((uint32_t)p[1] << 8); }
+static uint32_t rd32(const uint8_t *p) { return rd16(p) | (rd16(p + 2) << 16); }
+
+static int unit_fail(fh_unzip_t *z, const char *why)
+{
+    z->error = why;
+    return UNIT_ERROR;
+}
+
+static uint32_t getbits(fh_unzip_t *z, unsigned n)
+{
+    uint32_t v = 0;
+    for (unsigned i = 0; i < n; i++) {
+        uint32_t byte = z->bitpos >> 3;
+        if (byte >= z->in_avail) {
+            z->underflow = true;
+            return 0;
+        }
+        v |= (uint32_t)((z->in[byte] >> (z->bitpos & 7u)) & 1u) << i;
+        z->bitpos++;
+    }
+    return v;
+}
+
+static void crc_catch_up(fh_unzip_t *z)
+{
+    uint32_t crc = ~z->crc_run;
+    for (uint32_t i = z->crc_pos; i < z->out_len; i++) {
+        crc ^= z->out[i];
+        crc = (crc >> 4) ^ crc_nibble[crc & 15u];
+        crc = (crc >> 4) ^ crc_nibble[crc & 15u];
+    }
+    z->crc_run = ~crc;
+    z->crc_pos = z->out_len;
+}
+
+static bool is_rom_name(const char *name)
+{
+    size_t len = strlen(name);
+    if (len < 4u || name[len - 4u] != '.') return false;
+    char e1 = (char)tolower((unsigned char)name[len - 3u]);
+    char e2 = (char)tolower((unsigned char)name[len - 2u]);
+    char e3 = (char)tolower((unsigned char)name[len - 1u]);
+    return (e1 == 'r' && e2 == 'o' && e3 == 'm') ||
+           (e1 == 'm' && e2 == 'x' && (e3 == '1' || e3 == '2')) ||
+           (e1 == 'b' && e2 == 'i' && e3 == 'n');
+}
+
+bool fh_unzip_is_zip_name(const char *name)
+{
+    size_t len = name ? strlen(name) : 0u;
+    return len >= 4u && name[len - 4u] == '.' &&
+           tolower((unsigned char)name[len - 3u]) == 'z' &&
+           tolower((unsigned char)name[len - 2u]) == 'i' &&
+           tolower((unsigned char)name[len - 1u]) == 'p';
+}
+
+// -----------------------------------------------------------------------
+// Huffman tables
+// -----------------------------------------------------------------------
+static bool huff_build(fh_unzip_huff_t *t, const uint8_t *lengths, unsigned num)
+{
+    uint16_t offs[16];
+    int left = 1;
+
+    memset(t->counts, 0, sizeof(t->counts));
+    for (unsigned i = 0; i < num; i++)
+        t->counts[lengths[i]]++;
+    t->counts[0] = 0;
+
+    for (unsigned len = 1; len < 16; len++) {
+        left = (left << 1) - t->counts[len];
+        if (left < 0) return false; // over-subscribed
+    }
+
+    uint16_t sum = 0;
+    for (unsigned len = 0; len < 16; len++) {
+        offs[len] = sum;
+        sum = (uint16_t)(sum + t->counts[len]);
+    }
+    for (unsigned i = 0; i < num; i++) {
+        if (lengths[i]) t->symbols[offs[lengths[i]]++] = (uint16_t)i;
+    }
+    return true;
+}
+
+// Returns the symbol, -1 on input underflow, -2 on an invalid code.
+static int huff_decode(fh_unzip_t *z, const fh_unzip_huff_t *t)
+{
+    int cur = 0;
+    int sum = 0;
+    for (unsigned len = 1; len < 16; len++) {
+        cur = (cur << 1) | (int)getbits(z, 1);
+        if (z->underflow) return -1;
+        sum += t->counts[len];
+        cur -= t->counts[len];
+        if (cur < 0) return t->symbols[sum + cur];
+    }
+    return -2;
+}
+
+static void build_fixed_tables(fh_unzip_t *z)
+{
+    uint8_t lengths[288];
+    unsigned i;
+    for (i = 0; i < 144; i++) lengths[i] = 8;
+    for (; i < 256; i++) lengths[i] = 9;
+    for (; i < 280; i++) lengths[i] = 7;
+    for (; i < 288; i++) lengths[i] = 8;
+    huff_build(&z->lit, lengths, 288);
+    for (i = 0; i < 30; i++) lengths[i] = 5;
+    huff_build(&z->dist, lengths, 30);
+}
+
+// -----------------------------------------------------------------------
+// Decode units. Each either completes, or reports underflow without having
+// touched the output, so the caller can rewind bitpos and retry later.
+// -----------------------------------------------------------------------
+static int unit_dynamic_tables(fh_unzip_t *z)
+{
+    uint8_t lengths[288 + 32];
+    fh_unzip_huff_t clen;
+
+    unsigned hlit = getbits(z, 5) + 257u;
+    unsigned hdist = getbits(z, 5) + 1u;
+    unsigned hclen = getbits(z, 4) + 4u;
+    if (z->underflow) return UNIT_UNDERFLOW;
+    if (hlit > 286u || hdist > 30u) return unit_fail(z, "bad table sizes");
+
+    memset(lengths, 0, 19);
+    for (unsigned i = 0; i < hclen; i++)
+        lengths[clen_order[i]] = (uint8_t)getbits(z, 3);
+    if (z->underflow) return UNIT_UNDERFLOW;
+    if (!huff_build(&clen, lengths, 19)) return unit_fail(z, "bad code lengths");
+
+    unsigned n = 0;
+    while (n < hlit + hdist) {
+        int sym = huff_decode(z, &clen);
+        if (sym == -1) return UNIT_UNDERFLOW;
+        if (sym < 0) return unit_fail(z, "bad code length code");
+
+        if (sym < 16) {
+            lengths[n++] = (uint8_t)sym;
+            continue;
+        }
+
+        unsigned rep;
+        uint8_t val = 0;
+        if (sym == 16) {
+            if (n == 0) return unit_fail(z, "repeat without length");
+            val = lengths[n - 1u];
+            rep = 3u + getbits(z, 2);
+        } else if (sym == 17) {
+            rep = 3u + getbits(z, 3);
+        } else {
+            rep = 11u + getbits(z, 7);
+        }
+        if (z->underflow) return UNIT_UNDERFLOW;
+        if (n + rep > hlit + hdist) return unit_fail(z, "code lengths overflow");
+        while (rep--) lengths[n++] = val;
+    }
+
+    if (!huff_build(&z->lit, lengths, hlit) ||
+        !huff_build(&z->dist, lengths + hlit, hdist))
+        return unit_fail(z, "bad huffman table");
+    return UNIT_OK;
+}
+
+static int unit_block_header(fh_unzip_t *z)
+{
+    bool bfinal = getbits(z, 1) != 0;
+    uint32_t type = getbits(z, 2);
+    if (z->underflow) return UNIT_UNDERFLOW;
+
+    if (type == 0u) {
+        z->bitpos = (z->bitpos + 7u) & ~7u;
+        uint32_t len = getbits(z, 16);
+        uint32_t nlen = getbits(z, 16);
+        if (z->underflow) return UNIT_UNDERFLOW;
+        if ((len ^ 0xFFFFu) != nlen) return unit_fail(z, "bad stored block");
+        z->stored_remaining = len;
+        z->state = ST_STORED_BLOCK;
+    } else if (type == 1u) {
+        build_fixed_tables(z);
+        z->state = ST_CODES;
+    } else if (type == 2u) {
+        int r = unit_dynamic_tables(z);
+        if (r != UNIT_OK) return r;
+        z->state = ST_CODES;
+    } else {
+        return unit_fail(z, "bad block type");
+    }
+    z->bfinal = bfinal;
+    return UNIT_OK;
+}
+
+static int unit_codes(fh_unzip_t *z)
+{
+    int sym = huff_decode(z, &z->lit);
+    if (sym == -1) return UNIT_UNDERFLOW;
+    if (sym < 0) return unit_fail(z, "bad literal code");
+
+    if (sym < 256) {
+        if (z->out_len >= z->out_cap) return unit_fail(z, "output full");
+        z->out[z->out_len++] = (uint8_t)sym;
+        return UNIT_OK;
+    }
+    if (sym == 256) {
+        z->state = z->bfinal ? ST_FINISH : ST_BLOCK_HEADER;
+        return UNIT_OK;
+    }
+
+    sym -= 257;
+    if (sym >= 29) return unit_fail(z, "bad length code");
+    uint32_t len = length_base[sym] + getbits(z, length_extra[sym]);
+    int dsym = huff_decode(z, &z->dist);
+    if (dsym == -1) return UNIT_UNDERFLOW;
+    if (dsym < 0 || dsym >= 30) return unit_fail(z, "bad distance code");
+    uint32_t dist = dist_base[dsym] + getbits(z, dist_extra[dsym]);
+    if (z->underflow) return UNIT_UNDERFLOW;
+
+    if (dist > z->out_len) return unit_fail(z, "distance too far");
+    if (len > z->out_cap - z->out_len) return unit_fail(z, "output full");
+    uint8_t *dst = z->out + z->out_len;
+    const uint8_t *src = dst - dist;
+    for (uint32_t i = 0; i < len; i++) dst[i] = src[i];
+    z->out_len += len;
+    return UNIT_OK;
+}
+
+// Byte-aligned raw copy for stored entries and stored deflate blocks.
+static int unit_copy(fh_unzip_t *z, uint32_t *remaining)
+{
+    uint32_t pos = z->bitpos >> 3;
+    uint32_t n = *remaining;
+    if (n > z->in_avail - pos) n = z->in_avail - pos;
+    if (n > FH_UNZIP_BUDGET) n = FH_UNZIP_BUDGET;
+    if (n == 0u && *remaining != 0u) return UNIT_UNDERFLOW;
+    if (n > z->out_cap - z->out_len) return unit_fail(z, "output full");
+
+    memcpy(z->out + z->out_len, z->in + pos, n);
+    z->out_len += n;
+    z->bitpos += n * 8u;
+    *remaining -= n;
+    return UNIT_OK;
+}
+
+static int unit_local_header(fh_unzip_t *z)
+{
+    uint32_t pos = z->bitpos >> 3;
+    if (z->in_avail - pos < 4u) return UNIT_UNDERFLOW;
+
+    uint32_t sig = rd32(z->in + pos);
+    if (sig == ZIP_SIG_CENTRAL || sig == ZIP_SIG_END) {
+        // Ran past the last entry without a ROM-like name: rescan the
+        // staged archive and take the first file of any type.
+        if (z->any_entry) return unit_fail(z, "no file in archive");
+        z->any_entry = true;
+        z->bitpos = 0;
+        return UNIT_OK;
+    }
+    if (sig != ZIP_SIG_LOCAL) return unit_fail(z, "not a zip archive");
+    if (z->in_avail - pos < 30u) return UNIT_UNDERFLOW;
+
+    const uint8_t *h = z->in + pos;
+    uint32_t name_len = rd16(h + 26);
+    uint32_t extra_len = rd16(h + 28);
+    if (z->in_avail - pos < 30u + name_len + extra_len) return UNIT_UNDERFLOW;
+
+    z->flags = (uint16_t)rd16(h + 6);
+    z->method = (uint16_t)rd16(h + 8);
+    z->crc = rd32(h + 14);
+    z->comp_size = rd32(h + 18);
+    z->uncomp_size = rd32(h + 22);
+
+    uint32_t copy = name_len < (FH_UNZIP_NAME_MAX - 1u) ? name_len : (FH_UNZIP_NAME_MAX - 1u);
+    memcpy(z->name, h + 30, copy);
+    z->name[copy] = '\0';
+    z->bitpos = (pos + 30u + name_len + extra_len) * 8u;
+
+    bool is_dir = name_len > 0u && h[30 + name_len - 1u] == '/';
+    bool wanted = !is_dir && (z->any_entry || is_rom_name(z->name));
+    // An entry with a trailing data descriptor cannot be skipped without
+    // decoding it, so take it rather than give up.
+    if (!is_dir && !wanted && (z->flags & ZIP_FLAG_DESC)) wanted = true;
+
+    if (!wanted) {
+        z->skip_remaining = z->comp_size;
+        z->state = ST_SKIP;
+        return UNIT_OK;
+    }
+
+    if (z->flags & ZIP_FLAG_CRYPT) return unit_fail(z, "encrypted entry");
+    z->out_len = 0;
+    z->crc_run = 0;
+    z->crc_pos = 0;
+    if (z->method == 0u) {
+        if (z->flags & ZIP_FLAG_DESC) return unit_fail(z, "stored entry without size");
+        z->stored_remaining = z->comp_size;
+        z->state = ST_STORED_ENTRY;
+    } else if (z->method == 8u) {
+        z->state = ST_BLOCK_HEADER;
+    } else {
+        return unit_fail(z, "unsupported method");
+    }
+    return UNIT_OK;
+}
+
+static int unit_finish(fh_unzip_t *z)
+{
+    z->bitpos = (z->bitpos + 7u) & ~7u;
+    if (z->flags & ZIP_FLAG_DESC) {
+        uint32_t pos = z->bitpos >> 3;
+        if (z->in_avail - pos < 16u) return UNIT_UNDERFLOW;
+        const uint8_t *d = z->in + pos;
+        if (rd32(d) == ZIP_SIG_DESC) d += 4;
+        z->crc = rd32(d);
+        z->uncomp_size = rd32(d + 8);
+    }
+
+    crc_catch_up(z);
+    if (z->uncomp_size != z->out_len) return unit_fail(z, "size mismatch");
+    if (z->crc_run != z->crc) return unit_fail(z, "crc mismatch");
+    z->state = ST_DONE;
+    return UNIT_OK;
+}
+
+// -----------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------
+void fh_unzip_init(fh_unzip_t *z, uint8_t *out, uint32_t out_cap)
+{
+    memset(z, 0, sizeof(*z));
+    z->out = out;
+    z->out_cap = out_cap;
+    z->state = ST_LOCAL_HEADER;
+}
+
+fh_unzip_result_t fh_unzip_feed(fh_unzip_t *z, const uint8_t *in, uint32_t in_avail, bool in_complete)
+{
+    fh_unzip_result_t result;
+    uint32_t start_out = z->out_len;
+
+    z->in = in;
+    z->in_avail = in_avail;
+
+    while (true) {
+        if (z->state == ST_DONE) { result = FH_UNZIP_DONE; break; }
+        if (z->state == ST_ERROR) { result = FH_UNZIP_ERROR; break; }
+        if (z->out_len - start_out >= FH_UNZIP_BUDGET) { result = FH_UNZIP_BUSY; break; }
+
+        uint32_t mark = z->bitpos;
+        int r;
+        z->underflow = false;
+
+        switch (z->state) {
+            case ST_LOCAL_HEADER: r = unit_local_header(z); break;
+            case ST_SKIP: {
+                uint32_t pos = z->bitpos >> 3;
+                uint32_t n = z->skip_remaining;
+                if (n > z->in_avail - pos) n = z->in_avail - pos;
+                z->bitpos += n * 8u;
+                z->skip_remaining -= n;
+                if (z->skip_remaining == 0u) z->state = ST_LOCAL_HEADER;
+                r = (n == 0u && z->skip_remaining != 0u) ? UNIT_UNDERFLOW : UNIT_OK;
+                break;
+            }
+            case ST_STORED_ENTRY:
+                r = unit_copy(z, &z->stored_remaining);
+                if (r == UNIT_OK && z->stored_remaining == 0u) z->state = ST_FINISH;
+                break;
+            case ST_BLOCK_HEADER: r = unit_block_header(z); break;
+            case ST_STORED_BLOCK:
+                r = unit_copy(z, &z->stored_remaining);
+                if (r == UNIT_OK && z->stored_remaining == 0u)
+                    z->state = z->bfinal ? ST_FINISH : ST_BLOCK_HEADER;
+                break;
+            case ST_CODES: r = unit_codes(z); break;
+            case ST_FINISH: r = unit_finish(z); break;
+            default: r = unit_fail(z, "bad state"); break;
+        }
+
+        if (r == UNIT_UNDERFLOW) {
+            z->bitpos = mark;
+            if (in_complete) {
+                z->error = "truncated archive";
+                z->state = ST_ERROR;
+                result = FH_UNZIP_ERROR;
+            } else {
+                result = FH_UNZIP_NEED_MORE;
+            }
+            break;
+        }
+        if (r == UNIT_ERROR) {
+            z->state = ST_ERROR;
+            result = FH_UNZIP_ERROR;
+            break;
+        }
+    }
+
+    // Keep the running CRC level with the output so the final check is cheap.
+    if (z->state != ST_DONE && z->state != ST_ERROR)
+        crc_catch_up(z);
+    return result;
+}
@@ -0,0 +1,86 @@
+// MSX PICOVERSE PROJECT
+// (c) 2026 Cristiano Goncalves
+// The Retro Hacker
+//
+// fh_unzip.h - Streaming ZIP (stored/deflate) extractor for File Hunter
+// downloads.
+//
+// The compressed archive is appended to a staging buffer as TCP packets
+// arrive; fh_unzip_feed() is called whenever the receive loop is idle with
+// the number of bytes staged so far and inflates as far as the data allows,
+// straight into the output buffer. Because the whole archive and the whole output stay in
+// memory (PSRAM), the decoder needs no sliding window and can resume at any
+// point: each atomic unit (block header, literal, length/distance pair) is
+// decoded from a checkpoint and rolled back if the input runs out midway.
+//
+// The first entry with a ROM-like extension (.ROM/.MX1/.MX2/.BIN) is
+// extracted; if the archive has none, the first file entry is used.
+//
+// This work is licensed under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+// License". https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+#ifndef FH_UNZIP_H
+#define FH_UNZIP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FH_UNZIP_NAME_MAX 72u
+
+typedef enum {
+    FH_UNZIP_NEED_MORE = 0, // consumed everything staged so far
+    FH_UNZIP_BUSY,          // work budget exhausted, call again
+    FH_UNZIP_DONE,          // entry extracted and CRC-checked
+    FH_UNZIP_ERROR          // see fh_unzip_t.error
+} fh_unzip_result_t;
+
+typedef struct {
+    uint16_t counts[16];
+    uint16_t symbols[288];
+} fh_unzip_huff_t;
+
+typedef struct {
+    // Input: the archive as staged so far.
+    const uint8_t *in;
+    uint32_t in_avail;
+    uint32_t bitpos;        // absolute bit position within in[]
+    bool underflow;
+
+    // Output: the extracted entry.
+    uint8_t *out;
+    uint32_t out_cap;
+    uint32_t out_len;
+    uint32_t crc_run;       // CRC32 of out[0..crc_pos)
+    uint32_t crc_pos;
+
+    // ZIP layer.
+    uint8_t state;
+    bool any_entry;         // second pass: accept the first file of any type
+    uint16_t flags;
+    uint16_t method;
+    uint32_t comp_size;
+    uint32_t uncomp_size;
+    uint32_t crc;
+    uint32_t skip_remaining;
+    char name[FH_UNZIP_NAME_MAX];
+
+    // Deflate layer.
+    bool bfinal;
+    uint32_t stored_remaining;
+    fh_unzip_huff_t lit;
+    fh_unzip_huff_t dist;
+
+    const char *error;
+} fh_unzip_t;
+
+void fh_unzip_init(fh_unzip_t *z, uint8_t *out, uint32_t out_cap);
+
+// in/in_avail describe the whole staged archive (the pointer must not move
+// between calls). in_complete marks the final call: running out of input
+// then is an error rather than FH_UNZIP_NEED_MORE.
+fh_unzip_result_t fh_unzip_feed(fh_unzip_t *z, const uint8_t *in, uint32_t in_avail, bool in_complete);
+
+// True when a filename ends in .zip (case-insensitive).
+bool fh_unzip_is_zip_name(const char *name);
+
+#endif // FH_UNZIP_H
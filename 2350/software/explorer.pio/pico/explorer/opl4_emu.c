@@ -0,0 +1,505 @@
+// MSX PICOVERSE PROJECT
+// (c) 2026 Cristiano Goncalves
+// The Retro Hacker
+//
+// opl4_emu.c - YMF278B (OPL4) wave part for the MoonSound profile.
+//
+// Register layout, tone headers and the envelope rate formula follow the
+// YMF278B datasheet. Levels are kept as attenuation in 0.09375 dB steps
+// (1024 steps = 96 dB) and turned into a gain with a 64-entry table and a
+// shift, so a voice costs one or two memory reads and two multiplies per
+// sample.
+//
+// This work is licensed under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+// License". https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+#include <string.h>
+#include "opl4_emu.h"
+#include "pico.h"
+
+enum {
+    OPL4_EG_OFF = 0,
+    OPL4_EG_ATTACK,
+    OPL4_EG_DECAY1,
+    OPL4_EG_DECAY2,
+    OPL4_EG_RELEASE,
+    OPL4_EG_DAMP
+};
+
+#define OPL4_ATT_MUTE       0x400u
+#define OPL4_ENV_MAX        (0x3FFu << 16)
+#define OPL4_DAMP_RATE      56u
+#define OPL4_MEM_MASK       0x3FFFFFu
+
+// 2^(-i/64) in Q15: one octave of attenuation, 6 dB per 64 steps.
+static const uint16_t __not_in_flash("opl4") opl4_gain_table[64] = {
+    32768, 32415, 32066, 31720, 31379, 31041, 30706, 30376,
+    30048, 29725, 29405, 29088, 28774, 28464, 28158, 27855,
+    27554, 27258, 26964, 26674, 26386, 26102, 25821, 25543,
+    25268, 24995, 24726, 24460, 24196, 23936, 23678, 23423,
+    23170, 22921, 22674, 22430, 22188, 21949, 21713, 21479,
+    21247, 21019, 20792, 20568, 20347, 20127, 19911, 19696,
+    19484, 19274, 19066, 18861, 18658, 18457, 18258, 18061,
+    17867, 17674, 17484, 17296, 17109, 16925, 16743, 16562
+};
+
+// Pan attenuation (register 0x68 bits [3:0]) for the left and right side.
+static const uint16_t __not_in_flash("opl4") opl4_pan_att[2][16] = {
+    { 0, 32, 64, 96, 128, 160, 192, OPL4_ATT_MUTE,
+      OPL4_ATT_MUTE, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0,
+      OPL4_ATT_MUTE, OPL4_ATT_MUTE, 192, 160, 128, 96, 64, 32 }
+};
+
+// LFO phase increment per 44.1 kHz sample (phase is 32-bit, one cycle).
+static const uint32_t opl4_lfo_inc[8] = {
+    16362, 196634, 311263, 409629, 507897, 573441, 606165, 688169
+};
+
+// Vibrato depth as a 16.16 pitch factor at full LFO swing.
+static const uint16_t opl4_vib_depth[8] = {
+    0, 128, 192, 256, 384, 768, 1539, 3072
+};
+
+// Tremolo depth in attenuation steps at full LFO swing.
+static const uint8_t opl4_am_depth[8] = {
+    0, 19, 31, 39, 47, 63, 79, 127
+};
+
+// Register F8/F9 levels: 3 dB per step, 7 = off.
+static const uint16_t opl4_mix_gain[8] = {
+    32768, 23198, 16423, 11627, 8231, 5827, 4125, 0
+};
+
+static inline uint8_t __not_in_flash_func(opl4_mem_read)(const opl4_wave_t *w, uint32_t addr)
+{
+    addr &= OPL4_MEM_MASK;
+    if (addr < OPL4_WAVE_RAM_BASE)
+        return w->rom ? w->rom[addr] : 0xFF;
+    if (!w->ram)
+        return 0xFF;
+    return w->ram[(addr - OPL4_WAVE_RAM_BASE) & w->ram_mask];
+}
+
+static inline int32_t __not_in_flash_func(opl4_att_gain)(uint32_t att)
+{
+    if (att >= OPL4_ATT_MUTE) return 0;
+    return opl4_gain_table[att & 63u] >> (att >> 6);
+}
+
+// -----------------------------------------------------------------------
+// Pitch and envelope rates
+// -----------------------------------------------------------------------
+
+static void opl4_update_step(const opl4_wave_t *w, opl4_wave_voice_t *v)
+{
+    uint32_t step = (1024u + v->fnum) << 6;
+    if (v->oct >= 0)
+        step <<= v->oct;
+    else
+        step >>= -v->oct;
+    v->step = step << w->rate_shift;
+}
+
+static uint32_t opl4_compute_rate(const opl4_wave_voice_t *v, uint32_t val)
+{
+    if (val == 0) return 0;
+    if (val == 15) return 63;
+    int32_t rate;
+    if (v->rc != 15)
+        rate = (v->oct + v->rc) * 2 + ((v->fnum & 0x200u) ? 1 : 0) + (int32_t)val * 4;
+    else
+        rate = (int32_t)val * 4;
+    if (rate < 0) rate = 0;
+    if (rate > 63) rate = 63;
+    return (uint32_t)rate;
+}
+
+static uint32_t opl4_rate_inc(const opl4_wave_t *w, uint32_t rate)
+{
+    if (rate < 4) return 0;
+    return (((4u + (rate & 3u)) << (rate >> 2)) << 2) << w->rate_shift;
+}
+
+static uint32_t opl4_stage_rate(const opl4_wave_voice_t *v)
+{
+    switch (v->eg) {
+    case OPL4_EG_ATTACK:  return opl4_compute_rate(v, v->ar);
+    case OPL4_EG_DECAY1:  return opl4_compute_rate(v, v->d1r);
+    case OPL4_EG_DECAY2:  return opl4_compute_rate(v, v->d2r);
+    case OPL4_EG_RELEASE: return opl4_compute_rate(v, v->rr);
+    case OPL4_EG_DAMP:    return OPL4_DAMP_RATE;
+    default:              return 0;
+    }
+}
+
+static void opl4_set_stage(const opl4_wave_t *w, opl4_wave_voice_t *v, uint8_t eg)
+{
+    v->eg = eg;
+    v->eg_inc = opl4_rate_inc(w, opl4_stage_rate(v));
+}
+
+static inline uint32_t opl4_decay_level(const opl4_wave_voice_t *v)
+{
+    return v->dl == 15 ? OPL4_ENV_MAX : ((uint32_t)v->dl * 32u) << 16;
+}
+
+static void opl4_key_on(const opl4_wave_t *w, opl4_wave_voice_t *v)
+{
+    v->pos = 0;
+    v->frac = 0;
+    if (!v->lfo_hold) v->lfo_phase = 0;
+    if (opl4_compute_rate(v, v->ar) == 63) {
+        v->env = 0;
+        opl4_set_stage(w, v, OPL4_EG_DECAY1);
+    } else {
+        v->env = OPL4_ENV_MAX;
+        opl4_set_stage(w, v, OPL4_EG_ATTACK);
+    }
+}
+
+static void __not_in_flash_func(opl4_envelope)(const opl4_wave_t *w, opl4_wave_voice_t *v)
+{
+    switch (v->eg) {
+    case OPL4_EG_ATTACK:
+        if (v->eg_inc) {
+            uint32_t dec = (uint32_t)(((uint64_t)v->env * v->eg_inc) >> 20) + 1u;
+            if (v->env <= dec) {
+                v->env = 0;
+                opl4_set_stage(w, v, OPL4_EG_DECAY1);
+            } else {
+                v->env -= dec;
+            }
+        }
+        break;
+    case OPL4_EG_DECAY1:
+        v->env += v->eg_inc;
+        if (v->env >= opl4_decay_level(v)) {
+            if (v->env > OPL4_ENV_MAX) v->env = OPL4_ENV_MAX;
+            opl4_set_stage(w, v, OPL4_EG_DECAY2);
+        }
+        break;
+    case OPL4_EG_DECAY2:
+    case OPL4_EG_RELEASE:
+    case OPL4_EG_DAMP:
+        v->env += v->eg_inc;
+        if (v->env >= OPL4_ENV_MAX) {
+            v->env = OPL4_ENV_MAX;
+            v->eg = OPL4_EG_OFF;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+// -----------------------------------------------------------------------
+// Samples
+// -----------------------------------------------------------------------
+
+static inline int32_t __not_in_flash_func(opl4_fetch)(const opl4_wave_t *w, const opl4_wave_voice_t *v, uint32_t pos)
+{
+    uint32_t a;
+    switch (v->bits) {
+    case 0:
+        return (int32_t)(int8_t)opl4_mem_read(w, v->start + pos) << 8;
+    case 1:
+        a = v->start + (pos >> 1) * 3u;
+        if (pos & 1u)
+            return (int16_t)((opl4_mem_read(w, a + 2u) << 8) | ((opl4_mem_read(w, a + 1u) << 4) & 0xF0u));
+        return (int16_t)((opl4_mem_read(w, a) << 8) | (opl4_mem_read(w, a + 1u) & 0xF0u));
+    default:
+        a = v->start + pos * 2u;
+        return (int16_t)((opl4_mem_read(w, a) << 8) | opl4_mem_read(w, a + 1u));
+    }
+}
+
+static inline void __not_in_flash_func(opl4_advance)(opl4_wave_voice_t *v, uint32_t step)
+{
+    v->frac += step;
+    v->pos += v->frac >> 16;
+    v->frac &= 0xFFFFu;
+    if (v->pos >= v->end) {
+        uint32_t len = v->end > v->loop ? v->end - v->loop : 0u;
+        v->pos = len ? v->loop + (v->pos - v->end) % len : v->loop;
+    }
+}
+
+static void opl4_load_tone(opl4_wave_t *w, opl4_wave_voice_t *v, uint32_t n)
+{
+    uint32_t base;
+    uint8_t h[12];
+
+    if (v->wave < 384u || w->header_bank == 0)
+        base = v->wave * 12u;
+    else
+        base = w->header_bank * 0x80000u + (v->wave - 384u) * 12u;
+    for (uint32_t i = 0; i < sizeof(h); i++)
+        h[i] = opl4_mem_read(w, base + i);
+
+    v->bits = h[0] >> 6;
+    v->start = ((uint32_t)(h[0] & 0x3Fu) << 16) | ((uint32_t)h[1] << 8) | h[2];
+    v->loop = ((uint32_t)h[3] << 8) | h[4];
+    v->end = 0x10000u - (((uint32_t)h[5] << 8) | h[6]);
+    v->pos = 0;
+    v->frac = 0;
+
+    opl4_wave_apply_reg(w, (uint8_t)(0x80u + n), h[7]);
+    opl4_wave_apply_reg(w, (uint8_t)(0x98u + n), h[8]);
+    opl4_wave_apply_reg(w, (uint8_t)(0xB0u + n), h[9]);
+    opl4_wave_apply_reg(w, (uint8_t)(0xC8u + n), h[10]);
+    opl4_wave_apply_reg(w, (uint8_t)(0xE0u + n), h[11]);
+}
+
+// -----------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------
+
+void opl4_wave_init(opl4_wave_t *w, const uint8_t *rom, uint8_t *ram, uint32_t ram_size, uint32_t rate)
+{
+    memset(w, 0, sizeof(*w));
+    w->rom = rom;
+    w->ram = ram_size ? ram : NULL;
+    w->ram_mask = ram_size ? ram_size - 1u : 0u;
+    w->rate = rate;
+    w->rate_shift = (rate < OPL4_WAVE_NATIVE_RATE) ? 1u : 0u;
+    w->interpolate = true;
+    opl4_wave_reset(w);
+}
+
+void opl4_wave_reset(opl4_wave_t *w)
+{
+    memset(w->reg, 0, sizeof(w->reg));
+    memset(w->voice, 0, sizeof(w->voice));
+    w->mem_addr = 0;
+    w->header_bank = 0;
+    for (uint32_t i = 0; i < OPL4_WAVE_VOICES; i++)
+        opl4_update_step(w, &w->voice[i]);
+    w->reg[0xF8] = 0x1B;
+    opl4_wave_apply_reg(w, 0xF8, 0x1B);
+    opl4_wave_apply_reg(w, 0xF9, 0x00);
+}
+
+void opl4_wave_set_quality(opl4_wave_t *w, uint32_t rate, bool interpolate)
+{
+    w->rate = rate;
+    w->rate_shift = (rate < OPL4_WAVE_NATIVE_RATE) ? 1u : 0u;
+    w->interpolate = interpolate;
+    for (uint32_t i = 0; i < OPL4_WAVE_VOICES; i++) {
+        opl4_wave_voice_t *v = &w->voice[i];
+        opl4_update_step(w, v);
+        v->eg_inc = opl4_rate_inc(w, opl4_stage_rate(v));
+    }
+}
+
+uint8_t __not_in_flash_func(opl4_wave_read_reg)(opl4_wave_t *w, uint8_t reg)
+{
+    uint8_t data;
+    switch (reg) {
+    case 0x02:
+        return (uint8_t)((w->reg[2] & 0x1Fu) | OPL4_WAVE_DEVICE_ID);
+    case 0x06:
+        data = opl4_mem_read(w, w->mem_addr);
+        w->mem_addr = (w->mem_addr + 1u) & OPL4_MEM_MASK;
+        return data;
+    default:
+        return w->reg[reg];
+    }
+}
+
+bool __not_in_flash_func(opl4_wave_host_write)(opl4_wave_t *w, uint8_t reg, uint8_t data)
+{
+    w->reg[reg] = data;
+    switch (reg) {
+    case 0x03:
+        w->mem_addr = (w->mem_addr & 0x00FFFFu) | ((uint32_t)(data & 0x3Fu) << 16);
+        return false;
+    case 0x04:
+        w->mem_addr = (w->mem_addr & 0x3F00FFu) | ((uint32_t)data << 8);
+        return false;
+    case 0x05:
+        w->mem_addr = (w->mem_addr & 0x3FFF00u) | data;
+        return false;
+    case 0x06:
+        // The wave ROM is read-only; only the sample RAM takes writes.
+        if (w->mem_addr >= OPL4_WAVE_RAM_BASE && w->ram)
+            w->ram[(w->mem_addr - OPL4_WAVE_RAM_BASE) & w->ram_mask] = data;
+        w->mem_addr = (w->mem_addr + 1u) & OPL4_MEM_MASK;
+        return false;
+    default:
+        return reg == 0x02 || reg >= 0x08;
+    }
+}
+
+void __not_in_flash_func(opl4_wave_apply_reg)(opl4_wave_t *w, uint8_t reg, uint8_t data)
+{
+    if (reg == 0x02) {
+        w->header_bank = (data >> 2) & 7u;
+        return;
+    }
+    if (reg == 0xF8) {
+        w->mix_fm[0] = data & 7u;
+        w->mix_fm[1] = (data >> 3) & 7u;
+        return;
+    }
+    if (reg == 0xF9) {
+        w->mix_pcm_att[0] = (data & 7u) == 7u ? OPL4_ATT_MUTE : (uint16_t)((data & 7u) * 32u);
+        w->mix_pcm_att[1] = ((data >> 3) & 7u) == 7u ? OPL4_ATT_MUTE : (uint16_t)(((data >> 3) & 7u) * 32u);
+        return;
+    }
+    if (reg < 0x08 || reg >= 0xF8) return;
+
+    uint32_t group = (reg - 0x08u) / OPL4_WAVE_VOICES;
+    uint32_t n = (reg - 0x08u) % OPL4_WAVE_VOICES;
+    opl4_wave_voice_t *v = &w->voice[n];
+    bool key, damp;
+
+    switch (group) {
+    case 0: // 0x08: tone number [7:0]
+        v->wave = (uint16_t)((v->wave & 0x100u) | data);
+        opl4_load_tone(w, v, n);
+        break;
+    case 1: // 0x20: FNUM [6:0], tone number [8]
+        v->wave = (uint16_t)((v->wave & 0xFFu) | ((data & 1u) << 8));
+        v->fnum = (uint16_t)((v->fnum & 0x380u) | (data >> 1));
+        opl4_update_step(w, v);
+        v->eg_inc = opl4_rate_inc(w, opl4_stage_rate(v));
+        break;
+    case 2: // 0x38: octave, FNUM [9:7]
+        v->oct = (int8_t)((data >> 4) & 0x0Fu);
+        if (v->oct & 8) v->oct -= 16;
+        v->fnum = (uint16_t)((v->fnum & 0x07Fu) | ((data & 7u) << 7));
+        opl4_update_step(w, v);
+        v->eg_inc = opl4_rate_inc(w, opl4_stage_rate(v));
+        break;
+    case 3: // 0x50: total level
+        v->tl = data >> 1;
+        break;
+    case 4: // 0x68: key on, damp, LFO reset, pan
+        v->pan = data & 0x0Fu;
+        v->lfo_hold = (data & 0x20u) != 0;
+        if (v->lfo_hold) v->lfo_phase = 0;
+        key = (data & 0x80u) != 0;
+        damp = (data & 0x40u) != 0;
+        if (key && !v->key_on)
+            opl4_key_on(w, v);
+        else if (!key && v->key_on && v->eg != OPL4_EG_OFF && v->eg != OPL4_EG_DAMP)
+            opl4_set_stage(w, v, OPL4_EG_RELEASE);
+        if (damp && v->eg != OPL4_EG_OFF)
+            opl4_set_stage(w, v, OPL4_EG_DAMP);
+        v->key_on = key;
+        v->damp = damp;
+        break;
+    case 5: // 0x80: LFO frequency, vibrato
+        v->lfo = (data >> 3) & 7u;
+        v->vib = data & 7u;
+        break;
+    case 6: // 0x98: attack, decay 1
+        v->ar = data >> 4;
+        v->d1r = data & 0x0Fu;
+        v->eg_inc = opl4_rate_inc(w, opl4_stage_rate(v));
+        break;
+    case 7: // 0xB0: decay level, decay 2
+        v->dl = data >> 4;
+        v->d2r = data & 0x0Fu;
+        v->eg_inc = opl4_rate_inc(w, opl4_stage_rate(v));
+        break;
+    case 8: // 0xC8: rate correction, release
+        v->rc = data >> 4;
+        v->rr = data & 0x0Fu;
+        v->eg_inc = opl4_rate_inc(w, opl4_stage_rate(v));
+        break;
+    default: // 0xE0: tremolo
+        v->am = data & 7u;
+        break;
+    }
+}
+
+void opl4_wave_write_reg(opl4_wave_t *w, uint8_t reg, uint8_t data)
+{
+    if (opl4_wave_host_write(w, reg, data))
+        opl4_wave_apply_reg(w, reg, data);
+}
+
+uint32_t __not_in_flash_func(opl4_wave_schedule)(opl4_wave_t *w, uint32_t max_voices)
+{
+    uint32_t sounding = 0;
+    for (uint32_t i = 0; i < OPL4_WAVE_VOICES; i++) {
+        w->voice[i].muted = false;
+        if (w->voice[i].eg != OPL4_EG_OFF) sounding++;
+    }
+    if (sounding <= max_voices) return sounding;
+
+    // Drop released voices first, then the most attenuated ones.
+    for (uint32_t drop = sounding - max_voices; drop; drop--) {
+        opl4_wave_voice_t *pick = NULL;
+        uint32_t pick_rank = 0;
+        for (uint32_t i = 0; i < OPL4_WAVE_VOICES; i++) {
+            opl4_wave_voice_t *v = &w->voice[i];
+            if (v->eg == OPL4_EG_OFF || v->muted) continue;
+            uint32_t rank = (v->env >> 16) + ((uint32_t)v->tl << 2);
+            if (!v->key_on) rank += 0x10000u;
+            if (!pick || rank > pick_rank) {
+                pick = v;
+                pick_rank = rank;
+            }
+        }
+        if (!pick) break;
+        pick->muted = true;
+    }
+    return sounding;
+}
+
+void __not_in_flash_func(opl4_wave_calc)(opl4_wave_t *w, int32_t out[2])
+{
+    int32_t left = 0;
+    int32_t right = 0;
+
+    for (uint32_t i = 0; i < OPL4_WAVE_VOICES; i++) {
+        opl4_wave_voice_t *v = &w->voice[i];
+        if (v->eg == OPL4_EG_OFF) continue;
+
+        uint32_t step = v->step;
+        uint32_t am_att = 0;
+        if (v->vib | v->am) {
+            // Triangle LFO, +-32767 with the phase at 0 on reset.
+            int32_t p = (int32_t)(v->lfo_phase >> 16);
+            int32_t tri = (p < 0x8000) ? p - 0x4000 : 0xBFFF - p;
+            tri *= 2;
+            if (v->vib)
+                step += (uint32_t)(((int64_t)step * ((opl4_vib_depth[v->vib] * tri) >> 15)) >> 16);
+            if (v->am)
+                am_att = (uint32_t)((opl4_am_depth[v->am] * (tri + 32768)) >> 16);
+            if (!v->lfo_hold)
+                v->lfo_phase += opl4_lfo_inc[v->lfo] << w->rate_shift;
+        }
+
+        if (!v->muted) {
+            uint32_t att = (v->env >> 16) + ((uint32_t)v->tl << 2) + am_att;
+            uint32_t att_l = att + opl4_pan_att[0][v->pan] + w->mix_pcm_att[0];
+            uint32_t att_r = att + opl4_pan_att[1][v->pan] + w->mix_pcm_att[1];
+            if (att_l < OPL4_ATT_MUTE || att_r < OPL4_ATT_MUTE) {
+                int32_t s = opl4_fetch(w, v, v->pos);
+                if (w->interpolate) {
+                    uint32_t next = v->pos + 1u;
+                    if (next >= v->end) next = v->loop;
+                    int32_t s1 = opl4_fetch(w, v, next);
+                    s += ((s1 - s) * (int32_t)(v->frac >> 1)) >> 15;
+                }
+                left += (s * opl4_att_gain(att_l)) >> 15;
+                right += (s * opl4_att_gain(att_r)) >> 15;
+            }
+        }
+
+        opl4_advance(v, step);
+        opl4_envelope(w, v);
+    }
+
+    out[0] = left;
+    out[1] = right;
+}
+
+int32_t opl4_wave_fm_gain(const opl4_wave_t *w, uint32_t side)
+{
+    return opl4_mix_gain[w->mix_fm[side & 1u] & 7u];
+}
@@ -0,0 +1,122 @@
+// MSX PICOVERSE PROJECT
+// (c) 2026 Cristiano Goncalves
+// The Retro Hacker
+//
+// opl4_emu.h - YMF278B (OPL4) wave part for the MoonSound profile.
+//
+// The wave part is 24 PCM voices that play 8/12/16-bit samples from a 4MB
+// address space: the YRW801 wave ROM at 0x000000-0x1FFFFF (served straight
+// from flash) and the sample RAM at 0x200000-0x3FFFFF (a PSRAM region,
+// mirrored when smaller than 2MB). The FM part is a YMF262 and lives in
+// opl4_fm.cpp.
+//
+// The state is split by core. The host side (register shadow, memory
+// address/data registers 2-6) is touched only by the core serving the MSX
+// bus, so port 0x7F reads are answered at once. Writes that affect voices
+// are handed to the audio core, which owns the voice side and renders
+// samples. opl4_wave_write_reg() does both for single-core use.
+//
+// Rendering goes through a small voice scheduler: silent voices cost
+// nothing, and when more voices sound than the CPU budget allows, the
+// quietest ones keep their envelope and position running but are not
+// mixed. Pseudo-reverb and the level-direct TL glide are not modelled.
+//
+// This work is licensed under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+// License". https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+#ifndef OPL4_EMU_H
+#define OPL4_EMU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define OPL4_WAVE_VOICES        24u
+#define OPL4_WAVE_ROM_SIZE      0x200000u   // YRW801-M
+#define OPL4_WAVE_RAM_BASE      0x200000u
+#define OPL4_WAVE_RAM_MAX       0x200000u
+#define OPL4_WAVE_NATIVE_RATE   44100u
+#define OPL4_WAVE_DEVICE_ID     0x20u       // register 2 bits [7:5] = 001
+
+typedef struct {
+    // Tone header
+    uint32_t start;         // byte address of the first sample
+    uint32_t loop;          // loop point, in samples from start
+    uint32_t end;           // end point, in samples from start
+    uint8_t bits;           // 0 = 8-bit, 1 = 12-bit, 2 = 16-bit
+    uint16_t wave;          // tone number (9 bits)
+
+    // Voice registers
+    uint16_t fnum;
+    int8_t oct;
+    uint8_t tl;
+    uint8_t pan;
+    uint8_t lfo, vib, am;
+    uint8_t ar, d1r, dl, d2r, rc, rr;
+    bool key_on;
+    bool damp;
+    bool lfo_hold;
+
+    // Playback
+    uint32_t pos;           // sample index from start
+    uint32_t frac;          // 16-bit fraction of pos
+    uint32_t step;          // 16.16 samples per output sample
+    uint32_t env;           // attenuation, 16.16 in 0.09375 dB steps
+    uint8_t eg;             // OPL4_EG_*
+    uint32_t eg_inc;        // envelope increment for the current stage
+    uint32_t lfo_phase;
+    bool muted;             // dropped by the scheduler this buffer
+} opl4_wave_voice_t;
+
+typedef struct {
+    // Memory (read by both sides, RAM written by the host side)
+    const uint8_t *rom;
+    uint8_t *ram;
+    uint32_t ram_mask;
+
+    // Host side
+    uint8_t reg[256];       // register shadow for port 0x7F reads
+    uint32_t mem_addr;      // registers 3-5, auto-incremented by register 6
+
+    // Voice side
+    opl4_wave_voice_t voice[OPL4_WAVE_VOICES];
+    uint8_t header_bank;    // register 2 bits [4:2]: RAM header bank for tones >= 384
+    uint8_t mix_fm[2];      // register F8 attenuation per side (3 dB steps, 7 = off)
+    uint16_t mix_pcm_att[2]; // register F9 as extra voice attenuation
+    uint32_t rate;
+    uint8_t rate_shift;     // 1 when rendering at half the native rate
+    bool interpolate;
+} opl4_wave_t;
+
+// Attach the wave ROM and the sample RAM (ram_size must be a power of two,
+// at most 2MB) and reset the chip. rate is 44100 or 22050.
+void opl4_wave_init(opl4_wave_t *w, const uint8_t *rom, uint8_t *ram, uint32_t ram_size, uint32_t rate);
+
+void opl4_wave_reset(opl4_wave_t *w);
+
+// Output rate and interpolation; both belong to the voice side.
+void opl4_wave_set_quality(opl4_wave_t *w, uint32_t rate, bool interpolate);
+
+// Host side: read a register (2 reports the device ID, 6 reads memory).
+uint8_t opl4_wave_read_reg(opl4_wave_t *w, uint8_t reg);
+
+// Host side: latch a register write. Memory access is completed here;
+// returns true if the write must also reach opl4_wave_apply_reg().
+bool opl4_wave_host_write(opl4_wave_t *w, uint8_t reg, uint8_t data);
+
+// Voice side: apply a register write to the voices.
+void opl4_wave_apply_reg(opl4_wave_t *w, uint8_t reg, uint8_t data);
+
+// Both sides, for single-core use.
+void opl4_wave_write_reg(opl4_wave_t *w, uint8_t reg, uint8_t data);
+
+// Voice side: mark which voices get mixed until the next call so that at
+// most max_voices are rendered. Returns the number of sounding voices.
+uint32_t opl4_wave_schedule(opl4_wave_t *w, uint32_t max_voices);
+
+// Voice side: render one stereo sample (16-bit range per voice, summed).
+void opl4_wave_calc(opl4_wave_t *w, int32_t out[2]);
+
+// FM mix level from register F8 as a Q15 gain for side 0 (left) or 1.
+int32_t opl4_wave_fm_gain(const opl4_wave_t *w, uint32_t side);
+
+#endif // OPL4_EMU_H
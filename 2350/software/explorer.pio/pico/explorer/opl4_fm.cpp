@@ -0,0 +1,82 @@
+// MSX PICOVERSE PROJECT
+// (c) 2026 Cristiano Goncalves
+// The Retro Hacker
+//
+// opl4_fm.cpp - FM part of the MoonSound profile (YMF262 core of the OPL4).
+//
+// This work is licensed under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+// License". https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+#include "opl4_fm.h"
+#include "ymfm/ymfm_opl.h"
+#include "pico.h"
+
+namespace {
+
+constexpr int32_t OPL4_FM_CLOCKS_PER_SAMPLE = 288;
+
+// Timers are counted down in chip clocks as samples are generated; the
+// engine then sets the status flags exactly as on the real part.
+class opl4_fm_host : public ymfm::ymfm_interface
+{
+public:
+    void reset_timers()
+    {
+        m_timer[0] = m_timer[1] = -1;
+    }
+
+    void tick()
+    {
+        for (uint32_t t = 0; t < 2; t++)
+        {
+            if (m_timer[t] < 0)
+                continue;
+            m_timer[t] -= OPL4_FM_CLOCKS_PER_SAMPLE;
+            if (m_timer[t] <= 0)
+            {
+                m_timer[t] = -1;
+                m_engine->engine_timer_expired(t);
+            }
+        }
+    }
+
+protected:
+    void ymfm_set_timer(uint32_t tnum, int32_t duration_in_clocks) override
+    {
+        if (tnum < 2)
+            m_timer[tnum] = duration_in_clocks;
+    }
+
+private:
+    int32_t m_timer[2] = { -1, -1 };
+};
+
+opl4_fm_host opl4_fm_iface;
+ymfm::ymf262 opl4_fm_chip(opl4_fm_iface);
+
+}
+
+extern "C" void opl4_fm_reset(void)
+{
+    opl4_fm_iface.reset_timers();
+    opl4_fm_chip.reset();
+}
+
+extern "C" void __not_in_flash_func(opl4_fm_write)(uint32_t port, uint8_t data)
+{
+    opl4_fm_chip.write(port & 3u, data);
+}
+
+extern "C" uint8_t __not_in_flash_func(opl4_fm_status)(void)
+{
+    return opl4_fm_chip.read_status();
+}
+
+extern "C" void __not_in_flash_func(opl4_fm_generate)(int32_t out[2])
+{
+    ymfm::ymf262::output_data data;
+    opl4_fm_chip.generate(&data, 1);
+    opl4_fm_iface.tick();
+    out[0] = data.data[0];
+    out[1] = data.data[1];
+}
@@ -0,0 +1,42 @@
+// MSX PICOVERSE PROJECT
+// (c) 2026 Cristiano Goncalves
+// The Retro Hacker
+//
+// opl4_fm.h - FM part of the MoonSound profile (YMF262 core of the OPL4).
+//
+// A C wrapper around a single ymfm::ymf262 instance. The chip is clocked
+// at OPL4_FM_CLOCK so that one generated sample is one 44.1 kHz output
+// sample and the note pitches match the OPL4's 33.8688 MHz master clock.
+// The status register and its timer flags are emulated; nothing drives an
+// interrupt on the MSX bus.
+//
+// This work is licensed under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+// License". https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+#ifndef OPL4_FM_H
+#define OPL4_FM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OPL4_FM_CLOCK       12700800u   // 288 clocks per 44100 Hz sample
+
+void opl4_fm_reset(void);
+
+// port is 0-3 (address low, data low, address high, data high).
+void opl4_fm_write(uint32_t port, uint8_t data);
+
+uint8_t opl4_fm_status(void);
+
+// Render one 44.1 kHz stereo sample.
+void opl4_fm_generate(int32_t out[2]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OPL4_FM_H
@@ -21,18 +21,19 @@
 #include "pico/stdlib.h"
 #include "pico/sync.h"
 #include "bsp/board.h"
-#if !EXPLORER_USB_STDIO_DEBUG
+#if EXPLORER_USB_HOST
 #include "tusb.h"
 #include "class/msc/msc_host.h"
 #endif
 #include "sunrise_ide.h"
+#include "sunrise_ramdisk.h"
 
 // -----------------------------------------------------------------------
 // USB MSC state (Core 1 only, except where noted volatile/shared)
 // -----------------------------------------------------------------------
 static sunrise_ide_t *usb_ide_ctx = NULL;
 
-#if !EXPLORER_USB_STDIO_DEBUG
+#if EXPLORER_USB_HOST
 static scsi_inquiry_resp_t inquiry_resp;
 #else
 typedef struct {
@@ -53,7 +54,7 @@ static volatile uint32_t usb_block_size = 0;
 // Block I/O buffers — aligned for DMA.
 // usb_read_buffer is 4096 bytes to accommodate devices with 4K native sectors.
 // Each USB read fetches one native block; we extract the correct 512-byte slice.
-#if !EXPLORER_USB_STDIO_DEBUG
+#if EXPLORER_USB_HOST
 CFG_TUH_MEM_SECTION TU_ATTR_ALIGNED(4) static uint8_t usb_read_buffer[4096];
 TU_ATTR_ALIGNED(4) uint8_t usb_write_buffer[512];
 #else
@@ -175,6 +176,51 @@ static void build_identify_data(uint8_t *buf)
     w[61] = (uint16_t)(total >> 16);
 }
 
+// IDENTIFY data for the PSRAM RAM disk answered as the slave device.
+static void build_identify_data_ramdisk(uint8_t *buf)
+{
+    memset(buf, 0, 512);
+    uint16_t *w = (uint16_t *)buf;
+
+    w[0] = 0x0040;  // Fixed device, non-removable
+
+    uint32_t total = sunrise_ramdisk_block_count();
+    uint16_t heads = 16;
+    uint16_t spt = 63;
+    uint32_t cyls_calc = total / (heads * spt);
+    uint16_t cyls = (cyls_calc > 16383) ? 16383 : (uint16_t)cyls_calc;
+    w[1] = cyls;
+    w[3] = heads;
+    w[6] = spt;
+
+    char serial[20];
+    memset(serial, ' ', 20);
+    memcpy(serial, "PICOVERSE-RAMDISK", 17);
+    ata_string_to_words(&w[10], serial, 10);
+
+    char fwrev[8];
+    memset(fwrev, ' ', 8);
+    memcpy(fwrev, "1.0", 3);
+    ata_string_to_words(&w[23], fwrev, 4);
+
+    char model[40];
+    memset(model, ' ', 40);
+    memcpy(model, "PicoVerse PSRAM RAM disk", 24);
+    ata_string_to_words(&w[27], model, 20);
+
+    w[47] = 0x0001;
+    w[49] = 0x0200;  // LBA supported
+    w[53] = 0x0001;
+    w[54] = cyls;
+    w[55] = heads;
+    w[56] = spt;
+    uint32_t chs_cap = (uint32_t)cyls * heads * spt;
+    w[57] = (uint16_t)(chs_cap & 0xFFFF);
+    w[58] = (uint16_t)(chs_cap >> 16);
+    w[60] = (uint16_t)(total & 0xFFFF);
+    w[61] = (uint16_t)(total >> 16);
+}
+
 // -----------------------------------------------------------------------
 // IDE context initialisation
 // -----------------------------------------------------------------------
@@ -216,12 +262,125 @@ static inline uint32_t ide_get_lba(const sunrise_ide_t *ide)
          | ((uint32_t)(ide->device_head & ATA_DEV_HEAD_HEAD_MASK) << 24);
 }
 
+// -----------------------------------------------------------------------
+// PSRAM RAM disk (slave device)
+// -----------------------------------------------------------------------
+// Sectors are copied between PSRAM and the sector buffer right here on
+// Core 0, so a RAM disk transfer never goes through BSY. Only the explicit
+// image save/restore is handed to Core 1.
+static inline bool ide_ramdisk_selected(const sunrise_ide_t *ide)
+{
+    return (ide->device_head & ATA_DEV_HEAD_DEV) && sunrise_ramdisk_present();
+}
+
+// Load sector lba into the sector buffer and raise DRQ.
+static void __not_in_flash_func(ide_ramdisk_fill)(sunrise_ide_t *ide, uint32_t lba)
+{
+    if (lba >= sunrise_ramdisk_block_count())
+    {
+        ide->status = ATA_STATUS_DRDY | ATA_STATUS_ERR;
+        ide->error = ATA_ERROR_IDNF;
+        ide->state = IDE_STATE_IDLE;
+        return;
+    }
+    memcpy(ide->sector_buffer, sunrise_ramdisk_sector(lba), 512);
+    ide->buffer_index = 0;
+    ide->buffer_length = 512;
+    ide->data_latch_valid = false;
+    ide->status = ATA_STATUS_DRDY | ATA_STATUS_DSC | ATA_STATUS_DRQ;
+    ide->state = IDE_STATE_READ_DATA;
+}
+
+static void __not_in_flash_func(ide_execute_ramdisk_command)(sunrise_ide_t *ide, uint8_t cmd)
+{
+    ide->error = 0;
+    switch (cmd)
+    {
+    case ATA_CMD_IDENTIFY:
+        build_identify_data_ramdisk(ide->sector_buffer);
+        ide->buffer_index = 0;
+        ide->buffer_length = 512;
+        ide->data_latch_valid = false;
+        ide->status = ATA_STATUS_DRDY | ATA_STATUS_DSC | ATA_STATUS_DRQ;
+        ide->state = IDE_STATE_READ_DATA;
+        break;
+
+    case ATA_CMD_READ_SECTORS:
+        ide->sectors_remaining = ide->sector_count ? ide->sector_count : 256;
+        ide_ramdisk_fill(ide, ide_get_lba(ide));
+        break;
+
+    case ATA_CMD_WRITE_SECTORS:
+    {
+        uint16_t count = ide->sector_count ? ide->sector_count : 256;
+        if (ide_get_lba(ide) + count > sunrise_ramdisk_block_count())
+        {
+            ide->status = ATA_STATUS_DRDY | ATA_STATUS_ERR;
+            ide->error = ATA_ERROR_IDNF;
+            ide->state = IDE_STATE_IDLE;
+            break;
+        }
+        ide->sectors_remaining = count;
+        ide->buffer_index = 0;
+        ide->buffer_length = 512;
+        ide->data_latch_valid = false;
+        ide->status = ATA_STATUS_DRDY | ATA_STATUS_DSC | ATA_STATUS_DRQ;
+        ide->state = IDE_STATE_WRITE_DATA;
+        break;
+    }
+
+    case ATA_CMD_FLUSH_CACHE:
+    case ATA_CMD_RAMDISK:
+    {
+        // FLUSH CACHE is the standard way to ask for the image to be
+        // written back; the vendor command also allows a restore.
+        uint8_t op = (cmd == ATA_CMD_FLUSH_CACHE) ? RAMDISK_FEATURE_SAVE : ide->feature;
+        if (op != RAMDISK_FEATURE_SAVE && op != RAMDISK_FEATURE_RESTORE)
+        {
+            ide->status = ATA_STATUS_DRDY | ATA_STATUS_ERR;
+            ide->error = ATA_ERROR_ABRT;
+            ide->state = IDE_STATE_IDLE;
+            break;
+        }
+        ide->status = ATA_STATUS_BSY;
+        ide->state = IDE_STATE_BUSY;
+        sunrise_ramdisk_request(op);
+        break;
+    }
+
+    case ATA_CMD_SET_FEATURES:
+    case ATA_CMD_INIT_PARAMS:
+    case ATA_CMD_RECALIBRATE:
+        ide->status = ATA_STATUS_DRDY | ATA_STATUS_DSC;
+        ide->state = IDE_STATE_IDLE;
+        break;
+
+    case ATA_CMD_DEVICE_DIAG:
+    case ATA_CMD_DEVICE_RESET:
+        ide_set_device_signature(ide);
+        break;
+
+    default:
+        ide->status = ATA_STATUS_DRDY | ATA_STATUS_ERR;
+        ide->error = ATA_ERROR_ABRT;
+        ide->state = IDE_STATE_IDLE;
+        break;
+    }
+}
+
 // -----------------------------------------------------------------------
 // Execute ATA command (called on write to command register 0x7E07)
 // -----------------------------------------------------------------------
 static void __not_in_flash_func(ide_execute_command)(sunrise_ide_t *ide, uint8_t cmd)
 {
-    // Only respond to master device (bit 4 = 0)
+    // The slave device exists only while a PSRAM RAM disk is attached
+    if (ide_ramdisk_selected(ide))
+    {
+        ide_execute_ramdisk_command(ide, cmd);
+        return;
+    }
+
+    // Otherwise only respond to master device (bit 4 = 0)
     if (ide->device_head & ATA_DEV_HEAD_DEV)
     {
         ide->status = ATA_STATUS_ERR;
@@ -415,6 +574,24 @@ bool __not_in_flash_func(sunrise_ide_handle_write)(sunrise_ide_t *ide, uint16_t
                 ide->sectors_remaining--;
                 ide->buffer_index = 0;
 
+                if (ide_ramdisk_selected(ide))
+                {
+                    // RAM disk: store the sector and re-arm DRQ at once
+                    memcpy(sunrise_ramdisk_sector(ide_get_lba(ide)), ide->sector_buffer, 512);
+                    ide->data_latch_valid = false;
+                    if (ide->sectors_remaining > 0)
+                    {
+                        ide_advance_lba(ide);
+                        ide->status = ATA_STATUS_DRDY | ATA_STATUS_DSC | ATA_STATUS_DRQ;
+                    }
+                    else
+                    {
+                        ide->status = ATA_STATUS_DRDY | ATA_STATUS_DSC;
+                        ide->state = IDE_STATE_IDLE;
+                    }
+                    return true;
+                }
+
                 // Copy data to USB write buffer and request write
                 memcpy(usb_write_buffer, ide->sector_buffer, 512);
                 usb_write_lba = ide_get_lba(ide);
@@ -517,6 +694,11 @@ bool __not_in_flash_func(sunrise_ide_handle_read)(sunrise_ide_t *ide, uint16_t a
                 {
                     // Request next sector
                     ide_advance_lba(ide);
+                    if (ide_ramdisk_selected(ide))
+                    {
+                        ide_ramdisk_fill(ide, ide_get_lba(ide));
+                        return true;
+                    }
                     ide->buffer_index = 0;
                     ide->buffer_length = 0;
                     ide->data_latch_valid = false;
@@ -585,7 +767,7 @@ bool __not_in_flash_func(sunrise_ide_handle_read)(sunrise_ide_t *ide, uint16_t a
 // USB MSC callbacks (called from TinyUSB on Core 1)
 // -----------------------------------------------------------------------
 
-#if !EXPLORER_USB_STDIO_DEBUG
+#if EXPLORER_USB_HOST
 
 static bool read_complete_cb(uint8_t dev_addr, tuh_msc_complete_data_t const *cb_data);
 static bool write_complete_cb(uint8_t dev_addr, tuh_msc_complete_data_t const *cb_data);
@@ -708,10 +890,13 @@ void __not_in_flash_func(sunrise_usb_task)(void)
         tuh_task();
 
         service_system_audio();
+        service_storage_background();
 
         if (usb_ide_ctx == NULL)
             continue;
 
+        sunrise_ramdisk_service(usb_ide_ctx);
+
         // --- Timeout watchdog for in-progress USB transfers ---
         // Slow or stalled USB devices must not leave IDE in permanent BSY.
         // If a transfer exceeds the timeout, treat it as a failure so the
@@ -57,6 +57,7 @@
 
 // ATA error register bits
 #define ATA_ERROR_ABRT          0x04  // Aborted command
+#define ATA_ERROR_IDNF          0x10  // Requested sector not found
 
 // ATA commands (subset used by Nextor Sunrise IDE driver)
 #define ATA_CMD_DEVICE_RESET    0x08
@@ -65,6 +66,7 @@
 #define ATA_CMD_WRITE_SECTORS   0x30
 #define ATA_CMD_DEVICE_DIAG     0x90  // EXECUTE DEVICE DIAGNOSTIC
 #define ATA_CMD_INIT_PARAMS     0x91
+#define ATA_CMD_FLUSH_CACHE     0xE7
 #define ATA_CMD_IDENTIFY        0xEC
 #define ATA_CMD_SET_FEATURES    0xEF
 
@@ -153,6 +155,10 @@ void sunrise_usb_set_ide_ctx(sunrise_ide_t *ide);
 // storage task loops so Sunrise SYSTEM ROM audio profiles can share Core 1.
 void __not_in_flash_func(service_system_audio)(void);
 
+// Polled background persistence (e.g. the Carnivore2 flash image) —
+// implemented by the launcher and called from the storage task loops.
+void __not_in_flash_func(service_storage_background)(void);
+
 // Populate IDENTIFY DEVICE fields for non-USB backends (e.g. SD card).
 // Sets the block count, block size, and SCSI-style vendor/product/revision
 // strings used by build_identify_data().  Call before setting usb_device_mounted.
@@ -0,0 +1,191 @@
+// MSX PICOVERSE PROJECT
+// (c) 2026 Cristiano Goncalves
+// The Retro Hacker
+//
+// sunrise_ramdisk.c - PSRAM RAM disk for the Sunrise IDE emulation
+//
+// Sector traffic never reaches this file's slow path: the ATA front-end in
+// sunrise_ide.c copies sectors to and from the PSRAM window on Core 0. What
+// lives here is the image plumbing — the run list of the backing file, the
+// blocking restore used at launch, and the chunked save/restore that Core 1
+// performs on request. Transfers are split into small chunks so the storage
+// task loop keeps servicing SYSTEM audio while a multi-megabyte image moves.
+//
+// The run list holds absolute card LBAs resolved through FatFS at launch,
+// so the image is rewritten in place with raw sector writes: no FAT or
+// directory sector is touched while Nextor owns the card.
+//
+// This work is licensed under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+// License". https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "diskio.h"
+#include "hw_config.h"
+#include "sunrise_ramdisk.h"
+
+// Physical drive number for FatFS diskio (always 0 — single SD card)
+#define SD_PDRV                 0
+
+#define RAMDISK_SECTOR_SIZE     512u
+#define RAMDISK_CHUNK_SECTORS   8u      // sectors moved per service call
+
+static uint8_t *ramdisk_base = NULL;
+static uint32_t ramdisk_blocks = 0;
+static sunrise_ramdisk_run_t ramdisk_runs[SUNRISE_RAMDISK_MAX_RUNS];
+static uint8_t ramdisk_run_count = 0;
+
+static uint8_t ramdisk_bounce[RAMDISK_CHUNK_SECTORS * RAMDISK_SECTOR_SIZE];
+
+// Pending operation (set by Core 0, cleared by Core 1)
+static volatile uint8_t ramdisk_op_requested = 0;
+
+// Transfer cursor (Core 1 only)
+static uint8_t ramdisk_op = 0;
+static uint8_t ramdisk_run = 0;
+static uint32_t ramdisk_run_pos = 0;   // sectors done within the current run
+static uint32_t ramdisk_done = 0;      // sectors done in total
+
+void sunrise_ramdisk_attach(uint8_t *base, uint32_t block_count,
+                            const sunrise_ramdisk_run_t *runs, uint8_t run_count)
+{
+    if (run_count > SUNRISE_RAMDISK_MAX_RUNS)
+        run_count = SUNRISE_RAMDISK_MAX_RUNS;
+    memcpy(ramdisk_runs, runs, run_count * sizeof(sunrise_ramdisk_run_t));
+    ramdisk_run_count = run_count;
+    ramdisk_base = base;
+    ramdisk_blocks = block_count;
+    ramdisk_op_requested = 0;
+    ramdisk_op = 0;
+}
+
+void sunrise_ramdisk_detach(void)
+{
+    ramdisk_base = NULL;
+    ramdisk_blocks = 0;
+    ramdisk_run_count = 0;
+    ramdisk_op_requested = 0;
+    ramdisk_op = 0;
+}
+
+bool __not_in_flash_func(sunrise_ramdisk_present)(void)
+{
+    return ramdisk_base != NULL && ramdisk_blocks != 0;
+}
+
+uint32_t __not_in_flash_func(sunrise_ramdisk_block_count)(void)
+{
+    return ramdisk_blocks;
+}
+
+uint8_t *__not_in_flash_func(sunrise_ramdisk_sector)(uint32_t lba)
+{
+    return ramdisk_base + lba * RAMDISK_SECTOR_SIZE;
+}
+
+void __not_in_flash_func(sunrise_ramdisk_request)(uint8_t op)
+{
+    ramdisk_op_requested = op;
+}
+
+// Move the next chunk between the image and PSRAM. Returns false on an SD
+// error; *finished is set once every sector has been transferred.
+static bool ramdisk_step(uint8_t op, bool *finished)
+{
+    while (ramdisk_run < ramdisk_run_count &&
+           ramdisk_run_pos >= ramdisk_runs[ramdisk_run].sectors)
+    {
+        ramdisk_run++;
+        ramdisk_run_pos = 0;
+    }
+    if (ramdisk_run >= ramdisk_run_count || ramdisk_done >= ramdisk_blocks)
+    {
+        *finished = true;
+        return true;
+    }
+
+    const sunrise_ramdisk_run_t *run = &ramdisk_runs[ramdisk_run];
+    uint32_t count = run->sectors - ramdisk_run_pos;
+    if (count > RAMDISK_CHUNK_SECTORS) count = RAMDISK_CHUNK_SECTORS;
+    if (count > ramdisk_blocks - ramdisk_done) count = ramdisk_blocks - ramdisk_done;
+
+    uint32_t lba = run->lba + ramdisk_run_pos;
+    uint8_t *mem = ramdisk_base + ramdisk_done * RAMDISK_SECTOR_SIZE;
+    uint32_t bytes = count * RAMDISK_SECTOR_SIZE;
+
+    // PSRAM goes through the write-through XIP window on both sides, so the
+    // SD transfer uses an SRAM bounce buffer rather than DMA into PSRAM.
+    if (op == RAMDISK_FEATURE_SAVE)
+    {
+        memcpy(ramdisk_bounce, mem, bytes);
+        if (disk_write_raw(SD_PDRV, ramdisk_bounce, lba, count) != RES_OK)
+            return false;
+    }
+    else
+    {
+        if (disk_read_raw(SD_PDRV, ramdisk_bounce, lba, count) != RES_OK)
+            return false;
+        memcpy(mem, ramdisk_bounce, bytes);
+    }
+
+    ramdisk_run_pos += count;
+    ramdisk_done += count;
+    *finished = false;
+    return true;
+}
+
+static void ramdisk_begin(uint8_t op)
+{
+    ramdisk_op = op;
+    ramdisk_run = 0;
+    ramdisk_run_pos = 0;
+    ramdisk_done = 0;
+}
+
+bool sunrise_ramdisk_restore(void)
+{
+    if (!sunrise_ramdisk_present())
+        return false;
+
+    ramdisk_begin(RAMDISK_FEATURE_RESTORE);
+    bool finished = false;
+    bool ok = true;
+    while (ok && !finished)
+        ok = ramdisk_step(RAMDISK_FEATURE_RESTORE, &finished);
+    ramdisk_op = 0;
+
+    printf("RAMDISK: restore %s (%lu sectors)\n", ok ? "ok" : "failed",
+           (unsigned long)ramdisk_done);
+    return ok;
+}
+
+void sunrise_ramdisk_service(sunrise_ide_t *ide)
+{
+    if (ramdisk_op == 0)
+    {
+        uint8_t op = ramdisk_op_requested;
+        if (op == 0)
+            return;
+        ramdisk_op_requested = 0;
+        ramdisk_begin(op);
+    }
+
+    bool finished = false;
+    bool ok = ramdisk_step(ramdisk_op, &finished);
+    if (ok && !finished)
+        return;
+
+    ramdisk_op = 0;
+    if (ok)
+    {
+        ide->error = 0;
+        ide->status = ATA_STATUS_DRDY | ATA_STATUS_DSC;
+    }
+    else
+    {
+        ide->error = ATA_ERROR_ABRT;
+        ide->status = ATA_STATUS_DRDY | ATA_STATUS_ERR;
+    }
+    ide->state = IDE_STATE_IDLE;
+}
@@ -0,0 +1,67 @@
+// MSX PICOVERSE PROJECT
+// (c) 2026 Cristiano Goncalves
+// The Retro Hacker
+//
+// sunrise_ramdisk.h - PSRAM RAM disk for the Sunrise IDE emulation
+//
+// The RAM disk is answered as the IDE slave device next to the SD/USB master.
+// Its sectors live in PSRAM and are served by Core 0 straight from the ATA
+// front-end, so Nextor sees it at bus speed with no storage round trip.
+// The contents are backed by an image file on the microSD card: the image is
+// restored when a Sunrise ROM starts and written back only when the MSX asks
+// for it (FLUSH CACHE, or the vendor RAM disk command below).
+//
+// This work is licensed under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+// License". https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+#ifndef SUNRISE_RAMDISK_H
+#define SUNRISE_RAMDISK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sunrise_ide.h"
+
+// Backing image on the mounted microSD partition. The RAM disk is only
+// offered when this file exists; its size sets the disk size.
+#define SUNRISE_RAMDISK_IMAGE_PATH  "/RAMDISK.DSK"
+#define SUNRISE_RAMDISK_MAX_RUNS    31u
+
+// Vendor-specific ATA command (slave only). The feature register selects
+// the operation; the command completes once the SD transfer is done.
+#define ATA_CMD_RAMDISK             0xF0
+#define RAMDISK_FEATURE_SAVE        0x01  // write the RAM disk to the image
+#define RAMDISK_FEATURE_RESTORE     0x02  // reload the RAM disk from the image
+
+// Contiguous run of image sectors on the card (absolute LBAs).
+typedef struct {
+    uint32_t lba;
+    uint32_t sectors;
+} sunrise_ramdisk_run_t;
+
+// Attach the PSRAM window and the image run list. base must stay valid for
+// the whole session; block_count is in 512-byte sectors. Call on Core 0
+// before launching Core 1.
+void sunrise_ramdisk_attach(uint8_t *base, uint32_t block_count,
+                            const sunrise_ramdisk_run_t *runs, uint8_t run_count);
+
+// Drop the RAM disk; the slave device disappears again.
+void sunrise_ramdisk_detach(void);
+
+// Load the whole image into PSRAM. Blocking; used at launch on Core 0.
+bool sunrise_ramdisk_restore(void);
+
+bool __not_in_flash_func(sunrise_ramdisk_present)(void);
+uint32_t __not_in_flash_func(sunrise_ramdisk_block_count)(void);
+
+// PSRAM address of a RAM disk sector (lba must be < block count).
+uint8_t *__not_in_flash_func(sunrise_ramdisk_sector)(uint32_t lba);
+
+// Queue a save/restore for Core 1 (RAMDISK_FEATURE_*). Called by the ATA
+// front-end with the IDE already set busy.
+void __not_in_flash_func(sunrise_ramdisk_request)(uint8_t op);
+
+// Run a queued save/restore and complete the IDE command. Called from the
+// Core 1 storage task loops.
+void sunrise_ramdisk_service(sunrise_ide_t *ide);
+
+#endif // SUNRISE_RAMDISK_H
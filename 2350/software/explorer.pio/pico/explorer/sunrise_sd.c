@@ -31,6 +31,7 @@
 #include "util.h"
 #include "sunrise_sd.h"
 #include "sunrise_ide.h"
+#include "sunrise_ramdisk.h"
 
 // -----------------------------------------------------------------------
 // SD card state (Core 1 only, except shared volatiles)
@@ -457,10 +458,13 @@ void __not_in_flash_func(sunrise_sd_task)(void)
     while (true)
     {
         service_system_audio();
+        service_storage_background();
 
         if (sd_ide_ctx == NULL)
             continue;
 
+        sunrise_ramdisk_service(sd_ide_ctx);
+
         // --- Handle read request from Core 0 ---
         if (usb_read_requested && sd_device_mounted)
         {
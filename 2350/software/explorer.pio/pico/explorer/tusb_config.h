@@ -4,6 +4,10 @@
 //
 // tusb_config.h - TinyUSB configuration for Sunrise IDE USB host support
 //
+// The port runs as a host (USB MSC for the Sunrise IDE) in normal builds and
+// as a device in the EXPLORER_USB_STDIO_DEBUG (CDC) and EXPLORER_USB_PUSH
+// (vendor bulk) builds.
+//
 // This work is licensed under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
 // License". https://creativecommons.org/licenses/by-nc-sa/4.0/
 
@@ -22,8 +26,9 @@
   #error CFG_TUSB_MCU must be defined
 #endif
 
-#if EXPLORER_USB_STDIO_DEBUG
+#if !EXPLORER_USB_HOST
 #define CFG_TUSB_RHPORT0_MODE       OPT_MODE_DEVICE
+#define BOARD_TUD_RHPORT            0
 #else
 #define CFG_TUSB_RHPORT0_MODE       OPT_MODE_HOST
 #endif
@@ -57,6 +62,23 @@
 #define CFG_TUD_CDC_RX_BUFSIZE      256
 #define CFG_TUD_CDC_TX_BUFSIZE      256
 
+#elif EXPLORER_USB_PUSH
+
+//--------------------------------------------------------------------
+// DEVICE CONFIGURATION - USB push and run
+//--------------------------------------------------------------------
+
+#define CFG_TUD_ENDPOINT0_SIZE      64
+
+#define CFG_TUD_CDC                 0
+#define CFG_TUD_MSC                 0
+#define CFG_TUD_HID                 0
+#define CFG_TUD_MIDI                0
+#define CFG_TUD_VENDOR              1
+
+#define CFG_TUD_VENDOR_RX_BUFSIZE   512
+#define CFG_TUD_VENDOR_TX_BUFSIZE   256
+
 #else
 
 //--------------------------------------------------------------------
@@ -0,0 +1,143 @@
+// MSX PICOVERSE PROJECT
+// (c) 2026 Cristiano Goncalves
+// The Retro Hacker
+//
+// usb_push_dev.c - USB device personality for the "push and run" link
+//
+// Descriptors and the vendor-class pump. Everything the protocol does with
+// the image (placement in PSRAM, option checks, the launch) lives behind the
+// usb_push_sink_t handed in by explorer.c; this file only moves bytes between
+// the bulk endpoints and the usb_push.h parser.
+//
+// This work is licensed under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+// License". https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/unique_id.h"
+#include "hardware/irq.h"
+#include "tusb.h"
+#include "usb_push_dev.h"
+
+#define USB_PUSH_EP_OUT         0x01
+#define USB_PUSH_EP_IN          0x81
+#define USB_PUSH_EP_SIZE        64
+#define USB_PUSH_CONFIG_LEN     (TUD_CONFIG_DESC_LEN + TUD_VENDOR_DESC_LEN)
+#define USB_PUSH_STRING_MAX     32
+
+static const tusb_desc_device_t usb_push_device_desc = {
+    .bLength            = sizeof(tusb_desc_device_t),
+    .bDescriptorType    = TUSB_DESC_DEVICE,
+    .bcdUSB             = 0x0200,
+    .bDeviceClass       = 0x00,
+    .bDeviceSubClass    = 0x00,
+    .bDeviceProtocol    = 0x00,
+    .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+    .idVendor           = USB_PUSH_VID,
+    .idProduct          = USB_PUSH_PID,
+    .bcdDevice          = 0x0100,
+    .iManufacturer      = 0x01,
+    .iProduct           = 0x02,
+    .iSerialNumber      = 0x03,
+    .bNumConfigurations = 0x01
+};
+
+static const uint8_t usb_push_config_desc[] = {
+    TUD_CONFIG_DESCRIPTOR(1, 1, 0, USB_PUSH_CONFIG_LEN, 0x00, 100),
+    TUD_VENDOR_DESCRIPTOR(0, 4, USB_PUSH_EP_OUT, USB_PUSH_EP_IN, USB_PUSH_EP_SIZE)
+};
+
+static const char *const usb_push_strings[] = {
+    "PicoVerse",
+    "PicoVerse USB Push",
+    NULL,               // serial: Pico unique board ID
+    "Push and run"
+};
+
+static uint16_t usb_push_string_buf[USB_PUSH_STRING_MAX + 1];
+static usb_push_parser_t usb_push_parser;
+static uint8_t usb_push_rx[CFG_TUD_VENDOR_RX_BUFSIZE];
+static bool usb_push_started = false;
+
+uint8_t const *tud_descriptor_device_cb(void)
+{
+    return (uint8_t const *)&usb_push_device_desc;
+}
+
+uint8_t const *tud_descriptor_configuration_cb(uint8_t index)
+{
+    (void)index;
+    return usb_push_config_desc;
+}
+
+uint16_t const *tud_descriptor_string_cb(uint8_t index, uint16_t langid)
+{
+    (void)langid;
+    uint8_t count;
+
+    if (index == 0) {
+        usb_push_string_buf[1] = 0x0409;
+        count = 1;
+    } else {
+        char serial[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+        const char *str;
+        if (index > sizeof(usb_push_strings) / sizeof(usb_push_strings[0]))
+            return NULL;
+        str = usb_push_strings[index - 1];
+        if (str == NULL) {
+            pico_get_unique_board_id_string(serial, sizeof(serial));
+            str = serial;
+        }
+        count = (uint8_t)strlen(str);
+        if (count > USB_PUSH_STRING_MAX) count = USB_PUSH_STRING_MAX;
+        for (uint8_t i = 0; i < count; i++)
+            usb_push_string_buf[1 + i] = (uint8_t)str[i];
+    }
+    usb_push_string_buf[0] = (uint16_t)((TUSB_DESC_STRING << 8) | (2 * count + 2));
+    return usb_push_string_buf;
+}
+
+void usb_push_dev_start(void)
+{
+    usb_push_parser_init(&usb_push_parser);
+    if (!usb_push_started) {
+        tud_init(BOARD_TUD_RHPORT);
+        usb_push_started = true;
+        printf("USBPUSH: device up %04X:%04X\n", USB_PUSH_VID, USB_PUSH_PID);
+        return;
+    }
+    irq_set_enabled(USBCTRL_IRQ, true);
+    tud_connect();
+}
+
+void usb_push_dev_stop(void)
+{
+    if (!usb_push_started) return;
+    tud_disconnect();
+    irq_set_enabled(USBCTRL_IRQ, false);
+}
+
+void usb_push_dev_task(const usb_push_sink_t *sink)
+{
+    tud_task();
+    if (!tud_vendor_mounted()) return;
+
+    // Leave bytes in the endpoint FIFO while a reply could not be queued;
+    // the host then sees NAKs instead of lost replies.
+    uint32_t avail = tud_vendor_available();
+    if (avail == 0 || tud_vendor_write_available() < USB_PUSH_HEADER_SIZE) return;
+    if (avail > sizeof(usb_push_rx)) avail = sizeof(usb_push_rx);
+    uint32_t len = tud_vendor_read(usb_push_rx, avail);
+
+    uint32_t pos = 0;
+    while (pos < len) {
+        uint8_t reply[USB_PUSH_HEADER_SIZE];
+        bool reply_ready;
+        pos += usb_push_feed(&usb_push_parser, sink, &usb_push_rx[pos], len - pos, reply, &reply_ready);
+        if (reply_ready) {
+            tud_vendor_write(reply, USB_PUSH_HEADER_SIZE);
+            tud_vendor_write_flush();
+        }
+    }
+}
@@ -0,0 +1,30 @@
+// MSX PICOVERSE PROJECT
+// (c) 2026 Cristiano Goncalves
+// The Retro Hacker
+//
+// usb_push_dev.h - USB device personality for the "push and run" link
+//
+// Built only with EXPLORER_USB_PUSH. The USB port then runs in device mode
+// with a single vendor bulk interface (EP 0x01 OUT, EP 0x81 IN) that speaks
+// the usb_push.h protocol. The device stack is polled from the menu's idle
+// branch on Core 0 and disconnected while a ROM runs, so it never interrupts
+// a mapper loop.
+//
+// This work is licensed under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+// License". https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+#ifndef USB_PUSH_DEV_H
+#define USB_PUSH_DEV_H
+
+#include "usb_push.h"
+
+// Bring the device up (first call) or reconnect it (after a stop).
+void usb_push_dev_start(void);
+
+// Disconnect from the host and mask the USB interrupt before a launch.
+void usb_push_dev_stop(void);
+
+// Run the device stack and feed any received bytes to the protocol parser.
+void usb_push_dev_task(const usb_push_sink_t *sink);
+
+#endif // USB_PUSH_DEV_H
@@ -28,7 +28,8 @@
 #include "esp8266p_rom.h"
 #include "fmpac_bios.h"
 #include "sfg_bios.h"
-#include "mapper_detect.h"
+#include "yrw801_rom.h"
+#include "../../../../../common/mapper_detect.h"
 
 #ifndef APP_VERSION
 #define APP_VERSION "v1.00"
@@ -42,8 +43,10 @@
 #define WIFI_BIOS_ROM_SIZE      (16 * 1024)     // Hidden ESP8266P UNAPI BIOS payload used by Sunrise WiFi support
 #define FMPAC_BIOS_ROM_SIZE     (64 * 1024)     // Hidden FM-PAC BIOS payload used by Explorer MSX-MUSIC support
 #define SFG_BIOS_ROM_SIZE       (64 * 1024)     // Hidden Yamaha SFG ROM payload used by Explorer YM2151/SFG support
+#define OPL4_WAVE_ROM_SIZE      (2 * 1024 * 1024) // Hidden YRW801-M wave ROM used by the Explorer MoonSound profile
 #define MAX_FILE_NAME_LENGTH    71              // Maximum length of a ROM name on the 80-column detail screen
 #define FLASH_START             0x10000000      // Start of the flash memory on the Raspberry Pi Pico
+#define FLASH_SIZE              (16U * 1024U * 1024U) // Flash fitted on the PicoVerse 2350 board
 #define MAX_ROM_FILES           128             // Maximum number of ROM files
 #define MAX_TOTAL_ROM_SIZE      (12U * 1024U * 1024U) // Cap combined visible ROM payload to 12 MB
 #define MAX_ROM_SIZE            15*1024*1024    // Maximum size of a ROM file
@@ -151,7 +154,7 @@ const char* mapper_description(int number) {
 }
 
 // Attempt to guess the mapper type from the ROM contents using the shared
-// SHA1 + heuristic detector (mapper_detect.h). Loads the full file into RAM
+// SHA1 + heuristic detector (common/mapper_detect.h). Loads the full file into RAM
 // so the openMSX softwaredb hash matches the canonical algorithm.
 // Returns the mapper byte expected by the firmware (0 signals unsupported/unknown).
 uint8_t detect_rom_type(const char *filename, uint32_t size) {
@@ -399,7 +402,7 @@ int main(int argc, char *argv[])
     FileInfo files[MAX_ROM_FILES]; // Array to track discovered ROM files
     int file_count = 0;
     int file_index = 1;
-    uint32_t base_offset = TARGET_FILE_SIZE + WIFI_CONFIG_ROM_SIZE + WIFI_BIOS_ROM_SIZE + FMPAC_BIOS_ROM_SIZE + SFG_BIOS_ROM_SIZE; // Visible ROMs start after hidden payloads
+    uint32_t base_offset = TARGET_FILE_SIZE + WIFI_CONFIG_ROM_SIZE + WIFI_BIOS_ROM_SIZE + FMPAC_BIOS_ROM_SIZE + SFG_BIOS_ROM_SIZE + OPL4_WAVE_ROM_SIZE; // Visible ROMs start after hidden payloads
     size_t total_rom_size = 0;
     size_t config_offset = 0;
     uint8_t *config_buffer = (uint8_t *)malloc(CONFIG_AREA_SIZE); // Configuration area buffer
@@ -688,8 +691,25 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    // Final flash image layout: [firmware][menu ROM][config area][WiFi config ROM][ESP8266P BIOS][FM-PAC BIOS][SFG BIOS][Nextor ROM + scanned ROM payloads]
-    const size_t total_size = firmware_size + MENU_COPY_SIZE + CONFIG_AREA_SIZE + WIFI_CONFIG_ROM_SIZE + WIFI_BIOS_ROM_SIZE + FMPAC_BIOS_ROM_SIZE + SFG_BIOS_ROM_SIZE + total_rom_size;
+    const size_t opl4_wave_rom_size = sizeof(______loadrom_pio_resources_YRW801_M___Yamaha___1993_rom);
+    if (opl4_wave_rom_size != OPL4_WAVE_ROM_SIZE) {
+        printf("Embedded YRW801-M wave ROM must be %u bytes (found %zu)\n",
+               (unsigned)OPL4_WAVE_ROM_SIZE, opl4_wave_rom_size);
+        free(config_buffer);
+        return 1;
+    }
+
+    // Final flash image layout: [firmware][menu ROM][config area][WiFi config ROM][ESP8266P BIOS][FM-PAC BIOS][SFG BIOS][YRW801-M][Nextor ROM + scanned ROM payloads]
+    const size_t total_size = firmware_size + MENU_COPY_SIZE + CONFIG_AREA_SIZE + WIFI_CONFIG_ROM_SIZE + WIFI_BIOS_ROM_SIZE + FMPAC_BIOS_ROM_SIZE + SFG_BIOS_ROM_SIZE + OPL4_WAVE_ROM_SIZE + total_rom_size;
+    // The ROM cap leaves room for the firmware and the smaller payloads, but
+    // not for the 2MB wave ROM on top of a full 12MB of ROMs.
+    if (total_size > FLASH_SIZE) {
+        printf("Flash image is %zu bytes, %zu over the %u bytes of flash. Remove %zu KB of ROMs.\n",
+               total_size, total_size - FLASH_SIZE, (unsigned)FLASH_SIZE,
+               (total_size - FLASH_SIZE + 1023) / 1024);
+        free(config_buffer);
+        return 1;
+    }
     uint8_t *combined_buffer = (uint8_t *)malloc(total_size);
     if (!combined_buffer) {
         printf("Failed to allocate combined buffer\n");
@@ -727,6 +747,10 @@ int main(int argc, char *argv[])
     memcpy(combined_buffer + offset, ___resources_SFG_64K_ROM, sfg_bios_rom_size);
     offset += SFG_BIOS_ROM_SIZE;
 
+    // Hidden YRW801-M wave ROM read by the OPL4 wave part of the MoonSound profile.
+    memcpy(combined_buffer + offset, ______loadrom_pio_resources_YRW801_M___Yamaha___1993_rom, opl4_wave_rom_size);
+    offset += OPL4_WAVE_ROM_SIZE;
+
 #ifdef DEBUG
     {
         const char *rom_dump_filename = "explorer.rom";
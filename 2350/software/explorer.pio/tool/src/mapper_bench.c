@@ -0,0 +1,443 @@
+// MSX PICOVERSE PROJECT
+// (c) 2026 Cristiano Goncalves
+// The Retro Hacker
+//
+// mapper_bench.c - Linux console benchmark for the shared mapper detector (mapper_detect.h)
+//
+// Runs the detector over a local corpus of ROM images described by a manifest and reports how often the
+// top candidate (and any ranked candidate) matches the expected mapper, broken down by mapper and by the
+// rule that produced the answer, plus detection throughput. The images themselves are not part of the
+// repository; the manifest pins each one by SHA-1 so results are comparable between runs.
+//
+// Manifest format, one image per line ('#' starts a comment):
+//     <sha1 hex> <mapper> <path>
+// <mapper> is a mapper number (1..14) or a tag from MAPPER_DESCRIPTIONS (e.g. ASC-08). Relative paths are
+// taken from the manifest's directory. `--emit` writes such lines for ROM files found in the openMSX
+// database, which makes a labelled corpus that `--no-romdb` can then score the heuristics against.
+//
+// `--self-test` replays built-in bank-write traces through the runtime inference the firmware uses for
+// MAPPER_AUTO launches (mapper_auto.h) and fails unless each one locks onto the mapper it was written for.
+//
+// This work is licensed  under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+// License". https://creativecommons.org/licenses/by-nc-sa/4.0/
+//
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <time.h>
+#include "../../../../../common/mapper_detect.h"
+#include "../../../../../common/mapper_auto.h"
+
+#define MAPPER_SLOTS        16
+#define MAX_LINE_LENGTH     1024
+#define BENCH_DEFAULT_RUNS  1
+
+static const char *MAPPER_DESCRIPTIONS[] = {
+    "PLA-16", "PLA-32", "KonSCC", "PLN-48", "ASC-08",
+    "ASC-16", "Konami", "NEO-8", "NEO-16", "SYSTEM",
+    "SYSTEM", "ASC16X", "PLN-64", "MANBW2"
+};
+
+#define MAPPER_DESCRIPTION_COUNT (sizeof(MAPPER_DESCRIPTIONS) / sizeof(MAPPER_DESCRIPTIONS[0]))
+
+static const char *SOURCE_NAMES[] = { "none", "romdb", "header", "heuristic", "fallback" };
+
+typedef struct {
+    uint32_t images;
+    uint32_t top1;
+    uint32_t ranked;        // expected mapper anywhere in the candidate list
+    uint32_t unknown;       // detector returned no candidate
+} bench_tally_t;
+
+typedef struct {
+    bench_tally_t total;
+    bench_tally_t by_mapper[MAPPER_SLOTS];
+    bench_tally_t by_source[5];
+    uint32_t confusion[MAPPER_SLOTS][MAPPER_SLOTS]; // [expected][detected]
+    uint32_t confident_wrong;                      // wrong answers above MAPPER_DETECT_CONFIDENT
+    uint32_t hash_mismatch;
+    uint32_t missing;
+    uint64_t bytes;
+    double seconds;
+} bench_stats_t;
+
+static const char *mapper_name(uint8_t mapper) {
+    if (mapper == 0 || mapper > MAPPER_DESCRIPTION_COUNT) return "unknown";
+    return MAPPER_DESCRIPTIONS[mapper - 1];
+}
+
+static bool equals_ignore_case(const char *a, const char *b) {
+    while (*a && *b) {
+        if (tolower((unsigned char)*a) != tolower((unsigned char)*b)) return false;
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+static int parse_mapper(const char *text) {
+    char *end = NULL;
+    long value = strtol(text, &end, 10);
+    if (end != text && *end == '\0') {
+        return (value > 0 && value < MAPPER_SLOTS) ? (int)value : -1;
+    }
+    for (size_t i = 0; i < MAPPER_DESCRIPTION_COUNT; ++i) {
+        if (equals_ignore_case(text, MAPPER_DESCRIPTIONS[i])) return (int)(i + 1);
+    }
+    return -1;
+}
+
+static bool parse_sha1(const char *text, uint8_t out[20]) {
+    if (strlen(text) != 40) return false;
+    for (int i = 0; i < 20; ++i) {
+        unsigned int byte;
+        if (sscanf(text + i * 2, "%2x", &byte) != 1) return false;
+        out[i] = (uint8_t)byte;
+    }
+    return true;
+}
+
+static void print_sha1(FILE *out, const uint8_t sha1[20]) {
+    for (int i = 0; i < 20; ++i) fprintf(out, "%02x", sha1[i]);
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Load a whole file into memory. Returns NULL on failure.
+static uint8_t *load_file(const char *path, uint32_t *size_out) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size <= 0 || (unsigned long)size > MAPPER_DETECT_MAX_ROM_SIZE) {
+        fclose(file);
+        return NULL;
+    }
+    uint8_t *data = (uint8_t *)malloc((size_t)size);
+    if (data && fread(data, 1, (size_t)size, file) != (size_t)size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    *size_out = (uint32_t)size;
+    return data;
+}
+
+static void tally(bench_tally_t *t, bool top1, bool ranked, bool unknown) {
+    t->images++;
+    if (top1) t->top1++;
+    if (ranked) t->ranked++;
+    if (unknown) t->unknown++;
+}
+
+static void print_tally(const char *label, const bench_tally_t *t) {
+    if (!t->images) return;
+    printf("  %-10s %6u images  top-1 %6.2f%%  ranked %6.2f%%  unknown %u\n", label, t->images,
+           100.0 * t->top1 / t->images, 100.0 * t->ranked / t->images, t->unknown);
+}
+
+static void bench_image(bench_stats_t *st, const char *path, const uint8_t expect_sha1[20],
+                        uint8_t expected, uint8_t flags, int runs, bool verbose) {
+    uint32_t size = 0;
+    uint8_t *rom = load_file(path, &size);
+    if (!rom) {
+        printf("missing  %s\n", path);
+        st->missing++;
+        return;
+    }
+
+    mapper_detect_result_t result;
+    double start = now_seconds();
+    for (int r = 0; r < runs; ++r) {
+        mapper_detect_buffer_ranked(rom, size, flags, &result);
+    }
+    st->seconds += now_seconds() - start;
+    st->bytes += (uint64_t)size * (uint64_t)runs;
+    free(rom);
+
+    if (!result.have_sha1 || memcmp(result.sha1, expect_sha1, 20) != 0) {
+        printf("hash     %s (manifest and file differ, not scored)\n", path);
+        st->hash_mismatch++;
+        return;
+    }
+
+    uint8_t detected = result.count ? result.cand[0].mapper : 0u;
+    bool top1 = (detected == expected);
+    bool ranked = false;
+    for (uint8_t i = 0; i < result.count; ++i) {
+        if (result.cand[i].mapper == expected) ranked = true;
+    }
+    bool unknown = (result.count == 0u);
+
+    tally(&st->total, top1, ranked, unknown);
+    tally(&st->by_mapper[expected], top1, ranked, unknown);
+    tally(&st->by_source[result.source], top1, ranked, unknown);
+    st->confusion[expected][detected < MAPPER_SLOTS ? detected : 0]++;
+    if (!top1 && detected && result.cand[0].confidence >= MAPPER_DETECT_CONFIDENT) st->confident_wrong++;
+
+    if (verbose || !top1) {
+        printf("%s %s expected %s got %s (%s", top1 ? "ok      " : "MISS    ", path,
+               mapper_name(expected), mapper_name(detected), SOURCE_NAMES[result.source]);
+        for (uint8_t i = 0; i < result.count; ++i) {
+            printf("%s%s:%u", i ? " " : ", ", mapper_name(result.cand[i].mapper), result.cand[i].confidence);
+        }
+        printf(")\n");
+    }
+}
+
+static void print_report(const bench_stats_t *st, uint8_t flags, int runs) {
+    printf("\nMapper detection benchmark%s\n", (flags & MAPPER_DETECT_NO_ROMDB) ? " (database disabled)" : "");
+    print_tally("all", &st->total);
+    printf("  confident but wrong: %u, hash mismatches: %u, missing files: %u\n",
+           st->confident_wrong, st->hash_mismatch, st->missing);
+
+    printf("\nBy expected mapper:\n");
+    for (int m = 1; m < MAPPER_SLOTS; ++m) print_tally(mapper_name((uint8_t)m), &st->by_mapper[m]);
+
+    printf("\nBy detection source:\n");
+    for (int s = 0; s < 5; ++s) print_tally(SOURCE_NAMES[s], &st->by_source[s]);
+
+    printf("\nConfusion (expected -> detected, misses only):\n");
+    for (int e = 1; e < MAPPER_SLOTS; ++e) {
+        for (int d = 0; d < MAPPER_SLOTS; ++d) {
+            if (d != e && st->confusion[e][d]) {
+                printf("  %-8s -> %-8s %u\n", mapper_name((uint8_t)e), mapper_name((uint8_t)d), st->confusion[e][d]);
+            }
+        }
+    }
+
+    if (st->seconds > 0.0) {
+        printf("\nThroughput: %.1f MB/s, %.1f images/s (%d run%s per image)\n",
+               (double)st->bytes / (1024.0 * 1024.0) / st->seconds,
+               (double)st->total.images * runs / st->seconds, runs, runs == 1 ? "" : "s");
+    }
+}
+
+static int run_manifest(const char *manifest, uint8_t flags, int runs, bool verbose) {
+    FILE *file = fopen(manifest, "r");
+    if (!file) {
+        printf("Failed to open manifest %s\n", manifest);
+        return 1;
+    }
+
+    char base[MAX_LINE_LENGTH] = "";
+    const char *slash = strrchr(manifest, '/');
+    if (slash) {
+        size_t len = (size_t)(slash - manifest) + 1;
+        if (len < sizeof(base)) {
+            memcpy(base, manifest, len);
+            base[len] = '\0';
+        }
+    }
+
+    static bench_stats_t st;
+    memset(&st, 0, sizeof(st));
+    char line[MAX_LINE_LENGTH];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), file)) {
+        line_no++;
+        char *hash = strtok(line, " \t\r\n");
+        if (!hash || hash[0] == '#') continue;
+        char *mapper_text = strtok(NULL, " \t\r\n");
+        char *path = strtok(NULL, "\r\n");
+        while (path && isspace((unsigned char)*path)) path++;
+
+        uint8_t sha1[20];
+        int mapper = mapper_text ? parse_mapper(mapper_text) : -1;
+        if (!parse_sha1(hash, sha1) || mapper < 0 || !path || !*path) {
+            printf("%s:%d: malformed manifest line\n", manifest, line_no);
+            continue;
+        }
+
+        char full[2 * MAX_LINE_LENGTH];
+        if (path[0] == '/') snprintf(full, sizeof(full), "%s", path);
+        else snprintf(full, sizeof(full), "%s%s", base, path);
+        bench_image(&st, full, sha1, (uint8_t)mapper, flags, runs, verbose);
+    }
+    fclose(file);
+
+    print_report(&st, flags, runs);
+    return 0;
+}
+
+// Print manifest lines for files whose SHA-1 is in the openMSX database.
+static int emit_manifest(int count, char **paths) {
+    for (int i = 0; i < count; ++i) {
+        uint32_t size = 0;
+        uint8_t *rom = load_file(paths[i], &size);
+        if (!rom) {
+            fprintf(stderr, "skip %s (unreadable)\n", paths[i]);
+            continue;
+        }
+        mapper_detect_result_t result;
+        mapper_detect_buffer_ranked(rom, size, 0u, &result);
+        free(rom);
+        if (result.source != MAPPER_DETECT_SRC_ROMDB) {
+            fprintf(stderr, "skip %s (not in database)\n", paths[i]);
+            continue;
+        }
+        print_sha1(stdout, result.sha1);
+        printf(" %s %s\n", mapper_name(result.cand[0].mapper), paths[i]);
+    }
+    return 0;
+}
+
+// One bank write from a game trace: the last ROM address the Z80 read (its code location) and the write.
+typedef struct {
+    uint16_t pc;
+    uint16_t addr;
+    uint8_t data;
+} trace_write_t;
+
+// A trace is a start-up sequence followed by a gameplay loop that repeats until the inference locks.
+typedef struct {
+    const char *name;
+    uint8_t expected;
+    uint32_t image_size;
+    const trace_write_t *init;
+    size_t init_count;
+    const trace_write_t *loop;
+    size_t loop_count;
+} trace_case_t;
+
+#define TRACE_LOOP_LIMIT 64
+#define TRACE(a) (a), (sizeof(a) / sizeof((a)[0]))
+
+// ASCII16: code in bank 0 at 4000h switches 8000h-BFFFh through 7000h and 77FFh, and 4000h-7FFFh from page 2.
+static const trace_write_t ascii16_init[] = {
+    { 0x4010, 0x6000, 0 }, { 0x4014, 0x7000, 1 },
+};
+static const trace_write_t ascii16_loop[] = {
+    { 0x5230, 0x7000, 2 }, { 0x5230, 0x7000, 3 }, { 0x5310, 0x77FF, 5 }, { 0x8120, 0x6000, 4 },
+    { 0x4020, 0x7000, 7 }, { 0x8120, 0x6000, 0 }, { 0x5310, 0x77FF, 9 }, { 0x5230, 0x7000, 1 },
+};
+
+// ASCII16 using the base register addresses only.
+static const trace_write_t ascii16_base_loop[] = {
+    { 0x5230, 0x7000, 2 }, { 0x8120, 0x6000, 3 }, { 0x5230, 0x7000, 6 }, { 0x8120, 0x6000, 0 },
+};
+
+// ASCII8: all four registers set at start-up, then pages 8000h-BFFFh switched from code at 4000h.
+static const trace_write_t ascii8_init[] = {
+    { 0x4010, 0x6000, 0 }, { 0x4014, 0x6800, 1 }, { 0x4018, 0x7000, 2 }, { 0x401C, 0x7800, 3 },
+};
+static const trace_write_t ascii8_loop[] = {
+    { 0x4300, 0x7000, 4 }, { 0x4300, 0x7800, 5 }, { 0x4310, 0x6800, 6 }, { 0x4300, 0x7000, 8 },
+    { 0x4300, 0x7800, 9 }, { 0x4310, 0x6800, 1 },
+};
+
+// ASCII8 whose start-up writes only the registers ASCII16 shares before the other two.
+static const trace_write_t ascii8_late_init[] = {
+    { 0x4010, 0x6000, 0 }, { 0x4014, 0x7000, 2 }, { 0x4018, 0x6800, 1 }, { 0x401C, 0x7800, 3 },
+};
+
+// Konami SCC: bank registers at 5000h/7000h/9000h/B000h, sound enabled with 3Fh in 9000h.
+static const trace_write_t konami_scc_init[] = {
+    { 0x4010, 0x5000, 0 }, { 0x4014, 0x7000, 1 }, { 0x4018, 0x9000, 0x3F }, { 0x401C, 0xB000, 3 },
+};
+static const trace_write_t konami_scc_loop[] = {
+    { 0x4200, 0x7000, 4 }, { 0x4200, 0x9000, 5 }, { 0x4210, 0xB000, 6 }, { 0x4200, 0x7000, 7 },
+    { 0x4200, 0x9000, 0x3F }, { 0x4210, 0xB000, 2 },
+};
+
+// Konami without SCC: bank registers at 6000h/8000h/A000h, 4000h fixed.
+static const trace_write_t konami_init[] = {
+    { 0x4010, 0x6000, 1 }, { 0x4014, 0x8000, 2 }, { 0x4018, 0xA000, 3 },
+};
+static const trace_write_t konami_loop[] = {
+    { 0x4200, 0x8000, 4 }, { 0x4200, 0xA000, 5 }, { 0x4210, 0x6000, 6 }, { 0x4200, 0x8000, 7 },
+    { 0x4200, 0xA000, 8 }, { 0x4210, 0x6000, 1 },
+};
+
+static const trace_case_t trace_cases[] = {
+    { "ASCII16",               MAPPER_DETECT_ASCII16,    256u * 1024u, TRACE(ascii16_init),    TRACE(ascii16_loop) },
+    { "ASCII16 base regs",     MAPPER_DETECT_ASCII16,    256u * 1024u, TRACE(ascii16_init),    TRACE(ascii16_base_loop) },
+    { "ASCII8",                MAPPER_DETECT_ASCII8,     128u * 1024u, TRACE(ascii8_init),     TRACE(ascii8_loop) },
+    { "ASCII8 late 6800h",     MAPPER_DETECT_ASCII8,     128u * 1024u, TRACE(ascii8_late_init), TRACE(ascii8_loop) },
+    { "Konami SCC",            MAPPER_DETECT_KONAMI_SCC, 128u * 1024u, TRACE(konami_scc_init), TRACE(konami_scc_loop) },
+    { "Konami",                MAPPER_DETECT_KONAMI,     128u * 1024u, TRACE(konami_init),     TRACE(konami_loop) },
+};
+
+static void trace_feed(mapper_auto_ctx_t *a, const trace_write_t *w, size_t count) {
+    for (size_t i = 0; i < count && !a->locked; ++i) {
+        a->last_read = w[i].pc;
+        mapper_auto_write(a, w[i].addr, w[i].data);
+    }
+}
+
+// Replay the write traces through the MAPPER_AUTO inference. Returns the number of failures.
+static int run_self_test(void) {
+    int failures = 0;
+    for (size_t t = 0; t < sizeof(trace_cases) / sizeof(trace_cases[0]); ++t) {
+        const trace_case_t *tc = &trace_cases[t];
+        mapper_auto_ctx_t a;
+        mapper_auto_init(&a, tc->image_size);
+        trace_feed(&a, tc->init, tc->init_count);
+        for (int r = 0; r < TRACE_LOOP_LIMIT && !a.locked; ++r) trace_feed(&a, tc->loop, tc->loop_count);
+
+        uint8_t got = a.cand[a.active].mapper;
+        bool ok = a.locked && got == tc->expected;
+        if (!ok) failures++;
+        printf("%s %-20s expected %s got %s (%s after %u writes)\n", ok ? "ok      " : "FAIL    ", tc->name,
+               mapper_name(tc->expected), mapper_name(got), a.locked ? "locked" : "not locked", a.writes);
+    }
+    printf("\nMapper inference self-test: %d failure%s\n", failures, failures == 1 ? "" : "s");
+    return failures;
+}
+
+static void print_usage(const char *prog_name) {
+    printf("Usage: %s [-n] [-v] [-r <runs>] <manifest>\n", prog_name);
+    printf("       %s --emit <romfile>...\n", prog_name);
+    printf("       %s --self-test\n", prog_name);
+    printf("Options:\n");
+    printf("  -n, --no-romdb   Skip the SHA-1 database and score the header/heuristic rules only\n");
+    printf("  -v, --verbose    List every image, not only the misses\n");
+    printf("  -r, --runs <n>   Detect each image n times for steadier throughput numbers\n");
+    printf("  --emit           Print manifest lines for ROM files found in the database\n");
+    printf("  --self-test      Check the runtime mapper inference against built-in write traces\n");
+}
+
+int main(int argc, char *argv[]) {
+    uint8_t flags = 0;
+    bool verbose = false;
+    int runs = BENCH_DEFAULT_RUNS;
+    const char *manifest = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--emit") == 0) {
+            return emit_manifest(argc - i - 1, argv + i + 1);
+        } else if (strcmp(argv[i], "--self-test") == 0) {
+            return run_self_test() ? 1 : 0;
+        } else if (strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--no-romdb") == 0) {
+            flags |= MAPPER_DETECT_NO_ROMDB;
+        } else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+        } else if ((strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--runs") == 0) && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+            if (runs < 1) runs = 1;
+        } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (!manifest) {
+            manifest = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!manifest) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    return run_manifest(manifest, flags, runs, verbose);
+}
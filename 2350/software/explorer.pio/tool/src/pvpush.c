@@ -0,0 +1,578 @@
+// MSX PICOVERSE PROJECT
+// (c) 2026 Cristiano Goncalves
+// The Retro Hacker
+//
+// pvpush.c - Linux console tool for the Explorer USB "push and run" link (usb_push.h)
+//
+// Uploads a ROM image straight into the Explorer's PSRAM over USB and resets the MSX into it, so a
+// development build can be tried without touching the flash image or the microSD card. The firmware
+// must be built with EXPLORER_USB_PUSH and be showing the menu. The device is opened through usbfs
+// (/dev/bus/usb), so no library is needed; the user needs write access to the device node (a udev
+// rule for 2E8A:00E2, or root).
+//
+// `--loopback` runs the same session against the firmware's protocol parser compiled into this tool,
+// with a stub sink standing in for PSRAM, and then replays the error cases (bad CRC, out-of-order
+// data, lost framing, oversized image). It needs no hardware and exits non-zero on any mismatch.
+//
+// This work is licensed  under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+// License". https://creativecommons.org/licenses/by-nc-sa/4.0/
+//
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/ioctl.h>
+#include <linux/usbdevice_fs.h>
+#include "../../../../../common/mapper_detect.h"
+#include "usb_push.h"
+
+#define PUSH_EP_OUT         0x01
+#define PUSH_EP_IN          0x81
+#define PUSH_INTERFACE      0
+#define PUSH_TIMEOUT_MS     5000
+#define PUSH_WINDOW         4       // DATA frames in flight before waiting for a reply
+#define PUSH_MAX_ROM_SIZE   (8u * 1024u * 1024u)
+#define LOOPBACK_CAPACITY   (4u * 1024u * 1024u)
+#define LOOPBACK_PACKET     64u     // full-speed bulk packet size
+#define LOOPBACK_REPLIES    8u
+#define MAPPER_AUTO         22
+
+static const char *MAPPER_DESCRIPTIONS[] = {
+    "PLA-16", "PLA-32", "KonSCC", "PLN-48", "ASC-08",
+    "ASC-16", "Konami", "NEO-8", "NEO-16", "SYSTEM",
+    "SYSTEM", "ASC16X", "PLN-64", "MANBW2"
+};
+
+#define MAPPER_DESCRIPTION_COUNT (sizeof(MAPPER_DESCRIPTIONS) / sizeof(MAPPER_DESCRIPTIONS[0]))
+
+static const char *STATUS_NAMES[] = {
+    "ok", "bad frame", "bad state", "too large", "bad offset", "bad CRC", "bad option", "short image"
+};
+
+// Byte transport under the protocol: the usbfs device or the loopback stub.
+typedef struct push_link push_link_t;
+struct push_link {
+    bool (*send)(push_link_t *link, const uint8_t *data, uint32_t len);
+    bool (*recv)(push_link_t *link, uint8_t reply[USB_PUSH_HEADER_SIZE]);
+};
+
+typedef struct {
+    push_link_t link;
+    int fd;
+} usb_link_t;
+
+typedef struct {
+    push_link_t link;
+    usb_push_parser_t parser;
+    usb_push_sink_t sink;
+    uint8_t *memory;
+    uint32_t image_size;
+    bool ran;
+    uint8_t replies[LOOPBACK_REPLIES][USB_PUSH_HEADER_SIZE];
+    uint32_t reply_head;
+    uint32_t reply_count;
+} loopback_link_t;
+
+static const char *status_name(uint8_t status) {
+    if (status < sizeof(STATUS_NAMES) / sizeof(STATUS_NAMES[0])) return STATUS_NAMES[status];
+    return "unknown";
+}
+
+static bool equals_ignore_case(const char *a, const char *b) {
+    while (*a && *b) {
+        if (tolower((unsigned char)*a) != tolower((unsigned char)*b)) return false;
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+static int parse_mapper(const char *text) {
+    char *end = NULL;
+    long value = strtol(text, &end, 10);
+    if (end != text && *end == '\0') {
+        return (value > 0 && (value <= (long)MAPPER_DESCRIPTION_COUNT || value == MAPPER_AUTO)) ? (int)value : -1;
+    }
+    if (equals_ignore_case(text, "AUTO")) return MAPPER_AUTO;
+    for (size_t i = 0; i < MAPPER_DESCRIPTION_COUNT; ++i) {
+        if (equals_ignore_case(text, MAPPER_DESCRIPTIONS[i])) return (int)(i + 1);
+    }
+    return -1;
+}
+
+static const char *mapper_name(uint8_t mapper) {
+    if (mapper == MAPPER_AUTO) return "AUTO";
+    if (mapper == 0 || mapper > MAPPER_DESCRIPTION_COUNT) return "unknown";
+    return MAPPER_DESCRIPTIONS[mapper - 1];
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Load a whole file into memory. Returns NULL on failure.
+static uint8_t *load_file(const char *path, uint32_t *size_out) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size <= 0 || (unsigned long)size > PUSH_MAX_ROM_SIZE) {
+        fclose(file);
+        return NULL;
+    }
+    uint8_t *data = (uint8_t *)malloc((size_t)size);
+    if (data && fread(data, 1, (size_t)size, file) != (size_t)size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    *size_out = (uint32_t)size;
+    return data;
+}
+
+// --- Protocol client ---
+
+static bool push_send_frame(push_link_t *link, uint8_t cmd, uint16_t seq, uint32_t arg,
+                            const void *payload, uint32_t len) {
+    static uint8_t frame[USB_PUSH_HEADER_SIZE + USB_PUSH_MAX_DATA];
+    usb_push_header_t h = { cmd, 0, seq, arg, len };
+    usb_push_encode_header(frame, &h);
+    if (len) memcpy(&frame[USB_PUSH_HEADER_SIZE], payload, len);
+    return link->send(link, frame, USB_PUSH_HEADER_SIZE + len);
+}
+
+// Wait for the reply to (cmd, seq). Returns the reply status, or -1 when the
+// link failed or the reply does not belong to the request.
+static int push_wait_reply(push_link_t *link, uint8_t cmd, uint16_t seq, uint32_t *arg_out) {
+    uint8_t raw[USB_PUSH_HEADER_SIZE];
+    usb_push_header_t r;
+    if (!link->recv(link, raw) || !usb_push_decode_header(raw, &r)) return -1;
+    if (r.status == USB_PUSH_STATUS_BAD_FRAME && r.cmd == USB_PUSH_REPLY) return r.status;
+    if (r.cmd != (uint8_t)(cmd | USB_PUSH_REPLY) || r.seq != seq) return -1;
+    if (arg_out) *arg_out = r.arg;
+    return r.status;
+}
+
+static int push_transact(push_link_t *link, uint8_t cmd, uint16_t *seq, uint32_t arg,
+                         const void *payload, uint32_t len, uint32_t *arg_out) {
+    uint16_t s = (*seq)++;
+    if (!push_send_frame(link, cmd, s, arg, payload, len)) return -1;
+    return push_wait_reply(link, cmd, s, arg_out);
+}
+
+static bool push_check(const char *step, int status) {
+    if (status == USB_PUSH_STATUS_OK) return true;
+    if (status < 0) fprintf(stderr, "%s: no valid reply from the device\n", step);
+    else fprintf(stderr, "%s: device answered %s\n", step, status_name((uint8_t)status));
+    return false;
+}
+
+// Upload an image and optionally launch it. Returns true on success.
+static bool push_session(push_link_t *link, const uint8_t *rom, uint32_t size,
+                         const usb_push_begin_t *opts, bool run, bool verbose) {
+    uint16_t seq = 1;
+    uint32_t capacity = 0;
+    double start = now_seconds();
+
+    if (!push_check("hello", push_transact(link, USB_PUSH_CMD_HELLO, &seq, USB_PUSH_VERSION, NULL, 0, &capacity)))
+        return false;
+    if (size > capacity) {
+        fprintf(stderr, "image is %u bytes, the device takes at most %u\n", size, capacity);
+        return false;
+    }
+    if (!push_check("begin", push_transact(link, USB_PUSH_CMD_BEGIN, &seq, size, opts, USB_PUSH_BEGIN_SIZE, NULL)))
+        return false;
+
+    // Keep PUSH_WINDOW frames queued so the bus never idles on a round trip.
+    uint32_t sent = 0;
+    uint32_t in_flight = 0;
+    uint16_t first_seq = seq;
+    while (sent < size || in_flight) {
+        if (sent < size && in_flight < PUSH_WINDOW) {
+            uint32_t chunk = size - sent;
+            if (chunk > USB_PUSH_MAX_DATA) chunk = USB_PUSH_MAX_DATA;
+            if (!push_send_frame(link, USB_PUSH_CMD_DATA, seq++, sent, rom + sent, chunk)) {
+                fprintf(stderr, "data: transfer failed at %u\n", sent);
+                return false;
+            }
+            sent += chunk;
+            in_flight++;
+            continue;
+        }
+        if (!push_check("data", push_wait_reply(link, USB_PUSH_CMD_DATA, first_seq++, NULL)))
+            return false;
+        in_flight--;
+    }
+
+    uint32_t device_crc = 0;
+    int status = push_transact(link, USB_PUSH_CMD_END, &seq, usb_push_crc32(rom, size), NULL, 0, &device_crc);
+    if (!push_check("end", status)) {
+        if (status == USB_PUSH_STATUS_BAD_CRC) fprintf(stderr, "device CRC %08x\n", device_crc);
+        return false;
+    }
+
+    double seconds = now_seconds() - start;
+    if (verbose) {
+        printf("pushed %u bytes in %.2f s (%.0f KB/s)\n", size, seconds,
+               seconds > 0.0 ? size / 1024.0 / seconds : 0.0);
+    }
+    if (run && !push_check("run", push_transact(link, USB_PUSH_CMD_RUN, &seq, 0, NULL, 0, NULL)))
+        return false;
+    return true;
+}
+
+// --- usbfs transport ---
+
+static bool usb_link_send(push_link_t *link, const uint8_t *data, uint32_t len) {
+    usb_link_t *u = (usb_link_t *)link;
+    struct usbdevfs_bulktransfer bulk = { PUSH_EP_OUT, len, PUSH_TIMEOUT_MS, (void *)data };
+    return ioctl(u->fd, USBDEVFS_BULK, &bulk) == (int)len;
+}
+
+static bool usb_link_recv(push_link_t *link, uint8_t reply[USB_PUSH_HEADER_SIZE]) {
+    usb_link_t *u = (usb_link_t *)link;
+    uint8_t packet[64];
+    struct usbdevfs_bulktransfer bulk = { PUSH_EP_IN, sizeof(packet), PUSH_TIMEOUT_MS, packet };
+    if (ioctl(u->fd, USBDEVFS_BULK, &bulk) < (int)USB_PUSH_HEADER_SIZE) return false;
+    memcpy(reply, packet, USB_PUSH_HEADER_SIZE);
+    return true;
+}
+
+static bool read_sysfs_hex(const char *dir, const char *name, unsigned int *value) {
+    char path[512];
+    snprintf(path, sizeof(path), "/sys/bus/usb/devices/%s/%s", dir, name);
+    FILE *file = fopen(path, "r");
+    if (!file) return false;
+    bool ok = fscanf(file, "%x", value) == 1;
+    fclose(file);
+    return ok;
+}
+
+static bool read_sysfs_dec(const char *dir, const char *name, unsigned int *value) {
+    char path[512];
+    snprintf(path, sizeof(path), "/sys/bus/usb/devices/%s/%s", dir, name);
+    FILE *file = fopen(path, "r");
+    if (!file) return false;
+    bool ok = fscanf(file, "%u", value) == 1;
+    fclose(file);
+    return ok;
+}
+
+// Find the first Explorer in push mode. Returns false if none is attached.
+static bool find_device(char *path, size_t path_size) {
+    DIR *dir = opendir("/sys/bus/usb/devices");
+    if (!dir) return false;
+    struct dirent *entry;
+    bool found = false;
+    while (!found && (entry = readdir(dir)) != NULL) {
+        unsigned int vid, pid, bus, dev;
+        if (entry->d_name[0] == '.' || strchr(entry->d_name, ':')) continue;
+        if (!read_sysfs_hex(entry->d_name, "idVendor", &vid) || !read_sysfs_hex(entry->d_name, "idProduct", &pid)) continue;
+        if (vid != USB_PUSH_VID || pid != USB_PUSH_PID) continue;
+        if (!read_sysfs_dec(entry->d_name, "busnum", &bus) || !read_sysfs_dec(entry->d_name, "devnum", &dev)) continue;
+        snprintf(path, path_size, "/dev/bus/usb/%03u/%03u", bus, dev);
+        found = true;
+    }
+    closedir(dir);
+    return found;
+}
+
+static bool usb_link_open(usb_link_t *u, const char *device) {
+    char path[64];
+    if (!device) {
+        if (!find_device(path, sizeof(path))) {
+            fprintf(stderr, "no Explorer in push mode found (%04X:%04X)\n", USB_PUSH_VID, USB_PUSH_PID);
+            return false;
+        }
+        device = path;
+    }
+    u->fd = open(device, O_RDWR);
+    if (u->fd < 0) {
+        fprintf(stderr, "%s: %s\n", device, strerror(errno));
+        return false;
+    }
+    unsigned int iface = PUSH_INTERFACE;
+    if (ioctl(u->fd, USBDEVFS_CLAIMINTERFACE, &iface) < 0) {
+        fprintf(stderr, "%s: cannot claim interface: %s\n", device, strerror(errno));
+        close(u->fd);
+        return false;
+    }
+    u->link.send = usb_link_send;
+    u->link.recv = usb_link_recv;
+    return true;
+}
+
+static void usb_link_close(usb_link_t *u) {
+    unsigned int iface = PUSH_INTERFACE;
+    ioctl(u->fd, USBDEVFS_RELEASEINTERFACE, &iface);
+    close(u->fd);
+}
+
+// --- Loopback transport: the firmware parser over a stub sink ---
+
+static uint8_t loopback_begin(void *user, uint32_t size, const usb_push_begin_t *opts) {
+    loopback_link_t *lb = (loopback_link_t *)user;
+    bool mapper_ok = (opts->mapper >= 1 && opts->mapper <= MAPPER_DESCRIPTION_COUNT &&
+                      opts->mapper != 10 && opts->mapper != 11) || opts->mapper == MAPPER_AUTO;
+    if (!mapper_ok || opts->vdp_freq > 2u) return USB_PUSH_STATUS_BAD_OPTION;
+    lb->image_size = size;
+    lb->ran = false;
+    memset(lb->memory, 0, LOOPBACK_CAPACITY);
+    return USB_PUSH_STATUS_OK;
+}
+
+static void loopback_write(void *user, uint32_t offset, const uint8_t *data, uint32_t len) {
+    loopback_link_t *lb = (loopback_link_t *)user;
+    memcpy(lb->memory + offset, data, len);
+}
+
+static uint8_t loopback_end(void *user, uint32_t size) {
+    (void)user;
+    (void)size;
+    return USB_PUSH_STATUS_OK;
+}
+
+static uint8_t loopback_run(void *user) {
+    ((loopback_link_t *)user)->ran = true;
+    return USB_PUSH_STATUS_OK;
+}
+
+// Hand the bytes to the parser one bulk packet at a time, as the firmware
+// sees them, and queue every reply it produces.
+static bool loopback_send(push_link_t *link, const uint8_t *data, uint32_t len) {
+    loopback_link_t *lb = (loopback_link_t *)link;
+    uint32_t pos = 0;
+    while (pos < len) {
+        uint32_t packet = len - pos;
+        if (packet > LOOPBACK_PACKET) packet = LOOPBACK_PACKET;
+        uint32_t used = 0;
+        while (used < packet) {
+            uint8_t reply[USB_PUSH_HEADER_SIZE];
+            bool ready;
+            used += usb_push_feed(&lb->parser, &lb->sink, data + pos + used, packet - used, reply, &ready);
+            if (!ready) continue;
+            if (lb->reply_count == LOOPBACK_REPLIES) return false;
+            memcpy(lb->replies[(lb->reply_head + lb->reply_count) % LOOPBACK_REPLIES], reply, USB_PUSH_HEADER_SIZE);
+            lb->reply_count++;
+        }
+        pos += packet;
+    }
+    return true;
+}
+
+static bool loopback_recv(push_link_t *link, uint8_t reply[USB_PUSH_HEADER_SIZE]) {
+    loopback_link_t *lb = (loopback_link_t *)link;
+    if (lb->reply_count == 0) return false;
+    memcpy(reply, lb->replies[lb->reply_head], USB_PUSH_HEADER_SIZE);
+    lb->reply_head = (lb->reply_head + 1) % LOOPBACK_REPLIES;
+    lb->reply_count--;
+    return true;
+}
+
+static bool loopback_open(loopback_link_t *lb) {
+    memset(lb, 0, sizeof(*lb));
+    lb->memory = (uint8_t *)malloc(LOOPBACK_CAPACITY);
+    if (!lb->memory) return false;
+    usb_push_parser_init(&lb->parser);
+    lb->sink.capacity = LOOPBACK_CAPACITY;
+    lb->sink.user = lb;
+    lb->sink.begin = loopback_begin;
+    lb->sink.write = loopback_write;
+    lb->sink.end = loopback_end;
+    lb->sink.run = loopback_run;
+    lb->link.send = loopback_send;
+    lb->link.recv = loopback_recv;
+    return true;
+}
+
+static int loopback_failures = 0;
+
+static void loopback_expect(const char *what, bool ok) {
+    printf("  %-40s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) loopback_failures++;
+}
+
+static int run_loopback(const uint8_t *rom, uint32_t size, const usb_push_begin_t *opts) {
+    loopback_link_t lb;
+    if (!loopback_open(&lb)) return 1;
+    push_link_t *link = &lb.link;
+    uint16_t seq = 100;
+    uint32_t arg = 0;
+
+    printf("Loopback self-check, %u byte image\n", size);
+    bool pushed = push_session(link, rom, size, opts, true, false);
+    loopback_expect("session completes", pushed);
+    loopback_expect("image arrives intact", pushed && lb.image_size == size && memcmp(lb.memory, rom, size) == 0);
+    loopback_expect("run reaches the sink", lb.ran);
+
+    push_transact(link, USB_PUSH_CMD_BEGIN, &seq, size, opts, USB_PUSH_BEGIN_SIZE, NULL);
+    push_send_frame(link, USB_PUSH_CMD_DATA, seq, 0, rom, size < USB_PUSH_MAX_DATA ? size : USB_PUSH_MAX_DATA);
+    push_wait_reply(link, USB_PUSH_CMD_DATA, seq++, NULL);
+    loopback_expect("repeated offset is refused",
+                    push_transact(link, USB_PUSH_CMD_DATA, &seq, 0, rom, 1, NULL) == USB_PUSH_STATUS_BAD_OFFSET);
+    loopback_expect("early END is refused",
+                    size <= USB_PUSH_MAX_DATA ||
+                    push_transact(link, USB_PUSH_CMD_END, &seq, 0, NULL, 0, NULL) == USB_PUSH_STATUS_SHORT);
+
+    push_transact(link, USB_PUSH_CMD_BEGIN, &seq, 1, opts, USB_PUSH_BEGIN_SIZE, NULL);
+    push_transact(link, USB_PUSH_CMD_DATA, &seq, 0, rom, 1, NULL);
+    loopback_expect("bad CRC is refused",
+                    push_transact(link, USB_PUSH_CMD_END, &seq, ~usb_push_crc32(rom, 1), NULL, 0, &arg) == USB_PUSH_STATUS_BAD_CRC &&
+                    arg == usb_push_crc32(rom, 1));
+    loopback_expect("RUN after a bad CRC is refused",
+                    push_transact(link, USB_PUSH_CMD_RUN, &seq, 0, NULL, 0, NULL) == USB_PUSH_STATUS_BAD_STATE);
+
+    loopback_expect("oversized image is refused",
+                    push_transact(link, USB_PUSH_CMD_BEGIN, &seq, LOOPBACK_CAPACITY + 1u, opts, USB_PUSH_BEGIN_SIZE, NULL) ==
+                    USB_PUSH_STATUS_TOO_LARGE);
+
+    usb_push_begin_t bad = *opts;
+    bad.mapper = 10;
+    loopback_expect("system mapper is refused",
+                    push_transact(link, USB_PUSH_CMD_BEGIN, &seq, size, &bad, USB_PUSH_BEGIN_SIZE, NULL) ==
+                    USB_PUSH_STATUS_BAD_OPTION);
+
+    uint8_t garbage[USB_PUSH_HEADER_SIZE];
+    memset(garbage, 0x5A, sizeof(garbage));
+    link->send(link, garbage, sizeof(garbage));
+    loopback_expect("lost framing is reported", push_wait_reply(link, USB_PUSH_CMD_HELLO, 0, NULL) == USB_PUSH_STATUS_BAD_FRAME);
+    loopback_expect("stream recovers after lost framing",
+                    push_transact(link, USB_PUSH_CMD_HELLO, &seq, USB_PUSH_VERSION, NULL, 0, &arg) == USB_PUSH_STATUS_OK &&
+                    arg == LOOPBACK_CAPACITY);
+    loopback_expect("no reply left over", lb.reply_count == 0);
+
+    free(lb.memory);
+    printf("%s\n", loopback_failures ? "Loopback self-check FAILED" : "Loopback self-check passed");
+    return loopback_failures ? 1 : 0;
+}
+
+static void print_usage(const char *prog_name) {
+    printf("Usage: %s [options] <romfile>\n", prog_name);
+    printf("       %s --loopback [options] [romfile]\n", prog_name);
+    printf("Options:\n");
+    printf("  -m, --mapper <m>   Mapper number or tag (e.g. ASC-08, AUTO); detected from the image if omitted\n");
+    printf("  -a, --audio <n>    Audio profile number (0 = none)\n");
+    printf("  -p, --psg          Enable primary PSG emulation\n");
+    printf("  --volume <pct>     Audio volume percent (default 100)\n");
+    printf("  --vdp <50|60>      Force the VDP frequency at launch\n");
+    printf("  -n, --name <text>  Name shown in the Pico log (defaults to the file name)\n");
+    printf("  --no-run           Upload only, do not reset the MSX into the image\n");
+    printf("  -d, --device <p>   usbfs node (/dev/bus/usb/BBB/DDD); found by VID:PID if omitted\n");
+    printf("  --loopback         Run the protocol self-check against an in-process device stub\n");
+}
+
+int main(int argc, char *argv[]) {
+    usb_push_begin_t opts;
+    const char *rom_path = NULL;
+    const char *device = NULL;
+    const char *name = NULL;
+    int mapper = 0;
+    bool run = true;
+    bool loopback = false;
+
+    memset(&opts, 0, sizeof(opts));
+    for (int i = 1; i < argc; ++i) {
+        if ((strcmp(argv[i], "-m") == 0 || strcmp(argv[i], "--mapper") == 0) && i + 1 < argc) {
+            mapper = parse_mapper(argv[++i]);
+            if (mapper < 0) {
+                fprintf(stderr, "unknown mapper '%s'\n", argv[i]);
+                return 1;
+            }
+        } else if ((strcmp(argv[i], "-a") == 0 || strcmp(argv[i], "--audio") == 0) && i + 1 < argc) {
+            opts.audio = (uint8_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "--psg") == 0) {
+            opts.psg = 1;
+        } else if (strcmp(argv[i], "--volume") == 0 && i + 1 < argc) {
+            opts.volume = (uint8_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--vdp") == 0 && i + 1 < argc) {
+            int hz = atoi(argv[++i]);
+            opts.vdp_freq = (hz == 60) ? 1 : (hz == 50) ? 2 : 0;
+        } else if ((strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--name") == 0) && i + 1 < argc) {
+            name = argv[++i];
+        } else if ((strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--device") == 0) && i + 1 < argc) {
+            device = argv[++i];
+        } else if (strcmp(argv[i], "--no-run") == 0) {
+            run = false;
+        } else if (strcmp(argv[i], "--loopback") == 0) {
+            loopback = true;
+        } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (!rom_path) {
+            rom_path = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!rom_path && !loopback) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    uint32_t size = 0;
+    uint8_t *rom = NULL;
+    if (rom_path) {
+        rom = load_file(rom_path, &size);
+        if (!rom) {
+            fprintf(stderr, "cannot read %s\n", rom_path);
+            return 1;
+        }
+    } else {
+        // Synthetic 300KB image: not a multiple of the frame size, so the
+        // last DATA frame is a short one.
+        size = 300u * 1024u + 123u;
+        rom = (uint8_t *)malloc(size);
+        if (!rom) return 1;
+        uint32_t x = 0x12345678u;
+        for (uint32_t i = 0; i < size; ++i) {
+            x = x * 1103515245u + 12345u;
+            rom[i] = (uint8_t)(x >> 16);
+        }
+        mapper = mapper ? mapper : 5;
+    }
+
+    if (mapper == 0) {
+        mapper = mapper_detect_buffer(rom, size);
+        if (mapper == 0) {
+            fprintf(stderr, "mapper not detected, use --mapper\n");
+            free(rom);
+            return 1;
+        }
+    }
+    opts.mapper = (uint8_t)mapper;
+    if (!name) {
+        name = rom_path ? strrchr(rom_path, '/') : NULL;
+        name = name ? name + 1 : (rom_path ? rom_path : "loopback");
+    }
+    strncpy(opts.name, name, USB_PUSH_NAME_SIZE - 1);
+
+    int result;
+    if (loopback) {
+        result = run_loopback(rom, size, &opts);
+    } else {
+        usb_link_t u;
+        printf("%s: %u bytes, mapper %s\n", opts.name, size, mapper_name(opts.mapper));
+        if (!usb_link_open(&u, device)) {
+            free(rom);
+            return 1;
+        }
+        result = push_session(&u.link, rom, size, &opts, run, true) ? 0 : 1;
+        usb_link_close(&u);
+        if (result == 0 && run) printf("MSX reset into the image\n");
+    }
+    free(rom);
+    return result;
+}
@@ -0,0 +1,307 @@
+// MSX PICOVERSE PROJECT
+// (c) 2026 Cristiano Goncalves
+// The Retro Hacker
+//
+// usb_push.h - Shared wire protocol for the USB "push and run" link.
+//
+// This header is shared between the Explorer Pico firmware (built with
+// EXPLORER_USB_PUSH, where it runs behind a vendor bulk interface) and the
+// pvpush Linux tool, which uploads a ROM image straight into the PSRAM SD ROM
+// region and asks the firmware to launch it. Both copies must stay identical.
+//
+// Every exchange is one frame from the host answered by one reply frame. A
+// frame is a 16-byte little-endian header followed by `length` payload bytes:
+//   0  magic   "PVPU"
+//   4  cmd     USB_PUSH_CMD_* (replies set USB_PUSH_REPLY)
+//   5  status  0 on requests, USB_PUSH_STATUS_* on replies
+//   6  seq     echoed back in the reply
+//   8  arg     command argument (see below)
+//   12 length  payload bytes that follow
+//
+// Session: HELLO (reply arg = largest image the device accepts), BEGIN
+// (arg = image size, payload = usb_push_begin_t), DATA frames in order
+// (arg = image offset, payload = image bytes), END (arg = CRC32 of the whole
+// image) and finally RUN. The receiver is a byte-stream parser with no
+// dependency on the transport, so it runs unchanged on the firmware and in
+// the tool's --loopback self-check.
+//
+// This work is licensed  under a "Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License".
+// https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+#ifndef USB_PUSH_H
+#define USB_PUSH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define USB_PUSH_MAGIC          0x55505650u // "PVPU"
+#define USB_PUSH_VERSION        1u
+#define USB_PUSH_HEADER_SIZE    16u
+#define USB_PUSH_MAX_DATA       4096u       // largest DATA payload the host sends
+#define USB_PUSH_NAME_SIZE      32u
+
+// USB identity of the push personality (Raspberry Pi VID).
+#define USB_PUSH_VID            0x2E8Au
+#define USB_PUSH_PID            0x00E2u
+
+#define USB_PUSH_CMD_HELLO      0x01u
+#define USB_PUSH_CMD_BEGIN      0x02u
+#define USB_PUSH_CMD_DATA       0x03u
+#define USB_PUSH_CMD_END        0x04u
+#define USB_PUSH_CMD_RUN        0x05u
+#define USB_PUSH_REPLY          0x80u
+
+#define USB_PUSH_STATUS_OK          0x00u
+#define USB_PUSH_STATUS_BAD_FRAME   0x01u // bad magic, unknown command or payload size
+#define USB_PUSH_STATUS_BAD_STATE   0x02u // command out of sequence
+#define USB_PUSH_STATUS_TOO_LARGE   0x03u // image does not fit the device
+#define USB_PUSH_STATUS_BAD_OFFSET  0x04u // DATA not contiguous with the previous one
+#define USB_PUSH_STATUS_BAD_CRC     0x05u // END checksum mismatch
+#define USB_PUSH_STATUS_BAD_OPTION  0x06u // BEGIN options rejected
+#define USB_PUSH_STATUS_SHORT       0x07u // END before the whole image arrived
+
+// BEGIN payload. The option bytes follow the .PVC per-ROM options file.
+typedef struct {
+    uint8_t mapper;         // Explorer mapper code (1..14, or 22 for auto)
+    uint8_t audio;          // audio profile (AUDIO_PROFILE_*)
+    uint8_t psg;            // 1 = primary PSG emulation over I2S
+    uint8_t volume;         // audio volume percent (0 = default)
+    uint8_t vdp_freq;       // 0 = default, 1 = 60 Hz, 2 = 50 Hz
+    uint8_t reserved[3];
+    char name[USB_PUSH_NAME_SIZE];
+} usb_push_begin_t;
+
+#define USB_PUSH_BEGIN_SIZE     ((uint32_t)sizeof(usb_push_begin_t))
+
+typedef struct {
+    uint8_t cmd;
+    uint8_t status;
+    uint16_t seq;
+    uint32_t arg;
+    uint32_t length;
+} usb_push_header_t;
+
+// Receiver callbacks. begin validates the options and prepares room for the
+// image; write stores a slice of it; end sees the completed image; run asks
+// for the launch. Non-OK returns are sent back as the reply status.
+typedef struct {
+    uint32_t capacity;
+    void *user;
+    uint8_t (*begin)(void *user, uint32_t size, const usb_push_begin_t *opts);
+    void (*write)(void *user, uint32_t offset, const uint8_t *data, uint32_t len);
+    uint8_t (*end)(void *user, uint32_t size);
+    uint8_t (*run)(void *user);
+} usb_push_sink_t;
+
+enum {
+    USB_PUSH_STATE_IDLE = 0,    // no image, or the last one was abandoned
+    USB_PUSH_STATE_LOADING,     // BEGIN accepted, DATA expected
+    USB_PUSH_STATE_LOADED       // END accepted, RUN allowed
+};
+
+typedef struct {
+    uint8_t header[USB_PUSH_HEADER_SIZE];
+    uint32_t header_fill;
+    usb_push_header_t frame;
+    uint32_t payload_done;      // payload bytes of the current frame consumed
+    uint8_t reply_status;       // first error seen while streaming the payload
+    uint8_t state;
+    uint32_t image_size;
+    uint32_t received;
+    uint32_t crc;               // running CRC32 of the image, pre-inversion
+    usb_push_begin_t begin;
+} usb_push_parser_t;
+
+// CRC-32 (IEEE, reflected, as zlib). Nibble table keeps it small enough for
+// the firmware and fast enough to run inline with the transfer.
+static inline uint32_t usb_push_crc32_update(uint32_t crc, const uint8_t *data, uint32_t len)
+{
+    static const uint32_t table[16] = {
+        0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu,
+        0x76DC4190u, 0x6B6B51F4u, 0x4DB26158u, 0x5005713Cu,
+        0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu,
+        0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu
+    };
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ table[crc & 0x0Fu];
+        crc = (crc >> 4) ^ table[crc & 0x0Fu];
+    }
+    return crc;
+}
+
+static inline uint32_t usb_push_crc32(const uint8_t *data, uint32_t len)
+{
+    return usb_push_crc32_update(0xFFFFFFFFu, data, len) ^ 0xFFFFFFFFu;
+}
+
+static inline void usb_push_put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint32_t usb_push_get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void usb_push_encode_header(uint8_t out[USB_PUSH_HEADER_SIZE], const usb_push_header_t *h)
+{
+    usb_push_put32(&out[0], USB_PUSH_MAGIC);
+    out[4] = h->cmd;
+    out[5] = h->status;
+    out[6] = (uint8_t)h->seq;
+    out[7] = (uint8_t)(h->seq >> 8);
+    usb_push_put32(&out[8], h->arg);
+    usb_push_put32(&out[12], h->length);
+}
+
+// Returns false when the magic does not match.
+static inline bool usb_push_decode_header(const uint8_t in[USB_PUSH_HEADER_SIZE], usb_push_header_t *h)
+{
+    if (usb_push_get32(&in[0]) != USB_PUSH_MAGIC) return false;
+    h->cmd = in[4];
+    h->status = in[5];
+    h->seq = (uint16_t)(in[6] | (in[7] << 8));
+    h->arg = usb_push_get32(&in[8]);
+    h->length = usb_push_get32(&in[12]);
+    return true;
+}
+
+static inline void usb_push_parser_init(usb_push_parser_t *p)
+{
+    memset(p, 0, sizeof(*p));
+}
+
+// Validate a frame header before its payload is consumed. The payload of a
+// rejected frame is still drained so the stream stays in sync.
+static inline uint8_t usb_push_check_frame(usb_push_parser_t *p, const usb_push_sink_t *sink)
+{
+    const usb_push_header_t *f = &p->frame;
+    switch (f->cmd) {
+        case USB_PUSH_CMD_HELLO:
+        case USB_PUSH_CMD_END:
+        case USB_PUSH_CMD_RUN:
+            return f->length == 0 ? USB_PUSH_STATUS_OK : USB_PUSH_STATUS_BAD_FRAME;
+        case USB_PUSH_CMD_BEGIN:
+            if (f->length != USB_PUSH_BEGIN_SIZE) return USB_PUSH_STATUS_BAD_FRAME;
+            if (f->arg == 0 || f->arg > sink->capacity) return USB_PUSH_STATUS_TOO_LARGE;
+            return USB_PUSH_STATUS_OK;
+        case USB_PUSH_CMD_DATA:
+            if (f->length > USB_PUSH_MAX_DATA) return USB_PUSH_STATUS_BAD_FRAME;
+            if (p->state != USB_PUSH_STATE_LOADING) return USB_PUSH_STATUS_BAD_STATE;
+            if (f->arg != p->received || f->length > p->image_size - p->received)
+                return USB_PUSH_STATUS_BAD_OFFSET;
+            return USB_PUSH_STATUS_OK;
+        default:
+            return USB_PUSH_STATUS_BAD_FRAME;
+    }
+}
+
+// Act on a frame whose payload has been consumed. Returns the reply status
+// and may set the reply argument.
+static inline uint8_t usb_push_complete_frame(usb_push_parser_t *p, const usb_push_sink_t *sink, uint32_t *reply_arg)
+{
+    const usb_push_header_t *f = &p->frame;
+    uint8_t status;
+
+    switch (f->cmd) {
+        case USB_PUSH_CMD_HELLO:
+            *reply_arg = sink->capacity;
+            return USB_PUSH_STATUS_OK;
+        case USB_PUSH_CMD_BEGIN:
+            p->state = USB_PUSH_STATE_IDLE;
+            p->begin.name[USB_PUSH_NAME_SIZE - 1] = '\0';
+            status = sink->begin(sink->user, f->arg, &p->begin);
+            if (status != USB_PUSH_STATUS_OK) return status;
+            p->image_size = f->arg;
+            p->received = 0;
+            p->crc = 0xFFFFFFFFu;
+            p->state = USB_PUSH_STATE_LOADING;
+            return USB_PUSH_STATUS_OK;
+        case USB_PUSH_CMD_DATA:
+            *reply_arg = p->received;
+            return USB_PUSH_STATUS_OK;
+        case USB_PUSH_CMD_END:
+            if (p->state != USB_PUSH_STATE_LOADING) return USB_PUSH_STATUS_BAD_STATE;
+            if (p->received != p->image_size) return USB_PUSH_STATUS_SHORT;
+            *reply_arg = p->crc ^ 0xFFFFFFFFu;
+            if (*reply_arg != f->arg) {
+                p->state = USB_PUSH_STATE_IDLE;
+                return USB_PUSH_STATUS_BAD_CRC;
+            }
+            status = sink->end(sink->user, p->image_size);
+            p->state = (status == USB_PUSH_STATUS_OK) ? USB_PUSH_STATE_LOADED : USB_PUSH_STATE_IDLE;
+            return status;
+        default: // USB_PUSH_CMD_RUN
+            if (p->state != USB_PUSH_STATE_LOADED) return USB_PUSH_STATUS_BAD_STATE;
+            return sink->run(sink->user);
+    }
+}
+
+// Consume bytes from the stream. Stops right after a frame completes and
+// fills reply with the frame to send back; returns the bytes consumed, so
+// callers loop until everything they read has been fed.
+static inline uint32_t usb_push_feed(usb_push_parser_t *p, const usb_push_sink_t *sink,
+                                     const uint8_t *data, uint32_t len,
+                                     uint8_t reply[USB_PUSH_HEADER_SIZE], bool *reply_ready)
+{
+    uint32_t used = 0;
+    *reply_ready = false;
+
+    while (used < len) {
+        if (p->header_fill < USB_PUSH_HEADER_SIZE) {
+            uint32_t take = USB_PUSH_HEADER_SIZE - p->header_fill;
+            if (take > len - used) take = len - used;
+            memcpy(&p->header[p->header_fill], &data[used], take);
+            p->header_fill += take;
+            used += take;
+            if (p->header_fill < USB_PUSH_HEADER_SIZE) break;
+
+            p->payload_done = 0;
+            if (!usb_push_decode_header(p->header, &p->frame)) {
+                // Out of sync: answer once and start over on the next bytes.
+                usb_push_header_t r = { USB_PUSH_REPLY, USB_PUSH_STATUS_BAD_FRAME, 0, 0, 0 };
+                usb_push_encode_header(reply, &r);
+                p->header_fill = 0;
+                *reply_ready = true;
+                return used;
+            }
+            p->reply_status = usb_push_check_frame(p, sink);
+        } else {
+            uint32_t take = p->frame.length - p->payload_done;
+            if (take > len - used) take = len - used;
+            if (p->reply_status == USB_PUSH_STATUS_OK) {
+                if (p->frame.cmd == USB_PUSH_CMD_DATA) {
+                    sink->write(sink->user, p->received, &data[used], take);
+                    p->crc = usb_push_crc32_update(p->crc, &data[used], take);
+                    p->received += take;
+                } else {
+                    memcpy((uint8_t *)&p->begin + p->payload_done, &data[used], take);
+                }
+            }
+            p->payload_done += take;
+            used += take;
+        }
+
+        if (p->payload_done == p->frame.length) {
+            uint32_t arg = 0;
+            uint8_t status = p->reply_status;
+            if (status == USB_PUSH_STATUS_OK)
+                status = usb_push_complete_frame(p, sink, &arg);
+            usb_push_header_t r = { (uint8_t)(p->frame.cmd | USB_PUSH_REPLY), status, p->frame.seq, arg, 0 };
+            usb_push_encode_header(reply, &r);
+            p->header_fill = 0;
+            *reply_ready = true;
+            return used;
+        }
+    }
+    return used;
+}
+
+#endif // USB_PUSH_H
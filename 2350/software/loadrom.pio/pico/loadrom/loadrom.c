@@ -64,7 +64,8 @@ typedef struct {
 } msx_pio_io_bus_t;
 
 static msx_pio_io_bus_t msx_io_bus;
-static bool msx_io_bus_programs_loaded = false;
+static bool msx_io_write_program_loaded = false;
+static bool msx_io_read_program_loaded = false;
 
 // Tracks how many bytes of the ROM are cached in SRAM (0 = no cache)
 static uint32_t rom_cached_size = 0;
@@ -866,7 +867,55 @@ static void msx_pio_bus_init(void)
 
 // -----------------------------------------------------------------------
 // PIO I/O bus initialisation (for memory mapper port access on PIO1)
+//
+// msx_io_read_responder only hands the CPU reads of the 8-port blocks the
+// running mode owns (bit n = ports n*8..n*8+7); every other port read
+// completes without the CPU seeing it. The block numbers are patched into
+// the program's compare slots, so it is reloaded whenever the set changes.
 // -----------------------------------------------------------------------
+#define IO_PORT_BLOCK(port) (1u << ((port) >> 3))
+#define IO_READ_SLOTS       3u
+
+static uint32_t msx_io_read_owned = 0;  // blocks owned by the running mode
+static uint32_t msx_io_read_loaded = 0; // blocks the loaded program answers
+
+static void msx_io_read_load_program(uint32_t owned)
+{
+    if (msx_io_read_program_loaded)
+    {
+        if (owned == msx_io_read_loaded)
+            return;
+        pio_remove_program(msx_io_bus.pio_read, &msx_io_read_responder_program, msx_io_bus.offset_io_read);
+    }
+
+    uint16_t instructions[sizeof(msx_io_read_responder_program_instructions) / sizeof(uint16_t)];
+    memcpy(instructions, msx_io_read_responder_program_instructions, sizeof(instructions));
+
+    uint32_t slot = 0;
+    for (uint32_t block = 0; block < 32u; ++block)
+    {
+        if (!(owned & (1u << block)))
+            continue;
+        if (slot == IO_READ_SLOTS)
+        {
+            // More blocks than slots: pass every read to the CPU.
+            instructions[msx_io_read_responder_offset_slots + 1u] = (uint16_t)pio_encode_jmp(msx_io_read_responder_offset_respond);
+            break;
+        }
+        instructions[msx_io_read_responder_offset_slots + 3u * slot] = (uint16_t)pio_encode_set(pio_y, block);
+        slot++;
+    }
+    for (; slot < IO_READ_SLOTS; ++slot)
+        instructions[msx_io_read_responder_offset_slots + 3u * slot + 2u] = (uint16_t)pio_encode_jmp(msx_io_read_responder_offset_ignore);
+
+    pio_program_t program = msx_io_read_responder_program;
+    program.instructions = instructions;
+    msx_io_bus.offset_io_read = pio_add_program(msx_io_bus.pio_read, &program);
+    msx_io_read_loaded = owned;
+    msx_io_read_program_loaded = true;
+}
+
+// Starts the I/O bus state machines for the ports in msx_io_read_owned.
 static void msx_pio_io_bus_init(void)
 {
     msx_io_bus.pio_read = pio1;
@@ -874,15 +923,16 @@ static void msx_pio_io_bus_init(void)
     msx_io_bus.sm_io_read  = 0;
     msx_io_bus.sm_io_write = 1;
 
-    if (!msx_io_bus_programs_loaded)
+    pio_sm_set_enabled(msx_io_bus.pio_read, msx_io_bus.sm_io_read, false);
+    pio_sm_set_enabled(msx_io_bus.pio_write, msx_io_bus.sm_io_write, false);
+
+    msx_io_read_load_program(msx_io_read_owned);
+    if (!msx_io_write_program_loaded)
     {
-        msx_io_bus.offset_io_read = pio_add_program(msx_io_bus.pio_read, &msx_io_read_responder_program);
         msx_io_bus.offset_io_write = pio_add_program(msx_io_bus.pio_write, &msx_io_write_captor_program);
-        msx_io_bus_programs_loaded = true;
+        msx_io_write_program_loaded = true;
     }
 
-    pio_sm_set_enabled(msx_io_bus.pio_read, msx_io_bus.sm_io_read, false);
-    pio_sm_set_enabled(msx_io_bus.pio_write, msx_io_bus.sm_io_write, false);
     pio_sm_clear_fifos(msx_io_bus.pio_read, msx_io_bus.sm_io_read);
     pio_sm_clear_fifos(msx_io_bus.pio_write, msx_io_bus.sm_io_write);
     pio_sm_restart(msx_io_bus.pio_read, msx_io_bus.sm_io_read);
@@ -911,6 +961,13 @@ static void msx_pio_io_bus_init(void)
     pio_sm_set_enabled(msx_io_bus.pio_write, msx_io_bus.sm_io_write, true);
 }
 
+// Mapper loops declare the I/O ports they answer before starting the bus.
+static void msx_pio_io_bus_init_ports(uint32_t owned_blocks)
+{
+    msx_io_read_owned = owned_blocks;
+    msx_pio_io_bus_init();
+}
+
 // -----------------------------------------------------------------------
 // Token helpers
 // -----------------------------------------------------------------------
@@ -1958,7 +2015,7 @@ void __no_inline_not_in_flash_func(loadrom_sunrise_mapper)(uint32_t offset, bool
 
     // Initialise PIO I/O bus FIRST (mapper port handlers must be ready
     // before the memory bus releases WAIT and the BIOS starts probing).
-    msx_pio_io_bus_init();
+    msx_pio_io_bus_init_ports(IO_PORT_BLOCK(0xFCu));
 
     // Initialise PIO memory bus — this hands PIN_WAIT back to the PIO
     // read SM whose first instruction uses "side 1" (WAIT released),
@@ -2247,7 +2304,7 @@ void __no_inline_not_in_flash_func(loadrom_sunrise_mapper_sd)(uint32_t offset, b
 
     mapper_fill_ff();
 
-    msx_pio_io_bus_init();
+    msx_pio_io_bus_init_ports(IO_PORT_BLOCK(0xFCu));
     msx_pio_bus_init();
 
     sunrise_ctx_t ctx = { .ide = &ide };
@@ -3527,7 +3584,7 @@ static void __no_inline_not_in_flash_func(loadrom_c2_common)(uint32_t offset,
         i2s_audio_init();
     }
 
-    msx_pio_io_bus_init();
+    msx_pio_io_bus_init_ports(IO_PORT_BLOCK(0xFCu) | IO_PORT_BLOCK(0xF0u));
     msx_pio_bus_init();
 
     // Main loop: service memory + I/O traffic for Nextor, mapper RAM,
@@ -3929,7 +3986,7 @@ static void __not_in_flash_func(loadrom_sunrise_wifi_common)(
             while (true) { tight_loop_contents(); }
         }
         mapper_fill_ff();
-        msx_pio_io_bus_init();
+        msx_pio_io_bus_init_ports(IO_PORT_BLOCK(0xFCu));
     }
 
     msx_pio_bus_init();
@@ -4126,7 +4183,7 @@ static void __not_in_flash_func(loadrom_sunrise_megaram_common)(
     mapper_fill_ff();
     megaram_fill_ff();
 
-    msx_pio_io_bus_init();
+    msx_pio_io_bus_init_ports(IO_PORT_BLOCK(0xFCu) | IO_PORT_BLOCK(0x8Eu));
     msx_pio_bus_init();
 
     while (true)
@@ -25,8 +25,7 @@
 #include "menu.h"
 #include "nextor_sunrise.h"
 #include "esp8266p_rom.h"
-#include "sha1.h"
-#include "romdb.h"
+#include "../../../../../common/mapper_detect.h"
 
 #ifndef APP_VERSION
 #define APP_VERSION "v1.00"
@@ -173,23 +172,11 @@ static bool rom_has_ab_at(const uint8_t *rom, uint32_t size, uint32_t offset) {
     return (offset + 1u < size) && rom[offset] == 'A' && rom[offset + 1u] == 'B';
 }
 
-// Attempt to guess the mapper type from the ROM contents.
-// Returns the mapper byte expected by the firmware (0 signals unsupported/unknown).
-// Code adapted from openMSX mapper detection routines.
+// Attempt to guess the mapper type from the ROM contents using the shared
+// SHA1 + heuristic detector (common/mapper_detect.h, the same header as the
+// Explorer tool and firmware). Returns the mapper byte expected by the
+// firmware (0 signals unsupported/unknown).
 uint8_t detect_rom_type(const char *filename, uint32_t size) {
-    
-    // Define the NEO8 signature
-    const char neo8_signature[] = "ROM_NEO8";
-    const char neo16_signature[] = "ROM_NE16";
-    const char ascii16x_signature[] = "ASCII16X";
-
-    // Scores for each mapper type (unit weights, matching openMSX guessRomType)
-    unsigned int konami_score = 0;
-    unsigned int konami_scc_score = 0;
-    unsigned int ascii8_score = 0;
-    unsigned int ascii16_score = 0;
-
-    //size_t size = file_size(filename);
     if (size > MAX_ROM_SIZE || size < MIN_ROM_SIZE) {
         printf("Invalid ROM size\n");
         return 0; // unknown mapper
@@ -201,198 +188,37 @@ uint8_t detect_rom_type(const char *filename, uint32_t size) {
         return 0; // unknown mapper
     }
 
-    // openMSX-style: inspect the full ROM for mapper-write patterns.
-    size_t read_size = size;
-    // Dynamically allocate memory for the ROM
-    uint8_t *rom = (uint8_t *)malloc(read_size);
+    uint8_t *rom = (uint8_t *)malloc(size);
     if (!rom) {
         printf("Failed to allocate memory for ROM\n");
         fclose(file);
         return 0; // unknown mapper
     }
 
-    size_t read_bytes = fread(rom, 1, read_size, file);
+    size_t read_bytes = fread(rom, 1, size, file);
     fclose(file);
-    if (read_bytes != read_size) {
+    if (read_bytes != size) {
         printf("Failed to read ROM data from %s\n", filename);
         free(rom);
         return 0; // unknown mapper
     }
 
-    // SHA1 database lookup (openMSX softwaredb) — checked before heuristics.
-    {
-        uint8_t sha1[20];
-        sha1_from_buffer(rom, (uint32_t)read_size, sha1);
-        uint8_t db_type = romdb_lookup(sha1);
-        if (db_type) {
-            free(rom);
-            return db_type;
-        }
-    }
-    
-    bool ab0 = rom_has_ab_at(rom, size, 0x0000u);
-    bool ab4000 = rom_has_ab_at(rom, size, 0x4000u);
-
-    // Check if the ROM has the signature "AB" at 0x0000 and 0x0001
-    // Those are the cases for 16KB and 32KB ROMs
-    if (ab0 && size <= 16384u) {
-        free(rom);
-        return 1;     // Plain 8KB/16KB
-    }
-
-    if (ab0 && size <= 32768u) {
-
-        // Check if it is a normal 32KB ROM or Planar32/48-style layout.
-        if (ab4000) {
-            free(rom);
-            return 4; // Planar32/48 style (AB at 0x4000)
-        }
-        
-        free(rom);
-        return 2;     // Plain 32KB 
-    }
-
-    // Check for the "AB" header at the start
-    if (ab0) {
-        if (memcmp(&rom[16], ascii16x_signature, sizeof(ascii16x_signature) - 1) == 0) {
-            free(rom);
-            return ROM_TYPE_ASCII16X; // ASCII16-X mapper detected
-        }
-        // Check for the NEO8 signature at offset 16
-        if (memcmp(&rom[16], neo8_signature, sizeof(neo8_signature) - 1) == 0) {
-            free(rom);
-            return 8; // NEO8 mapper detected
-        } else if (memcmp(&rom[16], neo16_signature, sizeof(neo16_signature) - 1) == 0) {
-            free(rom);
-            return 9; // NEO16 mapper detected
-        }
-    }
-
-    // Manbow 2 detection: 512KB ROM with "Manbow 2" string at offset 0x28000.
-    if (size == 524288u && ab0 &&
-        memcmp(&rom[0x28000], "Manbow 2", 8) == 0)
-    {
-        free(rom);
-        return ROM_TYPE_MANBOW2;
-    }
-
-    // Check if the ROM has the signature "AB" at 0x4000 and 0x4001
-    // That is the case for 48KB Planar mapping.
-    if (ab4000 && size <= 49152) {
-        free(rom);
-        return 4; // Planar48
+    mapper_detect_result_t result;
+    uint8_t mapper = mapper_detect_buffer_ranked(rom, size, 0u, &result);
+    // MultiROM also runs 8KB "AB" ROMs through the 16KB plain mapper.
+    if (result.source != MAPPER_DETECT_SRC_ROMDB && size < 16384u && rom_has_ab_at(rom, size, 0x0000u)) {
+        mapper = 1;
     }
+    free(rom);
 
-    // 64KB planar ROMs may only expose AB at 0x4000.
-    if (size == 65536u) {
-        if (ab4000) {
-            free(rom);
-            return ROM_TYPE_PLANAR64;
-        }
+#if defined(DEBUG) || defined(_DEBUG)
+    for (uint8_t i = 0; i < result.count; ++i) {
+        printf("DEBUG: candidate %u mapper %u confidence %u (source %u)\n",
+               i, result.cand[i].mapper, result.cand[i].confidence, result.source);
     }
+#endif
 
-    // Heuristic analysis for larger ROMs
-    if (size > 32768) {
-        // Scan through the ROM data to detect ld (nnnn),a patterns.
-        // Scoring matches openMSX guessRomType(): unit weights, no SCC
-        // credit for 0x6000, and >= tie-breaking favoring later types.
-        for (size_t i = 0; i < read_size - 3; i++) {
-            if (rom[i] == 0x32) { // ld (nnnn),a
-                uint16_t addr = rom[i + 1] | (rom[i + 2] << 8);
-                switch (addr) {
-                    case 0x4000:
-                    case 0x8000:
-                    case 0xA000:
-                        konami_score++;
-                        break;
-                    case 0x5000:
-                    case 0x9000:
-                    case 0xB000:
-                        konami_scc_score++;
-                        break;
-                    case 0x6800:
-                    case 0x7800:
-                        ascii8_score++;
-                        break;
-                    case 0x77FF:
-                        ascii16_score++;
-                        break;
-                    case 0x6000:
-                        konami_score++;
-                        ascii8_score++;
-                        ascii16_score++;
-                        break;
-                    case 0x7000:
-                        konami_scc_score++;
-                        ascii8_score++;
-                        ascii16_score++;
-                        break;
-                }
-            }
-        }
-
-        // openMSX quirk: subtract 1 from ASCII8 if non-zero.
-        if (ascii8_score) ascii8_score--;
-
-        // Pick the winner using >= so that later types win ties.
-        {
-            uint8_t best_type = 0;
-            unsigned int best_score = 0;
-            struct { unsigned int score; uint8_t type; } candidates[] = {
-                { konami_scc_score, 3 },  // Konami SCC
-                { konami_score,     7 },  // Konami
-                { ascii8_score,     5 },  // ASCII8
-                { ascii16_score,    6 },  // ASCII16
-            };
-            for (int c = 0; c < 4; c++) {
-                if (candidates[c].score && candidates[c].score >= best_score) {
-                    best_score = candidates[c].score;
-                    best_type = candidates[c].type;
-                }
-            }
-            if (best_type) {
-                free(rom);
-                return best_type;
-            }
-        }
-
-        // Fallbacks when no mapper writes were identified.
-        if (konami_score == 0 && konami_scc_score == 0 && ascii8_score == 0 && ascii16_score == 0)
-        {
-            if (size == 65536u && (ab0 || ab4000))
-            {
-                free(rom);
-                return ROM_TYPE_PLANAR64;
-            }
-
-            if (size > 65536u && ab0 && ((size % 16384u) == 0u))
-            {
-                unsigned int raw_77ff = 0u;
-                unsigned int raw_6800 = 0u;
-                unsigned int raw_7800 = 0u;
-
-                for (size_t i = 0; i + 1 < read_size; ++i)
-                {
-                    uint16_t raw = (uint16_t)(rom[i] | (rom[i + 1] << 8));
-                    if (raw == 0x77FFu) ++raw_77ff;
-                    else if (raw == 0x6800u) ++raw_6800;
-                    else if (raw == 0x7800u) ++raw_7800;
-                }
-
-                free(rom);
-                return (raw_77ff > (raw_6800 + raw_7800)) ? 6 : 5; // ASCII16 : ASCII8
-            }
-
-            free(rom);
-            return 0; // unknown mapper
-        }
-
-        free(rom);
-        return 0; // unknown mapper
-    }
-    
-    free(rom);
-    return 0;
+    return mapper;
 }
 
 // Print usage information
@@ -0,0 +1,57 @@
+// MSX PICOVERSE PROJECT
+// (c) 2026 Cristiano Goncalves
+// The Retro Hacker
+//
+// hw_config.c - SD card hardware configuration for PicoVerse Yamanooto (flash-image export)
+//
+// This work is licensed  under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+// License". https://creativecommons.org/licenses/by-nc-sa/4.0/
+//
+// Original third-party notice preserved below.
+
+/* hw_config.c
+Copyright 2021 Carl John Kugler III
+
+Licensed under the Apache License, Version 2.0 (the License); you may not use
+this file except in compliance with the License. You may obtain a copy of the
+License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software distributed
+under the License is distributed on an AS IS BASIS, WITHOUT WARRANTIES OR
+CONDITIONS OF ANY KIND, either express or implied. See the License for the
+specific language governing permissions and limitations under the License.
+*/
+
+#include "hw_config.h"
+
+/* Configuration of hardware SPI object */
+static spi_t spi = {
+    .hw_inst = spi0,  // SPI component
+    .sck_gpio = 34,    // GPIO number (not Pico pin number)
+    .mosi_gpio = 35,
+    .miso_gpio = 36,
+    .baud_rate = 125 * 1000 * 1000 / 4    // 31250000 Hz
+};
+
+/* SPI Interface */
+static sd_spi_if_t spi_if = {
+    .spi = &spi,  // Pointer to the SPI driving this card
+    .ss_gpio = 33  // The SPI slave select GPIO for this SD card
+};
+
+/* Configuration of the SD Card socket object */
+static sd_card_t sd_card = {
+    .type = SD_IF_SPI,
+    .spi_if_p = &spi_if  // Pointer to the SPI interface driving this card
+};
+
+size_t sd_get_num() { return 1; }
+
+sd_card_t *sd_get_by_num(size_t num) {
+    if (0 == num) {
+        return &sd_card;
+    } else {
+        return NULL;
+    }
+}
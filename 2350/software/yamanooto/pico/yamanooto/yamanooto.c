@@ -38,6 +38,9 @@
 //
 // ENAR WREN enables the S29GL064-compatible command interface. Its mutable
 // image is held in PSRAM and changed pages are journaled in unused board flash.
+// At boot the changes can be exported to microSD for re-import by the PC tool,
+// and an image selected from the microSD library can replace the embedded ROM,
+// with its own journal file on the card.
 //
 // This work is licensed under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
 // License". https://creativecommons.org/licenses/by-nc-sa/4.0/
@@ -57,6 +60,8 @@
 #include "pico/flash.h"
 #include "hardware/structs/xip_ctrl.h"
 #include "pico/audio_i2s.h"
+#include "ff.h"
+#include "hw_config.h"
 #include "yamanooto.h"
 #include "emu2212.h"
 #include "emu2149.h"
@@ -190,6 +195,49 @@ static uint8_t flash_buffer_count = 0;
 static uint8_t flash_buffer_index = 0;
 static uint8_t flash_buffer[YAMA_FLASH_BUFFER_SIZE];
 
+// microSD image library: when /yamanooto/select.txt names an image in
+// /yamanooto/images, that image is streamed into PSRAM at boot and replaces
+// the embedded ROM. Its save journal is a per-image file on the card instead
+// of the board-flash journal, so every installed image keeps its own saves.
+#define YAMA_SD_DIR                 "/yamanooto"
+#define YAMA_LIBRARY_SELECT_PATH    YAMA_SD_DIR "/select.txt"
+#define YAMA_LIBRARY_IMAGE_DIR      YAMA_SD_DIR "/images"
+#define YAMA_LIBRARY_SAVE_DIR       YAMA_SD_DIR "/saves"
+#define YAMA_LIBRARY_NAME_MAX       64u
+#define YAMA_LIBRARY_PATH_MAX       96u
+#define YAMA_LIBRARY_MIN_SIZE       8192u
+#define YAMA_LIBRARY_CHUNK_SIZE     32768u
+
+static FATFS sd_fatfs;
+static bool sd_mounted = false;
+static FIL library_journal;
+static bool library_active = false;     // rom_base points at the SD image in PSRAM
+static char library_image_path[YAMA_LIBRARY_PATH_MAX];
+
+// SD writes take milliseconds, far too long for the bus loop. In library mode
+// the flash command handlers on core 0 only queue what changed; core 1 turns
+// the queue into journal records between audio buffers once the game has
+// stopped programming for YAMA_SAVE_FLUSH_IDLE_BUFFERS buffers, so a page
+// costs one record however many bytes were programmed into it. Sector erases
+// are queued per 8 KB unit (the smallest S29GL064 sector). Core 1 writes at
+// most one record per buffer and rests for a few buffers after a slow card
+// write, so the audio pool can catch up. Compacting a full journal takes far
+// longer than the pool covers; it runs with the audio muted instead.
+#define YAMA_SAVE_FLUSH_IDLE_BUFFERS 8u    // ~93 ms without flash commands
+#define YAMA_AUDIO_POOL_BUFFERS     3u
+#define YAMA_AUDIO_BUFFER_BUDGET_US ((SCC_AUDIO_BUFFER_SAMPLES * 1000000u) / SCC_SAMPLE_RATE)
+#define YAMA_SAVE_STEP_BUDGET_US    (YAMA_AUDIO_BUFFER_BUDGET_US / 4u)
+#define YAMA_FLASH_ERASE_UNIT       0x2000u
+#define YAMA_FLASH_ERASE_UNITS      (YAMA_FLASH_SIZE / YAMA_FLASH_ERASE_UNIT)
+
+static uint32_t save_pending_pages[YAMA_FLASH_PAGE_COUNT / 32u];
+static uint32_t save_pending_erases[YAMA_FLASH_ERASE_UNITS / 32u];
+static volatile bool save_pending_chip_erase = false;
+static volatile uint32_t save_activity = 0;  // bumped on each queued change (core 0)
+
+static bool yama_save_compact_muted(void);
+
+static inline bool __not_in_flash_func(yama_flash_page_is_dirty)(uint32_t page);
 static inline void __not_in_flash_func(yama_flash_page_set_dirty)(uint32_t page);
 static void __not_in_flash_func(yama_flash_mark_dirty_range)(uint32_t address, uint32_t size);
 
@@ -222,7 +270,6 @@ static volatile uint32_t audio_debug_last_us = 0;
 static volatile uint32_t audio_debug_max_us = 0;
 static volatile uint32_t audio_debug_overruns = 0;
 static volatile uint32_t audio_debug_engine = 0;
-#define YAMA_AUDIO_BUFFER_BUDGET_US ((SCC_AUDIO_BUFFER_SAMPLES * 1000000u) / SCC_SAMPLE_RATE)
 #endif
 
 #if YAMANOOTO_USB_STDIO_DEBUG && YAMANOOTO_FMVOICE_TRACE
@@ -361,6 +408,13 @@ static bool yama_flash_storage_execute(yama_flash_storage_op_t *op, uint32_t tim
     return flash_safe_execute(yama_flash_storage_callback, op, timeout_ms) == PICO_OK;
 }
 
+static bool yama_sd_mount(void)
+{
+    if (!sd_mounted)
+        sd_mounted = sd_init_driver() && f_mount(&sd_fatfs, "", 1) == FR_OK;
+    return sd_mounted;
+}
+
 static uint32_t yama_rom_signature(void)
 {
     uint32_t hash = 2166136261u;
@@ -383,6 +437,17 @@ static bool yama_save_write_record(uint8_t type, uint32_t address)
     if (type == YAMA_SAVE_TYPE_PAGE)
         memcpy(record + YAMA_SAVE_PAGE_SIZE, flash_image + address, YAMA_SAVE_PAGE_SIZE);
 
+    if (library_active)
+    {
+        UINT written = 0;
+        if (f_lseek(&library_journal, (FSIZE_t)save_record_cursor * YAMA_SAVE_RECORD_SIZE) != FR_OK ||
+            f_write(&library_journal, record, sizeof(record), &written) != FR_OK ||
+            written != sizeof(record))
+            return false;
+        ++save_record_cursor;
+        return true;
+    }
+
     yama_flash_storage_op_t op = {
         .offset = YAMA_SAVE_STORAGE_OFFSET + save_record_cursor * YAMA_SAVE_RECORD_SIZE,
         .data = record,
@@ -400,6 +465,9 @@ static bool yama_flash_page_differs_from_initial(uint32_t page)
     if ((flash_dirty_pages[page / YAMA_SAVE_PAGE_SIZE / 8u] &
          (1u << ((page / YAMA_SAVE_PAGE_SIZE) & 7u))) == 0u)
         return false;
+    // An SD image is modified in place, so its original content is gone.
+    if (library_active)
+        return true;
 
     for (uint32_t index = 0; index < YAMA_SAVE_PAGE_SIZE; ++index)
     {
@@ -411,6 +479,21 @@ static bool yama_flash_page_differs_from_initial(uint32_t page)
     return false;
 }
 
+static bool yama_save_erase_storage(void)
+{
+    if (library_active)
+        return f_lseek(&library_journal, 0) == FR_OK && f_truncate(&library_journal) == FR_OK &&
+               f_sync(&library_journal) == FR_OK;
+
+    yama_flash_storage_op_t erase = {
+        .offset = YAMA_SAVE_STORAGE_OFFSET,
+        .data = NULL,
+        .length = YAMA_SAVE_STORAGE_SIZE,
+        .erase = true,
+    };
+    return yama_flash_storage_execute(&erase, 10000u);
+}
+
 static bool yama_save_compact(void)
 {
     const uint32_t record_count = YAMA_SAVE_STORAGE_SIZE / YAMA_SAVE_RECORD_SIZE;
@@ -421,13 +504,7 @@ static bool yama_save_compact(void)
             return false;
     }
 
-    yama_flash_storage_op_t erase = {
-        .offset = YAMA_SAVE_STORAGE_OFFSET,
-        .data = NULL,
-        .length = YAMA_SAVE_STORAGE_SIZE,
-        .erase = true,
-    };
-    if (!yama_flash_storage_execute(&erase, 10000u))
+    if (!yama_save_erase_storage())
         return false;
 
     save_record_cursor = 0;
@@ -458,6 +535,159 @@ static uint32_t yama_flash_sector_size(uint32_t address)
     return address < 0x10000u ? 0x2000u : 0x10000u;
 }
 
+static bool yama_save_take_pending(uint32_t *bits, uint32_t words, uint32_t *index)
+{
+    for (uint32_t word = 0; word < words; ++word)
+    {
+        uint32_t pending = __atomic_load_n(&bits[word], __ATOMIC_SEQ_CST);
+        if (pending == 0u)
+            continue;
+        uint32_t bit = (uint32_t)__builtin_ctz(pending);
+        __atomic_fetch_and(&bits[word], ~(1u << bit), __ATOMIC_SEQ_CST);
+        *index = word * 32u + bit;
+        return true;
+    }
+    return false;
+}
+
+static bool yama_save_has_pending(void)
+{
+    if (save_pending_chip_erase)
+        return true;
+    for (uint32_t word = 0; word < YAMA_FLASH_ERASE_UNITS / 32u; ++word)
+        if (__atomic_load_n(&save_pending_erases[word], __ATOMIC_SEQ_CST) != 0u)
+            return true;
+    for (uint32_t word = 0; word < YAMA_FLASH_PAGE_COUNT / 32u; ++word)
+        if (__atomic_load_n(&save_pending_pages[word], __ATOMIC_SEQ_CST) != 0u)
+            return true;
+    return false;
+}
+
+// Core 1: journals one queued change. Erases go first so that a page record
+// always lands after any erase that preceded the data it holds; a page copied
+// while an erase covering it was being queued is queued again behind it.
+// Returns false when the queue is empty or the journal is full; a full
+// journal is left to yama_save_compact_muted() rather than compacted here.
+static bool yama_save_flush_step(void)
+{
+    uint32_t index;
+    bool ok;
+    if (save_record_cursor >= YAMA_SAVE_STORAGE_SIZE / YAMA_SAVE_RECORD_SIZE)
+        return false;
+    if (__atomic_exchange_n(&save_pending_chip_erase, false, __ATOMIC_SEQ_CST))
+    {
+        ok = yama_save_append(YAMA_SAVE_TYPE_CHIP_ERASE, 0u);
+    }
+    else if (yama_save_take_pending(save_pending_erases, YAMA_FLASH_ERASE_UNITS / 32u, &index))
+    {
+        ok = yama_save_append(YAMA_SAVE_TYPE_ERASE, index * YAMA_FLASH_ERASE_UNIT);
+    }
+    else if (yama_save_take_pending(save_pending_pages, YAMA_FLASH_PAGE_COUNT / 32u, &index))
+    {
+        uint32_t address = index * YAMA_SAVE_PAGE_SIZE;
+        uint32_t unit = yama_flash_sector_start(address) / YAMA_FLASH_ERASE_UNIT;
+        ok = yama_save_append(YAMA_SAVE_TYPE_PAGE, address);
+        if (save_pending_chip_erase ||
+            (__atomic_load_n(&save_pending_erases[unit / 32u], __ATOMIC_SEQ_CST) & (1u << (unit & 31u))) != 0u)
+            __atomic_fetch_or(&save_pending_pages[index / 32u], 1u << (index & 31u), __ATOMIC_SEQ_CST);
+    }
+    else
+    {
+        return false;
+    }
+    if (!ok)
+        debug_trace("YAMA library journal write failed");
+    return true;
+}
+
+// Called by core 1 after each audio buffer. Flushes one record per buffer once
+// the flash command handlers have been quiet for a while, and syncs the
+// journal file when the queue runs dry. A step that took longer than
+// YAMA_SAVE_STEP_BUDGET_US skips the next buffers so the renderer gets ahead
+// of the I2S again.
+static void yama_save_service(void)
+{
+    static uint32_t seen_activity = 0;
+    static uint32_t quiet_buffers = 0;
+    static uint32_t rest_buffers = 0;
+    static bool unsynced = false;
+    static bool stopped = false;
+    if (!library_active || stopped)
+        return;
+
+    uint32_t now_activity = save_activity;
+    if (now_activity != seen_activity)
+    {
+        seen_activity = now_activity;
+        quiet_buffers = 0;
+        return;
+    }
+    if (quiet_buffers < YAMA_SAVE_FLUSH_IDLE_BUFFERS)
+    {
+        ++quiet_buffers;
+        return;
+    }
+    if (rest_buffers != 0u)
+    {
+        --rest_buffers;
+        return;
+    }
+
+    if (save_record_cursor >= YAMA_SAVE_STORAGE_SIZE / YAMA_SAVE_RECORD_SIZE && yama_save_has_pending())
+    {
+        if (!yama_save_compact_muted())
+        {
+            debug_trace("YAMA library journal full, saving stopped");
+            stopped = true;
+        }
+        unsynced = false;
+        return;
+    }
+
+    uint32_t start_us = time_us_32();
+    if (yama_save_flush_step())
+        unsynced = true;
+    else if (unsynced && f_sync(&library_journal) == FR_OK)
+        unsynced = false;
+    uint32_t spent_us = time_us_32() - start_us;
+    if (spent_us > YAMA_SAVE_STEP_BUDGET_US)
+        rest_buffers = spent_us / YAMA_AUDIO_BUFFER_BUDGET_US + 1u;
+}
+
+// Replays one journal record. Returns false when the record ends the journal
+// (blank) or belongs to another ROM image.
+static bool yama_save_apply_record(const uint8_t *record, bool *foreign)
+{
+    const yama_save_record_header_t *header = (const yama_save_record_header_t *)record;
+    if (header->magic == 0xFFFFFFFFu)
+        return false;
+    if (header->magic != YAMA_SAVE_MAGIC || header->rom_signature != flash_rom_signature)
+    {
+        *foreign = true;
+        return false;
+    }
+    if (header->address >= YAMA_FLASH_SIZE)
+        return true;
+    if (header->type == YAMA_SAVE_TYPE_ERASE)
+    {
+        memset(flash_image + yama_flash_sector_start(header->address), 0xFF,
+               yama_flash_sector_size(header->address));
+        yama_flash_mark_dirty_range(yama_flash_sector_start(header->address),
+                                    yama_flash_sector_size(header->address));
+    }
+    else if (header->type == YAMA_SAVE_TYPE_CHIP_ERASE)
+    {
+        memset(flash_image, 0xFF, YAMA_FLASH_SIZE);
+        memset(flash_dirty_pages, 0xFF, sizeof(flash_dirty_pages));
+    }
+    else if (header->type == YAMA_SAVE_TYPE_PAGE && header->address <= YAMA_FLASH_SIZE - YAMA_SAVE_PAGE_SIZE)
+    {
+        memcpy(flash_image + header->address, record + YAMA_SAVE_PAGE_SIZE, YAMA_SAVE_PAGE_SIZE);
+        yama_flash_page_set_dirty(header->address / YAMA_SAVE_PAGE_SIZE);
+    }
+    return true;
+}
+
 static void yama_save_restore(void)
 {
     const uint32_t record_count = YAMA_SAVE_STORAGE_SIZE / YAMA_SAVE_RECORD_SIZE;
@@ -466,46 +696,131 @@ static void yama_save_restore(void)
     save_record_cursor = 0;
     for (; save_record_cursor < record_count; ++save_record_cursor)
     {
-        const yama_save_record_header_t *header = (const yama_save_record_header_t *)(storage + save_record_cursor * YAMA_SAVE_RECORD_SIZE);
-        if (header->magic == 0xFFFFFFFFu)
+        if (!yama_save_apply_record(storage + save_record_cursor * YAMA_SAVE_RECORD_SIZE, &has_foreign_records))
             break;
-        if (header->magic != YAMA_SAVE_MAGIC || header->rom_signature != flash_rom_signature)
-        {
-            has_foreign_records = true;
+    }
+    // Pages replayed before a foreign record are dropped with the journal.
+    if (has_foreign_records)
+        memset(flash_dirty_pages, 0, sizeof(flash_dirty_pages));
+    if (has_foreign_records && yama_save_erase_storage())
+        save_record_cursor = 0;
+}
+
+// Streams an SD image into PSRAM. Returns its size, or 0 when it is missing,
+// unreadable or outside the supported size range.
+static uint32_t yama_library_read_image(const char *path)
+{
+    FIL image;
+    if (f_open(&image, path, FA_READ) != FR_OK)
+    {
+        debug_trace("YAMA library image %s not found", path);
+        return 0u;
+    }
+    FSIZE_t image_size = f_size(&image);
+    bool ok = image_size >= YAMA_LIBRARY_MIN_SIZE && image_size <= YAMA_FLASH_SIZE;
+    for (uint32_t address = 0; ok && address < image_size; address += YAMA_LIBRARY_CHUNK_SIZE)
+    {
+        UINT length = (UINT)(image_size - address);
+        if (length > YAMA_LIBRARY_CHUNK_SIZE)
+            length = YAMA_LIBRARY_CHUNK_SIZE;
+        UINT read = 0;
+        ok = f_read(&image, flash_image + address, length, &read) == FR_OK && read == length;
+    }
+    f_close(&image);
+    if (!ok)
+    {
+        debug_trace("YAMA library image %s unusable size=%lu", path, (unsigned long)image_size);
+        return 0u;
+    }
+    return (uint32_t)image_size;
+}
+
+// Per-image journal on microSD: the same records as the board-flash journal,
+// appended to /yamanooto/saves/<image>.ysv. A journal left over from another
+// image with the same file name is discarded.
+static void yama_library_restore(void)
+{
+    static uint8_t record[YAMA_SAVE_RECORD_SIZE];
+    const uint32_t record_count = YAMA_SAVE_STORAGE_SIZE / YAMA_SAVE_RECORD_SIZE;
+    bool has_foreign_records = false;
+    save_record_cursor = 0;
+    for (; save_record_cursor < record_count; ++save_record_cursor)
+    {
+        UINT read = 0;
+        if (f_read(&library_journal, record, sizeof(record), &read) != FR_OK || read != sizeof(record))
+            break;
+        if (!yama_save_apply_record(record, &has_foreign_records))
             break;
-        }
-        if (header->address >= YAMA_FLASH_SIZE)
-            continue;
-        if (header->type == YAMA_SAVE_TYPE_ERASE)
-        {
-            memset(flash_image + yama_flash_sector_start(header->address), 0xFF,
-                   yama_flash_sector_size(header->address));
-            yama_flash_mark_dirty_range(yama_flash_sector_start(header->address),
-                                        yama_flash_sector_size(header->address));
-        }
-        else if (header->type == YAMA_SAVE_TYPE_CHIP_ERASE)
-        {
-            memset(flash_image, 0xFF, YAMA_FLASH_SIZE);
-            memset(flash_dirty_pages, 0xFF, sizeof(flash_dirty_pages));
-        }
-        else if (header->type == YAMA_SAVE_TYPE_PAGE && header->address <= YAMA_FLASH_SIZE - YAMA_SAVE_PAGE_SIZE)
-        {
-            memcpy(flash_image + header->address, storage + save_record_cursor * YAMA_SAVE_RECORD_SIZE + YAMA_SAVE_PAGE_SIZE,
-                   YAMA_SAVE_PAGE_SIZE);
-            yama_flash_page_set_dirty(header->address / YAMA_SAVE_PAGE_SIZE);
-        }
     }
+    // Drop a torn or foreign tail so new records append to a clean journal.
+    // Records replayed before a foreign one have already modified the PSRAM
+    // copy, so a foreign journal also reloads the image from the card.
     if (has_foreign_records)
     {
-        yama_flash_storage_op_t op = {
-            .offset = YAMA_SAVE_STORAGE_OFFSET,
-            .data = NULL,
-            .length = YAMA_SAVE_STORAGE_SIZE,
-            .erase = true,
-        };
-        if (yama_flash_storage_execute(&op, 10000u))
-            save_record_cursor = 0;
+        save_record_cursor = 0;
+        memset(flash_dirty_pages, 0, sizeof(flash_dirty_pages));
+        if (yama_library_read_image(library_image_path) != active_rom_size)
+            debug_trace("YAMA library image %s reload failed", library_image_path);
     }
+    if (f_lseek(&library_journal, (FSIZE_t)save_record_cursor * YAMA_SAVE_RECORD_SIZE) == FR_OK)
+        f_truncate(&library_journal);
+}
+
+// Reads the image name from select.txt: the first line, without surrounding
+// blanks. Returns false when no library image is selected.
+static bool yama_library_selection(char *name, size_t name_size)
+{
+    FIL select;
+    if (f_open(&select, YAMA_LIBRARY_SELECT_PATH, FA_READ) != FR_OK)
+        return false;
+    UINT read = 0;
+    FRESULT fr = f_read(&select, name, (UINT)(name_size - 1u), &read);
+    f_close(&select);
+    if (fr != FR_OK)
+        return false;
+    name[read] = '\0';
+
+    char *start = name;
+    while (*start == ' ' || *start == '\t')
+        ++start;
+    size_t length = strcspn(start, "\r\n");
+    while (length > 0u && (start[length - 1u] == ' ' || start[length - 1u] == '\t'))
+        --length;
+    memmove(name, start, length);
+    name[length] = '\0';
+    return length != 0u;
+}
+
+// Streams the selected SD image into PSRAM and opens its journal. On any
+// failure the embedded ROM stays active with the board-flash journal.
+static bool yama_library_load(void)
+{
+    char name[YAMA_LIBRARY_NAME_MAX];
+    char path[YAMA_LIBRARY_PATH_MAX];
+    if (!yama_sd_mount() || !yama_library_selection(name, sizeof(name)))
+        return false;
+
+    snprintf(library_image_path, sizeof(library_image_path), YAMA_LIBRARY_IMAGE_DIR "/%s", name);
+    uint32_t image_size = yama_library_read_image(library_image_path);
+    if (image_size == 0u)
+        return false;
+
+    FRESULT fr = f_mkdir(YAMA_SD_DIR);
+    if (fr == FR_OK || fr == FR_EXIST)
+        fr = f_mkdir(YAMA_LIBRARY_SAVE_DIR);
+    snprintf(path, sizeof(path), YAMA_LIBRARY_SAVE_DIR "/%s.ysv", name);
+    if ((fr != FR_OK && fr != FR_EXIST) ||
+        f_open(&library_journal, path, FA_READ | FA_WRITE | FA_OPEN_ALWAYS) != FR_OK)
+    {
+        debug_trace("YAMA library journal %s unavailable", path);
+        return false;
+    }
+
+    rom_base = flash_image;
+    active_rom_size = image_size;
+    library_active = true;
+    debug_trace("YAMA library image %s size=%lu", name, (unsigned long)active_rom_size);
+    return true;
 }
 
 static bool yama_flash_init(void)
@@ -514,11 +829,141 @@ static bool yama_flash_init(void)
         return false;
     flash_image = (uint8_t *)YAMA_PSRAM_BASE;
     memset(flash_dirty_pages, 0, sizeof(flash_dirty_pages));
+    bool from_library = yama_library_load();
     flash_rom_signature = yama_rom_signature();
-    yama_save_restore();
+    if (from_library)
+        yama_library_restore();
+    else
+        yama_save_restore();
     return true;
 }
 
+// -----------------------------------------------------------------------
+// microSD flash-image export
+// -----------------------------------------------------------------------
+// At boot, once the journal has been replayed, the modified image is copied
+// to microSD so it can be re-imported by the PC tool:
+//   * /yamanooto/<signature>.ymd - compact delta of every page that differs
+//     from the original ROM, rewritten whenever such pages exist;
+//   * /yamanooto/<signature>.rom - the whole materialised image, written only
+//     when /yamanooto/export.req exists (the request file is then removed).
+// The export runs before the bus loop starts, so the MSX simply waits on
+// /WAIT as it does during the journal replay.
+#define YAMA_EXPORT_REQUEST_PATH    YAMA_SD_DIR "/export.req"
+#define YAMA_EXPORT_DELTA_MAGIC     0x44414D59u  // "YMAD"
+#define YAMA_EXPORT_CHUNK_SIZE      4096u
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t rom_signature;
+    uint32_t rom_size;
+    uint32_t page_count;
+} yama_export_delta_header_t;
+
+static FIL export_file;
+static uint8_t export_chunk[YAMA_EXPORT_CHUNK_SIZE];
+
+// Current content of one flash byte as the MSX would read it in read mode.
+static uint8_t yama_export_byte(uint32_t address)
+{
+    if (yama_flash_page_is_dirty(address / YAMA_SAVE_PAGE_SIZE))
+        return flash_image[address];
+    return address < active_rom_size ? rom_base[address] : 0xFFu;
+}
+
+static bool yama_export_write(const void *data, UINT length)
+{
+    UINT written = 0;
+    return f_write(&export_file, data, length, &written) == FR_OK && written == length;
+}
+
+static bool yama_export_delta(const char *path, uint32_t page_count)
+{
+    if (f_open(&export_file, path, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+        return false;
+
+    yama_export_delta_header_t header = {
+        .magic = YAMA_EXPORT_DELTA_MAGIC,
+        .rom_signature = flash_rom_signature,
+        .rom_size = active_rom_size,
+        .page_count = page_count,
+    };
+    bool ok = yama_export_write(&header, sizeof(header));
+    for (uint32_t page = 0; ok && page < YAMA_FLASH_SIZE; page += YAMA_SAVE_PAGE_SIZE)
+    {
+        if (!yama_flash_page_differs_from_initial(page))
+            continue;
+        ok = yama_export_write(&page, sizeof(page)) &&
+             yama_export_write(flash_image + page, YAMA_SAVE_PAGE_SIZE);
+    }
+    return f_close(&export_file) == FR_OK && ok;
+}
+
+static bool yama_export_image(const char *path, uint32_t image_size)
+{
+    if (f_open(&export_file, path, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+        return false;
+
+    bool ok = true;
+    for (uint32_t address = 0; ok && address < image_size; address += YAMA_EXPORT_CHUNK_SIZE)
+    {
+        uint32_t length = image_size - address;
+        if (length > YAMA_EXPORT_CHUNK_SIZE)
+            length = YAMA_EXPORT_CHUNK_SIZE;
+        for (uint32_t index = 0; index < length; ++index)
+            export_chunk[index] = yama_export_byte(address + index);
+        ok = yama_export_write(export_chunk, length);
+    }
+    return f_close(&export_file) == FR_OK && ok;
+}
+
+static void yama_export_to_sd(void)
+{
+    if (!flash_image)
+        return;
+
+    // The exported image covers the original ROM plus any page programmed
+    // beyond it; everything past that reads back as erased flash.
+    uint32_t page_count = 0;
+    uint32_t image_size = active_rom_size;
+    for (uint32_t page = 0; page < YAMA_FLASH_SIZE; page += YAMA_SAVE_PAGE_SIZE)
+    {
+        if (!yama_flash_page_differs_from_initial(page))
+            continue;
+        ++page_count;
+        if (page + YAMA_SAVE_PAGE_SIZE > image_size)
+            image_size = page + YAMA_SAVE_PAGE_SIZE;
+    }
+
+    if (!yama_sd_mount())
+        return;
+
+    FILINFO request;
+    bool image_requested = f_stat(YAMA_EXPORT_REQUEST_PATH, &request) == FR_OK;
+    if (page_count != 0u || image_requested)
+    {
+        FRESULT fr = f_mkdir(YAMA_SD_DIR);
+        if (fr == FR_OK || fr == FR_EXIST)
+        {
+            char path[32];
+            if (page_count != 0u)
+            {
+                snprintf(path, sizeof(path), YAMA_SD_DIR "/%08lX.ymd", (unsigned long)flash_rom_signature);
+                bool ok = yama_export_delta(path, page_count);
+                debug_trace("YAMA export delta %s pages=%lu %s", path, (unsigned long)page_count, ok ? "ok" : "failed");
+            }
+            if (image_requested)
+            {
+                snprintf(path, sizeof(path), YAMA_SD_DIR "/%08lX.rom", (unsigned long)flash_rom_signature);
+                bool ok = yama_export_image(path, image_size);
+                debug_trace("YAMA export image %s size=%lu %s", path, (unsigned long)image_size, ok ? "ok" : "failed");
+                if (ok)
+                    f_unlink(YAMA_EXPORT_REQUEST_PATH);
+            }
+        }
+    }
+}
+
 // -----------------------------------------------------------------------
 // PIO bus initialisation (memory reads/writes on PIO0)
 // -----------------------------------------------------------------------
@@ -713,7 +1158,7 @@ static void __not_in_flash_func(yama_flash_materialize_page)(uint32_t faddr)
 
     uint32_t available = page_address < active_rom_size ? active_rom_size - page_address : 0u;
     uint32_t copy_size = available < YAMA_SAVE_PAGE_SIZE ? available : YAMA_SAVE_PAGE_SIZE;
-    if (copy_size != 0u)
+    if (copy_size != 0u && rom_base != flash_image)
         memcpy(flash_image + page_address, rom_base + page_address, copy_size);
     if (copy_size < YAMA_SAVE_PAGE_SIZE)
         memset(flash_image + page_address + copy_size, 0xFFu, YAMA_SAVE_PAGE_SIZE - copy_size);
@@ -815,13 +1260,39 @@ static inline bool __not_in_flash_func(yama_flash_unlock_2)(uint32_t faddr)
     return faddr == 0x0555u || faddr == 0x02AAu;
 }
 
+// Journals a flash change. The board-flash journal is written in place; the
+// SD journal is only queued here and written by core 1 (yama_save_service).
+static void __not_in_flash_func(yama_save_queue)(uint8_t type, uint32_t address)
+{
+    if (!library_active)
+    {
+        (void)yama_save_append(type, address);
+        return;
+    }
+    if (type == YAMA_SAVE_TYPE_PAGE)
+    {
+        uint32_t page = address / YAMA_SAVE_PAGE_SIZE;
+        __atomic_fetch_or(&save_pending_pages[page / 32u], 1u << (page & 31u), __ATOMIC_SEQ_CST);
+    }
+    else if (type == YAMA_SAVE_TYPE_ERASE)
+    {
+        uint32_t unit = address / YAMA_FLASH_ERASE_UNIT;
+        __atomic_fetch_or(&save_pending_erases[unit / 32u], 1u << (unit & 31u), __ATOMIC_SEQ_CST);
+    }
+    else
+    {
+        __atomic_store_n(&save_pending_chip_erase, true, __ATOMIC_SEQ_CST);
+    }
+    save_activity++;
+}
+
 static void __not_in_flash_func(yama_flash_program)(uint32_t faddr, uint8_t data)
 {
     if (!flash_image || faddr >= YAMA_FLASH_SIZE)
         return;
     yama_flash_materialize_page(faddr);
     flash_image[faddr] &= data;  // NOR flash can only change 1 bits to 0.
-    (void)yama_save_append(YAMA_SAVE_TYPE_PAGE, faddr & ~(YAMA_SAVE_PAGE_SIZE - 1u));
+    yama_save_queue(YAMA_SAVE_TYPE_PAGE, faddr & ~(YAMA_SAVE_PAGE_SIZE - 1u));
 }
 
 static void __not_in_flash_func(yama_flash_erase_sector)(uint32_t faddr)
@@ -831,7 +1302,7 @@ static void __not_in_flash_func(yama_flash_erase_sector)(uint32_t faddr)
     uint32_t sector = yama_flash_sector_start(faddr);
     memset(flash_image + sector, 0xFF, yama_flash_sector_size(faddr));
     yama_flash_mark_dirty_range(sector, yama_flash_sector_size(faddr));
-    (void)yama_save_append(YAMA_SAVE_TYPE_ERASE, sector);
+    yama_save_queue(YAMA_SAVE_TYPE_ERASE, sector);
 }
 
 static void __not_in_flash_func(yama_flash_erase_chip)(void)
@@ -840,7 +1311,7 @@ static void __not_in_flash_func(yama_flash_erase_chip)(void)
         return;
     memset(flash_image, 0xFF, YAMA_FLASH_SIZE);
     memset(flash_dirty_pages, 0xFF, sizeof(flash_dirty_pages));
-    (void)yama_save_append(YAMA_SAVE_TYPE_CHIP_ERASE, 0u);
+    yama_save_queue(YAMA_SAVE_TYPE_CHIP_ERASE, 0u);
 }
 
 static void __not_in_flash_func(yama_flash_program_buffer)(void)
@@ -852,7 +1323,7 @@ static void __not_in_flash_func(yama_flash_program_buffer)(void)
         yama_flash_materialize_page(flash_buffer_page + index);
         flash_image[flash_buffer_page + index] &= flash_buffer[index];
     }
-    (void)yama_save_append(YAMA_SAVE_TYPE_PAGE, flash_buffer_page & ~(YAMA_SAVE_PAGE_SIZE - 1u));
+    yama_save_queue(YAMA_SAVE_TYPE_PAGE, flash_buffer_page & ~(YAMA_SAVE_PAGE_SIZE - 1u));
 }
 
 static void __not_in_flash_func(yama_flash_write)(uint32_t faddr, uint8_t data)
@@ -1547,7 +2018,7 @@ static void i2s_audio_init(void)
         .sample_stride = 4,  // 2 channels * 2 bytes
     };
 
-    audio_pool = audio_new_producer_pool(&producer_format, 3, SCC_AUDIO_BUFFER_SAMPLES);
+    audio_pool = audio_new_producer_pool(&producer_format, YAMA_AUDIO_POOL_BUFFERS, SCC_AUDIO_BUFFER_SAMPLES);
 
     if (audio_dma_channel < 0)
     {
@@ -1592,6 +2063,23 @@ static inline struct audio_buffer *__not_in_flash_func(take_audio_buffer_servici
     }
 }
 
+// Core 1, library mode: compacts a full save journal. That rewrites every
+// changed page, seconds of SD I/O, so the whole pool is queued as silence
+// first; once it has played, the I2S driver repeats its own silence buffer
+// until rendering resumes. The game hears a gap, not an underrun.
+static bool yama_save_compact_muted(void)
+{
+    for (uint32_t index = 0; index < YAMA_AUDIO_POOL_BUFFERS; ++index)
+    {
+        struct audio_buffer *buffer = take_audio_buffer_servicing_psg();
+        memset(buffer->buffer->bytes, 0, buffer->buffer->size);
+        buffer->sample_count = SCC_AUDIO_BUFFER_SAMPLES;
+        give_audio_buffer(audio_pool, buffer);
+    }
+    debug_trace("YAMA library journal full, compacting with audio muted");
+    return yama_save_compact() && f_sync(&library_journal) == FR_OK;
+}
+
 static void __no_inline_not_in_flash_func(core1_yamanooto_audio)(void)
 {
     flash_safe_execute_core_init();
@@ -1717,6 +2205,9 @@ static void __no_inline_not_in_flash_func(core1_yamanooto_audio)(void)
 #endif
         buffer->sample_count = SCC_AUDIO_BUFFER_SAMPLES;
         give_audio_buffer(audio_pool, buffer);
+
+        // Library-mode saves reach the SD card from here, never from the bus loop.
+        yama_save_service();
     }
 }
 
@@ -1934,6 +2425,7 @@ static void __no_inline_not_in_flash_func(yamanooto_run_fmpac)(void)
     // the PSRAM bring-up and ROM copy until its forced restart is held on WAIT.
     if (!yama_flash_init())
         debug_trace("YAMA PSRAM unavailable; flash save support disabled");
+    yama_export_to_sd();
 
     static fmpac_state_t fmpac;
     memset(&fmpac, 0, sizeof(fmpac));
@@ -2049,6 +2541,7 @@ static void __no_inline_not_in_flash_func(yamanooto_run_simple)(void)
 #if !YAMANOOTO_USB_STDIO_DEBUG
     if (!yama_flash_init())
         debug_trace("YAMA PSRAM unavailable; flash save support disabled");
+    yama_export_to_sd();
 #else
     debug_trace("YAMA debug plain mode: PSRAM save support skipped");
 #endif
@@ -17,6 +17,12 @@
 //   size   - Size of the ROM in bytes           - 04 bytes
 //   offset - Reserved (0)                        - 04 bytes
 //
+// A flash-image delta (.ymd) exported by the firmware to microSD can be applied
+// on top of the original ROM with -d, carrying game saves into the new UF2.
+// The delta starts with a 16-byte header (magic "YMAD", ROM signature, ROM size,
+// page count) followed by one record per page: a 32-bit flash address and the
+// 256 bytes of that page.
+//
 // This work is licensed under a "Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
 // License". https://creativecommons.org/licenses/by-nc-sa/4.0/
 
@@ -43,6 +49,9 @@
 #define YAMANOOTO_ROM_TYPE        1                       // Fixed cartridge type (informational)
 #define YAMANOOTO_MSX_MUSIC_FLAG  0x20u                   // 'type' byte flag: expanded slot + FM-PAC (YM2413)
 #define CONFIG_RECORD_SIZE        (MAX_FILE_NAME_LENGTH + 1 + sizeof(uint32_t) + sizeof(uint32_t))
+#define DELTA_MAGIC               0x44414D59UL           // "YMAD" flash-image delta exported by the firmware
+#define DELTA_HEADER_SIZE         16                     // magic + signature + ROM size + page count
+#define DELTA_PAGE_SIZE           256                    // flash page carried by each delta record
 
 static uint32_t file_size(const char *filename)
 {
@@ -77,6 +86,100 @@ static void derive_rom_name(const char *path, char *out, size_t out_size)
     out[len] = '\0';
 }
 
+static uint32_t read_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Same FNV-1a based signature the firmware uses to tie saves to a ROM image.
+static uint32_t rom_signature(const uint8_t *data, uint32_t size)
+{
+    uint32_t hash = 2166136261u;
+    for (uint32_t index = 0; index < size; ++index)
+        hash = (hash ^ data[index]) * 16777619u;
+    return hash ^ size;
+}
+
+// Load the ROM and apply a firmware-exported delta on top of it. The image may
+// grow when pages were programmed past the end of the original ROM.
+static uint8_t *load_rom_with_delta(const char *rom_filename, uint32_t *rom_size,
+                                    const char *delta_filename)
+{
+    uint8_t *image = malloc(MAX_ROM_SIZE);
+    if (!image)
+    {
+        printf("Out of memory loading the ROM image.\n");
+        return NULL;
+    }
+    memset(image, 0xFF, MAX_ROM_SIZE);
+
+    FILE *rom_file = fopen(rom_filename, "rb");
+    if (!rom_file || fread(image, 1, *rom_size, rom_file) != *rom_size)
+    {
+        printf("Failed to read ROM file: %s\n", rom_filename);
+        if (rom_file)
+            fclose(rom_file);
+        free(image);
+        return NULL;
+    }
+    fclose(rom_file);
+
+    FILE *delta_file = fopen(delta_filename, "rb");
+    if (!delta_file)
+    {
+        printf("Failed to open delta file: %s\n", delta_filename);
+        free(image);
+        return NULL;
+    }
+
+    uint8_t header[DELTA_HEADER_SIZE];
+    uint8_t record[sizeof(uint32_t) + DELTA_PAGE_SIZE];
+    uint32_t image_size = *rom_size;
+    bool ok = false;
+
+    if (fread(header, 1, sizeof(header), delta_file) != sizeof(header) || read_le32(header) != DELTA_MAGIC)
+    {
+        printf("Delta file is not a Yamanooto flash-image delta: %s\n", delta_filename);
+        goto done;
+    }
+    if (read_le32(header + 8) != *rom_size || read_le32(header + 4) != rom_signature(image, *rom_size))
+    {
+        printf("Delta file was exported from a different ROM image.\n");
+        goto done;
+    }
+
+    uint32_t page_count = read_le32(header + 12);
+    for (uint32_t page = 0; page < page_count; ++page)
+    {
+        if (fread(record, 1, sizeof(record), delta_file) != sizeof(record))
+        {
+            printf("Delta file is truncated at page %u of %u.\n", page, page_count);
+            goto done;
+        }
+        uint32_t address = read_le32(record);
+        if ((address % DELTA_PAGE_SIZE) != 0 || address > MAX_ROM_SIZE - DELTA_PAGE_SIZE)
+        {
+            printf("Delta file holds an invalid page address 0x%06X.\n", address);
+            goto done;
+        }
+        memcpy(image + address, record + sizeof(uint32_t), DELTA_PAGE_SIZE);
+        if (address + DELTA_PAGE_SIZE > image_size)
+            image_size = address + DELTA_PAGE_SIZE;
+    }
+    printf("Delta: %u modified page(s) applied from %s\n", page_count, delta_filename);
+    ok = true;
+
+done:
+    fclose(delta_file);
+    if (!ok)
+    {
+        free(image);
+        return NULL;
+    }
+    *rom_size = image_size;
+    return image;
+}
+
 static void print_usage(const char *prog)
 {
     printf("Usage: %s [options] <rom_file>\n\n", prog);
@@ -86,14 +189,18 @@ static void print_usage(const char *prog)
     printf("  -f, --fmpac           Enable the FM-PAC BIOS: present the cartridge as an\n");
     printf("                        expanded slot with the MSX-MUSIC (YM2413) BIOS in\n");
     printf("                        sub-slot 3. \n");
+    printf("  -d, --delta <file>    Apply a flash-image delta (.ymd) exported by the\n");
+    printf("                        firmware to microSD on top of the ROM image\n");
     printf("  -h, --help            Show this help message\n\n");
     printf("The ROM image must be a Konami-SCC / Konami-4 compatible image up to 8 MB.\n");
     printf("By default the cartridge is a plain slot with SCC/SCC+, FMPAC I/O and dual PSG only.\n");
     printf("Use --fmpac to add FMPAC BIOS; the firmware then selects SCC or FM on the fly.\n");
+    printf("A full image exported by the firmware (.rom) can be used directly as the ROM file.\n");
 }
 
 // Build the UF2 file: firmware + config record + ROM image + FM-PAC BIOS.
-static int create_uf2_file(const char *rom_filename, uint32_t rom_size,
+// The ROM is streamed from rom_filename unless rom_image already holds it.
+static int create_uf2_file(const char *rom_filename, const uint8_t *rom_image, uint32_t rom_size,
                            const char *rom_name, const char *uf2_filename,
                            uint8_t type_flags)
 {
@@ -120,18 +227,23 @@ static int create_uf2_file(const char *rom_filename, uint32_t rom_size,
     cursor += sizeof(rom_size);
     memcpy(config_record + cursor, &base_offset, sizeof(base_offset));
 
-    FILE *rom_file = fopen(rom_filename, "rb");
-    if (!rom_file)
+    FILE *rom_file = NULL;
+    if (!rom_image)
     {
-        perror("Failed to open ROM file for UF2 creation");
-        return 1;
+        rom_file = fopen(rom_filename, "rb");
+        if (!rom_file)
+        {
+            perror("Failed to open ROM file for UF2 creation");
+            return 1;
+        }
     }
 
     FILE *uf2_file = fopen(uf2_filename, "wb");
     if (!uf2_file)
     {
         perror("Failed to create UF2 file");
-        fclose(rom_file);
+        if (rom_file)
+            fclose(rom_file);
         return 1;
     }
 
@@ -184,7 +296,11 @@ static int create_uf2_file(const char *rom_filename, uint32_t rom_size,
             {
                 size_t remaining = (size_t)rom_size - rom_bytes_written;
                 size_t request = remaining < space ? remaining : space;
-                size_t read_now = fread(bl.data + chunk_filled, 1, request, rom_file);
+                size_t read_now = request;
+                if (rom_image)
+                    memcpy(bl.data + chunk_filled, rom_image + rom_bytes_written, request);
+                else
+                    read_now = fread(bl.data + chunk_filled, 1, request, rom_file);
                 if (read_now != request)
                 {
                     printf("Failed to read ROM data while building UF2 file.\n");
@@ -219,7 +335,8 @@ static int create_uf2_file(const char *rom_filename, uint32_t rom_size,
     success = true;
 
 cleanup:
-    fclose(rom_file);
+    if (rom_file)
+        fclose(rom_file);
     fclose(uf2_file);
 
     if (success)
@@ -237,6 +354,7 @@ int main(int argc, char *argv[])
 
     const char *output_filename = UF2FILENAME;
     const char *rom_filename = NULL;
+    const char *delta_filename = NULL;
     uint8_t type_flags = 0;
 
     for (int i = 1; i < argc; ++i)
@@ -259,6 +377,15 @@ int main(int argc, char *argv[])
         {
             type_flags |= YAMANOOTO_MSX_MUSIC_FLAG;
         }
+        else if ((strcmp(argv[i], "-d") == 0) || (strcmp(argv[i], "--delta") == 0))
+        {
+            if (i + 1 >= argc)
+            {
+                printf("Option -d/--delta requires a filename.\n");
+                return 1;
+            }
+            delta_filename = argv[++i];
+        }
         else if (argv[i][0] == '-')
         {
             printf("Unknown option: %s\n", argv[i]);
@@ -318,5 +445,15 @@ int main(int argc, char *argv[])
     }
     printf("UF2 Output: %s\n", output_filename);
 
-    return create_uf2_file(rom_filename, rom_size, rom_name, output_filename, type_flags);
+    uint8_t *rom_image = NULL;
+    if (delta_filename)
+    {
+        rom_image = load_rom_with_delta(rom_filename, &rom_size, delta_filename);
+        if (!rom_image)
+            return 1;
+    }
+
+    int result = create_uf2_file(rom_filename, rom_image, rom_size, rom_name, output_filename, type_flags);
+    free(rom_image);
+    return result;
 }
@@ -0,0 +1,195 @@
+// MSX PICOVERSE PROJECT
+// (c) 2026 Cristiano Goncalves
+// The Retro Hacker
+//
+// mapper_auto.h - Runtime Konami/ASCII megaROM mapper inference.
+//
+// This header is shared between the Explorer Pico firmware (MAPPER_AUTO
+// launches, see mapper_auto_loop() in explorer.c) and the mapper_bench tool,
+// which replays recorded bank-write traces through it with --self-test. Both
+// include this one copy from common/ by relative path.
+//
+// Konami, Konami SCC, ASCII8 and ASCII16 images cannot always be told apart
+// from their contents, but the game tells us as soon as it switches banks.
+// Every candidate keeps its own bank registers, updated from reset by each
+// write it would decode, so the reads can be served by whichever candidate
+// currently leads without any state to rebuild when the lead changes. A
+// write scores for a candidate when it hits one of its bank registers; it
+// scores against it when it would page out the window the Z80 is executing
+// from (the last read address) or select a bank beyond the end of the image.
+//
+// ASCII8 decodes every address ASCII16 does (0x6000-0x67FF, 0x7000-0x77FF),
+// so an ASCII16 game scores the same for both. ASCII8 only gets credit for
+// those shared hits once the game has also written one of the registers
+// ASCII16 lacks (0x6800-0x6FFF, 0x7800-0x7FFF); such a write also counts
+// against ASCII16, which would ignore it.
+//
+// Once one candidate is clearly ahead, or after MAPPER_AUTO_LOCK_WRITES
+// scored writes, the caller hands its registers to that mapper's regular
+// loop.
+//
+// This work is licensed  under a "Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License".
+// https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+#ifndef MAPPER_AUTO_H
+#define MAPPER_AUTO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "mapper_detect.h"
+
+// The firmware forces these into its RAM-resident write handler.
+#ifndef MAPPER_AUTO_INLINE
+#define MAPPER_AUTO_INLINE static inline
+#endif
+
+#define MAPPER_AUTO_CANDIDATES   4u
+#define MAPPER_AUTO_LOCK_WRITES  256u
+#define MAPPER_AUTO_LOCK_MARGIN  24
+#define MAPPER_AUTO_HIT          2
+#define MAPPER_AUTO_SELF_SWITCH  5
+#define MAPPER_AUTO_OUT_OF_RANGE 1
+#define MAPPER_AUTO_IGNORED      2  // ASCII16, for a write only ASCII8 decodes
+
+typedef struct {
+    uint8_t mapper;     // MAPPER_DETECT_* code this candidate stands for
+    uint8_t regs[4];    // 8 KB bank registers (ASCII16 uses regs[0..1] as 16 KB banks)
+    uint32_t blocks;    // image size in the candidate's bank units
+    int32_t score;
+} mapper_auto_candidate_t;
+
+typedef struct {
+    mapper_auto_candidate_t cand[MAPPER_AUTO_CANDIDATES];
+    uint8_t active;         // candidate currently serving reads
+    uint16_t last_read;
+    uint32_t writes;        // scored bank-register writes
+    uint32_t ascii8_shared; // ASCII8 hits on registers ASCII16 also has
+    bool ascii8_own;        // a register only ASCII8 has was written
+    bool locked;
+} mapper_auto_ctx_t;
+
+// Candidate order doubles as the tie-break: the first entry is the
+// provisional mapper used until a write tells the candidates apart.
+static const uint8_t mapper_auto_order[MAPPER_AUTO_CANDIDATES] = {
+    MAPPER_DETECT_KONAMI_SCC, MAPPER_DETECT_ASCII16, MAPPER_DETECT_ASCII8, MAPPER_DETECT_KONAMI
+};
+
+// Bank register a write decodes to for the given mapper, or -1. The ranges
+// match the handle_*_write() decoders used by the firmware's regular loops.
+MAPPER_AUTO_INLINE int mapper_auto_register(uint8_t mapper, uint16_t addr)
+{
+    switch (mapper)
+    {
+        case MAPPER_DETECT_KONAMI_SCC:
+            if ((addr & 0x1800u) == 0x1000u) return (int)((addr - 0x4000u) >> 13); // x000-x7FF, x = 5/7/9/B
+            return -1;
+        case MAPPER_DETECT_KONAMI:
+            if (addr >= 0x6000u && (addr & 0x1800u) == 0u) return (int)((addr - 0x4000u) >> 13); // 6000/8000/A000-x7FF
+            return -1;
+        case MAPPER_DETECT_ASCII8:
+            if (addr >= 0x6000u && addr <= 0x7FFFu) return (int)((addr >> 11) & 0x03u);
+            return -1;
+        case MAPPER_DETECT_ASCII16:
+            if (addr >= 0x6000u && addr <= 0x67FFu) return 0;
+            if (addr >= 0x7000u && addr <= 0x77FFu) return 1;
+            return -1;
+    }
+    return -1;
+}
+
+MAPPER_AUTO_INLINE bool mapper_auto_window_hit(uint8_t mapper, int reg, uint16_t addr)
+{
+    uint32_t size = (mapper == MAPPER_DETECT_ASCII16) ? 0x4000u : 0x2000u;
+    uint32_t base = 0x4000u + (uint32_t)reg * size;
+    return addr >= base && addr < (base + size);
+}
+
+// Score used to rank a candidate (see the ASCII8/ASCII16 note above).
+MAPPER_AUTO_INLINE int32_t mapper_auto_rank(const mapper_auto_ctx_t *a, uint32_t i)
+{
+    const mapper_auto_candidate_t *c = &a->cand[i];
+    if (c->mapper == MAPPER_DETECT_ASCII8 && !a->ascii8_own)
+        return c->score - (int32_t)a->ascii8_shared * MAPPER_AUTO_HIT;
+    return c->score;
+}
+
+// Feed one Z80 write. last_read must hold the address of the latest ROM read.
+MAPPER_AUTO_INLINE void mapper_auto_write(mapper_auto_ctx_t *a, uint16_t addr, uint8_t data)
+{
+    if (addr < 0x4000u || addr > 0xBFFFu) return;
+
+    bool scored = false;
+    bool ascii16_reg = mapper_auto_register(MAPPER_DETECT_ASCII16, addr) >= 0;
+    for (uint32_t i = 0; i < MAPPER_AUTO_CANDIDATES; i++)
+    {
+        mapper_auto_candidate_t *c = &a->cand[i];
+        int reg = mapper_auto_register(c->mapper, addr);
+        if (reg < 0) continue;
+
+        int32_t delta = MAPPER_AUTO_HIT;
+        if (data != c->regs[reg] && mapper_auto_window_hit(c->mapper, reg, a->last_read))
+            delta -= MAPPER_AUTO_SELF_SWITCH;
+        // Konami SCC enables its sound chip with 3Fh in the 9000h register.
+        bool scc_enable = (c->mapper == MAPPER_DETECT_KONAMI_SCC && reg == 2 && (data & 0x3Fu) == 0x3Fu);
+        if (c->blocks != 0u && data >= c->blocks && !scc_enable)
+            delta -= MAPPER_AUTO_OUT_OF_RANGE;
+        if (c->mapper == MAPPER_DETECT_ASCII8)
+        {
+            if (ascii16_reg) a->ascii8_shared++;
+            else a->ascii8_own = true;
+        }
+        c->score += delta;
+        c->regs[reg] = data;
+        scored = true;
+    }
+    if (!scored) return;
+    if (!ascii16_reg && addr >= 0x6000u && addr <= 0x7FFFu)
+    {
+        for (uint32_t i = 0; i < MAPPER_AUTO_CANDIDATES; i++)
+        {
+            if (a->cand[i].mapper == MAPPER_DETECT_ASCII16) a->cand[i].score -= MAPPER_AUTO_IGNORED;
+        }
+    }
+    a->writes++;
+
+    uint8_t best = 0;
+    int32_t best_rank = mapper_auto_rank(a, 0);
+    int32_t second = INT32_MIN;
+    for (uint8_t i = 1; i < MAPPER_AUTO_CANDIDATES; i++)
+    {
+        int32_t rank = mapper_auto_rank(a, i);
+        if (rank > best_rank) {
+            second = best_rank;
+            best = i;
+            best_rank = rank;
+        } else if (rank > second) {
+            second = rank;
+        }
+    }
+    a->active = best;
+    if (a->writes >= MAPPER_AUTO_LOCK_WRITES || (best_rank - second) >= MAPPER_AUTO_LOCK_MARGIN)
+        a->locked = true;
+}
+
+// Reset for an image of available_length bytes (0 = unknown size).
+static inline void mapper_auto_init(mapper_auto_ctx_t *a, uint32_t available_length)
+{
+    memset(a, 0, sizeof(*a));
+    for (uint32_t i = 0; i < MAPPER_AUTO_CANDIDATES; i++)
+    {
+        mapper_auto_candidate_t *c = &a->cand[i];
+        c->mapper = mapper_auto_order[i];
+        bool is16 = (c->mapper == MAPPER_DETECT_ASCII16);
+        c->blocks = is16 ? ((available_length + 0x3FFFu) >> 14) : ((available_length + 0x1FFFu) >> 13);
+        // Power-on layouts of the regular loops (ASCII8 maps block 0 everywhere).
+        if (c->mapper != MAPPER_DETECT_ASCII8) {
+            for (uint8_t r = 0; r < 4u; r++) c->regs[r] = r;
+        }
+    }
+    a->active = 0;
+}
+
+#endif // MAPPER_AUTO_H
@@ -19,6 +19,13 @@
 // After the pass it consults the openMSX SHA1 database first, then falls back
 // to header-based and heuristic rules — matching the multirom.pio tool.
 //
+// mapper_detect_stream_ranked() also reports how the answer was reached and
+// a ranked candidate list with a 0..100 confidence per entry, so callers can
+// tell a database hit from a marginal opcode count. This is the only copy of
+// the header: the Explorer firmware and tool, the 2040 and 2350 loadrom.pio
+// and multirom.pio tools and the tool/bench accuracy benchmark include it
+// from common/ by relative path, together with sha1.h and romdb.h.
+//
 // This work is licensed  under a "Creative Commons Attribution-NonCommercial-
 // ShareAlike 4.0 International License".
 // https://creativecommons.org/licenses/by-nc-sa/4.0/
@@ -56,6 +63,38 @@
 #define MAPPER_DETECT_PLANAR64      13u
 #define MAPPER_DETECT_MANBOW2       14u
 
+#define MAPPER_DETECT_MAX_CANDIDATES 4u
+
+// How the top candidate was chosen.
+#define MAPPER_DETECT_SRC_NONE       0u // not identified
+#define MAPPER_DETECT_SRC_ROMDB      1u // SHA-1 found in the openMSX database
+#define MAPPER_DETECT_SRC_HEADER     2u // size / "AB" header / signature rule
+#define MAPPER_DETECT_SRC_HEURISTIC  3u // ld (nnnn),a write-pattern scoring
+#define MAPPER_DETECT_SRC_FALLBACK   4u // no mapper writes; raw constant counts
+
+// Flags for mapper_detect_stream_ranked().
+#define MAPPER_DETECT_NO_ROMDB       0x01u // skip the database (heuristic benchmarking)
+
+// Below this the top candidate is a guess rather than a detection. Only the
+// benchmark uses it; Explorer's MAPPER_AUTO routing compares the top two.
+#define MAPPER_DETECT_CONFIDENT      50u
+
+// Write-pattern hits needed before heuristic confidence is not scaled down.
+#define MAPPER_DETECT_EVIDENCE_FULL  8u
+
+typedef struct {
+    uint8_t mapper;
+    uint8_t confidence;   // 0..100
+} mapper_detect_candidate_t;
+
+typedef struct {
+    uint8_t source;       // MAPPER_DETECT_SRC_*
+    uint8_t count;        // valid entries in cand[], best first
+    mapper_detect_candidate_t cand[MAPPER_DETECT_MAX_CANDIDATES];
+    uint8_t sha1[20];     // valid once the full image was read
+    bool have_sha1;
+} mapper_detect_result_t;
+
 // Streaming reader callback. Reads up to `len` bytes from absolute `offset`
 // into `buf`. Returns the number of bytes actually copied (`< len` only on
 // EOF or error). A return value of 0 before reaching `size` aborts detection.
@@ -105,13 +144,30 @@ static inline void mapper_detect_count_raw(uint16_t raw,
     else if (raw == 0x7800u) (*raw_7800)++;
 }
 
+// Record a single-candidate answer and return its mapper byte.
+static inline uint8_t mapper_detect_single(mapper_detect_result_t *out,
+                                           uint8_t source,
+                                           uint8_t mapper,
+                                           uint8_t confidence)
+{
+    out->source = source;
+    out->count = 1u;
+    out->cand[0].mapper = mapper;
+    out->cand[0].confidence = confidence;
+    return mapper;
+}
+
 // Run the full detector against a streaming reader. `size` is the total ROM
 // length in bytes. Returns the mapper byte (1..14, never 10/11/15..18 which
-// are reserved for system slots) or 0 if the format could not be identified.
-static inline uint8_t mapper_detect_stream(uint32_t size,
-                                           mapper_detect_reader_t reader,
-                                           void *user)
+// are reserved for system slots) or 0 if the format could not be identified;
+// `out` receives the ranked candidates (count 0 when unidentified).
+static inline uint8_t mapper_detect_stream_ranked(uint32_t size,
+                                                  mapper_detect_reader_t reader,
+                                                  void *user,
+                                                  uint8_t flags,
+                                                  mapper_detect_result_t *out)
 {
+    memset(out, 0, sizeof(*out));
     if (size > MAPPER_DETECT_MAX_ROM_SIZE || size < MAPPER_DETECT_MIN_ROM_SIZE) {
         return 0;
     }
@@ -294,13 +350,13 @@ static inline uint8_t mapper_detect_stream(uint32_t size,
         off += got;
     }
 
-    uint8_t sha1[20];
-    sha1_final(&sctx, sha1);
+    sha1_final(&sctx, out->sha1);
+    out->have_sha1 = true;
 
     // ---- Step 1: openMSX SHA1 database lookup ----
-    uint8_t db_type = romdb_lookup(sha1);
+    uint8_t db_type = (flags & MAPPER_DETECT_NO_ROMDB) ? 0u : romdb_lookup(out->sha1);
     if (db_type) {
-        return db_type;
+        return mapper_detect_single(out, MAPPER_DETECT_SRC_ROMDB, db_type, 100u);
     }
 
     // openMSX-style: subtract 1 from ASCII8 if non-zero. Applied here so the
@@ -314,41 +370,41 @@ static inline uint8_t mapper_detect_stream(uint32_t size,
     bool ab4000 = have_hdr_4000 && (hdr_4000[0] == 'A' && hdr_4000[1] == 'B');
 
     if (ab0 && size == 16384u) {
-        return MAPPER_DETECT_PLAIN16;
+        return mapper_detect_single(out, MAPPER_DETECT_SRC_HEADER, MAPPER_DETECT_PLAIN16, 90u);
     }
 
     if (ab0 && size <= 32768u) {
-        if (ab4000) return MAPPER_DETECT_PLANAR48; // Planar32 layout
-        return MAPPER_DETECT_PLAIN32;
+        if (ab4000) return mapper_detect_single(out, MAPPER_DETECT_SRC_HEADER, MAPPER_DETECT_PLANAR48, 80u); // Planar32 layout
+        return mapper_detect_single(out, MAPPER_DETECT_SRC_HEADER, MAPPER_DETECT_PLAIN32, 90u);
     }
 
     if (ab0 && have_hdr16) {
         // ASCII16-X signature: "ASCII16X" at offset 0x10
         static const char ascii16x_sig[] = "ASCII16X";
         if (memcmp(hdr16, ascii16x_sig, 8) == 0) {
-            return MAPPER_DETECT_ASCII16X;
+            return mapper_detect_single(out, MAPPER_DETECT_SRC_HEADER, MAPPER_DETECT_ASCII16X, 95u);
         }
         // NEO-8 / NEO-16 signatures at offset 0x10
         static const char neo8_sig[]  = "ROM_NEO8";
         static const char neo16_sig[] = "ROM_NE16";
-        if (memcmp(hdr16, neo8_sig, 8) == 0)  return MAPPER_DETECT_NEO8;
-        if (memcmp(hdr16, neo16_sig, 8) == 0) return MAPPER_DETECT_NEO16;
+        if (memcmp(hdr16, neo8_sig, 8) == 0)  return mapper_detect_single(out, MAPPER_DETECT_SRC_HEADER, MAPPER_DETECT_NEO8, 95u);
+        if (memcmp(hdr16, neo16_sig, 8) == 0) return mapper_detect_single(out, MAPPER_DETECT_SRC_HEADER, MAPPER_DETECT_NEO16, 95u);
     }
 
     // Manbow2: 512KB ROM with "AB" header and "Manbow 2" string at 0x28000.
     if (size == 524288u && ab0 && have_hdr_28000 &&
         memcmp(hdr_28000, "Manbow 2", 8) == 0) {
-        return MAPPER_DETECT_MANBOW2;
+        return mapper_detect_single(out, MAPPER_DETECT_SRC_HEADER, MAPPER_DETECT_MANBOW2, 95u);
     }
 
     // Planar48: AB at 0x4000 and total ROM <= 48KB (with optional 32KB).
     if (ab4000 && size <= 49152u) {
-        return MAPPER_DETECT_PLANAR48;
+        return mapper_detect_single(out, MAPPER_DETECT_SRC_HEADER, MAPPER_DETECT_PLANAR48, 80u);
     }
 
     // 64KB planar ROMs may only expose AB at 0x4000.
     if (size == 65536u && ab4000) {
-        return MAPPER_DETECT_PLANAR64;
+        return mapper_detect_single(out, MAPPER_DETECT_SRC_HEADER, MAPPER_DETECT_PLANAR64, 80u);
     }
 
     // ---- Step 3: heuristic scoring on larger ROMs ----
@@ -359,15 +415,29 @@ static inline uint8_t mapper_detect_stream(uint32_t size,
             { ascii8_score,     MAPPER_DETECT_ASCII8     },
             { ascii16_score,    MAPPER_DETECT_ASCII16    }
         };
-        uint8_t best_type = 0;
-        unsigned int best_score = 0;
-        for (int c = 0; c < 4; ++c) {
-            if (cands[c].score && cands[c].score >= best_score) {
-                best_score = cands[c].score;
-                best_type = cands[c].type;
+        // Rank by score; on equal scores the later entry wins, as in
+        // openMSX (ASCII16 beats ASCII8, ASCII8 beats Konami, ...).
+        unsigned int total = 0;
+        for (int c = 0; c < 4; ++c) total += cands[c].score;
+        if (total) {
+            unsigned int evidence = total < MAPPER_DETECT_EVIDENCE_FULL ? total : MAPPER_DETECT_EVIDENCE_FULL;
+            bool taken[4] = { false, false, false, false };
+            out->source = MAPPER_DETECT_SRC_HEURISTIC;
+            for (uint8_t n = 0; n < MAPPER_DETECT_MAX_CANDIDATES; ++n) {
+                int best = -1;
+                for (int c = 0; c < 4; ++c) {
+                    if (taken[c] || !cands[c].score) continue;
+                    if (best < 0 || cands[c].score >= cands[best].score) best = c;
+                }
+                if (best < 0) break;
+                taken[best] = true;
+                out->cand[n].mapper = cands[best].type;
+                out->cand[n].confidence = (uint8_t)((uint64_t)cands[best].score * 100u * evidence /
+                                                    ((uint64_t)total * MAPPER_DETECT_EVIDENCE_FULL));
+                out->count = (uint8_t)(n + 1u);
             }
+            return out->cand[0].mapper;
         }
-        if (best_type) return best_type;
 
         // Fallback: no mapper writes detected — disambiguate based on raw
         // 16-bit immediate counts and the observed AB headers.
@@ -375,12 +445,17 @@ static inline uint8_t mapper_detect_stream(uint32_t size,
             ascii8_score == 0u && ascii16_score == 0u)
         {
             if (size == 65536u && (ab0 || ab4000)) {
-                return MAPPER_DETECT_PLANAR64;
+                return mapper_detect_single(out, MAPPER_DETECT_SRC_FALLBACK, MAPPER_DETECT_PLANAR64, 40u);
             }
             if (size > 65536u && ab0 && ((size % 16384u) == 0u)) {
-                return (raw_77ff > (raw_6800 + raw_7800))
-                       ? MAPPER_DETECT_ASCII16
-                       : MAPPER_DETECT_ASCII8;
+                bool a16 = raw_77ff > (raw_6800 + raw_7800);
+                out->source = MAPPER_DETECT_SRC_FALLBACK;
+                out->count = 2u;
+                out->cand[0].mapper = a16 ? MAPPER_DETECT_ASCII16 : MAPPER_DETECT_ASCII8;
+                out->cand[0].confidence = 30u;
+                out->cand[1].mapper = a16 ? MAPPER_DETECT_ASCII8 : MAPPER_DETECT_ASCII16;
+                out->cand[1].confidence = 10u;
+                return out->cand[0].mapper;
             }
         }
     }
@@ -388,6 +463,15 @@ static inline uint8_t mapper_detect_stream(uint32_t size,
     return 0;
 }
 
+// Top candidate only (0 if unidentified).
+static inline uint8_t mapper_detect_stream(uint32_t size,
+                                           mapper_detect_reader_t reader,
+                                           void *user)
+{
+    mapper_detect_result_t result;
+    return mapper_detect_stream_ranked(size, reader, user, 0u, &result);
+}
+
 // Convenience wrapper: detect from an in-memory buffer (whole ROM).
 typedef struct {
     const uint8_t *data;
@@ -411,4 +495,12 @@ static inline uint8_t mapper_detect_buffer(const uint8_t *data, uint32_t size)
     return mapper_detect_stream(size, mapper_detect_membuf_reader, &mb);
 }
 
+static inline uint8_t mapper_detect_buffer_ranked(const uint8_t *data, uint32_t size,
+                                                  uint8_t flags,
+                                                  mapper_detect_result_t *out)
+{
+    mapper_detect_membuf_t mb = { data, size };
+    return mapper_detect_stream_ranked(size, mapper_detect_membuf_reader, &mb, flags, out);
+}
+
 #endif // MAPPER_DETECT_H
@@ -33,11 +33,20 @@ static inline uint32_t sha1_rol(uint32_t value, unsigned int bits)
 #define SHA1_R3(v,w,x,y,z,i) z+=(((w|x)&y)|(w&x))+SHA1_BLK(i)+0x8F1BBCDCu+sha1_rol(v,5);w=sha1_rol(w,30);
 #define SHA1_R4(v,w,x,y,z,i) z+=(w^x^y)+SHA1_BLK(i)+0xCA62C1D6u+sha1_rol(v,5);w=sha1_rol(w,30);
 
-static void sha1_transform(uint32_t state[5], const uint8_t buf[64])
+// The firmware may place the block transform in RAM (it hashes on core1
+// while a game is served from the XIP cache).
+#ifndef SHA1_TRANSFORM_ATTR
+#define SHA1_TRANSFORM_ATTR
+#endif
+
+static SHA1_TRANSFORM_ATTR void sha1_transform(uint32_t state[5], const uint8_t buf[64])
 {
     uint32_t a, b, c, d, e;
     uint32_t block[16];
-    memcpy(block, buf, 64);
+    // Little-endian word loads, as memcpy would do; SHA1_BLK0 swaps them.
+    for (unsigned int i = 0; i < 16; i++)
+        block[i] = (uint32_t)buf[i * 4] | ((uint32_t)buf[i * 4 + 1] << 8) |
+                   ((uint32_t)buf[i * 4 + 2] << 16) | ((uint32_t)buf[i * 4 + 3] << 24);
 
     a = state[0]; b = state[1]; c = state[2]; d = state[3]; e = state[4];
 